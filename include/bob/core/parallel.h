@@ -0,0 +1,106 @@
+/**
+ * @file bob/core/parallel.h
+ * @date Sat Oct 17 11:02:17 2026 +0200
+ *
+ * @brief Simple helpers to split a loop computation across multiple
+ * threads, based on boost::thread.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_CORE_PARALLEL_H
+#define BOB_CORE_PARALLEL_H
+
+#include <cstddef>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+
+namespace bob { namespace core {
+/**
+ * @ingroup CORE
+ * @{
+ */
+
+  namespace detail {
+    template <typename TOp>
+    void parallel_for_worker(TOp& op, const size_t thread_index,
+        const size_t begin, const size_t end, std::exception_ptr& error)
+    {
+      try {
+        op(thread_index, begin, end);
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+    }
+  }
+
+  /**
+   * @brief Returns the number of threads to use for a computation over
+   * n_objects objects, when n_threads threads are requested. A value of
+   * zero means as many threads as the number of hardware cores.
+   */
+  inline size_t parallel_threads(const size_t n_objects, size_t n_threads)
+  {
+    if (n_threads == 0) n_threads = boost::thread::hardware_concurrency();
+    return std::max((size_t)1, std::min(n_threads, n_objects));
+  }
+
+  /**
+   * @brief Splits the range [0, n_objects) into (at most) n_threads
+   * contiguous chunks of similar sizes, and calls
+   * op(thread_index, begin, end) on each of them in a separate thread.
+   * The call blocks until all the chunks have been processed. If a single
+   * thread is used, op is called directly in the calling thread.
+   *
+   * If any of the calls throws, the first exception (in thread order) is
+   * rethrown in the calling thread once all threads have been joined.
+   *
+   * @return The number of chunks (threads) actually used
+   */
+  template <typename TOp>
+  size_t parallel_for(TOp op, const size_t n_objects, const size_t n_threads)
+  {
+    const size_t n = parallel_threads(n_objects, n_threads);
+    if (n == 1) {
+      op((size_t)0, (size_t)0, n_objects);
+      return 1;
+    }
+
+    std::vector<std::exception_ptr> errors(n);
+    boost::thread_group threads;
+    for (size_t t=0; t<n; ++t) {
+      const size_t begin = (n_objects * t) / n;
+      const size_t end = (n_objects * (t+1)) / n;
+      threads.create_thread(boost::bind(&detail::parallel_for_worker<TOp>,
+            boost::ref(op), t, begin, end, boost::ref(errors[t])));
+    }
+    threads.join_all();
+
+    for (size_t t=0; t<n; ++t)
+      if (errors[t]) std::rethrow_exception(errors[t]);
+    return n;
+  }
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_CORE_PARALLEL_H */
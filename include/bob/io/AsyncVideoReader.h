@@ -0,0 +1,127 @@
+/**
+ * @file bob/io/AsyncVideoReader.h
+ * @date Sat Oct 17 16:40:12 2026 +0200
+ *
+ * @brief A class to read videos, decoding frames in a background thread.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_IO_ASYNCVIDEOREADER_H
+#define BOB_IO_ASYNCVIDEOREADER_H
+
+#include <vector>
+#include <exception>
+#include <blitz/array.h>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <bob/io/VideoReader.h>
+
+namespace bob { namespace io {
+
+  /**
+   * AsyncVideoReader objects read the frames of a video in a background
+   * thread. The producer thread demuxes, decodes and converts frames into a
+   * bounded ring of pre-allocated buffers, while the consumer pulls ready
+   * frames with read(). Decoding hence overlaps with whatever the consumer
+   * does with the frames.
+   *
+   * The producer starts as soon as the object is constructed, and stops
+   * once the end of the video is reached (or when the object is destroyed).
+   */
+  class AsyncVideoReader: boost::noncopyable {
+
+    public:
+
+      /**
+       * Starts reading the given video in a background thread, into a ring
+       * of 'n_buffers' frames (at least 1). The readout advances by 'stride'
+       * frames after each frame (see VideoReader::begin()).
+       *
+       * The flag 'throw_on_error' has the same meaning as for
+       * VideoReader::load(): if it is 'false', the video is silently
+       * truncated at the first frame that cannot be read. Otherwise,
+       * the error is reported by the read() call that would have returned
+       * that frame.
+       */
+      AsyncVideoReader(boost::shared_ptr<const VideoReader> reader,
+          size_t n_buffers=8, size_t stride=1, bool throw_on_error=false);
+
+      /**
+       * Destructor virtualization. Stops and joins the producer thread.
+       */
+      virtual ~AsyncVideoReader();
+
+      /**
+       * Returns the video reader frames are read from
+       */
+      inline const VideoReader& reader() const { return *m_reader; }
+
+      /**
+       * Returns the number of frame buffers in the ring
+       */
+      inline size_t buffers() const { return m_buffers.size(); }
+
+      /**
+       * Reads the next frame, waiting for it to be decoded if required. The
+       * 'data' format is (color-bands, height, width). Returns 'false' once
+       * all frames have been read.
+       */
+      bool read(blitz::Array<uint8_t,3>& data);
+
+      /**
+       * Reads the next frame, waiting for it to be decoded if required.
+       * Returns 'false' once all frames have been read.
+       */
+      bool read(bob::core::array::interface& data);
+
+      /**
+       * Returns the number (in the video) of the frame that was returned by
+       * the last call to read()
+       */
+      inline size_t cur() const { return m_last_frame; }
+
+    private: //methods
+
+      /**
+       * Body of the producer thread
+       */
+      void run();
+
+    private: //representation
+
+      boost::shared_ptr<const VideoReader> m_reader; ///< the video
+      size_t m_stride; ///< frames to advance after each read
+      bool m_throw_on_error; ///< report reading errors?
+      std::vector<blitz::Array<uint8_t,3> > m_buffers; ///< ring of frames
+      std::vector<size_t> m_frames; ///< frame numbers of the buffers
+      size_t m_head; ///< next buffer to be read by the consumer
+      size_t m_ready; ///< number of decoded buffers, starting at m_head
+      bool m_finished; ///< has the producer finished?
+      bool m_stop; ///< shall the producer stop?
+      std::exception_ptr m_error; ///< error reported by the producer
+      size_t m_last_frame; ///< last frame returned to the consumer
+      boost::mutex m_mutex; ///< protects the state of the ring
+      boost::condition_variable m_frame_ready; ///< signals decoded frames
+      boost::condition_variable m_buffer_free; ///< signals free buffers
+      boost::thread m_thread; ///< the producer
+  };
+
+}}
+
+#endif //BOB_IO_ASYNCVIDEOREADER_H
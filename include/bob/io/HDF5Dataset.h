@@ -400,6 +400,15 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        */
       void read_buffer (size_t index, const bob::io::HDF5Type& dest, void* buffer);
 
+      /**
+       * Reads a hyperslab of the whole dataset into the given (user) buffer.
+       * The hyperslab starts at the given offsets, and its extents are the
+       * shape of "dest", which must have the rank of the dataset. The values
+       * are converted to the element type of "dest" if needed.
+       */
+      void read_hyperslab (const bob::io::HDF5Shape& start,
+          const bob::io::HDF5Type& dest, void* buffer);
+
       /**
        * Writes the contents of a given buffer into the file. The area that the
        * data will occupy should have been selected beforehand.
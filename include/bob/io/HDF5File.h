@@ -381,6 +381,15 @@ namespace bob { namespace io {
       void read_buffer (const std::string& path, size_t pos,
           const HDF5Type& type, void* buffer) const;
 
+      /**
+       * Reads a hyperslab of the whole dataset, starting at the given
+       * offsets, into a buffer. The extents of the hyperslab are the shape of
+       * "type", which must have the rank of the dataset. Relative paths are
+       * accepted.
+       */
+      void read_hyperslab (const std::string& path, const HDF5Shape& start,
+          const HDF5Type& type, void* buffer) const;
+
       /**
        * writes the contents of a given buffer into the file. the area that the
        * data will occupy should have been selected beforehand.
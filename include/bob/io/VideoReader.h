@@ -27,6 +27,7 @@
 #include <string>
 #include <blitz/array.h>
 #include <stdint.h>
+#include <boost/thread/mutex.hpp>
 
 #include <bob/core/array.h>
 #include <bob/io/VideoUtilities.h>
@@ -133,6 +134,20 @@ namespace bob { namespace io {
        */
       inline const std::string& info() const { return m_formatted_info; }
 
+      /**
+       * Sets the number of threads ffmpeg may use to decode the frames or
+       * slices of the video stream in parallel (1 by default, 0 means as many
+       * threads as hardware cores). This applies to iterators created after
+       * this call. Not all codecs support multi-threaded decoding.
+       */
+      inline void setDecodingThreads(size_t n_threads)
+      { m_decoding_threads = n_threads; }
+
+      /**
+       * Returns the number of threads ffmpeg may use to decode the video
+       */
+      inline size_t getDecodingThreads() const { return m_decoding_threads; }
+
       /**
        * Returns the typing information for this video
        */
@@ -179,6 +194,34 @@ namespace bob { namespace io {
       size_t load(bob::core::array::interface& b, 
           bool throw_on_error=false, void (*check)(void)=0) const;
 
+      /**
+       * Reads a single frame, given its number in the video stream. The
+       * stream is moved to the closest key frame before the requested one,
+       * and decoded forward from there, so the cost of this call does not
+       * depend on the position of the frame in the stream. The 'data' format
+       * is (color-bands, height, width). The first call builds an index of
+       * the key frames of the video stream, by reading (but not decoding)
+       * the whole file.
+       *
+       * The decoding contexts are kept from one call to the next. Reading
+       * frames in increasing order hence continues decoding from the last
+       * frame read, instead of re-opening the file and seeking each time.
+       * Calls from several threads are serialized.
+       *
+       * The flag 'throw_on_error' has the same meaning as in load(). Reading
+       * a frame after the end of the stream returns 'false', or throws if
+       * this flag is set.
+       */
+      bool read(size_t index, blitz::Array<uint8_t,3>& data,
+          bool throw_on_error=false) const;
+
+      /**
+       * Reads a single frame, given its number in the video stream. See the
+       * method above for details.
+       */
+      bool read(size_t index, bob::core::array::interface& data,
+          bool throw_on_error=false) const;
+
     private: //methods
 
       /**
@@ -186,6 +229,12 @@ namespace bob { namespace io {
        */
       void open(const std::string& filename, bool check);
 
+      /**
+       * Returns the index of the frames of the video stream, building it on
+       * the first call. This method is thread-safe.
+       */
+      const bob::io::detail::ffmpeg::video_index& index() const;
+
     public: //iterators
 
       /**
@@ -224,7 +273,8 @@ namespace bob { namespace io {
            */
 
           /**
-           * Prefix operator, advance one frame, return self.
+           * Prefix operator, advance one frame (or stride frames for strided
+           * iterators), return self.
            */
           const_iterator& operator++ ();
 
@@ -235,12 +285,22 @@ namespace bob { namespace io {
 
           /**
            * Fast-forward the video readout by N frames, return self. This
-           * implementation is slow because of ffmpeg limitations. It has no
-           * precise frame lookup function. What we have to do is to read
-           * frame-by-frame and stop when you want to.
+           * uses seek() and hence does not depend on the stride of the
+           * iterator.
            */
           const_iterator& operator+= (size_t frames);
 
+          /**
+           * Moves the iterator to the given frame, return self. If there is
+           * no key frame between the current and the requested frame, the
+           * frames in between are decoded and skipped. Otherwise, the stream
+           * is moved to the closest key frame before the requested frame,
+           * and decoded forward from there. If the video stream cannot be
+           * indexed or if seeking fails, we fall back to reading the video
+           * frame-by-frame from its start.
+           */
+          const_iterator& seek (size_t frame);
+
           /**
            * Compares two iterators for equality
            */
@@ -311,6 +371,11 @@ namespace bob { namespace io {
            */
           inline size_t cur() const { return m_current_frame; }
 
+          /**
+           * Tells by how many frames the iterator advances after each read
+           */
+          inline size_t stride() const { return m_stride; }
+
           /**
            * Gets the parent
            */
@@ -322,7 +387,7 @@ namespace bob { namespace io {
            * The only way to build a new iterator is to use the parent's
            * begin()/end() methods.
            */
-          const_iterator(const VideoReader* parent);
+          const_iterator(const VideoReader* parent, size_t stride=1);
 
           /**
            * This creates an iterator pointing to "end"
@@ -336,6 +401,23 @@ namespace bob { namespace io {
            */
           void init();
 
+          /**
+           * Closes and re-opens the movie file, pointing to the first frame
+           */
+          void rewind();
+
+          /**
+           * Advances one frame, skipping it in the fastest possible way
+           */
+          void skip();
+
+          /**
+           * Seeks to the given key frame (position in the key frame index)
+           * and decodes forward up to the given frame, which is kept in
+           * m_context_frame. Returns 'false' if synchronization was lost.
+           */
+          bool seek_keyframe(size_t keyframe, size_t frame);
+
         private: //representation
           const VideoReader* m_parent; ///< who generated me
           boost::shared_ptr<AVFormatContext> m_format_context; ///< format context
@@ -347,6 +429,8 @@ namespace bob { namespace io {
           blitz::Array<uint8_t,3> m_rgb_array; ///< temporary
           boost::shared_ptr<SwsContext> m_swscaler; ///< software scaler
           size_t m_current_frame; ///< the current frame to be read
+          size_t m_stride; ///< how many frames to advance after each read
+          bool m_decoded; ///< is the current frame already in m_context_frame?
 
         public: //friendship
 
@@ -359,6 +443,13 @@ namespace bob { namespace io {
        */
       const_iterator begin() const;
 
+      /**
+       * Returns an iterator to the begin of the video stream, which advances
+       * by 'stride' frames after each read (e.g. to sample the video at a
+       * lower frame rate).
+       */
+      const_iterator begin(size_t stride) const;
+
       /**
        * Returns an iterator to the end of the video sequence.
        */
@@ -368,6 +459,7 @@ namespace bob { namespace io {
 
       std::string m_filepath; ///< the name of the file we are manipulating
       bool m_check; ///< shall I check for compatibility when opening?
+      size_t m_decoding_threads; ///< threads used by ffmpeg to decode frames
       size_t m_height; ///< the height of the video frames (number of rows)
       size_t m_width; ///< the width of the video frames (number of columns)
       size_t m_nframes; ///< the number of frames in this video file
@@ -380,6 +472,10 @@ namespace bob { namespace io {
       std::string m_formatted_info; ///< printable information about the video
       bob::core::array::typeinfo m_typeinfo_video; ///< read whole video type
       bob::core::array::typeinfo m_typeinfo_frame; ///< read single frame type
+      mutable boost::shared_ptr<bob::io::detail::ffmpeg::video_index> m_index; ///< key frames, built on demand
+      mutable boost::mutex m_index_mutex; ///< guards m_index (iterators may run in other threads)
+      mutable boost::shared_ptr<const_iterator> m_read_iterator; ///< kept between calls to read()
+      mutable boost::mutex m_read_mutex; ///< guards m_read_iterator
   };
 
 }}
@@ -113,7 +113,9 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
    ************************************************************************/
 
   /**
-   * Creates a new codec context and verify all is good.
+   * Creates a new codec context and verify all is good. If thread_count is
+   * not 1, the codec may use that many threads (0 means as many threads as
+   * hardware cores) to decode frames or slices in parallel.
    *
    * @note The returned object knows how to correctly delete itself, freeing
    * all acquired resources. Nonetheless, when this object is used in
@@ -121,7 +123,8 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
    * respected.
    */
   boost::shared_ptr<AVCodecContext> make_codec_context(
-      const std::string& filename, AVStream* stream, AVCodec* codec);
+      const std::string& filename, AVStream* stream, AVCodec* codec,
+      size_t thread_count=1);
 
   /**
    * Allocates the software scaler that handles size and pixel format
@@ -214,6 +217,61 @@ namespace bob { namespace io { namespace detail { namespace ffmpeg {
       boost::shared_ptr<AVCodecContext> codec_context,
       boost::shared_ptr<AVFrame> context_frame, bool throw_on_error);
 
+  /**
+   * Converts the frame last decoded into context_frame to packed RGB, into
+   * data. Input data must be previously allocated and be of the right type
+   * and size for holding the frame contents.
+   *
+   * @return true if it manages to convert the video frame or false otherwise.
+   */
+  bool convert_video_frame (const std::string& filename, int current_frame,
+      boost::shared_ptr<AVCodecContext> codec_context,
+      boost::shared_ptr<SwsContext> swscaler,
+      boost::shared_ptr<AVFrame> context_frame, uint8_t* data,
+      bool throw_on_error);
+
+  /**
+   * Index of the frames of a video stream, in presentation order. Frames
+   * are identified by their timestamps, in the stream time base.
+   */
+  struct video_index {
+    std::vector<int64_t> timestamps; ///< timestamps of all frames
+    std::vector<size_t> keyframes; ///< (presentation) numbers of key frames
+    std::vector<int64_t> seek_timestamps; ///< where to seek for key frames
+  };
+
+  /**
+   * Builds the index of the frames of the video stream, by reading (but not
+   * decoding) all of its packets. If the stream does not provide the
+   * timestamps of its packets, the index is left empty.
+   */
+  void index_video_stream (const std::string& filename, int stream_index,
+      boost::shared_ptr<AVFormatContext> format_context, video_index& index);
+
+  /**
+   * Moves the stream to (or before) the given timestamp and flushes the
+   * decoder buffers.
+   *
+   * @return true if the seek succeeds or false otherwise.
+   */
+  bool seek_video_stream (const std::string& filename, int stream_index,
+      boost::shared_ptr<AVFormatContext> format_context,
+      boost::shared_ptr<AVCodecContext> codec_context, int64_t timestamp,
+      bool throw_on_error);
+
+  /**
+   * Decodes the next video frame from the stream, without converting it,
+   * and returns its timestamp (AV_NOPTS_VALUE if unknown).
+   *
+   * @return true if a frame was decoded or false otherwise (end of the
+   * stream or error).
+   */
+  bool decode_video_frame (const std::string& filename, int current_frame,
+      int stream_index, boost::shared_ptr<AVFormatContext> format_context,
+      boost::shared_ptr<AVCodecContext> codec_context,
+      boost::shared_ptr<AVFrame> context_frame, int64_t& timestamp,
+      bool throw_on_error);
+
   /************************************************************************
    * Video writing specific utilities
    ************************************************************************/
@@ -27,15 +27,76 @@
 #include <iostream>
 #include <blitz/array.h>
 #include <algorithm>
+#include <limits>
+#include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
 #include "bob/core/assert.h"
 #include "bob/core/array_copy.h"
 #include "bob/core/cast.h"
+#include "bob/core/parallel.h"
 #include "bob/ip/Exception.h"
 #include "bob/sp/Quantization.h"
 
 namespace bob { namespace ip {
 
+  namespace detail {
+    /**
+     * Quantizes the rows of an image into grey levels. The generic version
+     * calls the quantization of each pixel, while small integer types (8 and
+     * 16 bits) go through a lookup table covering the whole range of the
+     * type, when the image has more pixels than the table has entries. The
+     * quantizer is only read while quantizing, so that it can be shared by
+     * several threads.
+     */
+    template <typename T, bool small = (std::numeric_limits<T>::is_integer && sizeof(T) <= 2)>
+    class GLCMQuantizer {
+      public:
+        GLCMQuantizer(const bob::sp::Quantization<T>& quantization, const size_t)
+        : m_quantization(quantization) {}
+
+        void quantize_row(const blitz::Array<T,2>& src, const int y, uint32_t* dst) const
+        {
+          for (int x = 0; x < src.extent(1); ++x)
+            dst[x] = m_quantization.quantization_level(src(y,x));
+        }
+
+      private:
+        const bob::sp::Quantization<T>& m_quantization;
+    };
+
+    template <typename T>
+    class GLCMQuantizer<T,true> {
+      public:
+        GLCMQuantizer(const bob::sp::Quantization<T>& quantization, const size_t n_pixels)
+        : m_quantization(quantization)
+        {
+          const int t_min = (int)std::numeric_limits<T>::min();
+          const int t_max = (int)std::numeric_limits<T>::max();
+          if (n_pixels < (size_t)(t_max - t_min + 1)) return;
+
+          m_lut.resize(t_max - t_min + 1);
+          for (int v = t_min; v <= t_max; ++v)
+            m_lut[v - t_min] = quantization.quantization_level((T)v);
+        }
+
+        void quantize_row(const blitz::Array<T,2>& src, const int y, uint32_t* dst) const
+        {
+          const int t_min = (int)std::numeric_limits<T>::min();
+          if (m_lut.empty())
+            for (int x = 0; x < src.extent(1); ++x)
+              dst[x] = m_quantization.quantization_level(src(y,x));
+          else
+            for (int x = 0; x < src.extent(1); ++x)
+              dst[x] = m_lut[(int)src(y,x) - t_min];
+        }
+
+      private:
+        const bob::sp::Quantization<T>& m_quantization;
+        std::vector<uint32_t> m_lut;
+    };
+  }
+
   /**
    * This class allows to extract Grey-Level Co-occurence Matrix (GLCM). For more information, please refer to the
    * following article: "Textural Features for Image calssification", from R. M. Haralick, K. Shanmugam, I. Dinstein
@@ -95,6 +156,15 @@ namespace bob { namespace ip {
       /**
        * Compute Gray-Level Co-occurences from a 2D blitz::Array, and save the resulting
        * GLCM matrix in the dst 3D blitz::Array.
+       *
+       * The image is visited once for all the offsets: each row of the
+       * quantized image is paired with the rows at all the vertical offsets,
+       * and the co-occurences are accumulated as integer counts. With several
+       * threads, each thread counts a band of rows in its own buffer, and the
+       * buffers are summed afterwards. The rows are quantized while they are
+       * counted, into a rolling buffer of each thread that only holds the
+       * rows spanned by the vertical offsets. Symmetry and normalization are
+       * applied while writing the counts into the output array.
        */
       void operator()(const blitz::Array<T,2>& src, blitz::Array<double,3>& glcm) const;
 
@@ -111,6 +181,7 @@ namespace bob { namespace ip {
       const bool getNormalized() const { return m_normalized; }
       const bob::sp::Quantization<T> getQuantization() const { return m_quantization; }
       const blitz::Array<T,1>&  getQuantizationTable() const{ return m_quantization.getThresholds(); }
+      size_t getNThreads() const { return m_n_threads; }
       
       
       /**
@@ -125,8 +196,24 @@ namespace bob { namespace ip {
 
       void setNormalized(const bool normalized)
       { m_normalized = normalized; }
+
+      /**
+       * Sets the number of threads used to accumulate the co-occurences
+       * (0 means as many threads as hardware cores)
+       */
+      void setNThreads(const size_t n_threads)
+      { m_n_threads = n_threads; }
       
     protected:
+    /**
+    * Counts the co-occurences of the rows [begin, end) of the image, for all
+    * the offsets, into the buffer of the given thread
+    */
+    void count_rows(const detail::GLCMQuantizer<T>& quantizer,
+      const blitz::Array<T,2>& src,
+      std::vector<uint32_t>& counts, const size_t thread,
+      const size_t begin, const size_t end) const;
+
     /**
     * Attributes
     */
@@ -136,7 +223,7 @@ namespace bob { namespace ip {
     bob::sp::Quantization<T> m_quantization;
     bool m_symmetric;
     bool m_normalized;
-    
+    size_t m_n_threads;
     
    };
 
@@ -148,6 +235,7 @@ bob::ip::GLCM<T>::GLCM()
   m_offset = 1, 0; // this is the default offset
   m_symmetric = false;
   m_normalized = false;
+  m_n_threads = 1;
   m_quantization = bob::sp::Quantization<T>();
 }
 
@@ -158,6 +246,7 @@ bob::ip::GLCM<T>::GLCM(int num_levels)
   m_offset = 1, 0; // this is the default offset
   m_symmetric = false;
   m_normalized = false;
+  m_n_threads = 1;
   m_quantization = bob::sp::Quantization<T>(bob::sp::quantization::UNIFORM, num_levels);
 }
 
@@ -168,6 +257,7 @@ bob::ip::GLCM<T>::GLCM(int num_levels, T min_level, T max_level)
   m_offset = 1, 0; // this is the default offset
   m_symmetric = false;
   m_normalized = false;
+  m_n_threads = 1;
   m_quantization = bob::sp::Quantization<T>(bob::sp::quantization::UNIFORM, num_levels, min_level, max_level);
 }
 
@@ -178,6 +268,7 @@ bob::ip::GLCM<T>::GLCM(const blitz::Array<T,1>& quant_thres)
   m_offset = 1, 0; // this is the default offset
   m_symmetric = false;
   m_normalized = false;
+  m_n_threads = 1;
   m_quantization = bob::sp::Quantization<T>(quant_thres);
 }
 
@@ -187,6 +278,7 @@ bob::ip::GLCM<T>::GLCM(const bob::ip::GLCM<T>& other)
   m_offset.reference(bob::core::array::ccopy(other.getOffset()));
   m_symmetric = other.getSymmetric();
   m_normalized = other.getNormalized();
+  m_n_threads = other.getNThreads();
   m_quantization = other.getQuantization();
 }
 
@@ -200,6 +292,7 @@ bob::ip::GLCM<T>& bob::ip::GLCM<T>::operator=(const bob::ip::GLCM<T>& other) {
     m_offset.reference(bob::core::array::ccopy(other.getOffset()));
     m_symmetric = other.getSymmetric();
     m_normalized = other.getNormalized();
+    m_n_threads = other.getNThreads();
     m_quantization = other.getQuantization();
   }
   return *this;
@@ -228,6 +321,56 @@ const blitz::TinyVector<int,3> bob::ip::GLCM<T>::getGLCMShape() const
 
 
 
+template <typename T>
+void bob::ip::GLCM<T>::count_rows(const detail::GLCMQuantizer<T>& quantizer,
+  const blitz::Array<T,2>& src,
+  std::vector<uint32_t>& counts, const size_t thread,
+  const size_t begin, const size_t end) const
+{
+  const int height = src.extent(0);
+  const int width = src.extent(1);
+  const int n_levels = m_quantization.getNumLevels();
+  const int n_offsets = m_offset.extent(0);
+  const size_t n_cells = (size_t)n_levels * n_levels;
+  uint32_t* thread_counts = &counts[thread * n_offsets * n_cells];
+
+  // the rows [y + dy_min, y + dy_max] are needed to count the row y; they
+  // are kept in a rolling buffer, the row y1 being stored at y1 % n_rows
+  int dy_min = 0, dy_max = 0;
+  for (int off_ind = 0; off_ind < n_offsets; ++off_ind)
+  {
+    dy_min = std::min(dy_min, (int)m_offset(off_ind, 1));
+    dy_max = std::max(dy_max, (int)m_offset(off_ind, 1));
+  }
+  const int n_rows = dy_max - dy_min + 1;
+  std::vector<uint32_t> levels((size_t)n_rows * width);
+  uint32_t* data = levels.data();
+
+  int next = std::max(0, (int)begin + dy_min); // the next row to quantize
+  for (int y = (int)begin; y < (int)end; ++y)
+  {
+    // quantizes the rows up to y + dy_max, overwriting the ones above y + dy_min
+    for (; next <= std::min(height - 1, y + dy_max); ++next)
+      quantizer.quantize_row(src, next, data + (size_t)(next % n_rows) * width);
+
+    const uint32_t* row = data + (size_t)(y % n_rows) * width;
+    for (int off_ind = 0; off_ind < n_offsets; ++off_ind)
+    {
+      const int dx = m_offset(off_ind, 0);
+      const int y1 = y + m_offset(off_ind, 1);
+      if (y1 < 0 || y1 >= height) continue;
+
+      // range of x for which the neighbour x + dx lies in the image
+      const int x_begin = std::max(0, -dx);
+      const int x_end = std::min(width, width - dx);
+      const uint32_t* row1 = data + (size_t)(y1 % n_rows) * width + dx;
+      uint32_t* off_counts = thread_counts + off_ind * n_cells;
+      for (int x = x_begin; x < x_end; ++x)
+        ++off_counts[row[x] * n_levels + row1[x]];
+    }
+  }
+}
+
 template <typename T>
 void bob::ip::GLCM<T>::operator()(const blitz::Array<T,2>& src, blitz::Array<double,3>& glcm) const
 {
@@ -235,50 +378,48 @@ void bob::ip::GLCM<T>::operator()(const blitz::Array<T,2>& src, blitz::Array<dou
   blitz::TinyVector<int,3> shape(getGLCMShape());
   bob::core::array::assertSameShape(glcm, shape);
 
-  glcm=0;
-  
-  blitz::Array<uint32_t,2> src_quant = m_quantization(src);
-  
-  for(int off_ind = 0; off_ind < m_offset.extent(0); ++off_ind) // loop over all the possible offsets
-  {
-      // loop over each pixel of the image
-      for(int y = 0; y < src_quant.extent(0); ++y)
-      {
-        for(int x = 0; x < src_quant.extent(1); ++x)
-        {
-          int i_level = (int)(src_quant(y,x)); // the grey level of the current pixel
-          const int y1 = y + m_offset(off_ind, 1);
-          const int x1 = x + m_offset(off_ind, 0);
-
-          if(y1 >= 0 && y1 < src_quant.extent(0) && x1 >= 0 && x1 < src_quant.extent(1))
-          {
-            int j_level = (int)(src_quant(y1, x1));
-            glcm(i_level, j_level, off_ind) += 1; 
-              
-          }
-        }
-      }   
-            
-    }
-  
-  if(m_symmetric) // make the matrix symmetric
+  const int n_levels = shape(0);
+  const int n_offsets = shape(2);
+  const size_t n_cells = (size_t)n_levels * n_levels;
+
+  const detail::GLCMQuantizer<T> quantizer(m_quantization, src.numElements());
+
+  // one buffer of counts per thread, laid out as (offset, i_level, j_level)
+  const size_t n_threads = bob::core::parallel_threads(src.extent(0), m_n_threads);
+  std::vector<uint32_t> counts(n_threads * n_offsets * n_cells, 0);
+  bob::core::parallel_for(boost::bind(&GLCM<T>::count_rows, this,
+        boost::cref(quantizer), boost::cref(src), boost::ref(counts), _1, _2, _3),
+      src.extent(0), n_threads);
+
+  // reduces the buffers of the other threads into the first one
+  for (size_t t = 1; t < n_threads; ++t)
   {
-    blitz::Array<double,3> temp = glcm.copy();
-    temp.transposeSelf(1,0,2);
-    glcm += temp;
+    const uint32_t* thread_counts = &counts[t * n_offsets * n_cells];
+    for (size_t k = 0; k < n_offsets * n_cells; ++k)
+      counts[k] += thread_counts[k];
   }
 
-  if (m_normalized) // normalize the output image
+  for (int off_ind = 0; off_ind < n_offsets; ++off_ind)
   {
-    blitz::firstIndex i;
-    blitz::secondIndex j;
-    blitz::thirdIndex k;
-    blitz::Array<double, 2> summations_temp(blitz::sum(glcm(i, k, j), k));
-    blitz::Array<double, 1> summations(blitz::sum(summations_temp(j,i), j));
-    glcm /= summations(k);
-    //std::cout << "glcm after normalization: " << glcm(blitz::Range(0,1),blitz::Range(0,1),blitz::Range(0,1)) << std::endl;    
+    const uint32_t* off_counts = &counts[off_ind * n_cells];
+    uint64_t total = 0;
+    for (size_t k = 0; k < n_cells; ++k)
+      total += off_counts[k];
+    if (m_symmetric) total *= 2; // both (i, j) and (j, i) are accumulated
+
+    for (int i_level = 0; i_level < n_levels; ++i_level)
+    {
+      for (int j_level = 0; j_level < n_levels; ++j_level)
+      {
+        double value = off_counts[i_level * n_levels + j_level];
+        if (m_symmetric) // make the matrix symmetric
+          value += off_counts[j_level * n_levels + i_level];
+        if (m_normalized) // normalize by the number of co-occurences
+          value /= (double)total;
+        glcm(i_level, j_level, off_ind) = value;
+      }
+    }
   }
-  
 }        
 
 }}
@@ -79,6 +79,35 @@ namespace bob { namespace ip {
       * Get the shape of the output array for the property 
       */
       const blitz::TinyVector<int,1> get_prop_shape(const blitz::Array<double,3>& glcm) const;
+
+      /**
+      * Columns of the output array of properties(), in the order of
+      * declaration of the single property methods below
+      */
+      enum Property {
+        ANGULAR_SECOND_MOMENT=0, ENERGY, VARIANCE, CONTRAST, AUTO_CORRELATION,
+        CORRELATION, CORRELATION_M, INV_DIFF_MOM, SUM_AVG, SUM_VAR,
+        SUM_ENTROPY, ENTROPY, DIFF_VAR, DIFF_ENTROPY, DISSIMILARITY,
+        HOMOGENEITY, CLUSTER_PROM, CLUSTER_SHADE, MAX_PROB, INF_MEAS_CORR1,
+        INF_MEAS_CORR2, INV_DIFF, INV_DIFF_NORM, INV_DIFF_MOM_NORM,
+        N_PROPERTIES
+      };
+
+      /**
+      * Get the shape of the output array of properties(): one row per
+      * offset, and one column per property
+      */
+      const blitz::TinyVector<int,2> get_properties_shape(const blitz::Array<double,3>& glcm) const;
+
+      /**
+      * Compute all the properties listed below at once. The matrix of each
+      * offset is read in a single pass, which accumulates its marginal
+      * probabilities, the probabilities of the sums and of the absolute
+      * differences of the grey levels, and a few cell-wise sums. All the
+      * properties are then derived from these accumulators. The columns of
+      * the output are given by the Property enumeration.
+      */
+      void properties(const blitz::Array<double,3>& glcm, blitz::Array<double,2>& props) const;
       
       /**
        * Compute each of the single GLCM properties from a 3D blitz::Array which is the GLCM matrix
@@ -145,6 +174,11 @@ namespace bob { namespace ip {
     */
     const blitz::Array<double,3> normalize_glcm(const blitz::Array<double,3>& glcm) const;
 
+    /**
+    * Computes all the properties, and copies the requested one into prop
+    */
+    void extract_property(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop, const Property property) const;
+
 };
 
 }}
@@ -155,6 +155,76 @@ namespace bob {
           bool do_normalize = true
         );
 
+        //! \brief performs Gabor wavelet transform of several images of the same
+        //! size, and returns one trafo image per input image (4D array)
+        void performGWT(
+          const blitz::Array<std::complex<double>,3>& gray_images,
+          blitz::Array<std::complex<double>,4>& trafo_images
+        );
+
+        //! \brief performs Gabor wavelet transform of several images of the same
+        //! size, and creates one 4D jet image per input image (5D array)
+        void computeJetImage(
+          const blitz::Array<std::complex<double>,3>& gray_images,
+          blitz::Array<double,5>& jet_images,
+          bool do_normalize = true
+        );
+
+        //! \brief performs Gabor wavelet transform of several images of the same
+        //! size, and creates one 3D jet image per input image (4D array)
+        void computeJetImage(
+          const blitz::Array<std::complex<double>,3>& gray_images,
+          blitz::Array<double,4>& jet_images,
+          bool do_normalize = true
+        );
+
+        //! \brief computes the Gabor jets (absolute part and phase part) at the
+        //! given (y,x) positions only, in spatial domain
+        void computeSparseJets(
+          const blitz::Array<std::complex<double>,2>& gray_image,
+          const blitz::Array<int,2>& positions,
+          blitz::Array<double,3>& jets,
+          bool do_normalize = true
+        );
+
+        //! \brief computes the Gabor jets (absolute parts of the responses only)
+        //! at the given (y,x) positions only, in spatial domain
+        void computeSparseJets(
+          const blitz::Array<std::complex<double>,2>& gray_image,
+          const blitz::Array<int,2>& positions,
+          blitz::Array<double,2>& jets,
+          bool do_normalize = true
+        );
+
+        //! \brief The largest number of positions for which computeSparseJets()
+        //! is cheaper than computeJetImage() on images of the given resolution.
+        //! Counting complex multiply-adds, one sparse jet costs the summed areas
+        //! of the cropped spatial wavelets (which depend on the spatial epsilon),
+        //! while the jet image costs one FFT and one inverse FFT per kernel
+        //! (about 5/8 N log2 N each, for N pixels) plus N products per kernel.
+        unsigned sparseJetsCrossover(blitz::TinyVector<unsigned,2> resolution);
+
+        //! \brief The number of threads used by the batch transforms, each
+        //! thread transforming a part of the images (0 means as many threads as
+        //! hardware cores)
+        size_t getNThreads() const {return m_n_threads;}
+        void setNThreads(const size_t n_threads) {m_n_threads = n_threads;}
+
+        //! \brief The fraction of the largest value of a spatial Gabor wavelet
+        //! below which its values are discarded by computeSparseJets() (default:
+        //! 1e-6). A wavelet with frequency k is kept in a box of about
+        //! +/- sigma/k * sqrt(2 ln(1/epsilon)) pixels, i.e., +/- 5.3 sigma/k for
+        //! 1e-6 and +/- 3.7 sigma/k for 1e-3. With the default family, the
+        //! boxes of the lowest frequencies are larger than a 128x128 image.
+        //! Counting operations, each sparse jet then costs about as much as 2.5
+        //! inverse FFTs of the image, while computeJetImage() costs one FFT and
+        //! 40 inverse FFTs. Hence, sparse jets are faster for up to about 15
+        //! positions with 1e-6, and about 25 positions with 1e-3, at the price
+        //! of a relative error of about epsilon per response (see
+        //! sparseJetsCrossover()).
+        double getSpatialEpsilon() const {return m_spatial_epsilon;}
+        void setSpatialEpsilon(const double spatial_epsilon);
+
         //! \brief saves the parameters of this Gabor wavelet family to file
         void save(bob::io::HDF5File& file) const;
 
@@ -163,14 +233,57 @@ namespace bob {
 
       private:
 
+        //! The Gabor wavelet in spatial domain, truncated to the box
+        //! [y0, y0+values.extent(0)) x [x0, x0+values.extent(1)) of offsets
+        struct SpatialKernel {
+          int y0, x0;
+          blitz::Array<std::complex<double>,2> values;
+        };
+
+        //! \brief The input and output arrays of a batch transform, given by
+        //! raw pointers and strides, since the reference counting of blitz
+        //! arrays is not thread-safe. Either trafo or jets is set; the jet
+        //! strides are (image, y, x, part, kernel), the part being 0 (absolute
+        //! value) or 1 (phase).
+        struct BatchJob {
+          const std::complex<double>* images;
+          blitz::TinyVector<int,3> image_strides;
+          std::complex<double>* trafo;
+          blitz::TinyVector<int,4> trafo_strides;
+          double* jets;
+          blitz::TinyVector<int,5> jet_strides;
+          bool include_phases;
+          bool do_normalize;
+        };
+
+        //! The scratch arrays of one thread of a batch transform
+        struct BatchBuffers {
+          blitz::Array<std::complex<double>,2> image, frequency_image, layer;
+        };
+
         void computeKernelFrequencies();
 
+        //! generates the spatial kernels for the current resolution, if needed
+        void generateSpatialKernels();
+
+        //! runs the batch transform defined by the job
+        void performBatch(const BatchJob& job, int number_of_images);
+
+        //! transforms the images [begin, end) of the job
+        void transformImages(const BatchJob& job, std::vector<BatchBuffers>& buffers,
+          size_t thread, size_t begin, size_t end) const;
+
+        //! computes the responses of all kernels at the given positions
+        void computeSparseResponses(const blitz::Array<std::complex<double>,2>& gray_image,
+          const blitz::Array<int,2>& positions);
+
         double m_sigma;
         double m_pow_of_k;
         double m_k_max;
         double m_k_fac;
         bool m_dc_free;
         std::vector<GaborKernel> m_gabor_kernels;
+        std::vector<SpatialKernel> m_spatial_kernels;
 
         std::vector<blitz::TinyVector<double,2> > m_kernel_frequencies;
 
@@ -178,11 +291,16 @@ namespace bob {
         bob::sp::IFFT2D m_ifft;
 
         blitz::Array<std::complex<double>,2> m_temp_array, m_frequency_image;
+        blitz::Array<std::complex<double>,2> m_sparse_responses;
 
         //! The number of scales (levels, frequencies) of this family
         unsigned m_number_of_scales;
         //! The number of directions (orientations) of this family
         unsigned m_number_of_directions;
+        //! The number of threads used by the batch transforms
+        size_t m_n_threads;
+        //! The relative threshold used to crop the spatial kernels
+        double m_spatial_epsilon;
     }; // class GaborWaveletTransform
 
     //! Normalizes a Gabor jet (vector of absolute values) to unit length
@@ -29,13 +29,15 @@
 
 #include <math.h>
 #include <stdint.h>
-#include <numeric>
+#include <vector>
 
 #include <blitz/array.h>
+#include <boost/bind.hpp>
 
 #include <bob/ip/Exception.h>
 #include <bob/core/assert.h>
-#include <bob/sp/interpolate.h>
+#include <bob/core/check.h>
+#include <bob/core/parallel.h>
 
 
 namespace bob { namespace ip {
@@ -49,6 +51,38 @@ namespace bob { namespace ip {
     ELBP_DIRECTION_CODED = 2//!< direction coded LBP: each three pixel values in a row define a two bit codes, which are then connected
   } ELBPType;
 
+  namespace detail {
+    /**
+     * Access to the rows of a 2D plane of pixels, relative to the row of the
+     * central pixel, when the rows are equally spaced in memory
+     */
+    template <typename T>
+    struct LBPStridedRows {
+      typedef T value_type;
+      LBPStridedRows(const T* center, const int stride): m_center(center), m_stride(stride) {}
+      const T* operator[](const int d) const { return m_center + d * m_stride; }
+      const T* m_center;
+      const int m_stride;
+    };
+
+    /**
+     * Access to the rows of a 2D plane of pixels, relative to the row of the
+     * central pixel, when each row lies in a different buffer (e.g., the
+     * frames of a video). Element d of rows points to the buffer of row d
+     * (d can be negative), in which the row starts at the given offset.
+     */
+    template <typename T>
+    struct LBPIndirectRows {
+      typedef T value_type;
+      LBPIndirectRows(const T* const* rows, const int offset): m_rows(rows), m_offset(offset) {}
+      const T* operator[](const int d) const { return m_rows[d] + m_offset; }
+      const T* const* m_rows;
+      const int m_offset;
+    };
+  }
+
+  class LBPTop;
+
   /**
    * This class is an abstraction for all the Local Binary Patterns
    *   variants. For more information, please refer to the following
@@ -145,6 +179,7 @@ namespace bob { namespace ip {
       bool getUniform() const { return m_uniform; }
       bool getRotationInvariant() const { return m_rotation_invariant; }
       bob::ip::ELBPType get_eLBP() const { return m_eLBP_type; }
+      size_t getNThreads() const { return m_n_threads; }
       blitz::Array<double,2> getRelativePositions(){return m_positions;}
       blitz::Array<uint16_t,1> getLookUpTable(){return m_lut;}
 
@@ -161,6 +196,12 @@ namespace bob { namespace ip {
       void setRotationInvariant(const bool rotation_invariant){ m_rotation_invariant = rotation_invariant; init(); }
       void set_eLBP(bob::ip::ELBPType eLBP_type){ m_eLBP_type = eLBP_type; if (eLBP_type == ELBP_DIRECTION_CODED && m_P%2) throw bob::core::InvalidArgumentException("Direction coded LBP types require an even number of neighbors.");}
       void setLookUpTable(const blitz::Array<uint16_t,1>& new_lut){m_lut = new_lut;}
+      /**
+       * Sets the number of threads used to extract the LBP codes of a whole
+       * image, each thread processing a band of rows (0 means as many
+       * threads as hardware cores)
+       */
+      void setNThreads(const size_t n_threads){ m_n_threads = n_threads; }
 
       /**
        * Extract LBP features from a 2D blitz::Array, and save
@@ -202,6 +243,32 @@ namespace bob { namespace ip {
       template <typename T>
         uint16_t lbp_code(const blitz::Array<T,2>& src, int y, int x) const;
 
+      /**
+       * Extract the LBP codes of a span of n pixels, and write them to dst
+       *   (with the given stride). rows gives access to the rows of the
+       *   plane relative to the one of the first pixel (detail::LBPStridedRows
+       *   or detail::LBPIndirectRows), rows[0] pointing to the first pixel.
+       *   s_x is the stride of the columns of the plane, and s_n the stride
+       *   between two consecutive pixels of the span, which is not
+       *   necessarily a direction of the plane (see LBPTop).
+       *   The neighbors are sampled one at a time for the whole span, using
+       *   the precomputed offsets and interpolation weights. The buffer
+       *   must have room for (m_P+2)*n values.
+       * Checks are disabled in this function.
+       */
+      template <typename TRows>
+        void lbp_span(const TRows& rows, const int s_x, const int s_n,
+            const int n, uint16_t* dst, const int dst_stride,
+            double* buffer) const;
+
+      /**
+       * Extract the LBP codes of the rows [begin,end) of dst (the parallel
+       *   worker of the operator() for whole images).
+       */
+      template <typename T>
+        void lbp_rows(const blitz::Array<T,2>& src, blitz::Array<uint16_t,2>& dst,
+            const size_t thread, const size_t begin, const size_t end) const;
+
       /**
        * Attributes
        */
@@ -220,6 +287,18 @@ namespace bob { namespace ip {
 
       // the positions of the points that have to be processed
       blitz::Array<double, 2> m_positions;
+
+      // for each point, the offsets of the pixels that surround it (low y,
+      // high y, low x, high x), and the weights of the low pixels in the
+      // bilinear interpolation (y, x)
+      blitz::Array<int, 2> m_offsets;
+      blitz::Array<double, 2> m_weights;
+
+      // the number of threads used to process whole images
+      size_t m_n_threads;
+
+      // LBPTop extracts the codes of its three planes with lbp_span()
+      friend class LBPTop;
   };
 
   ///////////////////////////////////////////////////
@@ -242,12 +321,31 @@ namespace bob { namespace ip {
       bob::core::array::assertZeroBase(dst);
       bob::core::array::assertSameShape(dst, getLBPShape(src) );
 
+      // process bands of rows (in parallel)
+      bob::core::parallel_for(boost::bind(&LBP::lbp_rows<T>, this,
+            boost::cref(src), boost::ref(dst), _1, _2, _3),
+          dst.extent(0), m_n_threads);
+    }
+
+
+  template <typename T>
+    inline void LBP::lbp_rows(const blitz::Array<T,2>& src, blitz::Array<uint16_t,2>& dst,
+        const size_t thread, const size_t begin, const size_t end) const
+    {
       // offset in the source image
       const int r_y = (int)ceil(m_R_y), r_x = (int)ceil(m_R_x);
-      // iterate over target pixels
-      for (int y = 0; y < dst.extent(0); ++y)
-        for (int x = 0; x < dst.extent(1); ++x)
-          dst(y, x) = lbp_code(src, y + r_y, x + r_x);
+      const int width = dst.extent(1);
+      if (width == 0) return;
+      // raw accesses only (blitz reference counting is not thread-safe)
+      std::vector<double> buffer((m_P + 2) * width);
+      const T* data = src.data();
+      const int s_y = src.stride(0), s_x = src.stride(1);
+      uint16_t* out = dst.data();
+      for (int y = (int)begin; y < (int)end; ++y){
+        detail::LBPStridedRows<T> rows(data + (y + r_y) * s_y + r_x * s_x, s_y);
+        lbp_span(rows, s_x, s_x, width, out + y * dst.stride(0),
+            dst.stride(1), &buffer[0]);
+      }
     }
 
 
@@ -266,40 +364,98 @@ namespace bob { namespace ip {
 
   template <typename T>
   inline uint16_t LBP::lbp_code(const blitz::Array<T,2>& src, int y, int x) const{
-    std::vector<double> pixels(m_P);
-    if (m_circular)
-      for (int p = 0; p < m_P; ++p)
-        pixels[p] = bob::sp::detail::bilinearInterpolationNoCheck(src, y + m_positions(p,0), x + m_positions(p,1));
-    else
+    double buffer[16 + 2];
+    uint16_t code;
+    detail::LBPStridedRows<T> rows(src.data() + y * src.stride(0) + x * src.stride(1), src.stride(0));
+    lbp_span(rows, src.stride(1), src.stride(1), 1, &code, 1, buffer);
+    return code;
+  }
+
+
+  namespace detail {
+    /**
+     * Compares two values as the LBP operators do, i.e., a >= b up to the
+     * tolerance of bob::core::isClose(), and returns the resulting bit
+     */
+    inline uint16_t lbp_bit(const double a, const double b){
+      return (a > b || bob::core::isClose(a, b)) ? 1 : 0;
+    }
+  }
+
+
+  template <typename TRows>
+  inline void LBP::lbp_span(const TRows& rows, const int s_x, const int s_n,
+      const int n, uint16_t* dst, const int dst_stride,
+      double* buffer) const{
+    // sample the neighbors, one neighbor for the whole span at a time
+    for (int p = 0; p < m_P; ++p){
+      double* pixels = buffer + p * n;
+      const int yl = m_offsets(p,0), yh = m_offsets(p,1);
+      const int xl = m_offsets(p,2) * s_x, xh = m_offsets(p,3) * s_x;
+      const typename TRows::value_type* ll = rows[yl] + xl;
+      if (yl == yh && xl == xh){
+        // integral position: no interpolation
+        for (int i = 0; i < n; ++i)
+          pixels[i] = static_cast<double>(ll[i * s_n]);
+      }else{
+        const typename TRows::value_type* lh = rows[yl] + xh;
+        const typename TRows::value_type* hl = rows[yh] + xl;
+        const typename TRows::value_type* hh = rows[yh] + xh;
+        const double w_y = m_weights(p,0), w_x = m_weights(p,1);
+        for (int i = 0; i < n; ++i){
+          const double Il = w_x * ll[i * s_n] + (1 - w_x) * lh[i * s_n];
+          const double Ih = w_x * hl[i * s_n] + (1 - w_x) * hh[i * s_n];
+          pixels[i] = w_y * Il + (1 - w_y) * Ih;
+        }
+      }
+    }
+
+    double* center = buffer + m_P * n;
+    const typename TRows::value_type* c = rows[0];
+    for (int i = 0; i < n; ++i)
+      center[i] = static_cast<double>(c[i * s_n]);
+
+    const double* cmp_point = center;
+    if (m_to_average){
+      // average over P+1 points (same order of summation as std::accumulate)
+      double* average = center + n;
+      for (int i = 0; i < n; ++i)
+        average[i] = center[i];
       for (int p = 0; p < m_P; ++p){
-        pixels[p] = static_cast<double>(src(y + static_cast<int>(m_positions(p,0)), x + static_cast<int>(m_positions(p,1))));
+        const double* pixels = buffer + p * n;
+        for (int i = 0; i < n; ++i)
+          average[i] += pixels[i];
       }
+      for (int i = 0; i < n; ++i)
+        average[i] /= (m_P + 1);
+      cmp_point = average;
+    }
 
-    double center = static_cast<double>(src(y, x));
-    double cmp_point = center;
-    if (m_to_average)
-      cmp_point = std::accumulate(pixels.begin(), pixels.end(), center) / (m_P + 1); // /(P+1) since (averaged over P+1 points)
+    for (int i = 0; i < n; ++i)
+      dst[i * dst_stride] = 0;
 
     // the formulas are implemented from Cosmin's thesis
-    uint16_t lbp_code = 0;
     switch (m_eLBP_type){
       case ELBP_REGULAR:{
         for (int p = 0; p < m_P; ++p){
-          lbp_code <<= 1;
-          if (pixels[p] > cmp_point || bob::core::isClose(pixels[p], cmp_point)) ++lbp_code;
+          const double* pixels = buffer + p * n;
+          for (int i = 0; i < n; ++i)
+            dst[i * dst_stride] = (dst[i * dst_stride] << 1) | detail::lbp_bit(pixels[i], cmp_point[i]);
         }
         if (m_add_average_bit && !m_rotation_invariant && !m_uniform)
         {
-          lbp_code <<= 1;
-          if (center > cmp_point || bob::core::isClose(center, cmp_point)) ++lbp_code;
+          for (int i = 0; i < n; ++i)
+            dst[i * dst_stride] = (dst[i * dst_stride] << 1) | detail::lbp_bit(center[i], cmp_point[i]);
         }
         break;
       }
 
       case ELBP_TRANSITIONAL:{
         for (int p = 0; p < m_P; ++p){
-          lbp_code <<= 1;
-          if (pixels[p] > pixels[(p+1)%m_P] || bob::core::isClose(pixels[p], pixels[(p+1)%m_P])) ++lbp_code;
+          const double* pixels = buffer + p * n;
+          const double* next = buffer + ((p+1)%m_P) * n;
+          for (int i = 0; i < n; ++i)
+            dst[i * dst_stride] = (dst[i * dst_stride] << 1) | detail::lbp_bit(pixels[i], next[i]);
         }
         break;
       }
@@ -307,17 +463,23 @@ namespace bob { namespace ip {
       case ELBP_DIRECTION_CODED:{
         int p_half = m_P/2;
         for (int p = 0; p < p_half; ++p){
-          lbp_code <<= 2;
-          if ((pixels[p] - cmp_point) * (pixels[p+p_half] - cmp_point) >= 0.) lbp_code += 1;
-          double p1 = std::abs(pixels[p] - cmp_point), p2 = std::abs(pixels[p+p_half] - cmp_point);
-          if ( p1 > p2 || bob::core::isClose(p1, p2) ) lbp_code += 2;
+          const double* pixels = buffer + p * n;
+          const double* opposite = buffer + (p+p_half) * n;
+          for (int i = 0; i < n; ++i){
+            uint16_t bits = 0;
+            if ((pixels[i] - cmp_point[i]) * (opposite[i] - cmp_point[i]) >= 0.) bits += 1;
+            double p1 = std::abs(pixels[i] - cmp_point[i]), p2 = std::abs(opposite[i] - cmp_point[i]);
+            bits += 2 * detail::lbp_bit(p1, p2);
+            dst[i * dst_stride] = (dst[i * dst_stride] << 2) | bits;
+          }
         }
         break;
       }
     }
 
-    // convert the lbp code according to the requested setup (uniform, rotation invariant, ...)
-    return m_lut(lbp_code);
+    // convert the lbp codes according to the requested setup (uniform, rotation invariant, ...)
+    for (int i = 0; i < n; ++i)
+      dst[i * dst_stride] = m_lut(dst[i * dst_stride]);
   }
 
 } }
@@ -28,6 +28,7 @@
 #include "bob/ip/Exception.h"
 #include "bob/ip/block.h"
 #include "bob/ip/histo.h"
+#include "bob/ip/integral.h"
 #include "bob/ip/LBP.h"
 #include <list>
 
@@ -58,7 +59,8 @@ namespace bob {
           const bool rotation_invariant = false):
         m_lbp(lbp_p, lbp_r, circular, to_average, add_average_bit, uniform, rotation_invariant),
         m_block_h(block_h), m_block_w(block_w), m_overlap_h(overlap_h),
-        m_overlap_w(overlap_w), m_lbp_r(lbp_r), m_lbp_p(lbp_p)
+        m_overlap_w(overlap_w), m_lbp_r(lbp_r), m_lbp_p(lbp_p),
+        m_integral_histogram(false)
       {
       }
 
@@ -69,7 +71,8 @@ namespace bob {
           const int overlap_w, const bob::ip::LBP& lbp):
         m_lbp(lbp),
         m_block_h(block_h), m_block_w(block_w), m_overlap_h(overlap_h),
-        m_overlap_w(overlap_w), m_lbp_r(lbp.getRadius()), m_lbp_p(lbp.getNNeighbours())
+        m_overlap_w(overlap_w), m_lbp_r(lbp.getRadius()), m_lbp_p(lbp.getNNeighbours()),
+        m_integral_histogram(false)
       {
       }
 
@@ -102,6 +105,22 @@ namespace bob {
         */
       inline const uint64_t getNBins() { return m_lbp.getMaxLabel(); }
 
+      /**
+        * @brief Returns whether the histograms of the blocks are computed
+        *   from the integral histogram of the LBP codes of the whole image
+        */
+      inline bool getIntegralHistogram() const { return m_integral_histogram; }
+
+      /**
+        * @brief Sets whether the histograms of the blocks are computed from
+        *   the integral histogram of the LBP codes of the whole image. The
+        *   LBP codes of each pixel are then computed once, and the histogram
+        *   of each block costs O(n_bins), whatever the size of the blocks and
+        *   their overlap, at the price of storing (height x width x n_bins)
+        *   counts. The histograms are the same in both modes.
+        */
+      inline void setIntegralHistogram(const bool v) { m_integral_histogram = v; }
+
     private:
       /**
         * Attributes
@@ -113,6 +132,7 @@ namespace bob {
       int m_overlap_w;
       double m_lbp_r;
       int m_lbp_p;
+      bool m_integral_histogram;
   };
 
   template <typename T, typename U>
@@ -122,6 +142,37 @@ namespace bob {
     // cast to double
     blitz::Array<double,2> double_version = bob::core::array::cast<double>(src);
 
+    if (m_integral_histogram)
+    {
+      // checks the blocks, and gets their number
+      const blitz::TinyVector<int,4> shape = getBlock4DOutputShape(
+        double_version, m_block_h, m_block_w, m_overlap_h, m_overlap_w);
+
+      // extract the lbp codes of the whole image, and their integral histogram
+      blitz::Array<uint16_t,2> lbp_image(m_lbp.getLBPShape(double_version));
+      m_lbp(double_version, lbp_image);
+      const int n_bins = m_lbp.getMaxLabel();
+      blitz::Array<uint32_t,3> lbp_integral(lbp_image.extent(0)+1,
+        lbp_image.extent(1)+1, n_bins);
+      integralHistogram(lbp_image, lbp_integral);
+
+      // the codes of a block are the ones of its pixels which are at least
+      // one radius away from its border
+      const blitz::TinyVector<double,2> radii = m_lbp.getRadii();
+      const int lbp_h = std::max(0, m_block_h - 2*(int)ceil(radii[0]));
+      const int lbp_w = std::max(0, m_block_w - 2*(int)ceil(radii[1]));
+      for (int h=0; h<shape(0); ++h)
+        for (int w=0; w<shape(1); ++w)
+        {
+          blitz::Array<uint64_t, 1> lbp_histo(n_bins);
+          if (lbp_h == 0 || lbp_w == 0) lbp_histo = 0;
+          else integralHistogramBlock(lbp_integral, h*(m_block_h-m_overlap_h),
+            w*(m_block_w-m_overlap_w), lbp_h, lbp_w, lbp_histo);
+          dst.push_back(lbp_histo);
+        }
+      return;
+    }
+
     // get all the blocks
     std::list<blitz::Array<double,2> > blocks;
     blockReference(double_version, blocks, m_block_h, m_block_w, m_overlap_h, m_overlap_w);
@@ -32,6 +32,9 @@
 #include <blitz/array.h>
 #include <algorithm>
 #include <limits>
+#include <vector>
+#include <boost/bind.hpp>
+#include "bob/core/parallel.h"
 #include "bob/ip/LBP.h"
 #include "bob/ip/Exception.h"
 
@@ -41,17 +44,21 @@ namespace bob { namespace ip {
    * The LBPTop class is designed to calculate the LBP-Top
    * coefficients given a set of images.
    *
-   * The workflow is as follows:
-   * TODO: UPDATE as this is not true
+   * The codes of the three planes are extracted in a single pass over the
+   * frames, using the same (2*R+1) frames for the three planes, R being
+   * the maximum radius of the three operators. Either the whole sequence is
+   * processed at once (operator(), parallelised over the frames), or the
+   * frames are streamed:
    * 1. You initialize the class, defining the radius and number of points
    * in each of the three directions: XY, XT, YT for the LBP calculations
    * 2. For each image you have in the frame sequence, you push into the
    * class
-   * 3. An internal FIFO queue (length = radius in T direction) keeps track
-   * of the current image and their order. As a new image is pushed in, the
-   * oldest on the queue is pushed out.
-   * 4. After pushing an image, you read the current LBP-Top coefficients
-   * and may save it somewhere.
+   * 3. An internal FIFO queue (length = 2*R+1) keeps track of the last
+   * images and their order. As a new image is pushed in, the oldest on the
+   * queue is pushed out.
+   * 4. Once the queue is full, pushing an image returns the LBP-Top
+   * coefficients of the central image of the queue, and you may save them
+   * somewhere.
    */
   class LBPTop {
 
@@ -119,10 +126,59 @@ namespace bob { namespace ip {
           blitz::Array<uint16_t,3>& xt,
           blitz::Array<uint16_t,3>& yt) const;
 
+      /**
+       * Pushes the next frame of a sequence of <b>grayscale</b> images. Only
+       * the last 2*R+1 frames are kept, R being the maximum radius of the
+       * three operators. Once 2*R+1 frames have been pushed, the LBP codes of
+       * the central frame of the queue (the one pushed R frames before) are
+       * computed in the three planes, and true is returned. Otherwise, false
+       * is returned and the outputs are left untouched.
+       *
+       * @param frame The next frame. All the frames of the sequence must have
+       * the same size.
+       * @param xy The result of the LBP operator in the XY plane for the
+       * central frame (height-2*R x width-2*R)
+       * @param xt The result of the LBP operator in the XT plane for the
+       * central frame (height-2*R x width-2*R)
+       * @param yt The result of the LBP operator in the YT plane for the
+       * central frame (height-2*R x width-2*R)
+       */
+      bool push(const blitz::Array<uint8_t,2>& frame,
+          blitz::Array<uint16_t,2>& xy,
+          blitz::Array<uint16_t,2>& xt,
+          blitz::Array<uint16_t,2>& yt);
+
+      bool push(const blitz::Array<uint16_t,2>& frame,
+          blitz::Array<uint16_t,2>& xy,
+          blitz::Array<uint16_t,2>& xt,
+          blitz::Array<uint16_t,2>& yt);
+
+      bool push(const blitz::Array<double,2>& frame,
+          blitz::Array<uint16_t,2>& xy,
+          blitz::Array<uint16_t,2>& xt,
+          blitz::Array<uint16_t,2>& yt);
+
+      /**
+       * Forgets the frames pushed so far, to start a new sequence
+       */
+      void reset() { m_n_frames = 0; }
+
       /**
        * Accessors
        */
 
+      /**
+       * Returns the number of threads used to compute the codes, over the
+       * frames for operator() and over the rows for push() (0 means as many
+       * threads as hardware cores)
+       */
+      size_t getNThreads() const { return m_n_threads; }
+
+      /**
+       * Sets the number of threads used to compute the codes
+       */
+      void setNThreads(const size_t n_threads) { m_n_threads = n_threads; }
+
       /**
        * Returns the XY plane LBP operator
        */
@@ -146,6 +202,35 @@ namespace bob { namespace ip {
 
     private: //representation and methods
 
+      /**
+       * Raw access to a 2D plane of codes (blitz reference counting is not
+       * thread-safe)
+       */
+      struct CodePlane {
+        CodePlane(uint16_t* d, const int s_y, const int s_x): data(d), stride_y(s_y), stride_x(s_x) {}
+        uint16_t* data;
+        int stride_y;
+        int stride_x;
+      };
+
+      /**
+       * Layout of a set of frames of the same size (and strides), and radius
+       * R of the neighbourhood of the codes
+       */
+      struct FrameLayout {
+        FrameLayout(const int r, const int w, const int s_y, const int s_x): radius(r), width(w), stride_y(s_y), stride_x(s_x) {}
+        int radius;
+        int width;
+        int stride_y;
+        int stride_x;
+      };
+
+      /**
+       * Returns the maximum radius of the three operators, which defines
+       * the neighbourhood used in the three planes
+       */
+      int maxRadius() const;
+
       /**
        * Processes a 3D array representing a set of <b>grayscale</b> images and
        * returns (by argument) the three LBP planes calculated.
@@ -156,9 +241,44 @@ namespace bob { namespace ip {
             blitz::Array<uint16_t,3>& xt,
             blitz::Array<uint16_t,3>& yt) const;
 
+      /**
+       * Processes the frames [begin,end) of the output (the parallel worker
+       * of process())
+       */
+      template <typename T>
+        void process_frames(const blitz::Array<T,3>& src,
+            blitz::Array<uint16_t,3>& xy,
+            blitz::Array<uint16_t,3>& xt,
+            blitz::Array<uint16_t,3>& yt,
+            const size_t thread, const size_t begin, const size_t end) const;
+
+      /**
+       * Computes the codes of the three planes for the rows [begin,end) of
+       * the output of a frame. frames[d] points to the first pixel of frame
+       * d relative to the central one (for d in [-R,R]).
+       */
+      template <typename T>
+        void process_rows(const T* const* frames, const FrameLayout& layout,
+            CodePlane xy, CodePlane xt, CodePlane yt,
+            const size_t thread, const size_t begin, const size_t end) const;
+
+      /**
+       * Adds a frame to the queue, and processes the central one once the
+       * queue is full
+       */
+      template <typename T>
+        bool push_(const blitz::Array<T,2>& frame,
+            blitz::Array<uint16_t,2>& xy,
+            blitz::Array<uint16_t,2>& xt,
+            blitz::Array<uint16_t,2>& yt);
+
       bob::ip::LBP m_lbp_xy; ///< LBP for the XY calculation
       bob::ip::LBP m_lbp_xt; ///< LBP for the XT calculation
       bob::ip::LBP m_lbp_yt; ///< LBP for the YT calculation
+      size_t m_n_threads; ///< Number of threads
+
+      blitz::Array<double,3> m_frames; ///< Circular queue of the last 2*R+1 pushed frames
+      int m_n_frames; ///< Number of frames pushed since the last reset
   };
 
   /**
@@ -173,8 +293,6 @@ namespace bob { namespace ip {
     {
 
 
-      int radius_x = m_lbp_xy.getRadii()[0];  ///< The LBPu2,i radius in X direction
-      int radius_y = m_lbp_xy.getRadii()[1];  ///< The LBPu2,i radius in Y direction
       int radius_t = m_lbp_yt.getRadii()[1];  ///< The LBPu2,i radius in T direction
 
 
@@ -184,11 +302,6 @@ namespace bob { namespace ip {
 
 
       /***** Checking the inputs *****/
-      /**** Get XY plane (the first is enough) ****/
-
-      const blitz::Array<T,2> checkXY = src( 0, blitz::Range::all(), blitz::Range::all());
-      m_lbp_xy(checkXY, radius_x, radius_y);
-
       /**** Get XT plane (Intersect in one point is enough) ****/
       int limitT = ceil(2*radius_t + 1);
       if( Tlength < limitT )
@@ -197,8 +310,7 @@ namespace bob { namespace ip {
 
 
       /***** Checking the outputs *****/
-      int max_radius = radius_x > radius_y ? radius_x : radius_y;
-      max_radius = max_radius > radius_t ? max_radius : radius_t;
+      int max_radius = maxRadius();
       int limitWidth  = width-2*max_radius;
       int limitHeight = height-2*max_radius;
       int limitTime   = Tlength-2*max_radius;
@@ -228,28 +340,123 @@ namespace bob { namespace ip {
         throw bob::core::InvalidArgumentException("Width parameter in  YT ", yt.extent(2), limitWidth, limitWidth);
 
 
-      //for each element in time domain (the simplest way to see what is happening)
-      for(int i=max_radius;i<(Tlength-max_radius);i++){
-        for (int j=max_radius; j < (height-max_radius); j++) {
-          for (int k=max_radius; k < (width-max_radius); k++) {
-            /*Getting the "micro-plane" for XY calculus*/
-            const blitz::Array<T,2> kxy =
-               src( i, blitz::Range(j-max_radius,j+max_radius), blitz::Range(k-max_radius,k+max_radius));
-            xy(i-max_radius,j-max_radius,k-max_radius) = m_lbp_xy(kxy, max_radius, max_radius);
-
-            /*Getting the "micro-plane" for XT calculus*/
-            const blitz::Array<T,2> kxt =
-               src(blitz::Range(i-max_radius,i+max_radius),j,blitz::Range(k-max_radius,k+max_radius));
-            xt(i-max_radius,j-max_radius,k-max_radius) = m_lbp_xt(kxt, max_radius, max_radius);
-
-            /*Getting the "micro-plane" for YT calculus*/
-            const blitz::Array<T,2> kyt =
-               src(blitz::Range(i-max_radius,i+max_radius),blitz::Range(j-max_radius,j+max_radius),k);
-            yt(i-max_radius,j-max_radius,k-max_radius) = m_lbp_yt(kyt, max_radius, max_radius);
-          }
-        }
+      if (limitTime <= 0 || limitHeight <= 0 || limitWidth <= 0) return;
+
+      // process the frames (in parallel)
+      bob::core::parallel_for(boost::bind(&LBPTop::process_frames<T>, this,
+            boost::cref(src), boost::ref(xy), boost::ref(xt), boost::ref(yt),
+            _1, _2, _3), limitTime, m_n_threads);
+    }
+
+
+  template <typename T>
+    void bob::ip::LBPTop::process_frames(const blitz::Array<T,3>& src,
+                                         blitz::Array<uint16_t,3>& xy,
+                                         blitz::Array<uint16_t,3>& xt,
+                                         blitz::Array<uint16_t,3>& yt,
+                                         const size_t thread,
+                                         const size_t begin,
+                                         const size_t end) const
+    {
+      const int max_radius = maxRadius();
+      const int height = src.extent(1);
+      std::vector<const T*> frames(2*max_radius+1);
+      for (int i = (int)begin; i < (int)end; ++i) {
+        // the frames around the central frame i+max_radius
+        for (int d = 0; d < 2*max_radius+1; ++d)
+          frames[d] = &src(i+d, 0, 0);
+        process_rows(&frames[max_radius],
+            FrameLayout(max_radius, src.extent(2), src.stride(1), src.stride(2)),
+            CodePlane(&xy(i,0,0), xy.stride(1), xy.stride(2)),
+            CodePlane(&xt(i,0,0), xt.stride(1), xt.stride(2)),
+            CodePlane(&yt(i,0,0), yt.stride(1), yt.stride(2)),
+            thread, 0, height-2*max_radius);
       }
     }
+
+
+  template <typename T>
+    void bob::ip::LBPTop::process_rows(const T* const* frames,
+                                       const FrameLayout& layout,
+                                       CodePlane xy, CodePlane xt, CodePlane yt,
+                                       const size_t thread,
+                                       const size_t begin,
+                                       const size_t end) const
+    {
+      // each row of the output is a span along the x direction in the
+      // three planes
+      const int radius = layout.radius;
+      const int s_y = layout.stride_y, s_x = layout.stride_x;
+      const int n = layout.width - 2*radius;
+      const int P = std::max(m_lbp_xy.getNNeighbours(),
+          std::max(m_lbp_xt.getNNeighbours(), m_lbp_yt.getNNeighbours()));
+      std::vector<double> buffer((P + 2) * n);
+      for (int r = (int)begin; r < (int)end; ++r) {
+        const int offset = (r + radius) * s_y + radius * s_x;
+        // XY: the rows are the ones of the central frame
+        bob::ip::detail::LBPStridedRows<T> rows_xy(frames[0] + offset, s_y);
+        m_lbp_xy.lbp_span(rows_xy, s_x, s_x, n,
+            xy.data + r * xy.stride_y, xy.stride_x, &buffer[0]);
+        // XT and YT: the rows are taken along the time direction
+        bob::ip::detail::LBPIndirectRows<T> rows_t(frames, offset);
+        m_lbp_xt.lbp_span(rows_t, s_x, s_x, n,
+            xt.data + r * xt.stride_y, xt.stride_x, &buffer[0]);
+        m_lbp_yt.lbp_span(rows_t, s_y, s_x, n,
+            yt.data + r * yt.stride_y, yt.stride_x, &buffer[0]);
+      }
+    }
+
+
+  template <typename T>
+    bool bob::ip::LBPTop::push_(const blitz::Array<T,2>& frame,
+                                blitz::Array<uint16_t,2>& xy,
+                                blitz::Array<uint16_t,2>& xt,
+                                blitz::Array<uint16_t,2>& yt)
+    {
+      const int max_radius = maxRadius();
+      const int length = 2*max_radius+1;
+      const int height = frame.extent(0);
+      const int width = frame.extent(1);
+
+      // the first frame of a sequence defines the size of the queue
+      if (m_n_frames == 0) {
+        if (m_frames.extent(0) != length || m_frames.extent(1) != height ||
+            m_frames.extent(2) != width)
+          m_frames.resize(length, height, width);
+      }
+      else
+        bob::core::array::assertSameShape(frame,
+            blitz::TinyVector<int,2>(m_frames.extent(1), m_frames.extent(2)));
+
+      // replaces the oldest frame of the queue
+      m_frames(m_n_frames % length, blitz::Range::all(), blitz::Range::all()) =
+        blitz::cast<double>(frame);
+      ++m_n_frames;
+      if (m_n_frames < length) return false;
+
+      int limitHeight = height-2*max_radius;
+      int limitWidth  = width-2*max_radius;
+      const blitz::TinyVector<int,2> shape(limitHeight, limitWidth);
+      bob::core::array::assertSameShape(xy, shape);
+      bob::core::array::assertSameShape(xt, shape);
+      bob::core::array::assertSameShape(yt, shape);
+      if (limitHeight <= 0 || limitWidth <= 0) return true;
+
+      // the frames of the queue, from the oldest to the newest one
+      std::vector<const double*> frames(length);
+      for (int d = 0; d < length; ++d)
+        frames[d] = &m_frames((m_n_frames + d) % length, 0, 0);
+
+      // process the rows of the central frame (in parallel)
+      bob::core::parallel_for(boost::bind(&LBPTop::process_rows<double>, this,
+            &frames[max_radius],
+            FrameLayout(max_radius, width, m_frames.stride(1), m_frames.stride(2)),
+            CodePlane(xy.data(), xy.stride(0), xy.stride(1)),
+            CodePlane(xt.data(), xt.stride(0), xt.stride(1)),
+            CodePlane(yt.data(), yt.stride(0), yt.stride(1)),
+            _1, _2, _3), limitHeight, m_n_threads);
+      return true;
+    }
 } }
 
 #endif /* BOB_IP_LBPTOP_H */
@@ -23,10 +23,15 @@
 #ifndef BOB_IP_MEDIAN_H
 #define BOB_IP_MEDIAN_H
 
-#include <boost/shared_ptr.hpp>
-#include <list>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 #include "bob/core/assert.h"
 #include "bob/core/cast.h"
+#include "bob/core/parallel.h"
 #include "bob/ip/Exception.h"
 
 namespace bob {
@@ -39,45 +44,103 @@ namespace bob {
   namespace ip {
 
     namespace detail {
+      /**
+        * @brief Tells if a (floating point) array contains NaN values,
+        * which cannot be ordered and hence have no median
+        */
       template <typename T>
-      struct Pixel {
-        int y;
-        int x;
-        T value;
-        Pixel(): y(0), x(0), value(0) {}
-        Pixel(int b, int a, T v): y(b), x(a), value(v) {}
-      };
-
-      template <typename T>
-      void listInsertPixel(const boost::shared_ptr<Pixel<T> > p, 
-                           std::list<boost::shared_ptr<Pixel<T> > >& l)
+      bool hasNaN(const blitz::Array<T,2>& src)
       {
-        typename std::list<boost::shared_ptr<Pixel<T> > >::iterator it=l.begin();
-        for( ; it!=l.end(); ++it)
-          if( p->value > (*it)->value) break;
-        l.insert(it, p);
+        if (!std::numeric_limits<T>::has_quiet_NaN) return false;
+        for(int y=0; y<src.extent(0); ++y)
+          for(int x=0; x<src.extent(1); ++x)
+            if (src(y,x) != src(y,x)) return true;
+        return false;
       }
 
+      /**
+        * @brief Median filters the rows [row_begin, row_end) of dst, using
+        * a sorted buffer of the values of the sliding window. When the
+        * window slides by one column, the values of the leaving column are
+        * removed and the ones of the entering column are inserted using
+        * binary searches. This is the generic (e.g. floating point) engine.
+        * @warning The input and output arrays are not checked, and the
+        * input must not contain NaN values (see hasNaN())
+        */
       template <typename T>
-      T listGetValueAtPosition(const int pos, 
-        const std::list<boost::shared_ptr<Pixel<T> > >& l)
-      { 
-        typename std::list<boost::shared_ptr<Pixel<T> > >::const_iterator it=l.begin();
-        int c=0;
-        for( ; it!=l.end(); ++it, ++c)
-          if( c==pos) return (*it)->value;
-        throw bob::ip::Exception();
-      }
-    
-      template <typename T>
-      void printList(const std::list<boost::shared_ptr<Pixel<T> > >& l)
+      void medianRows(const blitz::Array<T,2>& src, blitz::Array<T,2>& dst,
+        const int radius_y, const int radius_x, const int row_begin,
+        const int row_end)
       {
-        typename std::list<boost::shared_ptr<Pixel<T> > >::const_iterator it=l.begin();
-        for( ; it!=l.end(); ++it)
+        const int size_y = 2*radius_y+1;
+        const int size_x = 2*radius_x+1;
+        const size_t median_pos = (size_t)(size_y*size_x/2);
+
+        std::vector<T> window;
+        window.reserve(size_y*size_x);
+        for(int j=row_begin; j<row_end; ++j)
         {
-          std::cout << "(" << (*it)->y << "," << (*it)->x << "," << (*it)->value << ") - ";
+          // Initializes the (sorted) window at the beginning of the row
+          window.clear();
+          for(int k=0; k<size_y; ++k)
+            for(int l=0; l<size_x; ++l)
+              window.push_back(src(j+k,l));
+          std::sort(window.begin(), window.end());
+          dst(j,0) = window[median_pos];
+
+          for(int i=1; i<dst.extent(1); ++i)
+          {
+            // Removes the values of column i-1 and adds the ones of
+            // column i+2*radius_x
+            for(int k=0; k<size_y; ++k)
+            {
+              window.erase(std::lower_bound(window.begin(), window.end(),
+                src(j+k,i-1)));
+              const T v = src(j+k,i+2*radius_x);
+              window.insert(std::upper_bound(window.begin(), window.end(), v),
+                v);
+            }
+            dst(j,i) = window[median_pos];
+          }
         }
-        std::cout << std::endl;
+      }
+
+      /**
+        * @brief Median filters the rows [row_begin, row_end) of dst, for
+        * 8 bit images. This uses per-column histograms, which are updated
+        * by one pixel when moving to the next row, and a kernel histogram,
+        * which is updated by adding/removing a column histogram when
+        * moving to the next column. The cost per pixel hence does not
+        * depend on the radius of the filter (Perreault and Hebert, 2007).
+        * @warning The input and output arrays are not checked
+        */
+      void medianRows(const blitz::Array<uint8_t,2>& src,
+        blitz::Array<uint8_t,2>& dst, const int radius_y, const int radius_x,
+        const int row_begin, const int row_end);
+
+      /**
+        * @brief Median filters the rows [row_begin, row_end) of dst, for
+        * 16 bit images. A kernel histogram with a coarse (high byte) and a
+        * fine (full value) level is updated when the window slides by one
+        * column, and the median is found by looking at 256 coarse and
+        * (at most) 256 fine bins.
+        * @warning The input and output arrays are not checked
+        */
+      void medianRows(const blitz::Array<uint16_t,2>& src,
+        blitz::Array<uint16_t,2>& dst, const int radius_y,
+        const int radius_x, const int row_begin, const int row_end);
+
+      /**
+        * @brief Median filters a band of rows, selecting the engine
+        * according to the pixel type (signature used by parallel_for)
+        */
+      template <typename T>
+      void medianBand(const blitz::Array<T,2>& src, blitz::Array<T,2>& dst,
+        const int radius_y, const int radius_x, const size_t thread_index,
+        const size_t row_begin, const size_t row_end)
+      {
+        medianRows(src, dst, radius_y, radius_x, (int)row_begin,
+          (int)row_end);
       }
     }
 
@@ -95,7 +158,7 @@ namespace bob {
          */
         Median(const size_t radius_y=1, const size_t radius_x=1): 
           m_radius_y(radius_y), m_radius_x(radius_x),
-          m_median_pos((2*radius_y+1)*(2*radius_x+1)/2)
+          m_n_threads(1)
         {
         }
 
@@ -110,9 +173,23 @@ namespace bob {
         {
           m_radius_y = (int)radius_y;
           m_radius_x = (int)radius_x;
-          m_median_pos = (2*(int)radius_y+1)*(2*(int)radius_x+1)/2;
         }
 
+        /**
+         * @brief Sets the number of threads used to filter an image.
+         * The output rows are split into contiguous bands, which are
+         * filtered independently. A value of zero means as many threads
+         * as the number of hardware cores.
+         */
+        void setNThreads(const size_t n_threads)
+        { m_n_threads = n_threads; }
+
+        /**
+         * @brief Returns the number of threads used to filter an image
+         */
+        size_t getNThreads() const
+        { return m_n_threads; }
+
         /**
          * @brief Processes a 2D blitz Array/Image
          * @param src The 2D input blitz array
@@ -131,92 +208,14 @@ namespace bob {
 
 
       private:
-        /**
-          * @brief Initializes the ordered lists of values
-          */
-        void initLists(const blitz::Array<T,2>& src);
-        /**
-          * @brief Efficiently updates the ordered lists
-          */
-        void listRemoveAddColumn(const int j, const int i, 
-                const blitz::Array<T,2>& src, 
-                std::list<boost::shared_ptr<struct detail::Pixel<T> > >& l);
-        void listRemoveAddRow(const int j, const int i, 
-                const blitz::Array<T,2>& src, 
-                std::list<boost::shared_ptr<struct detail::Pixel<T> > >& l);
-
         /**
          * @brief Attributes
          */  
         int m_radius_y;
         int m_radius_x;
-        int m_median_pos;
-
-        std::list<boost::shared_ptr<struct detail::Pixel<T> > > m_list_current;
-        std::list<boost::shared_ptr<struct detail::Pixel<T> > > m_list_first_col;
+        size_t m_n_threads;
     };
 
-    template <typename T>
-    void bob::ip::Median<T>::initLists(const blitz::Array<T,2>& src)
-    {
-      // Clears content
-      m_list_first_col.clear();
-      m_list_current.clear();
-      typedef struct bob::ip::detail::Pixel<T> Pix;
-      for(int j=0; j<2*m_radius_y+1; ++j)
-        for(int i=0; i<2*m_radius_x+1; ++i)
-        {
-          boost::shared_ptr<Pix> pix(new Pix(j,i,src(j,i)));
-          bob::ip::detail::listInsertPixel(pix, m_list_first_col);
-        }
-      m_list_current = m_list_first_col;
-    }
-
-
-    template <typename T>
-    void bob::ip::Median<T>::listRemoveAddColumn(const int j, const int i,
-                  const blitz::Array<T,2>& src,
-                  std::list<boost::shared_ptr<struct detail::Pixel<T> > >& l)
-    {
-      // Erases elements from column i
-      typename std::list<boost::shared_ptr<struct detail::Pixel<T> > >::iterator it=l.begin();
-      for( ; it!=l.end(); )
-      {
-        if( (*it)->x == i) it = l.erase(it);
-        else ++it;
-      }
-      // Adds elements from new column i+2*m_radius_x+1
-      blitz::Array<T,1> col_new = src(blitz::Range(j,j+2*m_radius_y), i+2*m_radius_x+1);
-      for(int k=0; k<col_new.extent(0); ++k)
-      {
-        boost::shared_ptr<struct detail::Pixel<T> > pix(
-          new struct detail::Pixel<T>(j+k,i+2*m_radius_x+1,src(j+k,i+2*m_radius_x+1)));
-        bob::ip::detail::listInsertPixel(pix, l);
-      }
-    }
-
-    template <typename T>
-    void bob::ip::Median<T>::listRemoveAddRow(const int j, const int i,
-                  const blitz::Array<T,2>& src,
-                  std::list<boost::shared_ptr<struct detail::Pixel<T> > >& l)
-    {
-      // Erases elements from row j 
-      typename std::list<boost::shared_ptr<struct detail::Pixel<T> > >::iterator it=l.begin();
-      for( ; it!=l.end(); )
-      {
-        if( (*it)->y == j) it = l.erase(it);
-        else ++it;
-      }
-      // Adds elements from new row j+2*m_radius_y+2
-      blitz::Array<T,1> col_new = src(j+2*m_radius_y+1,blitz::Range(i,i+2*m_radius_x));
-      for(int k=0; k<col_new.extent(0); ++k)
-      {
-        boost::shared_ptr<struct detail::Pixel<T> > pix(
-          new struct detail::Pixel<T>(j+2*m_radius_y+1,i+k,src(j+2*m_radius_y+1,i+k)));
-        bob::ip::detail::listInsertPixel(pix, l);
-      }
-    }
-
     template <typename T> 
     void bob::ip::Median<T>::operator()(const blitz::Array<T,2>& src, 
       blitz::Array<T,2>& dst)
@@ -228,28 +227,14 @@ namespace bob {
       dst_size(0) = src.extent(0) - 2 * m_radius_y;
       dst_size(1) = src.extent(1) - 2 * m_radius_x;
       bob::core::array::assertSameShape(dst, dst_size);
+      if (detail::hasNaN(src))
+        throw std::runtime_error("median filtering requires an input without NaN values");
 
-      // Initializes the lists
-      initLists(src);
-
-      // Filters
-      for(int j=0; j<dst.extent(0); ++j)
-      {
-        for(int i=0; i<dst.extent(1); ++i)
-        {
-          dst(j,i) = bob::ip::detail::listGetValueAtPosition( m_median_pos, m_list_current);
-          // Updates current ordered list
-          if( i<dst.extent(1) - 1) {
-            listRemoveAddColumn(j, i, src, m_list_current);
-          }
-        }
-        // Updates current ordered list
-        if(j<dst.extent(0)-1)
-        {
-          listRemoveAddRow(j, 0, src, m_list_first_col);
-          m_list_current = m_list_first_col;
-        }
-      }
+      // Filters (bands of rows)
+      if (dst.extent(0) == 0 || dst.extent(1) == 0) return;
+      bob::core::parallel_for(boost::bind(&detail::medianBand<T>,
+          boost::cref(src), boost::ref(dst), m_radius_y, m_radius_x,
+          _1, _2, _3), dst.extent(0), m_n_threads);
     }
 
     template <typename T> 
@@ -27,6 +27,9 @@
 #include "bob/core/assert.h"
 #include "bob/core/array_index.h"
 #include "bob/core/cast.h"
+#include "bob/core/Exception.h"
+#include <vector>
+#include <algorithm>
 
 namespace bob {
 /**
@@ -114,6 +117,87 @@ namespace bob {
         detail::integralNoCheck(src, dst);
     }
 
+
+    /**
+      * @brief Function which computes the integral histogram of a 2D
+      *   blitz::array/image of labels (e.g. LBP codes) in [0,n_bins).
+      *   dst(y,x,b) is the number of pixels with label b in the rectangle
+      *   src(0:y-1,0:x-1), such that the histogram of any rectangle can be
+      *   computed in O(n_bins) using integralHistogramBlock(), whatever its
+      *   size. The bins are interleaved (last dimension), such that the
+      *   four corners of a rectangle are four contiguous runs of values.
+      *   The first dimension is the height (y-axis), whereas the second
+      *   one is the width (x-axis).
+      * @param src The input blitz array of labels
+      * @param dst The output blitz array, of size
+      *   (height+1, width+1, n_bins), which must be C-contiguous
+      */
+    template<typename T, typename U>
+    void integralHistogram(const blitz::Array<T,2>& src, blitz::Array<U,3>& dst)
+    {
+      bob::core::array::assertZeroBase(src);
+      bob::core::array::assertCZeroBaseContiguous(dst);
+      const int n_bins = dst.extent(2);
+      bob::core::array::assertSameShape(dst,
+        blitz::TinyVector<int,3>(src.extent(0)+1, src.extent(1)+1, n_bins));
+
+      // First row and first column are zero
+      dst(0, blitz::Range::all(), blitz::Range::all()) = 0;
+      dst(blitz::Range::all(), 0, blitz::Range::all()) = 0;
+
+      // Each row is the one above plus the histogram of the current row
+      // until the current pixel
+      std::vector<U> row_histogram(n_bins);
+      for(int y=0; y<src.extent(0); ++y)
+      {
+        std::fill(row_histogram.begin(), row_histogram.end(), 0);
+        for(int x=0; x<src.extent(1); ++x)
+        {
+          const int label = static_cast<int>(src(y,x));
+          if(label < 0 || label >= n_bins)
+            throw bob::core::InvalidArgumentException("src", label, 0, n_bins-1);
+          ++row_histogram[label];
+          const U* above = &dst(y,x+1,0);
+          U* current = &dst(y+1,x+1,0);
+          for(int b=0; b<n_bins; ++b)
+            current[b] = above[b] + row_histogram[b];
+        }
+      }
+    }
+
+    /**
+      * @brief Function which computes the histogram of the labels of the
+      *   rectangle src(y:y+height-1,x:x+width-1) of a 2D blitz::array/image,
+      *   given its integral histogram (see integralHistogram()).
+      * @param integral The integral histogram of src
+      * @param y The top of the rectangle
+      * @param x The left of the rectangle
+      * @param height The height of the rectangle
+      * @param width The width of the rectangle
+      * @param dst The output histogram, of size n_bins
+      */
+    template<typename U, typename V>
+    void integralHistogramBlock(const blitz::Array<U,3>& integral,
+      const int y, const int x, const int height, const int width,
+      blitz::Array<V,1>& dst)
+    {
+      bob::core::array::assertCZeroBaseContiguous(integral);
+      bob::core::array::assertZeroBase(dst);
+      const int n_bins = integral.extent(2);
+      bob::core::array::assertSameDimensionLength(dst.extent(0), n_bins);
+      if(y < 0 || height < 0 || y+height >= integral.extent(0))
+        throw bob::core::InvalidArgumentException("y", y+height, 0, integral.extent(0)-1);
+      if(x < 0 || width < 0 || x+width >= integral.extent(1))
+        throw bob::core::InvalidArgumentException("x", x+width, 0, integral.extent(1)-1);
+
+      const U* tl = &integral(y,x,0);
+      const U* tr = &integral(y,x+width,0);
+      const U* bl = &integral(y+height,x,0);
+      const U* br = &integral(y+height,x+width,0);
+      for(int b=0; b<n_bins; ++b)
+        dst(b) = static_cast<V>((br[b] - bl[b]) - (tr[b] - tl[b]));
+    }
+
   }
 /**
  * @}
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <boost/shared_ptr.hpp>
+#include <blitz/array.h>
 #include "bob/io/HDF5File.h"
 
 namespace bob { namespace machine {
@@ -57,6 +58,22 @@ namespace bob { namespace machine {
        */
       virtual double f_prime_from_f (double a) const =0;
 
+      /**
+       * Applies the activation to all the elements of z, in place. This is
+       * used to process a whole layer (e.g. a batch of samples) with a
+       * single virtual call. The default implementation calls f() for each
+       * element.
+       */
+      virtual void f_inplace (blitz::Array<double,2>& z) const;
+
+      /**
+       * Multiplies all the elements of x by the derivative of the
+       * activation, given the activated values a (of the same shape as x).
+       * The default implementation calls f_prime_from_f() for each element.
+       */
+      virtual void multiply_f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& x) const;
+
       /**
        * Saves itself to an HDF5File
        */
@@ -109,6 +126,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f_inplace (blitz::Array<double,2>& z) const;
+      virtual void multiply_f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& x) const;
       virtual void save(bob::io::HDF5File&) const;
       virtual void load(bob::io::HDF5File&);
       virtual std::string unique_identifier() const;
@@ -128,6 +148,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f_inplace (blitz::Array<double,2>& z) const;
+      virtual void multiply_f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& x) const;
       double C() const;
       virtual void save(bob::io::HDF5File& f) const;
       virtual void load(bob::io::HDF5File&);
@@ -150,6 +173,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f_inplace (blitz::Array<double,2>& z) const;
+      virtual void multiply_f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& x) const;
       virtual void save(bob::io::HDF5File& f) const;
       virtual void load(bob::io::HDF5File&);
       virtual std::string unique_identifier() const;
@@ -169,6 +195,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f_inplace (blitz::Array<double,2>& z) const;
+      virtual void multiply_f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& x) const;
       double C() const;
       double M() const;
       virtual void save(bob::io::HDF5File& f) const;
@@ -193,6 +222,9 @@ namespace bob { namespace machine {
       virtual double f (double z) const;
       virtual double f_prime (double z) const;
       virtual double f_prime_from_f (double a) const;
+      virtual void f_inplace (blitz::Array<double,2>& z) const;
+      virtual void multiply_f_prime_from_f (const blitz::Array<double,2>& a,
+          blitz::Array<double,2>& x) const;
       virtual void save(bob::io::HDF5File& f) const;
       virtual void load(bob::io::HDF5File&);
       virtual std::string unique_identifier() const;
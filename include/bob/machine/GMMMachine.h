@@ -253,6 +253,10 @@ class GMMMachine: public Machine<blitz::Array<double,1>, double>
 
     /**
      * Accumulates the GMM statistics over a set of samples.
+     * The samples are processed by blocks: the log-likelihoods of a block
+     * of samples for all the Gaussian components are obtained with two
+     * matrix-matrix products, and the statistics are then accumulated with
+     * two other matrix-matrix products.
      * @see bool accStatistics(const blitz::Array<double,1> &x, GMMStats stats)
      * Dimensions of the parameters are checked
      */
@@ -260,7 +264,7 @@ class GMMMachine: public Machine<blitz::Array<double,1>, double>
 
     /**
      * Accumulates the GMM statistics over a set of samples.
-     * @see bool accStatistics(const blitz::Array<double,1> &x, GMMStats stats)
+     * @see bool accStatistics(const blitz::Array<double,2> &input, GMMStats stats)
      * @warning Dimensions of the parameters are not checked
      */
     void accStatistics_(const blitz::Array<double,2>& input, GMMStats &stats) const;
@@ -367,18 +371,34 @@ class GMMMachine: public Machine<blitz::Array<double,1>, double>
      *
      * @param[in]  x     The current sample
      * @param[out] stats The accumulated statistics
+     * @param[in]  log_weighted_gaussian_likelihoods For each Gaussian, i: log(weight_i*p(x|Gaussian_i))
      * @param[in]  log_likelihood  The current log_likelihood
      * @warning Dimensions of the parameters are not checked
      */
     void accStatisticsInternal(const blitz::Array<double,1> &x,
-      GMMStats &stats, const double log_likelihood) const;
+      GMMStats &stats,
+      const blitz::Array<double,1> &log_weighted_gaussian_likelihoods,
+      const double log_likelihood) const;
+
+    /**
+     * Computes the terms required to evaluate the weighted log-likelihoods
+     * of a block of samples x (one per row), using the expansion:
+     *   log(weight_i*p(x|Gaussian_i)) = x^2 * A_i^T + x * B_i^T + c_i
+     *
+     * @param[out] A  The (-1/2 * 1/variance) terms (n_gaussians x n_inputs)
+     * @param[out] B  The (mean/variance) terms (n_gaussians x n_inputs)
+     * @param[out] c  The constant terms (n_gaussians)
+     */
+    void computeBlockTerms(blitz::Array<double,2>& A,
+      blitz::Array<double,2>& B, blitz::Array<double,1>& c) const;
 
 
-    /// Some cache arrays to avoid re-allocation when computing log-likelihoods
+    /// The logarithm of the weights (cache)
+    /// @note There are no other scratch arrays, such that const methods
+    /// (e.g. accStatistics()) can be called concurrently from several
+    /// threads on the same machine. The caller may use the logLikelihood()
+    /// overloads with an output array to avoid re-allocations.
     mutable blitz::Array<double,1> m_cache_log_weights;
-    mutable blitz::Array<double,1> m_cache_log_weighted_gaussian_likelihoods;
-    mutable blitz::Array<double,1> m_cache_P;
-    mutable blitz::Array<double,2> m_cache_Px;
 
     mutable blitz::Array<double,1> m_cache_mean_supervector;
     mutable blitz::Array<double,1> m_cache_variance_supervector;
@@ -187,6 +187,14 @@ class Gaussian: public Machine<blitz::Array<double,1>, double>
      */
     double logLikelihood_(const blitz::Array<double,1>& x) const;
 
+    /**
+     * Get the normalisation constant g_norm, such that
+     * log(p(x)) = -1/2 * (g_norm + sum((x-mean)^2/variance))
+     * @see preComputeConstants()
+     */
+    inline double getGNorm() const
+    { return m_g_norm; }
+
     /**
      * Computes the log likelihood of the sample, x
      * @param x The data sample (feature vector)
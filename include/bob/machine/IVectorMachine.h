@@ -26,6 +26,7 @@
 #include "GMMMachine.h"
 #include "GMMStats.h"
 #include <bob/io/HDF5File.h>
+#include <vector>
 
 namespace bob { namespace machine {
 /**
@@ -246,6 +247,53 @@ class IVectorMachine: public bob::machine::Machine<bob::machine::GMMStats, blitz
      */
     void forward_(const bob::machine::GMMStats& input, blitz::Array<double,1>& output) const;
 
+    /**
+     * @brief Extracts an ivector from each GMMStats of the input, using
+     *   several threads (0 means as many threads as the number of hardware
+     *   cores). The GMMStats are split into contiguous chunks, and each
+     *   thread uses its own working arrays.
+     *
+     * @param input GMM statistics to be used by the machine
+     * @param output I-vectors computed by the machine (one per row)
+     * @param n_threads number of threads
+     */
+    void forward(const std::vector<bob::machine::GMMStats>& input,
+      blitz::Array<double,2>& output, const size_t n_threads=1) const;
+
+    /**
+     * @brief Working arrays used to compute the posterior distribution of
+     *   the latent variable \f$w\f$ given some GMM statistics. Threads
+     *   sharing the same machine should each use their own workspace.
+     */
+    struct Posterior
+    {
+      /**
+       * @brief Allocates the working arrays for a machine of rank rt. The
+       *   covariance of the posterior is only computed if with_covariance
+       *   is enabled.
+       */
+      Posterior(const size_t rt, const bool with_covariance);
+
+      /// \f$Id + \sum_{c=1}^{C} N_{c} T_{c}^{T} \Sigma_{c}^{-1} T_{c}\f$
+      blitz::Array<double,2> precision;
+      /// \f$[T^{T} \Sigma^{-1} F_{norm}, Id]\f$
+      blitz::Array<double,2> rhs;
+      /// \f$[E\{w\}, Cov\{w\}]\f$: the first column is the ivector, the
+      /// remaining ones (if any) are the covariance of the posterior
+      blitz::Array<double,2> solution;
+    };
+
+    /**
+     * @brief Computes the posterior distribution of the latent variable
+     *   given the GMM statistics, by solving a symmetric positive definite
+     *   linear system (Cholesky decomposition). Only uses the working
+     *   arrays of the given Posterior, and might hence be called by
+     *   several threads at once.
+     * @warning No check is perform
+     */
+    void computePosterior_(const bob::machine::GMMStats& input,
+      Posterior& posterior) const;
+
   protected:
     /**
      * @brief Apply the variance flooring thresholds.
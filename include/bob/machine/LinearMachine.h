@@ -136,6 +136,28 @@ namespace bob { namespace machine {
       void forward (const blitz::Array<double,1>& input,
           blitz::Array<double,1>& output) const;
 
+      /**
+       * Forwards a number of inputs, arranged row-wise in a single input
+       * matrix (i.e., every row contains an individual input), using a
+       * single matrix-matrix product.
+       *
+       * The input and output are NOT checked for compatibility each time. It
+       * is your responsibility to do it.
+       */
+      void forward_ (const blitz::Array<double,2>& input,
+          blitz::Array<double,2>& output) const;
+
+      /**
+       * Forwards a number of inputs, arranged row-wise in a single input
+       * matrix (i.e., every row contains an individual input), using a
+       * single matrix-matrix product.
+       *
+       * The input and output are checked for compatibility each time the
+       * forward method is applied.
+       */
+      void forward (const blitz::Array<double,2>& input,
+          blitz::Array<double,2>& output) const;
+
       /**
        * Resizes the machine. If either the input or output increases in size,
        * the weights and other factors should be considered uninitialized. If
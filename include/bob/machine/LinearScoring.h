@@ -43,6 +43,7 @@ namespace bob { namespace machine {
  * @param test_channelOffset  list of channel offset if any (for JFA/ISA for instance)
  * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
  * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to compute the scores (zero means as many threads as the number of hardware cores)
  * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
  */
 void linearScoring(const std::vector<blitz::Array<double,1> >& models,
@@ -50,12 +51,12 @@ void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double, 1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores);
+                   blitz::Array<double, 2>& scores, const size_t n_threads=1);
 void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores);
+                   blitz::Array<double, 2>& scores, const size_t n_threads=1);
 
 /**
  * Compute a matrix of scores using linear scoring.
@@ -67,13 +68,14 @@ void linearScoring(const std::vector<blitz::Array<double,1> >& models,
  * @param test_stats  list of accumulate statistics for each test trial
  * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
  * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to compute the scores (zero means as many threads as the number of hardware cores)
  * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
  */
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
                    const bob::machine::GMMMachine& ubm,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores);
+                   blitz::Array<double, 2>& scores, const size_t n_threads=1);
 /**
  * Compute a matrix of scores using linear scoring.
  *
@@ -85,6 +87,7 @@ void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMa
  * @param test_channelOffset  list of channel offset if any (for JFA/ISA for instance)
  * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
  * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to compute the scores (zero means as many threads as the number of hardware cores)
  * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
  */
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
@@ -92,7 +95,54 @@ void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMa
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double, 1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores);
+                   blitz::Array<double, 2>& scores, const size_t n_threads=1);
+
+/**
+ * Compute a matrix of scores using linear scoring, from stacked (2D) arrays
+ * of model mean supervectors and of test statistics.
+ *
+ * @param models      mean supervectors of the client models (one per row)
+ * @param ubm_mean    mean supervector of the world model
+ * @param ubm_variance  variance supervector of the world model
+ * @param test_n      zeroth order statistics of the test trials (one per row, size number of Gaussians)
+ * @param test_sumPx  first order statistics of the test trials (one supervector per row)
+ * @param test_T      number of feature vectors of each test trial
+ * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
+ * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to compute the scores (zero means as many threads as the number of hardware cores)
+ * @warning the output scores matrix should have the correct size (number of models x number of test trials)
+ */
+void linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const blitz::Array<double,2>& test_n,
+                   const blitz::Array<double,2>& test_sumPx,
+                   const blitz::Array<double,1>& test_T,
+                   const bool frame_length_normalisation,
+                   blitz::Array<double, 2>& scores, const size_t n_threads=1);
+/**
+ * Compute a matrix of scores using linear scoring, from stacked (2D) arrays
+ * of model mean supervectors and of test statistics.
+ *
+ * @param models      mean supervectors of the client models (one per row)
+ * @param ubm_mean    mean supervector of the world model
+ * @param ubm_variance  variance supervector of the world model
+ * @param test_n      zeroth order statistics of the test trials (one per row, size number of Gaussians)
+ * @param test_sumPx  first order statistics of the test trials (one supervector per row)
+ * @param test_T      number of feature vectors of each test trial
+ * @param test_channelOffset  channel offsets of the test trials (one supervector per row)
+ * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
+ * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to compute the scores (zero means as many threads as the number of hardware cores)
+ * @warning the output scores matrix should have the correct size (number of models x number of test trials)
+ */
+void linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const blitz::Array<double,2>& test_n,
+                   const blitz::Array<double,2>& test_sumPx,
+                   const blitz::Array<double,1>& test_T,
+                   const blitz::Array<double,2>& test_channelOffset,
+                   const bool frame_length_normalisation,
+                   blitz::Array<double, 2>& scores, const size_t n_threads=1);
 
 /**
  * @}
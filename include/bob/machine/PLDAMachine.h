@@ -28,7 +28,9 @@
 #include <blitz/array.h>
 #include <bob/io/HDF5File.h>
 #include <map>
+#include <vector>
 #include <iostream>
+#include <boost/shared_ptr.hpp>
 
 namespace bob { namespace machine {
 /**
@@ -711,6 +713,30 @@ class PLDAMachine: public Machine<blitz::Array<double,1>, double>
     void resizeTmp();
 };
 
+/**
+ * @brief Computes the scores (log-likelihood ratios) of all the probes
+ * against all the enrolled models at once. The score of a model for a 
+ * probe \f$x\f$ is expressed in closed form as
+ * \f$c + W^T \gamma_{n+1} f + \frac{1}{2} f^T (\gamma_{n+1} - \gamma_1) f\f$,
+ * where \f$f = F^T \beta (x - \mu)\f$, \f$n\f$ is the number of
+ * enrollment samples of the model, \f$W\f$ its weighted sum and \f$c\f$
+ * a constant which only depends on the model. The computation is hence 
+ * performed with a few matrix products, and the \f$\gamma\f$ matrices
+ * are computed once for each number of enrollment samples.
+ *
+ * @param models The enrolled models, which should all share the same 
+ *   PLDABase
+ * @param probes The probe samples (one per row)
+ * @param[out] scores 2D matrix of scores, <tt>scores[m, p]</tt> is the 
+ *   score of model @c m for probe @c p, which is the same as 
+ *   <tt>models[m]->forward(probes[p])</tt>
+ * @warning the output scores matrix should have the correct size 
+ *   (number of models x number of probes)
+ */
+void pldaScoring(
+  const std::vector<boost::shared_ptr<const PLDAMachine> >& models,
+  const blitz::Array<double,2>& probes, blitz::Array<double,2>& scores);
+
 /**
  * @}
  */
@@ -23,6 +23,8 @@
 #define BOB_MACHINE_ZTNORM_H
 
 #include <blitz/array.h>
+#include <string>
+#include <bob/io/HDF5File.h>
 
 namespace bob { namespace machine {
 /**
@@ -101,6 +103,79 @@ void zNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
            const blitz::Array<double,2>& rawscores_zprobes_vs_models,
            blitz::Array<double,2>& normalizedscores);
 
+/**
+ * Normalise raw scores with ZT-Norm, reading the raw scores from and
+ * writing the normalised scores to HDF5 files, by blocks of rows. This
+ * allows to normalise score matrices which do not fit in memory: at most
+ * n_threads blocks of block_size rows of a score matrix are loaded at once.
+ *
+ * Each score matrix is a 2D dataset (or, equivalently, a list of 1D arrays
+ * with one row per array) of the input file. The rows of normalised scores
+ * are appended to the (new) output dataset normalizedscores. The statistics
+ * are computed in a single pass over each matrix. Files are accessed
+ * sequentially, whereas the blocks are processed in parallel.
+ *
+ * @exception bob::core::UnexpectedShapeError matrix sizes are not consistent
+ * @exception std::runtime_error the output dataset already exists
+ *
+ * @param file HDF5 file containing the raw scores
+ * @param rawscores_probes_vs_models path of the dataset
+ * @param rawscores_zprobes_vs_models path of the dataset
+ * @param rawscores_probes_vs_tmodels path of the dataset
+ * @param rawscores_zprobes_vs_tmodels path of the dataset
+ * @param mask_zprobes_vs_tmodels_istruetrial path of the (boolean) dataset
+ * @param output HDF5 file to which the normalised scores are written
+ * @param normalizedscores path of the output dataset
+ * @param block_size number of rows processed at once by each thread
+ * @param n_threads number of threads (0 means as many threads as the number
+ *   of hardware cores)
+ */
+void ztNorm(bob::io::HDF5File& file,
+            const std::string& rawscores_probes_vs_models,
+            const std::string& rawscores_zprobes_vs_models,
+            const std::string& rawscores_probes_vs_tmodels,
+            const std::string& rawscores_zprobes_vs_tmodels,
+            const std::string& mask_zprobes_vs_tmodels_istruetrial,
+            bob::io::HDF5File& output,
+            const std::string& normalizedscores,
+            const size_t block_size=1024, const size_t n_threads=1);
+
+/**
+ * Normalise raw scores with ZT-Norm, by blocks of rows of HDF5 datasets.
+ * Assume that znorm and tnorm have no common subject id.
+ * See the above function for the description of the parameters.
+ */
+void ztNorm(bob::io::HDF5File& file,
+            const std::string& rawscores_probes_vs_models,
+            const std::string& rawscores_zprobes_vs_models,
+            const std::string& rawscores_probes_vs_tmodels,
+            const std::string& rawscores_zprobes_vs_tmodels,
+            bob::io::HDF5File& output,
+            const std::string& normalizedscores,
+            const size_t block_size=1024, const size_t n_threads=1);
+
+/**
+ * Normalise raw scores with T-Norm, by blocks of rows of HDF5 datasets.
+ * See the above functions for the description of the parameters.
+ */
+void tNorm(bob::io::HDF5File& file,
+           const std::string& rawscores_probes_vs_models,
+           const std::string& rawscores_probes_vs_tmodels,
+           bob::io::HDF5File& output,
+           const std::string& normalizedscores,
+           const size_t block_size=1024, const size_t n_threads=1);
+
+/**
+ * Normalise raw scores with Z-Norm, by blocks of rows of HDF5 datasets.
+ * See the above functions for the description of the parameters.
+ */
+void zNorm(bob::io::HDF5File& file,
+           const std::string& rawscores_probes_vs_models,
+           const std::string& rawscores_zprobes_vs_models,
+           bob::io::HDF5File& output,
+           const std::string& normalizedscores,
+           const size_t block_size=1024, const size_t n_threads=1);
+
 /**
  * @}
  */
@@ -0,0 +1,63 @@
+/**
+ * @file bob/math/gemm.h
+ * @date Sat Oct 17 10:12:41 2026 +0200
+ *
+ * @brief This file defines a general matrix-matrix product of 2D blitz
+ *   arrays, using the dgemm BLAS function.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_MATH_GEMM_H
+#define BOB_MATH_GEMM_H
+
+#include <blitz/array.h>
+
+namespace bob { namespace math {
+/**
+ * @ingroup MATH
+ * @{
+ */
+
+/**
+ * @brief Function which computes C = alpha*op(A)*op(B) + beta*C,
+ *   using the dgemm BLAS function, where op(X) is either X or X^T.
+ *   Contrary to prod(), this relies on the (cache-blocked) BLAS
+ *   implementation and should be preferred for large matrices.
+ * @param A The A matrix (size MxK, or KxM if transA is set)
+ * @param B The B matrix (size KxN, or NxK if transB is set)
+ * @param C The C matrix (size MxN), which is updated
+ * @param transA Whether A should be transposed
+ * @param transB Whether B should be transposed
+ * @param alpha The scaling factor of the product
+ * @param beta The scaling factor of the initial content of C. If beta
+ *   is zero, the initial content of C is ignored.
+ */
+void gemm(const blitz::Array<double,2>& A, const blitz::Array<double,2>& B,
+  blitz::Array<double,2>& C, const bool transA=false,
+  const bool transB=false, const double alpha=1., const double beta=0.);
+/**
+ * @warning Same as gemm() but does not check the input/output arrays
+ */
+void gemm_(const blitz::Array<double,2>& A, const blitz::Array<double,2>& B,
+  blitz::Array<double,2>& C, const bool transA=false,
+  const bool transB=false, const double alpha=1., const double beta=0.);
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_MATH_GEMM_H */
@@ -26,6 +26,8 @@
 #include <blitz/array.h>
 #include <utility>
 #include <vector>
+#include <limits>
+#include <algorithm>
 
 namespace bob { namespace measure {
 
@@ -68,6 +70,26 @@ namespace bob { namespace measure {
   std::pair<double, double> farfrr(const blitz::Array<double,1>& negatives,
       const blitz::Array<double,1>& positives, double threshold);
 
+  /**
+   * Same as farfrr(), but expects the negatives and positives to be sorted
+   * in ascending order (see sortScores()). The false-accepts and
+   * false-rejections are then counted using binary searches, in
+   * O(log(N)) instead of O(N).
+   *
+   * @warning The negatives and positives must be sorted in ascending order,
+   * which is not checked, and must be contiguous arrays with zero base
+   * indices, which is checked (an exception is thrown otherwise). Unsorted
+   * scores silently give wrong ratios.
+   */
+  std::pair<double, double> sortedFarfrr(const blitz::Array<double,1>& negatives,
+      const blitz::Array<double,1>& positives, double threshold);
+
+  /**
+   * Returns a (contiguous) copy of the given scores, sorted in ascending
+   * order, as expected by sortedFarfrr().
+   */
+  blitz::Array<double,1> sortScores(const blitz::Array<double,1>& scores);
+
   /**
    * This method returns a blitz::Array composed of booleans that pin-point
    * which positives where correctly classified in a 'positive' score sample,
@@ -100,6 +122,9 @@ namespace bob { namespace measure {
    * Recursively minimizes w.r.t. to the given predicate method. Please refer
    * to minimizingThreshold() for a full explanation. This method is only
    * supposed to be used through that method.
+   *
+   * @warning The negatives and positives must be sorted in ascending order
+   * (see sortScores()).
    */
   template <typename T>
   static double recursive_minimization(const blitz::Array<double,1>& negatives,
@@ -124,7 +149,7 @@ namespace bob { namespace measure {
       double threshold = ((double)i * step_size) + min;
 
       std::pair<double, double> ratios =
-        farfrr(negatives, positives, threshold);
+        sortedFarfrr(negatives, positives, threshold);
 
       double current_cost = predicate(ratios.first, ratios.second);
 
@@ -151,6 +176,30 @@ namespace bob { namespace measure {
     return accumulator[accumulator.size()/2];
   }
 
+  /**
+   * Same as minimizingThreshold() (see below), but expects the negatives
+   * and positives to be sorted in ascending order, in contiguous arrays
+   * with zero base indices (see sortScores() and sortedFarfrr()).
+   * This is useful to compute several thresholds on the same set of scores.
+   */
+  template <typename T> double
+    sortedMinimizingThreshold(const blitz::Array<double,1>& negatives,
+        const blitz::Array<double,1>& positives, T& predicate) {
+      const size_t N = 100; ///< number of steps in each iteration
+      double min = std::numeric_limits<double>::max();
+      double max = -std::numeric_limits<double>::max();
+      if (negatives.extent(0)) {
+        min = std::min(min, negatives(0));
+        max = std::max(max, negatives(negatives.extent(0)-1));
+      }
+      if (positives.extent(0)) {
+        min = std::min(min, positives(0));
+        max = std::max(max, positives(positives.extent(0)-1));
+      }
+      return recursive_minimization(negatives, positives, predicate, min,
+          max, N);
+    }
+
   /**
    * This method can calculate a threshold based on a set of scores (positives
    * and negatives) given a certain minimization criteria, input as a
@@ -180,15 +229,15 @@ namespace bob { namespace measure {
    * The procedure continues until all calculated predicates in a given round
    * give the same minimum. At this point, the center threshold is picked up and
    * returned.
+   *
+   * The scores are sorted once, such that the FA and FR ratios of each
+   * evaluated threshold are obtained with binary searches.
    */
   template <typename T> double
     minimizingThreshold(const blitz::Array<double,1>& negatives,
         const blitz::Array<double,1>& positives, T& predicate) {
-      const size_t N = 100; ///< number of steps in each iteration
-      double min = std::min(blitz::min(negatives), blitz::min(positives));
-      double max = std::max(blitz::max(negatives), blitz::max(positives));
-      return recursive_minimization(negatives, positives, predicate, min,
-          max, N);
+      return sortedMinimizingThreshold(sortScores(negatives),
+          sortScores(positives), predicate);
     }
 
   /**
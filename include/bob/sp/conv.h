@@ -24,9 +24,12 @@
 #define BOB_SP_CONV_H
 
 #include <bob/sp/Exception.h>
+#include <bob/sp/FFT1D.h>
 #include <bob/core/assert.h>
 #include <algorithm>
+#include <complex>
 #include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
 
 /**
  * @addtogroup SP sp
@@ -114,6 +117,97 @@ namespace detail {
     }
   }
 
+  /**
+   * @brief Tells if a 1D convolution of a signal of length M with a kernel
+   * of length N, for an output of length P, is cheaper using the FFT than
+   * using the direct computation.
+   */
+  bool useFFTConv(const int M, const int N, const int P);
+
+  /**
+   * @brief Tells if a 2D convolution of a M0xM1 signal with a N0xN1 kernel,
+   * for an output of size P0xP1, is cheaper using the FFT than using the
+   * direct computation.
+   */
+  bool useFFTConv(const int M0, const int M1, const int N0, const int N1,
+    const int P0, const int P1);
+
+  /**
+   * @brief 1D convolution of real signals of a given length with a fixed
+   * kernel, based on the FFT. The spectrum of the kernel is computed once
+   * at construction time. Long signals are processed by blocks, using the
+   * overlap-add method, such that the transforms are only a few times 
+   * longer than the kernel.
+   */
+  class FFTConv1D
+  {
+    public:
+      /**
+       * @brief Constructor
+       * @param b The kernel
+       * @param length The length of the signals to convolve
+       */
+      FFTConv1D(const blitz::Array<double,1>& b, const int length);
+
+      /**
+       * @brief Convolves the signal a with the kernel, and stores the 
+       * part of the full convolution starting at index start in c.
+       */
+      void operator()(const blitz::Array<double,1>& a, 
+        blitz::Array<double,1>& c, const int start) const;
+
+    private:
+      int m_kernel_length;
+      int m_signal_length;
+      int m_block;
+      bob::sp::FFT1D m_fft;
+      bob::sp::IFFT1D m_ifft;
+      blitz::Array<std::complex<double>,1> m_kernel_fft;
+      mutable blitz::Array<std::complex<double>,1> m_buffer;
+      mutable blitz::Array<std::complex<double>,1> m_buffer_fft;
+      mutable blitz::Array<double,1> m_full;
+  };
+
+  /**
+   * @brief Dispatches a 1D convolution to the most appropriate engine.
+   * The generic version relies on the direct computation.
+   */
+  template <typename T>
+  void convEngine(const blitz::Array<T,1>& a, const blitz::Array<T,1>& b, 
+    blitz::Array<T,1>& c, const int offset_0, const int offset_1)
+  {
+    convInternal(a, b, c, offset_0, offset_1);
+  }
+
+  /**
+   * @brief Dispatches a 1D convolution of double signals either to the
+   * direct computation or to the FFT-based one, depending on the sizes.
+   */
+  void convEngine(const blitz::Array<double,1>& a, 
+    const blitz::Array<double,1>& b, blitz::Array<double,1>& c, 
+    const int offset_0, const int offset_1);
+
+  /**
+   * @brief Dispatches a 2D convolution to the most appropriate engine.
+   * The generic version relies on the direct computation.
+   */
+  template <typename T>
+  void convEngine(const blitz::Array<T,2>& A, const blitz::Array<T,2>& B, 
+    blitz::Array<T,2>& C, const int offset0_0, const int offset0_1, 
+    const int offset1_0, const int offset1_1)
+  {
+    convInternal(A, B, C, offset0_0, offset0_1, offset1_0, offset1_1);
+  }
+
+  /**
+   * @brief Dispatches a 2D convolution of double signals either to the
+   * direct computation or to the FFT-based one, depending on the sizes.
+   */
+  void convEngine(const blitz::Array<double,2>& A, 
+    const blitz::Array<double,2>& B, blitz::Array<double,2>& C, 
+    const int offset0_0, const int offset0_1, const int offset1_0, 
+    const int offset1_1);
+
 }
 
 /**
@@ -261,11 +355,11 @@ void conv(const blitz::Array<T,1> a, const blitz::Array<T,1> b,
     throw ConvolutionKernelTooLarge(0, a.extent(0), b.extent(0));
 
   if (size_opt == Conv::Full)
-    detail::convInternal(a, b, c, N-1, 1);
+    detail::convEngine(a, b, c, N-1, 1);
   else if (size_opt == Conv::Same)
-    detail::convInternal(a, b, c, N/2, (N+1)/2);
+    detail::convEngine(a, b, c, N/2, (N+1)/2);
   else
-    detail::convInternal(a, b, c, 0, N);
+    detail::convEngine(a, b, c, 0, N);
 }
 
 /**
@@ -292,24 +386,72 @@ void conv(const blitz::Array<T,2> A, const blitz::Array<T,2> B,
     throw ConvolutionKernelTooLarge(1, A.extent(0), B.extent(0));
 
   if (size_opt == Conv::Full)
-    detail::convInternal(A, B, C, N0-1, 1, N1-1, 1);
+    detail::convEngine(A, B, C, N0-1, 1, N1-1, 1);
   else if (size_opt == Conv::Same)
-    detail::convInternal(A, B, C, N0/2, (N0+1)/2, N1/2, (N1+1)/2);
+    detail::convEngine(A, B, C, N0/2, (N0+1)/2, N1/2, (N1+1)/2);
   else
-    detail::convInternal(A, B, C, 0, N0, 0, N1);
+    detail::convEngine(A, B, C, 0, N0, 0, N1);
 }
 
 namespace detail {
 
+  /**
+   * @brief Convolves 1D lines of a given length with a fixed kernel. This
+   * is used by the separable convolution. The generic version relies on
+   * conv().
+   */
+  template <typename T>
+  class LineConv
+  {
+    public:
+      LineConv(const blitz::Array<T,1>& b, const int length,
+          const Conv::SizeOption size_opt):
+        m_b(b), m_size_opt(size_opt)
+      {
+      }
+
+      void operator()(const blitz::Array<T,1>& a, blitz::Array<T,1>& c) const
+      {
+        conv(a, m_b, c, m_size_opt);
+      }
+
+    private:
+      blitz::Array<T,1> m_b;
+      Conv::SizeOption m_size_opt;
+  };
+
+  /**
+   * @brief Convolves 1D double lines of a given length with a fixed kernel.
+   * When the FFT is used, the spectrum of the kernel is only computed once
+   * for all the lines.
+   */
+  template <>
+  class LineConv<double>
+  {
+    public:
+      LineConv(const blitz::Array<double,1>& b, const int length,
+          const Conv::SizeOption size_opt);
+
+      void operator()(const blitz::Array<double,1>& a, 
+        blitz::Array<double,1>& c) const;
+
+    private:
+      blitz::Array<double,1> m_b;
+      Conv::SizeOption m_size_opt;
+      boost::shared_ptr<FFTConv1D> m_fft;
+      int m_start;
+  };
+
   template<typename T> void convSep(const blitz::Array<T,2>& A, 
     const blitz::Array<T,1>& b, blitz::Array<T,2>& C,
     const Conv::SizeOption size_opt = Conv::Full)
   {
+    const LineConv<T> line_conv(b, A.extent(0), size_opt);
     for (int i=0; i<A.extent(1); ++i)
     {
       const blitz::Array<T,1> Arow = A(blitz::Range::all(), i);
       blitz::Array<T,1> Crow = C(blitz::Range::all(), i);
-      conv(Arow, b, Crow, size_opt);
+      line_conv(Arow, Crow);
     }
   }
 
@@ -317,12 +459,13 @@ namespace detail {
     const blitz::Array<T,1>& b, blitz::Array<T,3>& C,
     const Conv::SizeOption size_opt = Conv::Full)
   {
+    const LineConv<T> line_conv(b, A.extent(0), size_opt);
     for (int i=0; i<A.extent(1); ++i)
       for (int j=0; j<A.extent(2); ++j)
       {
         const blitz::Array<T,1> Arow = A(blitz::Range::all(), i, j);
         blitz::Array<T,1> Crow = C(blitz::Range::all(), i, j);
-        conv(Arow, b, Crow, size_opt);
+        line_conv(Arow, Crow);
       }
   }
 
@@ -330,13 +473,14 @@ namespace detail {
     const blitz::Array<T,1>& b, blitz::Array<T,4>& C,
     const Conv::SizeOption size_opt = Conv::Full)
   {
+    const LineConv<T> line_conv(b, A.extent(0), size_opt);
     for (int i=0; i<A.extent(1); ++i)
       for (int j=0; j<A.extent(2); ++j)
         for (int k=0; k<A.extent(3); ++k)
         {
           const blitz::Array<T,1> Arow = A(blitz::Range::all(), i, j, k);
           blitz::Array<T,1> Crow = C(blitz::Range::all(), i, j, k);
-          conv(Arow, b, Crow, size_opt);
+          line_conv(Arow, Crow);
         }
   }
 }
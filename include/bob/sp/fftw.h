@@ -0,0 +1,101 @@
+/**
+ * @file bob/sp/fftw.h
+ * @date Sat Oct 17 16:05:12 2026 +0200
+ *
+ * @brief Controls the planning of the FFTW-based transforms (FFT1D, FFT2D,
+ * DCT1D, DCT2D and their inverses). Plans are created once for each size
+ * and kind of transform, and are kept in a process-wide cache.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_SP_FFTW_H
+#define BOB_SP_FFTW_H
+
+#include <cstddef>
+#include <string>
+
+namespace bob { namespace sp {
+/**
+ * @ingroup SP
+ * @{
+ */
+
+/**
+ * @brief Enumerations of the possible FFTW planning rigors
+ */
+namespace FFTW {
+  typedef enum PlanningRigor_ {
+    Estimate,
+    Measure,
+    Patient
+  } PlanningRigor;
+}
+
+/**
+ * @brief Sets the rigor used to create new FFTW plans. Estimate (default)
+ * creates plans quickly, while Measure and Patient time several algorithms
+ * on the first transform of a given size, which is slower, but leads to
+ * faster transforms afterwards.
+ */
+void setFFTWPlanningRigor(const FFTW::PlanningRigor rigor);
+
+/**
+ * @brief Returns the rigor used to create new FFTW plans
+ */
+FFTW::PlanningRigor getFFTWPlanningRigor();
+
+/**
+ * @brief Imports FFTW wisdom from the given file, such that plans created
+ * with Measure or Patient rigor do not need to be timed again.
+ * @return false if the wisdom could not be read
+ */
+bool importFFTWWisdom(const std::string& filename);
+
+/**
+ * @brief Exports the FFTW wisdom accumulated so far to the given file
+ * @return false if the file could not be written
+ */
+bool exportFFTWWisdom(const std::string& filename);
+
+/**
+ * @brief Releases all the cached FFTW plans. Transforms which are being
+ * executed in other threads keep their plan until they complete.
+ */
+void clearFFTWPlanCache();
+
+/**
+ * @brief Returns the number of cached FFTW plans
+ */
+size_t getFFTWPlanCacheSize();
+
+/**
+ * @brief Sets the maximum number of cached FFTW plans (256 by default).
+ * When the cache is full, the oldest plans are released first. With a
+ * capacity of 0, the plans are not cached at all.
+ */
+void setFFTWPlanCacheCapacity(const size_t capacity);
+
+/**
+ * @brief Returns the maximum number of cached FFTW plans
+ */
+size_t getFFTWPlanCacheCapacity();
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_SP_FFTW_H */
@@ -125,6 +125,22 @@ class GMMTrainer: public EMTrainer<bob::machine::GMMMachine, blitz::Array<double
      * E-step
      */
     void setGMMStats(const bob::machine::GMMStats& stats); 
+
+    /**
+     * @brief Sets the number of threads used during the E-step.
+     * The data is split into contiguous chunks of samples, and the
+     * statistics of each chunk are accumulated into a separate GMMStats
+     * before being merged. A value of zero means as many threads as
+     * the number of hardware cores.
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+
+    /**
+     * @brief Returns the number of threads used during the E-step
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
      
   protected:
     /**
@@ -155,6 +171,11 @@ class GMMTrainer: public EMTrainer<bob::machine::GMMMachine, blitz::Array<double
      * because of numerical issue. This threshold is used to avoid such divisions.
      */
     double m_mean_var_update_responsibilities_threshold;
+
+    /**
+     * number of threads used during the E-step
+     */
+    size_t m_n_threads;
 };
 
 /**
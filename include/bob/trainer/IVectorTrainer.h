@@ -151,6 +151,23 @@ class IVectorTrainer: public bob::trainer::EMTrainer<bob::machine::IVectorMachin
     { bob::core::array::assertSameShape(acc, m_acc_Snormij);
       m_acc_Snormij = acc; }
 
+    /**
+     * @brief Sets the number of threads used during the E-step.
+     * The data is split into contiguous chunks of GMMStats, and each thread
+     * accumulates the statistics of its chunk into its own accumulators,
+     * which are summed afterwards. Each additional thread hence requires
+     * memory for a copy of the accumulators. A value of zero means as many
+     * threads as the number of hardware cores.
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+
+    /**
+     * @brief Returns the number of threads used during the E-step
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+
   protected:
     // Attributes
     bool m_update_sigma;
@@ -162,14 +179,11 @@ class IVectorTrainer: public bob::trainer::EMTrainer<bob::machine::IVectorMachin
     blitz::Array<double,2> m_acc_Snormij;
     
     // Working arrays
-    mutable blitz::Array<double,1> m_tmp_wij;
-    mutable blitz::Array<double,2> m_tmp_wij2;
     mutable blitz::Array<double,1> m_tmp_d1;
-    mutable blitz::Array<double,1> m_tmp_t1;
     mutable blitz::Array<double,2> m_tmp_dd1;
-    mutable blitz::Array<double,2> m_tmp_dt1;
-    mutable blitz::Array<double,2> m_tmp_tt1;
-    mutable blitz::Array<double,2> m_tmp_tt2;
+
+    // Number of threads used during the E-step
+    size_t m_n_threads;
 };
 
 /**
@@ -316,8 +316,136 @@ class FABaseTrainer
     { bob::core::array::assertSameShape(acc, m_acc_D_A2);
       m_acc_D_A2 = acc; }
 
+    /**
+     * @brief Sets the number of threads used to update the latent variables
+     * x, y and z and to compute the accumulators. The identities are split
+     * into contiguous chunks, and each thread accumulates into its own copy
+     * of the accumulators, which are summed afterwards. A value of zero
+     * means as many threads as the number of hardware cores.
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+
+    /**
+     * @brief Returns the number of threads
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+
 
   private:
+    typedef std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > StatsVec;
+
+    /**
+     * @brief Accumulators computed by a parallel loop
+     */
+    typedef enum Accumulator_ {
+      NoAccumulator,
+      AccumulatorU,
+      AccumulatorV,
+      AccumulatorD
+    } Accumulator;
+
+    /**
+     * @brief Working arrays and accumulators of a thread, along with views
+     * of the arrays shared by all the threads (U, V, d, UBM mean and the
+     * caches), which do not rely on the (thread-unsafe) reference counting
+     * of blitz. The workspace of the first thread refers to the working
+     * arrays and accumulators of the trainer, whereas the other ones own
+     * their arrays.
+     */
+    struct Workspace
+    {
+      Workspace(FABaseTrainer& trainer, const bob::machine::FABase* m,
+        const bool own, const Accumulator acc);
+
+      // Shared arrays
+      blitz::Array<double,2> U;
+      blitz::Array<double,2> V;
+      blitz::Array<double,1> d;
+      blitz::Array<double,1> mean;
+      blitz::Array<double,2> UtSigmaInv;
+      blitz::Array<double,3> UProd;
+      blitz::Array<double,2> VtSigmaInv;
+      blitz::Array<double,3> VProd;
+      blitz::Array<double,1> DtSigmaInv;
+      blitz::Array<double,1> DProd;
+
+      // Working arrays
+      blitz::Array<double,2> IdPlusUProd_ih;
+      blitz::Array<double,1> Fn_x_ih;
+      blitz::Array<double,2> IdPlusVProd_i;
+      blitz::Array<double,1> Fn_y_i;
+      blitz::Array<double,1> IdPlusDProd_i;
+      blitz::Array<double,1> Fn_z_i;
+      blitz::Array<double,2> Fn_X; // Fn_x_ih for all the sessions
+      blitz::Array<double,2> CD_H; // U*x_ih for all the sessions
+      blitz::Array<double,2> ru_H; // Ut*diag(sigma)^-1*Fn_x_ih for all the sessions
+      blitz::Array<double,2> tmp_ruru;
+      blitz::Array<double,2> tmp_rvrv;
+      blitz::Array<double,1> tmp_rv;
+      blitz::Array<double,1> tmp_CD;
+      blitz::Array<double,1> tmp_CD_b;
+
+      // Accumulators
+      blitz::Array<double,3> acc_V_A1;
+      blitz::Array<double,2> acc_V_A2;
+      blitz::Array<double,3> acc_U_A1;
+      blitz::Array<double,2> acc_U_A2;
+      blitz::Array<double,1> acc_D_A1;
+      blitz::Array<double,1> acc_D_A2;
+    };
+
+    /**
+     * @brief Processes the identities [begin, end) with the given workspace
+     */
+    typedef void (FABaseTrainer::*IdentityLoop)(const StatsVec& stats,
+      Workspace& w, const size_t begin, const size_t end);
+
+    /**
+     * @brief Calls the given loop over all the identities in parallel, and
+     * sums the given accumulators of the threads
+     */
+    void parallelLoop(IdentityLoop loop, const Accumulator acc,
+      const bob::machine::FABase& m, const StatsVec& stats);
+    static void parallelLoopWorker(FABaseTrainer& trainer, IdentityLoop loop,
+      const StatsVec& stats,
+      std::vector<boost::shared_ptr<Workspace> >& workspaces,
+      const size_t thread, const size_t begin, const size_t end);
+
+    // Implementations of the above computations with a given workspace
+    void computeIdPlusVProd_i(const size_t id, Workspace& w) const;
+    void computeFn_y_i(const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+      const size_t id, Workspace& w) const;
+    void updateY_i(const size_t id, Workspace& w);
+    void updateYLoop(const StatsVec& stats, Workspace& w,
+      const size_t begin, const size_t end);
+    void accumulateVLoop(const StatsVec& stats, Workspace& w,
+      const size_t begin, const size_t end);
+
+    void computeIdPlusUProd_ih(const bob::machine::GMMStats& stats,
+      Workspace& w) const;
+    void computeFn_x_ih(const bob::machine::GMMStats& stats,
+      blitz::Array<double,1>& Fn_x_ih, Workspace& w) const;
+    void computeFn_X_i(const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+      const size_t id, Workspace& w) const;
+    void computeOffset_x_i(const size_t id, Workspace& w) const;
+    void subtractUx_i(const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+      const size_t id, blitz::Array<double,1>& Fn, Workspace& w) const;
+    void updateXLoop(const StatsVec& stats, Workspace& w,
+      const size_t begin, const size_t end);
+    void accumulateULoop(const StatsVec& stats, Workspace& w,
+      const size_t begin, const size_t end);
+
+    void computeIdPlusDProd_i(const size_t id, Workspace& w) const;
+    void computeFn_z_i(const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+      const size_t id, Workspace& w) const;
+    void updateZ_i(const size_t id, Workspace& w);
+    void updateZLoop(const StatsVec& stats, Workspace& w,
+      const size_t begin, const size_t end);
+    void accumulateDLoop(const StatsVec& stats, Workspace& w,
+      const size_t begin, const size_t end);
+
     size_t m_Nid; // Number of identities 
     size_t m_dim_C; // Number of Gaussian components of the UBM GMM
     size_t m_dim_D; // Dimensionality of the feature space
@@ -364,6 +492,9 @@ class FABaseTrainer
     mutable blitz::Array<double,1> m_tmp_ru;
     mutable blitz::Array<double,1> m_tmp_CD;
     mutable blitz::Array<double,1> m_tmp_CD_b;
+
+    // Number of threads
+    size_t m_n_threads;
 };
 
 
@@ -567,6 +698,19 @@ class JFATrainer
     void setAccDA2(const blitz::Array<double,1>& acc)
     { m_base_trainer.setAccDA2(acc); }
 
+    /**
+     * @brief Sets the number of threads used during the E-steps (0 means
+     * as many threads as the number of hardware cores)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_base_trainer.setNThreads(n_threads); }
+
+    /**
+     * @brief Returns the number of threads used during the E-steps
+     */
+    size_t getNThreads() const
+    { return m_base_trainer.getNThreads(); }
+
 
   private:
     // Attributes
@@ -691,6 +835,19 @@ class ISVTrainer: public EMTrainer<bob::machine::ISVBase, std::vector<std::vecto
     void setAccUA2(const blitz::Array<double,2>& acc)
     { m_base_trainer.setAccUA2(acc); }
 
+    /**
+     * @brief Sets the number of threads used during the E-steps (0 means
+     * as many threads as the number of hardware cores)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_base_trainer.setNThreads(n_threads); }
+
+    /**
+     * @brief Returns the number of threads used during the E-steps
+     */
+    size_t getNThreads() const
+    { return m_base_trainer.getNThreads(); }
+
 
   private:
     /**
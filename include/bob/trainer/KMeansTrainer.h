@@ -24,6 +24,7 @@
 #include <bob/machine/KMeansMachine.h>
 #include <bob/trainer/EMTrainer.h>
 #include <boost/version.hpp>
+#include <vector>
 
 namespace bob { namespace trainer {
 /**
@@ -42,18 +43,46 @@ class KMeansTrainer: public EMTrainer<bob::machine::KMeansMachine, blitz::Array<
   public: 
     /**
      * @brief This enumeration defines different initialization methods for
-     * K-means
+     * K-means:
+     * - RANDOM selects one random sample in each of the k chunks of the data
+     * - RANDOM_NO_DUPLICATE does the same, but avoids identical means
+     * - KMEANS_PLUS_PLUS selects the samples one after the other, with a 
+     *   probability proportional to their square distance to the closest 
+     *   mean already selected (D. Arthur and S. Vassilvitskii, "k-means++: 
+     *   the advantages of careful seeding", SODA 2007)
+     * - KMEANS_PARALLEL oversamples a set of candidates in a few passes over
+     *   the data, and selects the means among the (weighted) candidates 
+     *   using k-means++ (B. Bahmani et al., "Scalable k-means++", VLDB 2012)
      */
     typedef enum {
       RANDOM=0,
       RANDOM_NO_DUPLICATE
 #if BOOST_VERSION >= 104700
       ,
-      KMEANS_PLUS_PLUS
+      KMEANS_PLUS_PLUS,
+      KMEANS_PARALLEL
 #endif
     }   
     InitializationMethod;
 
+    /**
+     * @brief This enumeration defines different methods for assigning the
+     * samples to their closest mean during the E-step:
+     * - DIRECT computes the distances to all the means for each sample
+     * - HAMERLY keeps an upper bound on the distance of each sample to its
+     *   closest mean and a lower bound on the distance to the second 
+     *   closest one, which are updated using the displacement of the means 
+     *   and allow to skip most of the distance computations (G. Hamerly, 
+     *   "Making k-means even faster", SDM 2010). The bounds are kept from 
+     *   one E-step to the next, and assume that the same data are given to
+     *   the successive E-steps (as in train()).
+     */
+    typedef enum {
+      DIRECT=0,
+      HAMERLY
+    }
+    AssignmentMethod;
+
     /**
      * @brief Constructor
      */
@@ -158,6 +187,59 @@ class KMeansTrainer: public EMTrainer<bob::machine::KMeansMachine, blitz::Array<
      * @brief Gets the initialization method used to generate the initial means
      */
     InitializationMethod getInitializationMethod() const { return m_initialization_method; }
+
+    /**
+     * @brief Sets the number of oversampling passes over the data of the
+     * KMEANS_PARALLEL initialization (at least one)
+     */
+    void setOversamplingRounds(const size_t v);
+
+    /**
+     * @brief Gets the number of oversampling passes over the data of the
+     * KMEANS_PARALLEL initialization
+     */
+    size_t getOversamplingRounds() const { return m_oversampling_rounds; }
+
+    /**
+     * @brief Sets the oversampling factor of the KMEANS_PARALLEL 
+     * initialization: on average, factor*k candidates are selected at each
+     * pass over the data (strictly positive)
+     */
+    void setOversamplingFactor(const double v);
+
+    /**
+     * @brief Gets the oversampling factor of the KMEANS_PARALLEL 
+     * initialization
+     */
+    double getOversamplingFactor() const { return m_oversampling_factor; }
+
+    /**
+     * @brief Sets the method used to assign the samples to their closest 
+     * mean during the E-step
+     */
+    void setAssignmentMethod(AssignmentMethod v) 
+    { m_assignment_method = v; resetBounds(); }
+
+    /**
+     * @brief Gets the method used to assign the samples to their closest 
+     * mean during the E-step
+     */
+    AssignmentMethod getAssignmentMethod() const { return m_assignment_method; }
+
+    /**
+     * @brief Sets the number of threads used during the E-step and the 
+     * k-means++/k-means|| initializations.
+     * The data is split into contiguous chunks of samples, and the
+     * statistics of each chunk are accumulated separately before being 
+     * merged. A value of zero means as many threads as the number of 
+     * hardware cores.
+     */
+    void setNThreads(const size_t n_threads) { m_n_threads = n_threads; }
+
+    /**
+     * @brief Returns the number of threads used during the E-step
+     */
+    size_t getNThreads() const { return m_n_threads; }
   
     /**
      * @brief Returns the internal statistics. Useful to parallelize the E-step
@@ -180,6 +262,23 @@ class KMeansTrainer: public EMTrainer<bob::machine::KMeansMachine, blitz::Array<
      */
     InitializationMethod m_initialization_method;
 
+    /**
+     * @brief The method used to assign the samples to their closest mean
+     */
+    AssignmentMethod m_assignment_method;
+
+    /**
+     * @brief Number of passes and oversampling factor of the k-means|| 
+     * initialization
+     */
+    size_t m_oversampling_rounds;
+    double m_oversampling_factor;
+
+    /**
+     * @brief Number of threads used during the E-step
+     */
+    size_t m_n_threads;
+
     /**
      * @brief The random number generator for the inialization
      */
@@ -203,6 +302,20 @@ class KMeansTrainer: public EMTrainer<bob::machine::KMeansMachine, blitz::Array<
      * equation 9.4, Bishop, "Pattern recognition and machine learning", 2006
      */
     blitz::Array<double,2> m_firstOrderStats;
+
+  private:
+    /**
+     * @brief Invalidates the bounds of the accelerated assignment, which 
+     * are then recomputed from scratch during the next E-step
+     */
+    void resetBounds();
+
+    // State of the accelerated (HAMERLY) assignment, kept across E-steps
+    std::vector<size_t> m_assignment; ///< Closest mean of each sample
+    std::vector<double> m_upper_bounds; ///< Upper bound on the distance to the closest mean
+    std::vector<double> m_lower_bounds; ///< Lower bound on the distance to the second closest mean
+    blitz::Array<double,2> m_bounds_means; ///< Means for which the bounds were computed
+    const double* m_bounds_data; ///< Data for which the bounds were computed
 };
 
 /**
@@ -0,0 +1,179 @@
+/**
+ * @file bob/trainer/MiniBatchKMeansTrainer.h
+ * @date Sat Oct 17 18:42:10 2026 +0200
+ *
+ * @brief Mini-batch k-means, which processes the training samples by
+ * (bounded) batches read from a SampleSource
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_TRAINER_MINIBATCH_KMEANS_TRAINER_H
+#define BOB_TRAINER_MINIBATCH_KMEANS_TRAINER_H
+
+#include <bob/machine/KMeansMachine.h>
+#include <bob/trainer/KMeansTrainer.h>
+#include <bob/trainer/SampleSource.h>
+
+namespace bob { namespace trainer {
+/**
+ * @ingroup TRAINER
+ * @{
+ */
+
+/**
+ * @brief Trains a KMeansMachine using mini-batch k-means: the samples of
+ * each batch are assigned to their closest mean, and each mean is then
+ * moved towards the samples assigned to it, with a learning rate equal to
+ * the inverse of the number of samples assigned to it so far (each mean is
+ * hence the running average of its samples). Only one batch is kept in
+ * memory.
+ * @details See D. Sculley, "Web-scale k-means clustering", WWW 2010
+ */
+class MiniBatchKMeansTrainer
+{
+  public:
+    /**
+     * @brief Constructor
+     */
+    MiniBatchKMeansTrainer(const size_t batch_size=1000,
+      const double convergence_threshold=0.001,
+      const size_t max_iterations=10,
+      const KMeansTrainer::InitializationMethod=KMeansTrainer::RANDOM);
+
+    /**
+     * @brief Copy constructor
+     */
+    MiniBatchKMeansTrainer(const MiniBatchKMeansTrainer& other);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~MiniBatchKMeansTrainer() {}
+
+    /**
+     * @brief Assigns from a different trainer
+     */
+    MiniBatchKMeansTrainer& operator=(const MiniBatchKMeansTrainer& other);
+
+    /**
+     * @brief Equal to
+     */
+    bool operator==(const MiniBatchKMeansTrainer& b) const;
+
+    /**
+     * @brief Not equal to
+     */
+    bool operator!=(const MiniBatchKMeansTrainer& b) const;
+
+    /**
+     * @brief Initializes the means using the first batch of the source,
+     * and resets the number of samples assigned to each mean
+     */
+    void initialization(bob::machine::KMeansMachine& kmeans,
+      SampleSource& source);
+
+    /**
+     * @brief Updates the means using a batch of samples
+     */
+    void update(bob::machine::KMeansMachine& kmeans,
+      const blitz::Array<double,2>& batch);
+
+    /**
+     * @brief Initializes the means, and then updates them with all the
+     * batches of the source, until the average min distance over a pass
+     * converges or the maximum number of passes is reached
+     */
+    void train(bob::machine::KMeansMachine& kmeans, SampleSource& source);
+
+    /**
+     * @brief Sets/Gets the number of samples of each batch
+     */
+    void setBatchSize(const size_t v) { m_batch_size = v; }
+    size_t getBatchSize() const { return m_batch_size; }
+
+    /**
+     * @brief Sets/Gets the convergence threshold on the relative change of
+     * the average min distance over a pass
+     */
+    void setConvergenceThreshold(const double v)
+    { m_convergence_threshold = v; }
+    double getConvergenceThreshold() const
+    { return m_convergence_threshold; }
+
+    /**
+     * @brief Sets/Gets the maximum number of passes over the data
+     */
+    void setMaxIterations(const size_t v) { m_max_iterations = v; }
+    size_t getMaxIterations() const { return m_max_iterations; }
+
+    /**
+     * @brief Sets/Gets the method used to initialize the means from the
+     * first batch
+     */
+    void setInitializationMethod(const KMeansTrainer::InitializationMethod v)
+    { m_trainer.setInitializationMethod(v); }
+    KMeansTrainer::InitializationMethod getInitializationMethod() const
+    { return m_trainer.getInitializationMethod(); }
+
+    /**
+     * @brief Sets/Gets the random number generator used for the
+     * initialization
+     */
+    void setRng(const boost::shared_ptr<boost::mt19937> rng)
+    { m_trainer.setRng(rng); }
+    const boost::shared_ptr<boost::mt19937> getRng() const
+    { return m_trainer.getRng(); }
+
+    /**
+     * @brief Sets/Gets the number of threads used to assign the samples of
+     * a batch (0 means as many threads as hardware cores)
+     */
+    void setNThreads(const size_t v) { m_trainer.setNThreads(v); }
+    size_t getNThreads() const { return m_trainer.getNThreads(); }
+
+    /**
+     * @brief Returns the number of samples assigned to each mean so far
+     */
+    const blitz::Array<double,1>& getCounts() const { return m_counts; }
+
+    /**
+     * @brief Returns the average min (square Euclidean) distance of the
+     * samples of the last pass over the data (or of the last batch if
+     * update() was called directly)
+     */
+    double getAverageMinDistance() const { return m_average_min_distance; }
+
+  private:
+    size_t m_batch_size;
+    double m_convergence_threshold;
+    size_t m_max_iterations;
+
+    /**
+     * @brief Trainer used to initialize the means and to compute the
+     * statistics of each batch
+     */
+    KMeansTrainer m_trainer;
+
+    blitz::Array<double,1> m_counts;
+    double m_average_min_distance;
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_TRAINER_MINIBATCH_KMEANS_TRAINER_H */
@@ -0,0 +1,185 @@
+/**
+ * @file bob/trainer/OnlineGMMTrainer.h
+ * @date Sat Oct 17 18:42:10 2026 +0200
+ *
+ * @brief Stepwise (online) EM for GMMs, which processes the training
+ * samples by (bounded) batches read from a SampleSource
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_TRAINER_ONLINE_GMM_TRAINER_H
+#define BOB_TRAINER_ONLINE_GMM_TRAINER_H
+
+#include <bob/machine/GMMMachine.h>
+#include <bob/machine/GMMStats.h>
+#include <bob/trainer/ML_GMMTrainer.h>
+#include <bob/trainer/SampleSource.h>
+#include <limits>
+
+namespace bob { namespace trainer {
+/**
+ * @ingroup TRAINER
+ * @{
+ */
+
+/**
+ * @brief Trains a GMMMachine (maximum likelihood) using stepwise EM: the
+ * sufficient statistics of each batch, normalized by its number of
+ * samples, are interpolated with the running statistics,
+ * s <- (1-eta_t) s + eta_t s_t, using the decreasing step size
+ * eta_t = (t+1)^-kappa, and the parameters of the GMM are re-estimated
+ * from the running statistics after each batch. Only one batch is kept in
+ * memory. The GMM should be initialized beforehand (e.g. using k-means).
+ * @details See P. Liang and D. Klein, "Online EM for unsupervised models",
+ * NAACL 2009, and O. Cappe and E. Moulines, "On-line expectation-maximization
+ * algorithm for latent data models", JRSS-B 2009
+ */
+class OnlineGMMTrainer
+{
+  public:
+    /**
+     * @brief Constructor
+     */
+    OnlineGMMTrainer(const size_t batch_size=1000,
+      const double forgetting_rate=0.6,
+      const bool update_means=true, const bool update_variances=false,
+      const bool update_weights=false,
+      const double mean_var_update_responsibilities_threshold =
+        std::numeric_limits<double>::epsilon());
+
+    /**
+     * @brief Copy constructor
+     */
+    OnlineGMMTrainer(const OnlineGMMTrainer& other);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~OnlineGMMTrainer() {}
+
+    /**
+     * @brief Assigns from a different trainer
+     */
+    OnlineGMMTrainer& operator=(const OnlineGMMTrainer& other);
+
+    /**
+     * @brief Equal to
+     */
+    bool operator==(const OnlineGMMTrainer& b) const;
+
+    /**
+     * @brief Not equal to
+     */
+    bool operator!=(const OnlineGMMTrainer& b) const;
+
+    /**
+     * @brief Resets the running statistics
+     */
+    void initialization(bob::machine::GMMMachine& gmm);
+
+    /**
+     * @brief Updates the running statistics and the parameters of the GMM
+     * using a batch of samples
+     */
+    void update(bob::machine::GMMMachine& gmm,
+      const blitz::Array<double,2>& batch);
+
+    /**
+     * @brief Resets the running statistics, and then updates the GMM with
+     * all the batches of the source, until the average log likelihood over
+     * a pass converges or the maximum number of passes is reached
+     */
+    void train(bob::machine::GMMMachine& gmm, SampleSource& source);
+
+    /**
+     * @brief Sets/Gets the number of samples of each batch
+     */
+    void setBatchSize(const size_t v) { m_batch_size = v; }
+    size_t getBatchSize() const { return m_batch_size; }
+
+    /**
+     * @brief Sets/Gets the forgetting rate kappa of the step size, which
+     * should be in ]0.5,1]. With kappa=1, the running statistics are the
+     * average of the statistics of all the batches.
+     */
+    void setForgettingRate(const double v) { m_forgetting_rate = v; }
+    double getForgettingRate() const { return m_forgetting_rate; }
+
+    /**
+     * @brief Sets/Gets the convergence threshold on the relative change of
+     * the average log likelihood over a pass
+     */
+    void setConvergenceThreshold(const double v)
+    { m_convergence_threshold = v; }
+    double getConvergenceThreshold() const
+    { return m_convergence_threshold; }
+
+    /**
+     * @brief Sets/Gets the maximum number of passes over the data
+     */
+    void setMaxIterations(const size_t v) { m_max_iterations = v; }
+    size_t getMaxIterations() const { return m_max_iterations; }
+
+    /**
+     * @brief Sets/Gets the number of threads used to compute the
+     * statistics of a batch (0 means as many threads as hardware cores)
+     */
+    void setNThreads(const size_t v) { m_trainer.setNThreads(v); }
+    size_t getNThreads() const { return m_trainer.getNThreads(); }
+
+    /**
+     * @brief Returns the running statistics, normalized by the number of
+     * samples (T is one)
+     */
+    const bob::machine::GMMStats& getGMMStats() const { return m_ss; }
+
+    /**
+     * @brief Returns the number of batches processed since the
+     * initialization
+     */
+    size_t getNUpdates() const { return m_n_updates; }
+
+    /**
+     * @brief Returns the average log likelihood of the samples of the last
+     * pass over the data (or of the last batch if update() was called
+     * directly)
+     */
+    double getAverageLogLikelihood() const
+    { return m_average_log_likelihood; }
+
+  private:
+    size_t m_batch_size;
+    double m_forgetting_rate;
+    double m_convergence_threshold;
+    size_t m_max_iterations;
+
+    /**
+     * @brief Trainer used to compute the statistics of each batch, and to
+     * re-estimate the parameters from the running statistics
+     */
+    ML_GMMTrainer m_trainer;
+
+    bob::machine::GMMStats m_ss;
+    size_t m_n_updates;
+    double m_average_log_likelihood;
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_TRAINER_ONLINE_GMM_TRAINER_H */
@@ -233,6 +233,19 @@ class PLDATrainer: public EMTrainer<bob::machine::PLDABase,
       return m_cache_z_second_order;
     }
 
+    /**
+     * @brief Sets the number of threads used during the E-step. The 
+     * identities are split into contiguous chunks, and the sum of the 
+     * second order statistics of each chunk is accumulated separately 
+     * before being merged. A value of zero means as many threads as the 
+     * number of hardware cores.
+     */
+    void setNThreads(const size_t n_threads) { m_n_threads = n_threads; }
+    /**
+     * @brief Returns the number of threads used during the E-step
+     */
+    size_t getNThreads() const { return m_n_threads; }
+
     /**
      * @brief Main procedure for enrolling a PLDAMachine
      */
@@ -251,6 +264,7 @@ class PLDATrainer: public EMTrainer<bob::machine::PLDABase,
     double m_initG_ratio; ///< Ratio/factor used for the initialization of \f$G\f$
     InitSigmaMethod m_initSigma_method; ///< Initialization method for \f$\Sigma\f$
     double m_initSigma_ratio; ///< Ratio/factor used for the initialization of \f$\Sigma\f$
+    size_t m_n_threads; ///< Number of threads used during the E-step
 
     // Statistics and covariance computed during the training process
     blitz::Array<double,2> m_cache_S; ///< Covariance of the training data
@@ -276,8 +290,6 @@ class PLDATrainer: public EMTrainer<bob::machine::PLDABase,
 
     // Working arrays
     mutable blitz::Array<double,1> m_tmp_nf_1; ///< vector of dimension dim_f
-    mutable blitz::Array<double,1> m_tmp_nf_2; ///< vector of dimension dim_f
-    mutable blitz::Array<double,1> m_tmp_ng_1; ///< vector of dimension dim_f
     mutable blitz::Array<double,1> m_tmp_D_1; ///< vector of dimension dim_d 
     mutable blitz::Array<double,1> m_tmp_D_2; ///< vector of dimension dim_d
     mutable blitz::Array<double,2> m_tmp_nfng_nfng; ///< matrix of dimension (dim_f+dim_g)x(dim_f+dim_g)
@@ -0,0 +1,146 @@
+/**
+ * @file bob/trainer/SampleSource.h
+ * @date Sat Oct 17 18:42:10 2026 +0200
+ *
+ * @brief Pull-based sources of training samples, which provide the data by
+ * blocks of rows, such that trainers can process training sets that do not
+ * fit in memory.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_TRAINER_SAMPLE_SOURCE_H
+#define BOB_TRAINER_SAMPLE_SOURCE_H
+
+#include <vector>
+#include <string>
+#include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
+#include <bob/io/File.h>
+#include <bob/io/HDF5File.h>
+
+namespace bob { namespace trainer {
+/**
+ * @ingroup TRAINER
+ * @{
+ */
+
+/**
+ * @brief A pull-based source of training samples (one sample per row),
+ * which is read sequentially by blocks of rows.
+ */
+class SampleSource
+{
+  public:
+    virtual ~SampleSource() {}
+
+    /**
+     * @brief Returns the dimensionality of the samples
+     */
+    virtual size_t getNInputs() const =0;
+
+    /**
+     * @brief Reads the next samples into the first rows of block (at most
+     * block.extent(0) samples), and returns the number of samples read.
+     * Zero is returned once all the samples have been read.
+     */
+    virtual size_t read(blitz::Array<double,2>& block) =0;
+
+    /**
+     * @brief Restarts the reading from the first sample
+     */
+    virtual void reset() =0;
+};
+
+/**
+ * @brief A source of samples stored in memory. The data is copied
+ * internally.
+ */
+class ArraySampleSource: public SampleSource
+{
+  public:
+    /**
+     * @brief Constructor, with one sample per row of data
+     */
+    ArraySampleSource(const blitz::Array<double,2>& data);
+
+    virtual ~ArraySampleSource() {}
+
+    virtual size_t getNInputs() const { return m_data.extent(1); }
+    virtual size_t read(blitz::Array<double,2>& block);
+    virtual void reset() { m_offset = 0; }
+
+  private:
+    blitz::Array<double,2> m_data;
+    int m_offset;
+};
+
+/**
+ * @brief A source of samples stored in a list of files (e.g. HDF5 files),
+ * which are opened one after the other. Each file contains either 2D
+ * arrays, with one sample per row, or 1D arrays, with one sample each.
+ * HDF5 files are read by blocks of rows (hyperslabs), which are never
+ * larger than the block given to read(), whatever the size of the stored
+ * arrays. Other files are read one array at a time.
+ */
+class FileSampleSource: public SampleSource
+{
+  public:
+    /**
+     * @brief Constructor. The first file is opened to get the
+     * dimensionality of the samples.
+     */
+    FileSampleSource(const std::vector<std::string>& filenames);
+
+    virtual ~FileSampleSource() {}
+
+    virtual size_t getNInputs() const { return m_n_inputs; }
+    virtual size_t read(blitz::Array<double,2>& block);
+    virtual void reset();
+
+  private:
+    /**
+     * @brief Loads the next samples (at most max_rows of them from HDF5
+     * files) into m_samples, and returns false once all the files have been
+     * read
+     */
+    bool loadNext(const size_t max_rows);
+
+    /**
+     * @brief Opens the next file, and returns false if there is none
+     */
+    bool openNext();
+
+    std::vector<std::string> m_filenames;
+    size_t m_n_inputs;
+    size_t m_file_index; ///< Index of the next file to open
+    boost::shared_ptr<bob::io::File> m_file; ///< Current file, if not HDF5
+    boost::shared_ptr<bob::io::HDF5File> m_hdf5; ///< Current file, if HDF5
+    std::string m_path; ///< Dataset of the current HDF5 file
+    bool m_list; ///< Does the HDF5 dataset hold a list of 2D arrays?
+    size_t m_n_arrays; ///< Number of arrays of the current HDF5 dataset
+    size_t m_n_rows; ///< Number of rows of each of these arrays
+    size_t m_row; ///< Next row of the current array of the HDF5 dataset
+    size_t m_array_index; ///< Index of the next array of the current file
+    blitz::Array<double,2> m_samples; ///< Current block of samples
+    int m_offset; ///< Next row of m_samples
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_TRAINER_SAMPLE_SOURCE_H */
@@ -162,6 +162,22 @@ namespace bob { namespace visioner {
 
     private:
 
+      // Scanning work item: a band of columns at a given scale for a given output
+      struct scan_item_t
+      {
+        uint64_t        m_scale;
+        uint64_t        m_output;
+        int             m_min_x, m_max_x;
+      };
+
+      // Scan the [begin, end) work items using the <ith> thread's model
+      //  and statistics
+      void scan_mt(uint64_t ith, const std::pair<uint64_t, uint64_t>& range,
+          const std::vector<scan_item_t>& items,
+          const std::vector<Model*>& tmodels,
+          std::vector<std::vector<detection_t> >& idetections,
+          std::vector<stats_t>& tstats) const;
+
       static void threshold(std::vector<detection_t>& detections, double thres);
       static void cluster(std::vector<detection_t>& detections, double thres, uint64_t n_outputs);                 
 
@@ -177,6 +193,7 @@ namespace bob { namespace visioner {
       double m_cluster;	  ///< NMS threshold
       double m_threshold;	///< Detection threshold
       Type     m_type;      ///< Mode: scanning vs. GT
+      uint64_t m_threads;   ///< Number of scanning threads (0/1 = current thread)
 
     private: //attributes
 
@@ -186,6 +203,7 @@ namespace bob { namespace visioner {
       uint64_t			m_levels;	       ///< number of levels (speed-up scanning)
       ipyramid_t  m_ipyramid;	     ///< Pyramid of images
       mutable stats_t m_stats;     ///< Scanning statistics
+      mutable std::vector<boost::shared_ptr<Model> > m_tmodels; ///< Per-thread classifiers
 
   };
 
@@ -26,10 +26,15 @@
 #define BOB_VISIONER_UTIL_THREADS_H
 
 #include <vector>
+#include <algorithm>
+#include <exception>
 
 #include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
 #include <boost/lambda/bind.hpp>
 #include <boost/shared_array.hpp>
+#include <boost/noncopyable.hpp>
 
 namespace bob { namespace visioner {
 
@@ -37,27 +42,212 @@ namespace bob { namespace visioner {
   void thread_split(uint64_t n_objects, std::vector<uint64_t>& sbegins, 
       std::vector<uint64_t>& sends, size_t num_of_threads);
 
+  /**
+   * Pool of persistent worker threads. The threads are created once and then
+   * wait for jobs, such that the (many) multi-threaded loops executed during
+   * the training do not pay for creating and joining threads every time.
+   *
+   * A job is a function job(slot) that is called once for each slot in
+   * [0, n_slots), each slot on a distinct worker. Jobs are executed one at a
+   * time and execute() blocks until all slots are done. Jobs submitted from
+   * a worker thread (nested loops) are executed in the calling thread.
+   */
+  class ThreadPool: boost::noncopyable {
+
+    public:
+
+      typedef boost::function<void (size_t)> job_t;
+
+      // Constructor
+      explicit ThreadPool(size_t n_workers);
+
+      // Destructor: stops and joins the worker threads
+      ~ThreadPool();
+
+      // Number of worker threads
+      size_t size() const { return m_workers.size(); }
+
+      // Change the number of worker threads (0 = number of hardware cores)
+      void resize(size_t n_workers);
+
+      // Run job(slot) for each slot in [0, n_slots) and wait for completion.
+      // The pool grows if more slots than workers are requested.
+      // The first exception thrown by a slot (if any) is rethrown here.
+      void execute(const job_t& job, size_t n_slots);
+
+      // Process-wide pool (by default, as many workers as hardware cores)
+      static ThreadPool& instance();
+
+    private:
+
+      void start(size_t n_workers);
+      void stop();
+      void work(size_t index, uint64_t generation);
+
+      // Attributes
+      std::vector<boost::shared_ptr<boost::thread> > m_workers;
+      boost::mutex              m_submit;       // serializes the jobs
+      boost::mutex              m_mutex;        // guards the job state below
+      boost::condition_variable m_job_ready;
+      boost::condition_variable m_job_done;
+      job_t                     m_job;
+      size_t                    m_n_slots;
+      size_t                    m_pending;
+      uint64_t                  m_generation;
+      bool                      m_stop;
+      std::exception_ptr        m_error;
+  };
+
+  /**
+   * Ranges of objects to process by several threads, using dynamic
+   * chunking and work stealing. Each slot starts with a contiguous share of
+   * the objects, and takes chunks of (at most) <grain> objects from its
+   * front. Once its share is exhausted, a slot steals the upper half of the
+   * largest remaining share of the other slots.
+   */
+  class WorkRanges: boost::noncopyable {
+
+    public:
+
+      // Constructor
+      WorkRanges(uint64_t size, size_t n_slots, uint64_t grain);
+
+      // Get the next chunk to process by the given slot (false if done)
+      bool next(size_t slot, std::pair<uint64_t, uint64_t>& chunk);
+
+    private:
+
+      struct share_t {
+        boost::mutex    m_mutex;
+        uint64_t        m_begin, m_end;
+      };
+
+      // Attributes
+      boost::shared_array<share_t>      m_shares;
+      size_t                            m_n_slots;
+      uint64_t                          m_grain;
+  };
+
+  namespace detail {
+
+    // NB: The jobs are functors (and not boost::bind expressions of op), as
+    //  op is usually a boost::bind expression itself and would be evaluated
+    //  as a nested bind expression.
+
+    // Process chunks of objects (dynamically) until there are none left
+    template <typename TOp> struct steal_loop {
+      steal_loop(TOp op, WorkRanges& ranges)
+        : m_op(op), m_ranges(ranges) {}
+      void operator()(size_t slot) const {
+        std::pair<uint64_t, uint64_t> chunk;
+        while (m_ranges.next(slot, chunk) == true) {
+          m_op(chunk);
+        }
+      }
+      TOp m_op;
+      WorkRanges& m_ranges;
+    };
+
+    // Process the contiguous range of objects of a thread
+    template <typename TOp> struct static_loop {
+      static_loop(TOp op, const std::vector<uint64_t>& th_begins, 
+          const std::vector<uint64_t>& th_ends)
+        : m_op(op), m_begins(th_begins), m_ends(th_ends) {}
+      void operator()(size_t ith) const {
+        m_op(std::pair<uint64_t, uint64_t>(m_begins[ith], m_ends[ith]));
+      }
+      TOp m_op;
+      const std::vector<uint64_t>& m_begins;
+      const std::vector<uint64_t>& m_ends;
+    };
+
+    template <typename TOp> struct static_iloop {
+      static_iloop(TOp op, const std::vector<uint64_t>& th_begins, 
+          const std::vector<uint64_t>& th_ends)
+        : m_op(op), m_begins(th_begins), m_ends(th_ends) {}
+      void operator()(size_t ith) const {
+        m_op(ith, std::pair<uint64_t, uint64_t>(m_begins[ith], m_ends[ith]));
+      }
+      TOp m_op;
+      const std::vector<uint64_t>& m_begins;
+      const std::vector<uint64_t>& m_ends;
+    };
+
+    template <typename TOp, typename TResult> struct static_rloop {
+      static_rloop(TOp op, const std::vector<uint64_t>& th_begins, 
+          const std::vector<uint64_t>& th_ends, std::vector<TResult>& results)
+        : m_op(op), m_begins(th_begins), m_ends(th_ends), m_results(results) {}
+      void operator()(size_t ith) const {
+        m_op(std::pair<uint64_t, uint64_t>(m_begins[ith], m_ends[ith]), 
+            m_results[ith]);
+      }
+      TOp m_op;
+      const std::vector<uint64_t>& m_begins;
+      const std::vector<uint64_t>& m_ends;
+      std::vector<TResult>& m_results;
+    };
+
+    template <typename TOp, typename TResult> struct static_riloop {
+      static_riloop(TOp op, const std::vector<uint64_t>& th_begins, 
+          const std::vector<uint64_t>& th_ends, std::vector<TResult>& results)
+        : m_op(op), m_begins(th_begins), m_ends(th_ends), m_results(results) {}
+      void operator()(size_t ith) const {
+        m_op(ith, std::pair<uint64_t, uint64_t>(m_begins[ith], m_ends[ith]), 
+            m_results[ith]);
+      }
+      TOp m_op;
+      const std::vector<uint64_t>& m_begins;
+      const std::vector<uint64_t>& m_ends;
+      std::vector<TResult>& m_results;
+    };
+
+  }
+
   // Split a loop computation of the given size using multiple threads
   // NB: Stateless threads: op(<begin, end>)
+  // NB: The objects are processed in chunks dynamically distributed to the
+  //  threads of the pool (work stealing), so op may be called several times
+  //  by the same thread and the ranges do not depend on the thread.
   template <typename TOp> void thread_loop(TOp op, uint64_t size,
       size_t num_of_threads=boost::thread::hardware_concurrency()) {
-    
-    boost::shared_array<boost::thread> threads(new boost::thread[num_of_threads]);
-    std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
-    std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
-
-    thread_split(size, th_begins, th_ends, num_of_threads);		
 
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, range));
-      threads[ith] = boost::move(t);
+    if (num_of_threads <= 1 || size <= 1) {
+      op(std::pair<uint64_t, uint64_t>(0, size));
+      return;
     }
 
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      threads[ith].join();
+    // Chunks small enough to balance the load, large enough to amortize
+    // the synchronization
+    const uint64_t grain = std::max((uint64_t)1, 
+        size / ((uint64_t)num_of_threads * 16));
+    WorkRanges ranges(size, num_of_threads, grain);
+
+    ThreadPool::instance().execute(
+        detail::steal_loop<TOp>(op, ranges),
+        num_of_threads);
+  }
+
+  // Split a loop computation of the given size using multiple threads
+  // NB: Stateless threads: op(<begin, end>)
+  // NB: Each thread receives a single contiguous range, so use this variant
+  //  (instead of thread_loop) when op has an expensive per-call setup
+  //  (e.g. cloning a model or preprocessing an image).
+  template <typename TOp> void thread_sloop(TOp op, uint64_t size,
+      size_t num_of_threads=boost::thread::hardware_concurrency()) {
+
+    if (num_of_threads <= 1 || size <= 1) {
+      op(std::pair<uint64_t, uint64_t>(0, size));
+      return;
     }
 
+    std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
+    std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
+
+    thread_split(size, th_begins, th_ends, num_of_threads);		
+
+    ThreadPool::instance().execute(
+        detail::static_loop<TOp>(op, th_begins, th_ends),
+        num_of_threads);
   }
 
   // Split a loop computation of the given size using multiple threads
@@ -65,29 +255,20 @@ namespace bob { namespace visioner {
   template <typename TOp> void thread_iloop(TOp op, uint64_t size,
       size_t num_of_threads=boost::thread::hardware_concurrency()) {
 
-    boost::shared_array<boost::thread> threads(new boost::thread[num_of_threads]);
     std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
     std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
 
     thread_split(size, th_begins, th_ends, num_of_threads);		
 
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, ith, range));
-      threads[ith] = boost::move(t);
-    }
-
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      threads[ith].join();
-    }
-
+    ThreadPool::instance().execute(
+        detail::static_iloop<TOp>(op, th_begins, th_ends),
+        num_of_threads);
   }
 
   // Split a loop computation of the given size using multiple threads
   // NB: State threads: op(<begin, end>, result&)
   template <typename TOp, typename TResult> void thread_loop(TOp op, uint64_t size, std::vector<TResult>& results, size_t num_of_threads=boost::thread::hardware_concurrency()) {
 
-    boost::shared_array<boost::thread> threads(new boost::thread[num_of_threads]);
     std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
     std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
 
@@ -95,23 +276,15 @@ namespace bob { namespace visioner {
 
     results.resize(num_of_threads);
 
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, range, boost::ref(results[ith])));
-      threads[ith] = boost::move(t);
-    }
-
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      threads[ith].join();
-    }
-
+    ThreadPool::instance().execute(
+        detail::static_rloop<TOp, TResult>(op, th_begins, th_ends, results),
+        num_of_threads);
   }
 
   // Split a loop computation of the given size using multiple threads
   // NB: State threads: op(thread_index, <begin, end>, result&)
   template <typename TOp, typename TResult> void thread_iloop(TOp op, uint64_t size, std::vector<TResult>& results, size_t num_of_threads=boost::thread::hardware_concurrency()) {
 
-    boost::shared_array<boost::thread> threads(new boost::thread[num_of_threads]);
     std::vector<uint64_t> th_begins; th_begins.reserve(num_of_threads);
     std::vector<uint64_t> th_ends; th_ends.reserve(num_of_threads);
 
@@ -119,16 +292,10 @@ namespace bob { namespace visioner {
 
     results.resize(num_of_threads);
 
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      std::pair<uint64_t, uint64_t> range(th_begins[ith], th_ends[ith]);
-      boost::thread t(boost::bind(op, ith, range, boost::ref(results[ith])));
-      threads[ith] = boost::move(t);
-    }
-
-    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
-      threads[ith].join();
-    }
-
+    ThreadPool::instance().execute(
+        detail::static_riloop<TOp, TResult>(op, th_begins, th_ends, 
+          results),
+        num_of_threads);
   }
 
 }}
@@ -65,6 +65,90 @@ class VideoTest(unittest.TestCase):
     
     self.assertEqual(counter, len(video)) #we have gone through all frames
 
+  @utils.ffmpeg_found()
+  def test003_AsyncReaderYieldsTheSameFrames(self):
+
+    # The frames read in a background thread are the same as the ones read
+    # synchronously, with or without a stride
+    from .. import VideoReader, AsyncVideoReader
+    video = VideoReader(INPUT_VIDEO)
+    frames = [frame for frame in video]
+    self.assertEqual(len(frames), len(video))
+
+    for stride in (1, 2, 3, 7):
+      for buffers in (1, 4):
+        reader = AsyncVideoReader(video, buffers=buffers, stride=stride)
+        self.assertEqual(reader.buffers, buffers)
+        async_frames = [frame for frame in reader]
+        expected = frames[::stride]
+        self.assertEqual(len(async_frames), len(expected))
+        for frame, reference in zip(async_frames, expected):
+          self.assertTrue(numpy.array_equal(frame, reference))
+
+  @utils.ffmpeg_found()
+  def test004_AsyncReadersCanShareTheirReader(self):
+
+    # Several readers may seek (and hence build the index of the frames of
+    # the shared VideoReader) at the same time
+    from .. import VideoReader, AsyncVideoReader
+    video = VideoReader(INPUT_VIDEO)
+    frames = [frame for frame in video]
+
+    readers = [AsyncVideoReader(video, stride=s) for s in (2, 3, 5)]
+    results = [[frame for frame in r] for r in readers]
+    for stride, result in zip((2, 3, 5), results):
+      expected = frames[::stride]
+      self.assertEqual(len(result), len(expected))
+      for frame, reference in zip(result, expected):
+        self.assertTrue(numpy.array_equal(frame, reference))
+
+  @utils.ffmpeg_found()
+  def test005_CanReadSingleFrames(self):
+
+    # Frames read by index (in any order) are the same as the ones of a full
+    # sequential decode, including frames which are not key frames and the
+    # last frame
+    from .. import VideoReader
+    video = VideoReader(INPUT_VIDEO)
+    frames = [frame for frame in video]
+    last = len(frames) - 1
+
+    indices = [0, 1, 2, last, last // 2, last // 2 + 1, 3, last - 1, last]
+    indices += list(range(0, len(frames), 5))
+    for k in indices:
+      self.assertTrue(numpy.array_equal(video.read(k), frames[k]))
+      self.assertTrue(numpy.array_equal(video[k], frames[k]))
+    self.assertTrue(numpy.array_equal(video[-1], frames[last]))
+
+    # Past the end of the stream
+    self.assertEqual(video.read(len(frames)), None)
+    self.assertRaises(RuntimeError, video.read, len(frames), True)
+
+    # Seeking still works afterwards
+    self.assertTrue(numpy.array_equal(video.read(last - 2), frames[last - 2]))
+
+  @utils.ffmpeg_found()
+  def test006_CanIterateWithAStride(self):
+
+    # Strided iterators and slices return the same frames as a full
+    # sequential decode
+    from .. import VideoReader
+    video = VideoReader(INPUT_VIDEO)
+    frames = [frame for frame in video]
+
+    for stride in (1, 2, 3, 7, len(frames) - 1, len(frames) + 1):
+      strided = [frame for frame in video.begin(stride)]
+      expected = frames[::stride]
+      self.assertEqual(len(strided), len(expected))
+      for frame, reference in zip(strided, expected):
+        self.assertTrue(numpy.array_equal(frame, reference))
+
+    sliced = video[3::4]
+    expected = frames[3::4]
+    self.assertEqual(len(sliced), len(expected))
+    for frame, reference in zip(sliced, expected):
+      self.assertTrue(numpy.array_equal(frame, reference))
+
 TEST_NUMBER = 3
 
 @utils.ffmpeg_found()
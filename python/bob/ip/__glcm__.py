@@ -51,6 +51,15 @@ class GLCM(object):
     self._normalized = value
     self.G.normalized = value
     
+  @property
+  def n_threads(self):
+    'The number of threads used to accumulate the co-occurrences (0 means as many threads as hardware cores). The default is 1.'
+    return self.G.n_threads
+
+  @n_threads.setter
+  def n_threads(self, value):
+    self.G.n_threads = value
+
   @property
   def offset(self):
     "2D numpy.ndarray of dtype='int32' specifying the column and row distance between pixel pairs. The shape of this array is (num_offsets, 2), where num_offsets is the total number of offsets to be taken into account when computing GLCM."
@@ -7,36 +7,38 @@ def properties_by_name(self, glcm_matrix, prop_names=None):
     glcm The input GLCM as 3D numpy.ndarray of dtype='float64'
     prop_names A list GLCM texture properties' names
   """
-  prop_dict = {"angular second moment":self.angular_second_moment, 
-               "energy":self.energy, 
-               "variance":self.variance,
-               "contrast":self.contrast,
-               "autocorrelation":self.auto_correlation,
-               "correlation":self.correlation,
-               "correlation matlab":self.correlation_m,
-               "inverse difference moment":self.inv_diff_mom,
-               "sum average":self.sum_avg,
-               "sum variance":self.sum_var,
-               "sum entropy":self.sum_entropy,
-               "entropy":self.entropy,
-               "difference variance":self.diff_var,
-               "difference entropy":self.diff_entropy,
-               "dissimilarity":self.dissimilarity,
-               "homogeneity":self.homogeneity,
-               "cluster prominance":self.cluster_prom,
-               "cluster shade":self.cluster_shade,
-               "maximum probability":self.max_prob,
-               "information measure of correlation 1":self.inf_meas_corr1,
-               "information measure of correlation 2":self.inf_meas_corr2,               
-               "inverse difference":self.inv_diff,
-               "inverse difference normalized":self.inv_diff_norm,
-               "inverse difference moment normalized":self.inv_diff_mom_norm
+  # column of each property in the output of properties()
+  prop_dict = {"angular second moment":GLCMProp.Property.ANGULAR_SECOND_MOMENT, 
+               "energy":GLCMProp.Property.ENERGY, 
+               "variance":GLCMProp.Property.VARIANCE, 
+               "contrast":GLCMProp.Property.CONTRAST, 
+               "autocorrelation":GLCMProp.Property.AUTO_CORRELATION, 
+               "correlation":GLCMProp.Property.CORRELATION, 
+               "correlation matlab":GLCMProp.Property.CORRELATION_M, 
+               "inverse difference moment":GLCMProp.Property.INV_DIFF_MOM, 
+               "sum average":GLCMProp.Property.SUM_AVG, 
+               "sum variance":GLCMProp.Property.SUM_VAR, 
+               "sum entropy":GLCMProp.Property.SUM_ENTROPY, 
+               "entropy":GLCMProp.Property.ENTROPY, 
+               "difference variance":GLCMProp.Property.DIFF_VAR, 
+               "difference entropy":GLCMProp.Property.DIFF_ENTROPY, 
+               "dissimilarity":GLCMProp.Property.DISSIMILARITY, 
+               "homogeneity":GLCMProp.Property.HOMOGENEITY, 
+               "cluster prominance":GLCMProp.Property.CLUSTER_PROM, 
+               "cluster shade":GLCMProp.Property.CLUSTER_SHADE, 
+               "maximum probability":GLCMProp.Property.MAX_PROB, 
+               "information measure of correlation 1":GLCMProp.Property.INF_MEAS_CORR1, 
+               "information measure of correlation 2":GLCMProp.Property.INF_MEAS_CORR2, 
+               "inverse difference":GLCMProp.Property.INV_DIFF, 
+               "inverse difference normalized":GLCMProp.Property.INV_DIFF_NORM, 
+               "inverse difference moment normalized":GLCMProp.Property.INV_DIFF_MOM_NORM
                }
   if prop_names == None:
     prop_names = prop_dict.keys() 
+  all_props = self.properties(glcm_matrix)
   retval = []
   for props in prop_names:
-    retval.append(prop_dict[props](glcm_matrix))
+    retval.append(all_props[:, int(prop_dict[props])].copy())
 
   return retval    
   
@@ -0,0 +1,88 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Sat Oct 17 11:02:14 CEST 2026
+#
+# Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Tests the batch and sparse Gabor wavelet transforms
+"""
+
+import unittest
+import bob
+import numpy
+
+def complex_jets(jets):
+  """Turns jets with absolute values and phases into complex values, since the
+  phases of small responses are unstable"""
+  return jets[...,0,:] * numpy.exp(1j * jets[...,1,:])
+
+class GaborWaveletTransformTest(unittest.TestCase):
+  """Performs various tests for the Gabor wavelet transform"""
+
+  def test01_batch(self):
+    # The batch transforms give the same results as the single ones, with
+    # one or several threads
+    numpy.random.seed(0)
+    images = numpy.random.randint(0, 256, (3, 41, 37)).astype('float64')
+    gwt = bob.ip.GaborWaveletTransform()
+    trafo_images = numpy.array([gwt.perform_gwt(image) for image in images])
+    jet_images = numpy.array([gwt.compute_jets(image) for image in images])
+    abs_jet_images = numpy.array([gwt.compute_jets(image, False) for image in images])
+    raw_jet_images = numpy.array([gwt.compute_jets(image, False, False) for image in images])
+
+    for n_threads in (1, 2, 4):
+      gwt.n_threads = n_threads
+      self.assertEqual(gwt.n_threads, n_threads)
+      self.assertEqual(gwt.perform_gwt_batch(images).shape, trafo_images.shape)
+      self.assertTrue(numpy.allclose(gwt.perform_gwt_batch(images), trafo_images))
+      self.assertTrue(numpy.allclose(gwt.compute_jets_batch(images), jet_images))
+      self.assertTrue(numpy.allclose(gwt.compute_jets_batch(images, False), abs_jet_images))
+      self.assertTrue(numpy.allclose(gwt.compute_jets_batch(images, False, False), raw_jet_images))
+
+    # integral images are converted as the single images are
+    self.assertTrue(numpy.allclose(gwt.compute_jets_batch(images.astype('uint8')), jet_images))
+
+  def test02_sparse(self):
+    # The sparse jets match the jets of the full transform, including at the
+    # image borders
+    numpy.random.seed(0)
+    image = numpy.random.randint(0, 256, (41, 37)).astype('float64')
+    positions = numpy.array([[0,0], [20,18], [40,36], [3,30], [35,2]], dtype='int32')
+    gwt = bob.ip.GaborWaveletTransform()
+    jet_image = gwt.compute_jets(image)
+    abs_jet_image = gwt.compute_jets(image, False)
+    raw_jet_image = gwt.compute_jets(image, False, False)
+
+    jets = gwt.compute_sparse_jets(image, positions)
+    self.assertEqual(jets.shape, (5, 2, gwt.number_of_kernels))
+    abs_jets = gwt.compute_sparse_jets(image, positions, False)
+    raw_jets = gwt.compute_sparse_jets(image, positions, False, False)
+    for p, (y, x) in enumerate(positions):
+      self.assertTrue(numpy.allclose(complex_jets(jets[p]), complex_jets(jet_image[y,x]), atol=1e-4))
+      self.assertTrue(numpy.allclose(abs_jets[p], abs_jet_image[y,x], atol=1e-4))
+      self.assertTrue(numpy.allclose(raw_jets[p], raw_jet_image[y,x], rtol=1e-4, atol=1e-4))
+
+    # The spatial wavelets are regenerated when the threshold changes
+    self.assertEqual(gwt.spatial_epsilon, 1e-6)
+    gwt.spatial_epsilon = 0.5
+    self.assertEqual(gwt.spatial_epsilon, 0.5)
+    self.assertFalse(numpy.allclose(gwt.compute_sparse_jets(image, positions, False), abs_jets, atol=1e-4))
+    gwt.spatial_epsilon = 1e-6
+    self.assertTrue(numpy.allclose(gwt.compute_sparse_jets(image, positions, False), abs_jets))
+    self.assertRaises(RuntimeError, setattr, gwt, 'spatial_epsilon', 1.)
+    self.assertRaises(RuntimeError, setattr, gwt, 'spatial_epsilon', -1e-3)
+
+    # positions out of the image are rejected
+    self.assertRaises(RuntimeError, gwt.compute_sparse_jets, image, numpy.array([[41,0]], dtype='int32'))
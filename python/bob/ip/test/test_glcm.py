@@ -48,6 +48,59 @@ IMG_3x6_A = numpy.array([ [1, 1, 4, 2, 1, 0],
                           [0, 2, 3, 1, 4, 4]], dtype='uint8')
     
                           
+
+def glcm_properties_reference(glcm):
+  """Computes the GLCM properties of [5] on a single 2D matrix, directly from
+  their definitions"""
+  eps = numpy.finfo(numpy.float64).tiny
+  n = glcm.shape[0]
+  p = glcm / glcm.sum()
+  i, j = numpy.indices(p.shape).astype('double')
+  px = p.sum(axis=1)
+  py = p.sum(axis=0)
+  mx = (i * p).sum()
+  my = (j * p).sum()
+  sx = math.sqrt((((i - mx) ** 2) * p).sum())
+  sy = math.sqrt((((j - my) ** 2) * p).sum())
+  pxy = numpy.array([p[(i + j) == t].sum() for t in range(2 * n - 1)])
+  pdiff = numpy.array([p[numpy.abs(i - j) == t].sum() for t in range(n)])
+  t = numpy.arange(2 * n - 1)
+  entropy = -(p * numpy.log(p + eps)).sum()
+  sum_entropy = -(pxy * numpy.log(pxy + eps)).sum()
+  hx = -(px * numpy.log(px + eps)).sum()
+  hy = -(py * numpy.log(py + eps)).sum()
+  pxpy = numpy.outer(px, py)
+  hxy1 = -(p * numpy.log(pxpy + eps)).sum()
+  hxy2 = -(pxpy * numpy.log(pxpy + eps)).sum()
+  homogeneity = (p / (1 + numpy.abs(i - j))).sum()
+  contrast = (((i - j) ** 2) * p).sum()
+  return {
+    'ANGULAR_SECOND_MOMENT': (p ** 2).sum(),
+    'ENERGY': math.sqrt((p ** 2).sum()),
+    'VARIANCE': (((i - p.mean()) ** 2) * p).sum(),
+    'CONTRAST': contrast,
+    'AUTO_CORRELATION': (i * j * p).sum(),
+    'CORRELATION': ((i * j * p).sum() - mx * my) / (sx * sy),
+    'CORRELATION_M': ((i - mx) * (j - my) * p).sum() / (sx * sy),
+    'INV_DIFF_MOM': (p / (1 + (i - j) ** 2)).sum(),
+    'SUM_AVG': (t * pxy).sum(),
+    'SUM_VAR': (((t - sum_entropy) ** 2) * pxy).sum(),
+    'SUM_ENTROPY': sum_entropy,
+    'ENTROPY': entropy,
+    'DIFF_VAR': contrast,
+    'DIFF_ENTROPY': -(pdiff * numpy.log(pdiff + eps)).sum(),
+    'DISSIMILARITY': (numpy.abs(i - j) * p).sum(),
+    'HOMOGENEITY': homogeneity,
+    'CLUSTER_PROM': (((i + j - mx - my) ** 4) * p).sum(),
+    'CLUSTER_SHADE': (((i + j - mx - my) ** 3) * p).sum(),
+    'MAX_PROB': p.max(),
+    'INF_MEAS_CORR1': (entropy - hxy1) / max(hx, hy),
+    'INF_MEAS_CORR2': math.sqrt(1 - math.exp(-2 * (hxy2 - entropy))),
+    'INV_DIFF': homogeneity,
+    'INV_DIFF_NORM': (p / (1 + numpy.abs(i - j) / float(n))).sum(),
+    'INV_DIFF_MOM_NORM': (p / (1 + ((i - j) ** 2) / float(n ** 2))).sum(),
+    }
+
 class GLCMTest(unittest.TestCase):
   """Performs various tests on the GLCM functionalities"""
   
@@ -143,3 +196,33 @@ class GLCMTest(unittest.TestCase):
     self.assertTrue(numpy.allclose(glcm_prop.properties_by_name(res_matrix, ["angular second moment"]), numpy.array([0.09333333]))) # energy in [5],[6]
     
     
+
+  def test05_GLCM(self):
+    # The multi-threaded accumulation gives the same matrix as the serial one
+    numpy.random.seed(0)
+    image = numpy.random.randint(0, 256, (37, 23)).astype('uint8')
+    glcm = bob.ip.GLCM('uint8', num_levels=16)
+    glcm.offset = numpy.array([[1,0],[1,-1],[0,-1],[-1,-1],[-3,2]], dtype='int32')
+    glcm.symmetric = True
+    reference = glcm(image)
+    glcm.n_threads = 4
+    self.assertEqual(glcm.n_threads, 4)
+    self.assertTrue( (glcm(image) == reference).all() )
+
+    # The properties computed at once match the definitions of [5], on the
+    # matrices of several offsets, one of them with empty rows and columns
+    matrix = numpy.random.randint(0, 10, (9, 9, 4)).astype('double')
+    matrix[3,:,2] = 0
+    matrix[:,5,2] = 0
+    glcm_prop = bob.ip.GLCMProp()
+    self.assertEqual(glcm_prop.get_properties_shape(matrix), (4, 24))
+    props = glcm_prop.properties(matrix)
+    for l in range(matrix.shape[2]):
+      expected = glcm_properties_reference(matrix[:,:,l])
+      for name, value in expected.items():
+        self.assertTrue(numpy.allclose(props[l, int(getattr(bob.ip.GLCMProp.Property, name))], value), name)
+
+    # The single property methods and the selection by name read the same columns
+    self.assertTrue(numpy.allclose(glcm_prop.entropy(matrix), props[:, int(bob.ip.GLCMProp.ENTROPY)]))
+    self.assertTrue(numpy.allclose(glcm_prop.cluster_shade(matrix), props[:, int(bob.ip.GLCMProp.CLUSTER_SHADE)]))
+    self.assertTrue(numpy.allclose(glcm_prop.properties_by_name(matrix, ["entropy", "cluster shade"]), [props[:,11], props[:,17]]))
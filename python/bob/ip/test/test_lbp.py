@@ -626,4 +626,90 @@ class LBPTest(unittest.TestCase):
     self.assertEqual(proc2(values_5x5,plane_index=1,operator_coordinates=(0,0,0)),0x7)
     self.assertEqual(proc2(values_5x5,plane_index=2,operator_coordinates=(0,0,0)),0x7)
 
-
+  def test20_whole_image(self):
+    # the codes of a whole image are the same as the ones extracted pixel by
+    # pixel, whatever the number of threads
+    numpy.random.seed(0)
+    image = numpy.random.randint(0, 256, (23, 31)).astype(numpy.uint8)
+    operators = [
+        bob.ip.LBP(4),
+        bob.ip.LBP(8, uniform=True),
+        bob.ip.LBP(8, circular=True, rotation_invariant=True),
+        bob.ip.LBP(8, circular=True, to_average=True, add_average_bit=True),
+        bob.ip.LBP(16, radius=2., circular=True, uniform=True, rotation_invariant=True),
+        bob.ip.LBP(8, 1., 2., circular=True, elbp_type=bob.ip.ELBPType.TRANSITIONAL),
+        bob.ip.LBP(8, 2., 1., circular=True, elbp_type=bob.ip.ELBPType.DIRECTION_CODED),
+        ]
+    for op in operators:
+      codes = op(image)
+      r_y, r_x = [int(math.ceil(r)) for r in op.radii]
+      for y in range(codes.shape[0]):
+        for x in range(codes.shape[1]):
+          self.assertEqual(codes[y,x], op(image, y + r_y, x + r_x))
+      op.n_threads = 3
+      self.assertTrue((op(image) == codes).all())
+      self.assertTrue((op(image.astype(numpy.float64)) == codes).all())
+
+  def test21_lbptop_planes_and_stream(self):
+    # the LBP-TOP codes are the LBP codes of the XY, XT and YT planes, both
+    # when processing the whole sequence and when pushing the frames
+    numpy.random.seed(0)
+    video = numpy.random.randint(0, 256, (9, 12, 14)).astype(numpy.uint8)
+    lbp = bob.ip.LBP(8, circular=True)
+    op = bob.ip.LBPTop(lbp, lbp, lbp)
+    shape = (video.shape[0]-2, video.shape[1]-2, video.shape[2]-2)
+    xy = numpy.empty(shape, 'uint16')
+    xt = numpy.empty(shape, 'uint16')
+    yt = numpy.empty(shape, 'uint16')
+    op(video, xy, xt, yt)
+
+    for t in range(shape[0]):
+      self.assertTrue((xy[t] == lbp(video[t+1])).all())
+    for y in range(shape[1]):
+      self.assertTrue((xt[:,y,:] == lbp(numpy.ascontiguousarray(video[:,y+1,:]))).all())
+    for x in range(shape[2]):
+      self.assertTrue((yt[:,:,x] == lbp(numpy.ascontiguousarray(video[:,:,x+1]))).all())
+
+    op.n_threads = 3
+    for a in (xy, xt, yt): a.fill(0)
+    op(video, xy, xt, yt)
+    self.assertTrue((xy[-1] == lbp(video[-2])).all())
+
+    # streaming, with only 3 frames in memory
+    s_xy = numpy.empty(shape[1:], 'uint16')
+    s_xt = numpy.empty(shape[1:], 'uint16')
+    s_yt = numpy.empty(shape[1:], 'uint16')
+    for repeat in range(2):
+      op.reset()
+      for t in range(video.shape[0]):
+        ready = op.push(video[t], s_xy, s_xt, s_yt)
+        self.assertEqual(ready, t >= 2)
+        if ready:
+          self.assertTrue((s_xy == xy[t-2]).all())
+          self.assertTrue((s_xt == xt[t-2]).all())
+          self.assertTrue((s_yt == yt[t-2]).all())
+
+  def test22_lbphs_integral_histogram(self):
+    # the block histograms are the same with and without integral histogram
+    numpy.random.seed(0)
+    image = numpy.random.randint(0, 256, (40, 33)).astype(numpy.uint8)
+    for lbp in (bob.ip.LBP(8, uniform=True), bob.ip.LBP(8, radius=2., circular=True)):
+      op = bob.ip.LBPHSFeatures(10, 9, 7, 5, lbp)
+      reference = op(image)
+      op.integral_histogram = True
+      self.assertTrue(op.integral_histogram)
+      histograms = op(image)
+      self.assertEqual(len(histograms), op.get_n_blocks(image))
+      self.assertEqual(len(histograms), len(reference))
+      for h, r in zip(histograms, reference):
+        self.assertTrue((h == r).all())
+
+    # histogram of any rectangle of a label image
+    labels = lbp(image)
+    n_bins = lbp.max_label
+    integral = numpy.empty((labels.shape[0]+1, labels.shape[1]+1, n_bins), 'uint32')
+    bob.ip.integral_histogram(labels, integral)
+    for (y, x, h, w) in ((0, 0, labels.shape[0], labels.shape[1]), (3, 5, 7, 11), (10, 2, 1, 1), (4, 4, 0, 3)):
+      hist = bob.ip.integral_histogram_block(integral, y, x, h, w)
+      expected = numpy.bincount(labels[y:y+h, x:x+w].flatten(), minlength=n_bins)
+      self.assertTrue((hist == expected).all())
@@ -0,0 +1,66 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Sat Oct 17 11:02:14 CEST 2026
+#
+# Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Tests the extraction of Gabor graphs from gray images
+"""
+
+import unittest
+import bob
+import numpy
+
+def complex_jets(jets):
+  """Turns jets with absolute values and phases into complex values, since the
+  phases of small responses are unstable"""
+  return jets[...,0,:] * numpy.exp(1j * jets[...,1,:])
+
+class GaborGraphMachineTest(unittest.TestCase):
+  """Performs various tests for the Gabor graph machine"""
+
+  def test01_extract_from_image(self):
+    # The graphs extracted from the gray image match the ones extracted from
+    # the full Gabor jet image
+    numpy.random.seed(0)
+    image = numpy.random.randint(0, 256, (48, 40)).astype('uint8')
+    gwt = bob.ip.GaborWaveletTransform()
+    graph = bob.machine.GaborGraphMachine((0,1), (47,37), (5,4))
+
+    jets = graph.extract_from_image(gwt, image)
+    self.assertEqual(jets.shape, (graph.number_of_nodes, 2, gwt.number_of_kernels))
+    self.assertTrue(numpy.allclose(complex_jets(jets), complex_jets(graph(gwt.compute_jets(image))), atol=1e-4))
+    self.assertTrue(numpy.allclose(graph.extract_from_image(gwt, image, False), graph(gwt.compute_jets(image, False)), atol=1e-4))
+    self.assertTrue(numpy.allclose(graph.extract_from_image(gwt, image, False, False), graph(gwt.compute_jets(image, False, False)), rtol=1e-4, atol=1e-4))
+
+  def test02_extract_from_image_paths(self):
+    # Graphs with at most sparse_jets_crossover() nodes are extracted with
+    # sparse jets, larger ones from the full Gabor jet image; both match the
+    # graph extracted from the Gabor jet image
+    numpy.random.seed(1)
+    image = numpy.random.randint(0, 256, (48, 40)).astype('uint8')
+    gwt = bob.ip.GaborWaveletTransform()
+    crossover = gwt.sparse_jets_crossover(image.shape)
+    self.assertTrue(0 < crossover <= image.shape[1])
+
+    small = bob.machine.GaborGraphMachine((10,0), (10,crossover-1), (1,1))
+    large = bob.machine.GaborGraphMachine((0,0), (47,39), (1,1))
+    self.assertEqual(small.number_of_nodes, crossover)
+    self.assertTrue(large.number_of_nodes > crossover)
+
+    jet_image = gwt.compute_jets(image)
+    for graph in (small, large):
+      self.assertTrue(numpy.allclose(complex_jets(graph.extract_from_image(gwt, image)), complex_jets(graph(jet_image)), atol=1e-4))
+      self.assertTrue(numpy.allclose(graph.extract_from_image(gwt, image, False), graph(gwt.compute_jets(image, False)), atol=1e-4))
@@ -214,6 +214,40 @@ class GMMMachineTest(unittest.TestCase):
     self.assertTrue ( numpy.allclose(stats.sum_px, stats_ref.sum_px, atol=1e-10) )
     self.assertTrue( numpy.allclose(stats.sum_pxx, stats_ref.sum_pxx, atol=1e-10) )
 
+  def test03b_GMMMachine(self):
+    """Test a GMMMachine (statistics of a block of samples vs. per sample)"""
+
+    numpy.random.seed(1)
+    gmm = bob.machine.GMMMachine(3, 5)
+    gmm.weights   = numpy.array([0.2, 0.3, 0.5], 'float64')
+    gmm.means     = numpy.random.randn(3, 5)
+    gmm.variances = numpy.random.uniform(0.5, 2., (3, 5))
+
+    # The samples are accumulated by blocks of 256: checks sizes which are
+    # smaller than, equal to and not a multiple of the block size
+    for n_samples in (1, 37, 256, 2*256+88):
+      data = numpy.random.randn(n_samples, 5) * 2.
+
+      stats = bob.machine.GMMStats(3, 5)
+      gmm.acc_statistics(data, stats)
+
+      stats_ref = bob.machine.GMMStats(3, 5)
+      for k in range(n_samples):
+        gmm.acc_statistics(data[k,:], stats_ref)
+
+      self.assertEqual(stats.t, n_samples)
+      self.assertEqual(stats.t, stats_ref.t)
+      self.assertTrue( numpy.allclose(stats.log_likelihood, stats_ref.log_likelihood, rtol=1e-10, atol=0) )
+      self.assertTrue( numpy.allclose(stats.n, stats_ref.n, rtol=1e-10, atol=1e-12) )
+      self.assertTrue( numpy.allclose(stats.sum_px, stats_ref.sum_px, rtol=1e-10, atol=1e-12) )
+      self.assertTrue( numpy.allclose(stats.sum_pxx, stats_ref.sum_pxx, rtol=1e-10, atol=1e-12) )
+
+      # The statistics accumulate on top of the existing ones
+      gmm.acc_statistics_(data, stats)
+      self.assertEqual(stats.t, 2*n_samples)
+      self.assertTrue( numpy.allclose(stats.n, 2*stats_ref.n, rtol=1e-10, atol=1e-12) )
+      self.assertTrue( numpy.allclose(stats.sum_px, 2*stats_ref.sum_px, rtol=1e-10, atol=1e-12) )
+
   def test04_GMMMachine(self):
     """Test a GMMMachine (log-likelihood computation)"""
 
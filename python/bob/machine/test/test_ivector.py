@@ -166,3 +166,14 @@ class IVectorTests(unittest.TestCase):
     wij = mc.forward(gs)
     self.assertTrue(numpy.allclose(wij_ref, wij, 1e-5))
 
+    # Batch extraction (C++)
+    gs2 = bob.machine.GMMStats(gs)
+    gs2.n = numpy.array([0.2, 0.8], numpy.float64)
+    wij2 = mc.forward(gs2)
+    for n_threads in (1, 2, 0):
+      wijs = mc.forward([gs, gs2, gs], n_threads)
+      self.assertEqual(wijs.shape, (3, 2))
+      self.assertTrue(numpy.allclose(wijs[0], wij_ref, 1e-5))
+      self.assertTrue(numpy.allclose(wijs[1], wij2, 1e-10))
+      self.assertTrue(numpy.allclose(wijs[2], wij_ref, 1e-5))
+
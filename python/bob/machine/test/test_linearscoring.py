@@ -105,3 +105,24 @@ class LinearScoringTest(unittest.TestCase):
     # 2/d/ With test_channelOffset, with frame-length normalisation
     scores = bob.machine.linear_scoring([model1.mean_supervector, model2.mean_supervector], ubm.mean_supervector, ubm.variance_supervector, [stats1, stats2, stats3], test_channeloffset, True)
     self.assertTrue((abs(scores - ref_scores_11) < 1e-7).all())
+
+    # 3/ Use stacked arrays
+    models = numpy.vstack([model1.mean_supervector, model2.mean_supervector])
+    test_n = numpy.vstack([stats1.n, stats2.n, stats3.n])
+    test_sumpx = numpy.vstack([stats1.sum_px.flatten(), stats2.sum_px.flatten(), stats3.sum_px.flatten()])
+    test_t = numpy.array([stats1.t, stats2.t, stats3.t], 'float64')
+    test_offsets = numpy.vstack(test_channeloffset)
+    scores = bob.machine.linear_scoring(models, ubm.mean_supervector, ubm.variance_supervector, test_n, test_sumpx, test_t)
+    self.assertTrue((abs(scores - ref_scores_00) < 1e-7).all())
+    scores = bob.machine.linear_scoring(models, ubm.mean_supervector, ubm.variance_supervector, test_n, test_sumpx, test_t, None, True)
+    self.assertTrue((abs(scores - ref_scores_01) < 1e-7).all())
+    scores = bob.machine.linear_scoring(models, ubm.mean_supervector, ubm.variance_supervector, test_n, test_sumpx, test_t, test_offsets)
+    self.assertTrue((abs(scores - ref_scores_10) < 1e-7).all())
+    scores = bob.machine.linear_scoring(models, ubm.mean_supervector, ubm.variance_supervector, test_n, test_sumpx, test_t, test_offsets, True)
+    self.assertTrue((abs(scores - ref_scores_11) < 1e-7).all())
+
+    # 4/ Use several threads
+    scores = bob.machine.linear_scoring([model1, model2], ubm, [stats1, stats2, stats3], test_channeloffset, True, 2)
+    self.assertTrue((abs(scores - ref_scores_11) < 1e-7).all())
+    scores = bob.machine.linear_scoring(models, ubm.mean_supervector, ubm.variance_supervector, test_n, test_sumpx, test_t, None, False, 3)
+    self.assertTrue((abs(scores - ref_scores_00) < 1e-7).all())
@@ -151,6 +151,22 @@ def test_100in_100_10_4out():
 
   X = numpy.random.rand(20,100)
   assert numpy.allclose(m(X), pymac.forward(X), rtol=1e-10, atol=1e-15)
+def test_batch_forward():
+
+  # forwarding a batch of inputs at once is the same as forwarding each
+  # input individually
+  m = MLP((5,7,3))
+  m.randomize()
+  m.input_subtract = numpy.random.rand(5)
+  m.input_divide = 1. + numpy.random.rand(5)
+  m.hidden_activation = LogisticActivation()
+  m.output_activation = HyperbolicTangentActivation()
+
+  X = numpy.random.rand(15,5)
+  Y = m(X)
+  for k in range(X.shape[0]):
+    assert numpy.allclose(Y[k,:], m(X[k,:]), rtol=1e-10, atol=1e-15)
+
 def test_resize():
     
   m = MLP((2,3,5,1))
@@ -557,3 +557,36 @@ class PLDAMachineTest(unittest.TestCase):
     # and [x3] separately
     llr_ref = -4.43695386675
     self.assertTrue(abs((llX - (llY + llZ)) - llr_ref) < 1e-10)
+
+  def test06_plda_machine_scoring(self):
+    # Defines base machine
+    sigma = numpy.ndarray(C_dim_d, 'float64')
+    sigma.fill(0.01)
+    mu = numpy.random.randn(C_dim_d)
+    mb = bob.machine.PLDABase(C_dim_d, C_dim_f, C_dim_g)
+    mb.mu = mu
+    mb.f = C_F
+    mb.g = C_G
+    mb.sigma = sigma
+
+    # Defines enrolled models with various numbers of samples
+    models = []
+    for n_samples in [0, 1, 2, 2, 5]:
+      m = bob.machine.PLDAMachine(mb)
+      m.n_samples = n_samples
+      m.w_sum_xit_beta_xi = numpy.random.randn()
+      m.weighted_sum = numpy.random.randn(C_dim_f)
+      m.log_likelihood = numpy.random.randn()
+      models.append(m)
+
+    # Compares the scores of all the probes with the forward method
+    probes = numpy.random.randn(7, C_dim_d)
+    scores = bob.machine.plda_scoring(models, probes)
+    self.assertEqual(scores.shape, (5,7))
+    for i, m in enumerate(models):
+      for j in range(probes.shape[0]):
+        self.assertTrue(abs(scores[i,j] - m.forward(probes[j,:])) < 1e-8)
+
+    # Models should share the same PLDABase
+    m = bob.machine.PLDAMachine(bob.machine.PLDABase(mb))
+    self.assertRaises(RuntimeError, bob.machine.plda_scoring, models + [m], probes)
@@ -21,7 +21,7 @@
 """Tests on the ZTNorm function
 """
 
-import os, sys
+import os, sys, tempfile
 import unittest
 import numpy
 import bob
@@ -136,3 +136,47 @@ class ZTNormTest(unittest.TestCase):
     empty = numpy.zeros(shape=(0,0), dtype=numpy.float64)
     zA = bob.machine.ztnorm(my_A, my_B, empty, empty)
     self.assertTrue((abs(zA - zA_py) < 1e-7).all())
+
+  def test05_ztnorm_hdf5(self):
+    numpy.random.seed(0)
+    my_A = numpy.random.randn(23, 7)
+    my_B = numpy.random.randn(23, 11)
+    my_C = numpy.random.randn(9, 7)
+    my_D = numpy.random.randn(9, 11)
+    my_mask = numpy.random.rand(9, 11) < 0.2
+
+    filename = str(tempfile.mkstemp(".hdf5")[1])
+    f = bob.io.HDF5File(filename, 'w')
+    f.set('A', my_A)
+    f.set('B', my_B)
+    f.set('C', my_C)
+    f.set('D', my_D)
+    f.set('mask', my_mask)
+    del f
+
+    f = bob.io.HDF5File(filename, 'a')
+    for block_size, n_threads in ((1024, 1), (4, 1), (3, 2), (2, 0)):
+      bob.machine.ztnorm(f, 'A', 'B', 'C', 'D', 'mask', f, 'ztnorm_mask',
+          block_size, n_threads)
+      bob.machine.ztnorm(f, 'A', 'B', 'C', 'D', f, 'ztnorm', block_size,
+          n_threads)
+      bob.machine.tnorm(f, 'A', 'C', f, 'tnorm', block_size, n_threads)
+      bob.machine.znorm(f, 'A', 'B', f, 'znorm', block_size, n_threads)
+
+      ref = bob.machine.ztnorm(my_A, my_B, my_C, my_D, my_mask)
+      self.assertTrue((abs(f.read('ztnorm_mask') - ref) < 1e-10).all())
+      ref = bob.machine.ztnorm(my_A, my_B, my_C, my_D)
+      self.assertTrue((abs(f.read('ztnorm') - ref) < 1e-10).all())
+      ref = bob.machine.tnorm(my_A, my_C)
+      self.assertTrue((abs(f.read('tnorm') - ref) < 1e-10).all())
+      ref = bob.machine.znorm(my_A, my_B)
+      self.assertTrue((abs(f.read('znorm') - ref) < 1e-10).all())
+
+      for path in ('ztnorm_mask', 'ztnorm', 'tnorm', 'znorm'):
+        f.unlink(path)
+
+    # The output dataset should not already exist
+    bob.machine.znorm(f, 'A', 'B', f, 'znorm')
+    self.assertRaises(RuntimeError, bob.machine.znorm, f, 'A', 'B', f, 'znorm')
+    del f
+    os.unlink(filename)
@@ -38,6 +38,50 @@ def save(fname, data):
   """Saves a single array into a file in the 'data' directory."""
   bob.io.Array(data).save(os.path.join('data', fname))
 
+def farfrr_reference(negatives, positives, threshold):
+  """Counts the false accepts and rejects one by one"""
+  far = count(negatives >= threshold) / float(max(len(negatives), 1))
+  frr = count(positives < threshold) / float(max(len(positives), 1))
+  return far, frr
+
+def minimizing_threshold_reference(negatives, positives, predicate):
+  """Recursive minimization of the predicate, evaluating the ratios of each
+  threshold on the unsorted scores"""
+
+  def recursive(minimum, maximum, steps):
+    diff = maximum - minimum
+    if abs(diff/maximum) < 1e-10: return minimum
+    step_size = diff/float(steps)
+    min_value = predicate(1.0, 0.0)
+    accumulator = []
+    for i in range(steps):
+      threshold = (i * step_size) + minimum
+      cost = predicate(*farfrr_reference(negatives, positives, threshold))
+      if cost < min_value:
+        min_value = cost
+        accumulator = [threshold]
+      elif abs(cost - min_value) < 1e-16:
+        accumulator.append(threshold)
+    if len(accumulator) != steps:
+      middle = accumulator[len(accumulator)//2]
+      return recursive(middle-step_size, middle+step_size, steps)
+    return accumulator[len(accumulator)//2]
+
+  return recursive(min(negatives.min(), positives.min()),
+      max(negatives.max(), positives.max()), 100)
+
+def roc_reference(negatives, positives, points):
+  """ROC curve computed with one call to farfrr() per threshold"""
+  minimum = min(negatives.min(), positives.min())
+  maximum = max(negatives.max(), positives.max())
+  step = (maximum-minimum)/(points-1.0)
+  retval = numpy.ndarray((2, points), 'float64')
+  for i in range(points):
+    far, frr = farfrr_reference(negatives, positives, minimum + i*step)
+    retval[0,i] = frr
+    retval[1,i] = far
+  return retval
+
 class ErrorTest(unittest.TestCase):
   """Various measure package tests for error evaluation."""
 
@@ -189,6 +233,36 @@ class ErrorTest(unittest.TestCase):
     xyref = bob.io.load(F('nonsep-epc.hdf5'))
     self.assertTrue( numpy.allclose(xy, xyref, atol=1e-15) )
 
+  def test04b_sorted_scores(self):
+
+    # The scores are sorted once to compute the ratios with binary searches:
+    # the results are the same as when counting the errors one by one, on
+    # unsorted and non-contiguous inputs, and with ties on the thresholds
+    numpy.random.seed(42)
+    positives = bob.io.load(F('nonsep-positives.hdf5'))
+    negatives = bob.io.load(F('nonsep-negatives.hdf5'))
+    rounded_n = numpy.round(numpy.random.randn(301), 1)
+    rounded_p = numpy.round(numpy.random.randn(207) + 1., 1)
+
+    for n, p in ((negatives, positives), (rounded_n, rounded_p),
+        (negatives[::-1], positives[::2]), (rounded_n[::3], rounded_p[1::2])):
+
+      thresholds = list(numpy.unique(numpy.hstack((n, p))))
+      thresholds += [n.min()-1., p.max()+1., 0.05, 0.5]
+      for t in thresholds:
+        self.assertEqual(bob.measure.farfrr(n, p, t),
+            farfrr_reference(n, p, t))
+
+      self.assertEqual(bob.measure.eer_threshold(n, p),
+          minimizing_threshold_reference(n, p, lambda far, frr: abs(far-frr)))
+      self.assertEqual(bob.measure.min_hter_threshold(n, p),
+          minimizing_threshold_reference(n, p,
+            lambda far, frr: (0.5*far) + ((1.0-0.5)*frr)))
+
+      for points in (2, 17, 100):
+        self.assertTrue(numpy.array_equal(bob.measure.roc(n, p, points),
+          roc_reference(n, p, points)))
+
   def test05_rocch(self):
 
     # This example will demonstrate and check the use of eer_rocch_threshold() to
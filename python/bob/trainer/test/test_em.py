@@ -260,3 +260,34 @@ class GMMTest(unittest.TestCase):
     
     for i in range(0, 2):
       self.assertTrue((ar[i+1] == machine.means[i, :]).all())
+
+  def test08_gmm_threads(self):
+
+    # The E-step gives the same statistics whatever the number of threads
+    # (up to the order of the floating-point sums)
+
+    ar = bob.io.load(F('dataNormalized.hdf5'))
+    ar = numpy.vstack((ar, ar[:7])) # not a multiple of the number of threads
+
+    gmm = bob.machine.GMMMachine(5, 45)
+    gmm.means = bob.io.load(F('meansAfterKMeans.hdf5')).astype('float64')
+    gmm.variances = bob.io.load(F('variancesAfterKMeans.hdf5')).astype('float64')
+    gmm.weights = numpy.exp(bob.io.load(F('weightsAfterKMeans.hdf5')).astype('float64'))
+    gmm.set_variance_thresholds(0.001)
+
+    stats = []
+    for n_threads in (1, 4):
+      trainer = bob.trainer.ML_GMMTrainer(True, True, True)
+      trainer.n_threads = n_threads
+      self.assertEqual(trainer.n_threads, n_threads)
+      trainer.initialization(gmm, ar)
+      trainer.e_step(gmm, ar)
+      stats.append(trainer.gmm_statistics)
+
+    s1, s4 = stats
+    self.assertEqual(s1.t, ar.shape[0])
+    self.assertEqual(s1.t, s4.t)
+    self.assertTrue(numpy.allclose(s1.log_likelihood, s4.log_likelihood, rtol=1e-10, atol=0))
+    self.assertTrue(numpy.allclose(s1.n, s4.n, rtol=1e-10, atol=1e-12))
+    self.assertTrue(numpy.allclose(s1.sum_px, s4.sum_px, rtol=1e-10, atol=1e-12))
+    self.assertTrue(numpy.allclose(s1.sum_pxx, s4.sum_pxx, rtol=1e-10, atol=1e-12))
@@ -373,3 +373,43 @@ class IVectorTests(unittest.TestCase):
       self.assertTrue(numpy.allclose(t_ref[it], m.t, 1e-5))
       self.assertTrue(numpy.allclose(sigma_ref[it], m.sigma, 1e-5))
 
+  def test03_trainer_nthreads(self):
+    # Ubm
+    dim_c = 2
+    dim_d = 3
+    ubm = bob.machine.GMMMachine(dim_c,dim_d)
+    ubm.weights = numpy.array([0.4,0.6])
+    ubm.means = numpy.array([[1.,7,4],[4,5,3]])
+    ubm.variances = numpy.array([[0.5,1.,1.5],[1.,1.5,2.]])
+
+    # Defines GMMStats
+    numpy.random.seed(0)
+    data = []
+    for i in range(7):
+      gs = bob.machine.GMMStats(dim_c,dim_d)
+      gs.t = 1
+      gs.n = numpy.random.rand(dim_c)
+      gs.sum_px = numpy.random.rand(dim_c,dim_d) * 5.
+      gs.sum_pxx = numpy.random.rand(dim_c,dim_d) * 50.
+      data.append(gs)
+
+    t = numpy.array([[1.,2],[4,1],[0,3],[5,8],[7,10],[11,1]])
+    sigma = numpy.array([1.,2.,1.,3.,2.,4.])
+
+    # The accumulators should not depend on the number of threads
+    accs = []
+    for n_threads in (1, 3, 0):
+      m = bob.machine.IVectorMachine(ubm, 2)
+      trainer = bob.trainer.IVectorTrainer(update_sigma=True)
+      trainer.n_threads = n_threads
+      self.assertEqual(trainer.n_threads, n_threads)
+      trainer.initialization(m, data)
+      m.t = t
+      m.sigma = sigma
+      trainer.e_step(m, data)
+      accs.append((trainer.acc_nij_wij2, trainer.acc_fnormij_wij,
+        trainer.acc_nij, trainer.acc_snormij))
+
+    for acc in accs[1:]:
+      for a, ref in zip(acc, accs[0]):
+        self.assertTrue(numpy.allclose(a, ref, 1e-10, 1e-10))
@@ -268,3 +268,42 @@ class FATrainerTest(unittest.TestCase):
     t.enrol(m, gse, 5)
     self.assertTrue( numpy.allclose(m.z, z_ref, eps) )
 
+
+  def test06_FATrainer_nthreads(self):
+    # Checks that the E-steps give the same results with several threads
+
+    ubm = bob.machine.GMMMachine(2,3)
+    ubm.mean_supervector = UBM_MEAN
+    ubm.variance_supervector = UBM_VAR
+    training_stats = TRAINING_STATS + [[gs12, gs21, gs22], [gs11]]
+
+    jfa_results = []
+    for n_threads in (1, 3, 0):
+      mb = bob.machine.JFABase(ubm, 2, 2)
+      t = bob.trainer.JFATrainer(5)
+      t.n_threads = n_threads
+      self.assertEqual(t.n_threads, n_threads)
+      t.initialization(mb, training_stats)
+      mb.u = M_u
+      mb.v = M_v
+      mb.d = M_d
+      t.train_loop(mb, training_stats)
+      jfa_results.append((mb.u.copy(), mb.v.copy(), mb.d.copy()))
+
+    isv_results = []
+    for n_threads in (1, 3, 0):
+      mb = bob.machine.ISVBase(ubm, 2)
+      t = bob.trainer.ISVTrainer(5, 4.)
+      t.n_threads = n_threads
+      t.initialization(mb, training_stats)
+      mb.u = M_u
+      for i in range(5):
+        t.e_step(mb, training_stats)
+        t.m_step(mb, training_stats)
+      isv_results.append((mb.u.copy(), mb.d.copy()))
+
+    eps = 1e-10
+    for results in (jfa_results, isv_results):
+      for r in results[1:]:
+        for a, b in zip(results[0], r):
+          self.assertTrue( numpy.allclose(a, b, eps) )
@@ -52,7 +52,6 @@ def kmeans_plus_plus(machine, data, seed):
       for i in range(m):
         w_cur = min(machine.get_distance_from_mean(s_cur, i), w_cur)
       weights[s] = w_cur
-    weights *= weights
     weights /= numpy.sum(weights)
     rng_d = bob.core.random.discrete_int32(weights)
     index = rng_d(mt)
@@ -197,3 +196,87 @@ class KMeansTest(unittest.TestCase):
     trainer.train(machine, data)
     self.assertFalse( numpy.isnan(machine.means).any())
 
+
+  def test04_kmeans_assignment_nthreads(self):
+
+    # Checks that the accelerated assignment and the multithreaded E-step
+    # lead to the same means as the direct one
+    numpy.random.seed(1)
+    data = numpy.random.randn(500, 4)
+    data[:250] += 3.
+
+    def train(assignment_method, n_threads, compute_likelihood):
+      machine = bob.machine.KMeansMachine(8, 4)
+      trainer = bob.trainer.KMeansTrainer()
+      trainer.rng = bob.core.random.mt19937(0)
+      trainer.compute_likelihood = compute_likelihood
+      trainer.max_iterations = 20
+      trainer.assignment_method = assignment_method
+      trainer.n_threads = n_threads
+      trainer.train(machine, data)
+      return machine.means, trainer.average_min_distance
+
+    ref_means, ref_distance = train(bob.trainer.KMeansTrainer.DIRECT, 1, True)
+    for method in (bob.trainer.KMeansTrainer.DIRECT, bob.trainer.KMeansTrainer.HAMERLY):
+      for n_threads in (1, 3, 0):
+        means, distance = train(method, n_threads, True)
+        self.assertTrue(equals(means, ref_means, 1e-8))
+        self.assertTrue(abs(distance - ref_distance) < 1e-8)
+        means, distance = train(method, n_threads, False)
+        self.assertTrue(equals(means, ref_means, 1e-8))
+
+  def test05_kmeans_parallel(self):
+
+    # Tests the k-means|| initialization on well separated clusters
+    numpy.random.seed(2)
+    dim_c = 4
+    dim_d = 3
+    centres = 20. * numpy.random.randn(dim_c, dim_d)
+    data = numpy.vstack([c + numpy.random.randn(1000, dim_d) for c in centres])
+
+    def initialize(n_threads):
+      machine = bob.machine.KMeansMachine(dim_c, dim_d)
+      trainer = bob.trainer.KMeansTrainer()
+      trainer.rng = bob.core.random.mt19937(0)
+      trainer.initialization_method = bob.trainer.KMeansTrainer.KMEANS_PARALLEL
+      trainer.n_threads = n_threads
+      trainer.initialization(machine, data)
+      return machine.means
+
+    means = initialize(1)
+    # The selected candidates do not depend on the number of threads
+    for n_threads in (3, 0):
+      self.assertTrue(equals(initialize(n_threads), means, 1e-12))
+    # Each mean is a sample, and each cluster gets one mean
+    for m in means:
+      self.assertTrue((abs(data - m).sum(axis=1) < 1e-12).any())
+    closest = [numpy.argmin(((centres - m)**2).sum(axis=1)) for m in means]
+    self.assertEqual(sorted(closest), list(range(dim_c)))
+
+  def test06_kmeans_parallel_few_candidates(self):
+
+    # The k-means|| parameters that would not give any candidate are rejected
+    trainer = bob.trainer.KMeansTrainer()
+    self.assertRaises(RuntimeError, setattr, trainer, 'oversampling_rounds', 0)
+    self.assertRaises(RuntimeError, setattr, trainer, 'oversampling_factor', 0.)
+    self.assertRaises(RuntimeError, setattr, trainer, 'oversampling_factor', -1.)
+    self.assertEqual(trainer.oversampling_rounds, 5)
+    self.assertEqual(trainer.oversampling_factor, 2.)
+
+    # With fewer candidates than means, the means are selected among all the
+    # samples, so that they are all different and no cluster is empty
+    numpy.random.seed(3)
+    dim_c = 4
+    dim_d = 3
+    data = numpy.vstack([c + numpy.random.randn(50, dim_d) for c in 20. * numpy.random.randn(dim_c, dim_d)])
+    machine = bob.machine.KMeansMachine(dim_c, dim_d)
+    trainer.rng = bob.core.random.mt19937(0)
+    trainer.initialization_method = bob.trainer.KMeansTrainer.KMEANS_PARALLEL
+    trainer.oversampling_rounds = 1
+    trainer.oversampling_factor = 1e-6
+    trainer.train(machine, data)
+    means = machine.means
+    self.assertFalse(numpy.isnan(means).any())
+    for i in range(dim_c):
+      for j in range(i):
+        self.assertFalse(equals(means[i], means[j], 1e-8))
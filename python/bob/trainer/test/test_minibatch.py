@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Sat Oct 17 18:42:10 2026 +0200
+#
+# Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Tests the sample sources and the mini-batch k-means and GMM trainers
+"""
+
+import os
+import unittest
+import tempfile
+import numpy
+import bob
+
+def equals(x, y, epsilon):
+  return (abs(x - y) < epsilon).all()
+
+def clusters(n_samples):
+  """Three well separated clusters, with shuffled samples"""
+  numpy.random.seed(0)
+  centres = numpy.array([[0., 0.], [8., 0.], [0., 8.]])
+  data = numpy.vstack([c + numpy.random.randn(n_samples, 2) for c in centres])
+  return data[numpy.random.permutation(data.shape[0])]
+
+def sort_rows(a):
+  return a[numpy.lexsort(a.T[::-1])]
+
+class MiniBatchTest(unittest.TestCase):
+  """Performs various tests for the mini-batch trainers."""
+
+  def test01_sample_sources(self):
+
+    data = numpy.random.randn(25, 3)
+
+    # Samples in memory
+    source = bob.trainer.ArraySampleSource(data)
+    self.assertEqual(source.n_inputs, 3)
+    blocks = []
+    while True:
+      block = source.read(10)
+      if block.shape[0] == 0: break
+      blocks.append(block)
+    self.assertEqual([b.shape[0] for b in blocks], [10, 10, 5])
+    self.assertTrue(equals(numpy.vstack(blocks), data, 1e-12))
+    source.reset()
+    self.assertTrue(equals(source.read(30), data, 1e-12))
+
+    # Samples spread over several files
+    filenames = []
+    try:
+      for chunk in (data[:7], data[7:8], data[8:]):
+        fd, filename = tempfile.mkstemp(suffix='.hdf5')
+        os.close(fd)
+        os.unlink(filename)
+        bob.io.save(chunk, filename)
+        filenames.append(filename)
+      source = bob.trainer.FileSampleSource(filenames)
+      self.assertEqual(source.n_inputs, 3)
+      self.assertTrue(equals(source.read(9), data[:9], 1e-12))
+      self.assertTrue(equals(source.read(100), data[9:], 1e-12))
+      self.assertEqual(source.read(100).shape[0], 0)
+      source.reset()
+      self.assertTrue(equals(source.read(100), data, 1e-12))
+    finally:
+      for filename in filenames: os.unlink(filename)
+
+  def test01b_file_sample_source_blocks(self):
+
+    # Arrays larger than the requested blocks are read in several blocks,
+    # both from a single 2D array and from a list of 2D arrays
+    numpy.random.seed(1)
+    data = numpy.random.randn(57, 3)
+    filenames = []
+    try:
+      fd, filename = tempfile.mkstemp(suffix='.hdf5')
+      os.close(fd)
+      os.unlink(filename)
+      bob.io.save(data[:30], filename)
+      filenames.append(filename)
+      fd, filename = tempfile.mkstemp(suffix='.hdf5')
+      os.close(fd)
+      os.unlink(filename)
+      outfile = bob.io.HDF5File(filename, 'w')
+      outfile.append('samples', data[30:50])
+      outfile.append('samples', data[50:])
+      del outfile
+      filenames.append(filename)
+
+      source = bob.trainer.FileSampleSource(filenames)
+      self.assertEqual(source.n_inputs, 3)
+      for batch_size in (4, 7, 100):
+        source.reset()
+        blocks = []
+        while True:
+          block = source.read(batch_size)
+          if block.shape[0] == 0: break
+          self.assertTrue(block.shape[0] <= batch_size)
+          blocks.append(block)
+        self.assertEqual(len(blocks), (data.shape[0] + batch_size - 1) // batch_size)
+        self.assertTrue(equals(numpy.vstack(blocks), data, 1e-12))
+    finally:
+      for filename in filenames: os.unlink(filename)
+
+  def test02_minibatch_kmeans(self):
+
+    data = clusters(1000)
+
+    # Batch k-means
+    machine = bob.machine.KMeansMachine(3, 2)
+    trainer = bob.trainer.KMeansTrainer()
+    trainer.rng = bob.core.random.mt19937(0)
+    trainer.initialization_method = bob.trainer.KMeansTrainer.KMEANS_PLUS_PLUS
+    trainer.train(machine, data)
+
+    # Mini-batch k-means
+    mb_machine = bob.machine.KMeansMachine(3, 2)
+    mb_trainer = bob.trainer.MiniBatchKMeansTrainer(100)
+    mb_trainer.rng = bob.core.random.mt19937(0)
+    mb_trainer.initialization_method = bob.trainer.KMeansTrainer.KMEANS_PLUS_PLUS
+    mb_trainer.n_threads = 2
+    mb_trainer.train(mb_machine, bob.trainer.ArraySampleSource(data))
+
+    self.assertEqual(mb_trainer.counts.sum() % data.shape[0], 0)
+    self.assertTrue(equals(sort_rows(mb_machine.means), sort_rows(machine.means), 0.1))
+    self.assertTrue(abs(mb_trainer.average_min_distance - trainer.average_min_distance) < 0.1)
+
+  def test03_online_gmm(self):
+
+    data = clusters(1000)
+
+    def init_gmm():
+      gmm = bob.machine.GMMMachine(3, 2)
+      gmm.means = numpy.array([[1., 1.], [6., 1.], [1., 6.]])
+      gmm.variances = numpy.ones((3, 2))
+      gmm.weights = numpy.array([0.2, 0.3, 0.5])
+      return gmm
+
+    # Batch EM
+    gmm = init_gmm()
+    trainer = bob.trainer.ML_GMMTrainer(True, True, True)
+    trainer.max_iterations = 25
+    trainer.train(gmm, data)
+
+    # Stepwise EM
+    online_gmm = init_gmm()
+    online_trainer = bob.trainer.OnlineGMMTrainer(200, 0.6, True, True, True)
+    online_trainer.max_iterations = 10
+    online_trainer.train(online_gmm, bob.trainer.ArraySampleSource(data))
+
+    self.assertTrue(online_trainer.n_updates > 0)
+    self.assertTrue(equals(online_gmm.means, gmm.means, 0.1))
+    self.assertTrue(equals(online_gmm.variances, gmm.variances, 0.1))
+    self.assertTrue(equals(online_gmm.weights, gmm.weights, 0.02))
+
+    # With kappa=1, a single pass over the data with one batch is a batch
+    # EM iteration
+    gmm = init_gmm()
+    trainer.max_iterations = 1
+    trainer.initialization(gmm, data)
+    trainer.e_step(gmm, data)
+    trainer.m_step(gmm, data)
+    online_gmm = init_gmm()
+    online_trainer = bob.trainer.OnlineGMMTrainer(data.shape[0], 1., True, True, True)
+    online_trainer.initialization(online_gmm)
+    online_trainer.update(online_gmm, data)
+    self.assertTrue(equals(online_gmm.means, gmm.means, 1e-8))
+    self.assertTrue(equals(online_gmm.variances, gmm.variances, 1e-8))
+    self.assertTrue(equals(online_gmm.weights, gmm.weights, 1e-8))
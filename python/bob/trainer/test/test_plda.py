@@ -744,3 +744,36 @@ class PLDATrainerTest(unittest.TestCase):
     self.assertFalse( t1 == t2 )
     self.assertTrue(  t1 != t2 )
     self.assertFalse( t1.is_similar_to(t2) )
+
+  def test05_plda_nthreads(self):
+    # Checks that the E-step gives the same statistics with several threads
+
+    D = 5
+    nf = 2
+    ng = 2
+    numpy.random.seed(42)
+    l = [numpy.random.randn(n, D) for n in (4, 3, 4, 2, 3, 4, 1)]
+
+    results = []
+    for n_threads in (1, 3, 0):
+      for use_sum in (True, False):
+        m = bob.machine.PLDABase(D,nf,ng)
+        t = bob.trainer.PLDATrainer(5, use_sum)
+        t.n_threads = n_threads
+        self.assertEqual(t.n_threads, n_threads)
+        t.rng.seed(37)
+        t.initialization(m, l)
+        t.e_step(m, l)
+        z1 = [z.copy() for z in t.z_first_order]
+        z2_sum = t.z_second_order_sum.copy()
+        if not use_sum:
+          z2 = [z.copy() for z in t.z_second_order]
+          self.assertTrue(numpy.allclose(sum(z.sum(axis=0) for z in z2), z2_sum))
+        t.m_step(m, l)
+        results.append((z1, z2_sum, m.f.copy(), m.g.copy(), m.sigma.copy()))
+
+    for r in results[1:]:
+      for a, b in zip(r[0], results[0][0]):
+        self.assertTrue(numpy.allclose(a, b))
+      for a, b in zip(r[1:], results[0][1:]):
+        self.assertTrue(numpy.allclose(a, b))
@@ -70,6 +70,26 @@ class DetectionTest(unittest.TestCase):
       locdata = self.processor(image)
       self.assertTrue(locdata is not None)
 
+  @utils.visioner_available
+  @utils.ffmpeg_found()
+  def test04_Threaded(self):
+
+    # Scanning with several threads gives the same detections (in the same
+    # order) and the same statistics as scanning in the current thread
+    from .. import Detector
+    video = io.VideoReader(TEST_VIDEO)
+    images = [ip.rgb_to_gray(k) for k in video[:3]]
+    images.append(ip.rgb_to_gray(io.load(IMAGE)))
+
+    for threads in (2, 3, 8):
+      serial = Detector(scanning_levels=5)
+      serial.threads = 1
+      threaded = Detector(scanning_levels=5)
+      threaded.threads = threads
+      for image in images:
+        self.assertEqual(serial(image), threaded(image))
+      self.assertEqual(serial.stats, threaded.stats)
+
   @utils.visioner_available
   @utils.ffmpeg_found()
   def xtest03_Thorough(self):
@@ -0,0 +1,157 @@
+/**
+ * @file io/cxx/AsyncVideoReader.cc
+ * @date Sat Oct 17 16:40:12 2026 +0200
+ *
+ * @brief A class to read videos, decoding frames in a background thread.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/io/AsyncVideoReader.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+
+#include <bob/core/blitz_array.h>
+
+bob::io::AsyncVideoReader::AsyncVideoReader
+(boost::shared_ptr<const bob::io::VideoReader> reader, size_t n_buffers,
+ size_t stride, bool throw_on_error):
+  m_reader(reader),
+  m_stride(std::max(stride, (size_t)1)),
+  m_throw_on_error(throw_on_error),
+  m_buffers(std::max(n_buffers, (size_t)1)),
+  m_frames(m_buffers.size(), 0),
+  m_head(0),
+  m_ready(0),
+  m_finished(false),
+  m_stop(false),
+  m_last_frame(0)
+{
+  //pre-allocates the frame buffers, so no allocation happens while reading
+  for (size_t i=0; i<m_buffers.size(); ++i)
+    m_buffers[i].resize(3, m_reader->height(), m_reader->width());
+
+  m_thread = boost::thread(boost::bind(&bob::io::AsyncVideoReader::run, this));
+}
+
+bob::io::AsyncVideoReader::~AsyncVideoReader() {
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_buffer_free.notify_all();
+  m_thread.join();
+}
+
+void bob::io::AsyncVideoReader::run() {
+
+  try {
+    bob::io::VideoReader::const_iterator it = m_reader->begin(m_stride);
+
+    while (it.parent()) {
+
+      //waits for a free buffer
+      size_t slot = 0;
+      {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while (!m_stop && m_ready == m_buffers.size()) m_buffer_free.wait(lock);
+        if (m_stop) break;
+        slot = (m_head + m_ready) % m_buffers.size();
+      }
+
+      //decodes into the buffer: only this thread touches it until it is
+      //marked as ready (N.B.: we don't use blitz views, as reference
+      //counting is not thread-safe)
+      const size_t frame = it.cur();
+      bob::core::array::blitz_array ref(static_cast<void*>(m_buffers[slot].data()),
+          m_reader->frame_type());
+      if (!it.read(ref, m_throw_on_error)) break;
+
+      {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_frames[slot] = frame;
+        ++m_ready;
+      }
+      m_frame_ready.notify_one();
+    }
+  }
+  catch (...) {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_error = std::current_exception();
+  }
+
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_finished = true;
+  }
+  m_frame_ready.notify_one();
+}
+
+bool bob::io::AsyncVideoReader::read(blitz::Array<uint8_t,3>& data) {
+  bob::core::array::blitz_array tmp(data);
+  return read(tmp);
+}
+
+bool bob::io::AsyncVideoReader::read(bob::core::array::interface& data) {
+
+  const bob::core::array::typeinfo& info = data.type();
+
+  //checks if the output array shape conforms to the video specifications,
+  //otherwise, throw
+  if (!info.is_compatible(m_reader->frame_type())) {
+    boost::format s("input buffer (%s) does not conform to the video frame size specifications (%s)");
+    s % info.str() % m_reader->frame_type().str();
+    throw std::invalid_argument(s.str());
+  }
+
+  //waits for a decoded frame
+  size_t slot = 0;
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (m_ready == 0 && !m_finished) m_frame_ready.wait(lock);
+    if (m_ready == 0) {
+      if (m_error) {
+        std::exception_ptr error = m_error;
+        m_error = std::exception_ptr();
+        std::rethrow_exception(error);
+      }
+      return false;
+    }
+    slot = m_head;
+  }
+
+  //copies the frame out of the ring
+  blitz::TinyVector<int,3> shape;
+  blitz::TinyVector<int,3> stride;
+  shape = info.shape[0], info.shape[1], info.shape[2];
+  stride = info.stride[0], info.stride[1], info.stride[2];
+  blitz::Array<uint8_t,3> dst(static_cast<uint8_t*>(data.ptr()), 
+      shape, stride, blitz::neverDeleteData);
+  dst = m_buffers[slot];
+  m_last_frame = m_frames[slot];
+
+  //gives the buffer back to the producer
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_head = (m_head + 1) % m_buffers.size();
+    --m_ready;
+  }
+  m_buffer_free.notify_one();
+
+  return true;
+}
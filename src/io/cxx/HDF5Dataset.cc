@@ -485,6 +485,36 @@ void bob::io::detail::hdf5::Dataset::read_buffer (size_t index, const bob::io::H
   if (status < 0) throw bob::io::HDF5StatusError("H5Dread", status);
 }
 
+void bob::io::detail::hdf5::Dataset::read_hyperslab (const bob::io::HDF5Shape& start,
+    const bob::io::HDF5Type& dest, void* buffer) {
+
+  //the last descriptor reads the dataset as a single array
+  const bob::io::HDF5Shape& extents = m_descr.back().type.shape();
+  const bob::io::HDF5Shape& count = dest.shape();
+  if (start.n() != extents.n() || count.n() != extents.n()) {
+    boost::format m("cannot read a hyperslab of rank %d starting at rank %d from dataset '%s' of rank %d");
+    m % count.n() % start.n() % url() % extents.n();
+    throw std::runtime_error(m.str());
+  }
+  for (size_t k=0; k<extents.n(); ++k) {
+    if (start[k] + count[k] > extents[k]) {
+      boost::format m("the hyperslab [%d, %d) exceeds the extent %d of dimension %d of dataset '%s'");
+      m % start[k] % (start[k] + count[k]) % extents[k] % k % url();
+      throw std::runtime_error(m.str());
+    }
+  }
+
+  boost::shared_ptr<hid_t> memspace = open_memspace(count);
+
+  herr_t status = H5Sselect_hyperslab(*m_filespace, H5S_SELECT_SET,
+      start.get(), 0, count.get(), 0);
+  if (status < 0) throw bob::io::HDF5StatusError("H5Sselect_hyperslab", status);
+
+  status = H5Dread(*m_id, *dest.htype(), *memspace, *m_filespace,
+      H5P_DEFAULT, buffer);
+  if (status < 0) throw bob::io::HDF5StatusError("H5Dread", status);
+}
+
 void bob::io::detail::hdf5::Dataset::write_buffer (size_t index, const bob::io::HDF5Type& dest,
     const void* buffer) {
 
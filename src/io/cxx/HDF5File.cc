@@ -148,6 +148,12 @@ void bob::io::HDF5File::read_buffer (const std::string& path, size_t pos,
   (*m_cwd)[path]->read_buffer(pos, type, buffer);
 }
 
+void bob::io::HDF5File::read_hyperslab (const std::string& path,
+    const bob::io::HDF5Shape& start, const bob::io::HDF5Type& type,
+    void* buffer) const {
+  (*m_cwd)[path]->read_hyperslab(start, type, buffer);
+}
+
 void bob::io::HDF5File::write_buffer (const std::string& path,
     size_t pos, const bob::io::HDF5Type& type, const void* buffer) {
   if (!m_file->writeable()) {
@@ -27,6 +27,7 @@
 #include <boost/format.hpp>
 #include <boost/preprocessor.hpp>
 #include <limits>
+#include <algorithm>
 
 #include <bob/core/check.h>
 #include <bob/core/blitz_array.h>
@@ -36,21 +37,34 @@
 #define AV_PIX_FMT_RGB24 PIX_FMT_RGB24
 #endif
 
-bob::io::VideoReader::VideoReader(const std::string& filename, bool check) {
+bob::io::VideoReader::VideoReader(const std::string& filename, bool check):
+  m_decoding_threads(1)
+{
   open(filename, check);
 }
 
-bob::io::VideoReader::VideoReader(const bob::io::VideoReader& other) {
+bob::io::VideoReader::VideoReader(const bob::io::VideoReader& other):
+  m_decoding_threads(1)
+{
   *this = other;
 }
 
 bob::io::VideoReader& bob::io::VideoReader::operator= (const bob::io::VideoReader& other) {
+  m_decoding_threads = other.m_decoding_threads;
   open(other.filename(), other.m_check);
   return *this;
 }
 
 void bob::io::VideoReader::open(const std::string& filename, bool check) {
   m_filepath = filename;
+  {
+    boost::lock_guard<boost::mutex> lock(m_index_mutex);
+    m_index.reset();
+  }
+  {
+    boost::lock_guard<boost::mutex> lock(m_read_mutex);
+    m_read_iterator.reset();
+  }
 
   boost::shared_ptr<AVFormatContext> format_ctxt =
     bob::io::detail::ffmpeg::make_input_format_context(m_filepath);
@@ -175,31 +189,96 @@ size_t bob::io::VideoReader::load(bob::core::array::interface& b,
   return frames_read;
 }
 
+const bob::io::detail::ffmpeg::video_index& bob::io::VideoReader::index() const {
+  //iterators of the same reader may seek concurrently (e.g. the one of an
+  //AsyncVideoReader): the index is built only once
+  boost::lock_guard<boost::mutex> lock(m_index_mutex);
+  if (!m_index) {
+    boost::shared_ptr<bob::io::detail::ffmpeg::video_index> index(new bob::io::detail::ffmpeg::video_index);
+    boost::shared_ptr<AVFormatContext> format_ctxt =
+      bob::io::detail::ffmpeg::make_input_format_context(m_filepath);
+    int stream_index = bob::io::detail::ffmpeg::find_video_stream(m_filepath, format_ctxt);
+    bob::io::detail::ffmpeg::index_video_stream(m_filepath, stream_index, format_ctxt, *index);
+    m_index = index;
+  }
+  return *m_index;
+}
+
+bool bob::io::VideoReader::read(size_t index, blitz::Array<uint8_t,3>& data,
+  bool throw_on_error) const {
+  bob::core::array::blitz_array tmp(data);
+  return read(index, tmp, throw_on_error);
+}
+
+bool bob::io::VideoReader::read(size_t index, bob::core::array::interface& data,
+  bool throw_on_error) const {
+
+  boost::lock_guard<boost::mutex> lock(m_read_mutex);
+
+  //re-uses the iterator of the previous call, unless it reached the end:
+  //seek() decides whether to decode forward or to move to a key frame
+  if (!m_read_iterator || !m_read_iterator->parent())
+    m_read_iterator.reset(new const_iterator(this));
+  const_iterator& it = *m_read_iterator;
+  if (it.parent()) it.seek(index);
+
+  if (!it.parent()) {
+    if (throw_on_error) {
+      boost::format m("you are trying to read frame no. %d on file %s, which contains only %d frames");
+      m % index % m_filepath % m_nframes;
+      throw std::runtime_error(m.str());
+    }
+    return false;
+  }
+
+  //the decoder state is unknown after a failure: starts afresh next time
+  try {
+    if (it.read(data, throw_on_error)) return true;
+  }
+  catch (...) {
+    m_read_iterator.reset();
+    throw;
+  }
+  m_read_iterator.reset();
+  return false;
+}
+
 bob::io::VideoReader::const_iterator bob::io::VideoReader::begin() const {
   return bob::io::VideoReader::const_iterator(this);
 }
 
+bob::io::VideoReader::const_iterator bob::io::VideoReader::begin(size_t stride) const {
+  return bob::io::VideoReader::const_iterator(this, stride);
+}
+
 bob::io::VideoReader::const_iterator bob::io::VideoReader::end() const {
   return bob::io::VideoReader::const_iterator();
 }
 
-bob::io::VideoReader::const_iterator::const_iterator(const bob::io::VideoReader* parent) :
+bob::io::VideoReader::const_iterator::const_iterator(const bob::io::VideoReader* parent,
+    size_t stride) :
   m_parent(parent),
-  m_current_frame(std::numeric_limits<size_t>::max())
+  m_current_frame(std::numeric_limits<size_t>::max()),
+  m_stride(std::max(stride, (size_t)1)),
+  m_decoded(false)
 {
   init();
 }
 
 bob::io::VideoReader::const_iterator::const_iterator():
   m_parent(0),
-  m_current_frame(std::numeric_limits<size_t>::max())
+  m_current_frame(std::numeric_limits<size_t>::max()),
+  m_stride(1),
+  m_decoded(false)
 {
 }
 
 bob::io::VideoReader::const_iterator::const_iterator
 (const bob::io::VideoReader::const_iterator& other) :
   m_parent(other.m_parent),
-  m_current_frame(std::numeric_limits<size_t>::max())
+  m_current_frame(std::numeric_limits<size_t>::max()),
+  m_stride(other.m_stride),
+  m_decoded(false)
 {
   init();
   (*this) += other.m_current_frame;
@@ -212,6 +291,7 @@ bob::io::VideoReader::const_iterator::~const_iterator() {
 bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator= (const bob::io::VideoReader::const_iterator& other) {
   reset();
   m_parent = other.m_parent;
+  m_stride = other.m_stride;
   init();
   (*this) += other.m_current_frame;
   return *this;
@@ -225,7 +305,8 @@ void bob::io::VideoReader::const_iterator::init() {
   m_stream_index = bob::io::detail::ffmpeg::find_video_stream(filename, m_format_context);
   m_codec = bob::io::detail::ffmpeg::find_decoder(filename, m_format_context, m_stream_index);
   m_codec_context = bob::io::detail::ffmpeg::make_codec_context(filename, 
-        m_format_context->streams[m_stream_index], m_codec);
+        m_format_context->streams[m_stream_index], m_codec,
+        m_parent->m_decoding_threads);
   m_swscaler = bob::io::detail::ffmpeg::make_scaler(filename, m_codec_context,
       m_codec_context->pix_fmt, PIX_FMT_RGB24);
   m_context_frame = bob::io::detail::ffmpeg::make_empty_frame(filename);
@@ -250,9 +331,17 @@ void bob::io::VideoReader::const_iterator::reset() {
   m_codec = 0;
   m_format_context.reset();
   m_current_frame = std::numeric_limits<size_t>::max(); //that means "end" 
+  m_decoded = false;
   m_parent = 0;
 }
 
+void bob::io::VideoReader::const_iterator::rewind() {
+  const bob::io::VideoReader* parent = m_parent;
+  reset();
+  m_parent = parent;
+  init();
+}
+
 bool bob::io::VideoReader::const_iterator::read(blitz::Array<uint8_t,3>& data,
   bool throw_on_error) {
   bob::core::array::blitz_array tmp(data);
@@ -291,9 +380,19 @@ bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& dat
   }
 
   //we are going to need another copy step - use our internal array
-  bool ok = bob::io::detail::ffmpeg::read_video_frame(m_parent->m_filepath, m_current_frame,
-      m_stream_index, m_format_context, m_codec_context, m_swscaler,
-      m_context_frame, m_rgb_array.data(), throw_on_error);
+  bool ok = false;
+  if (m_decoded) {
+    //the frame was decoded while seeking, it only needs to be converted
+    ok = bob::io::detail::ffmpeg::convert_video_frame(m_parent->m_filepath,
+        m_current_frame, m_codec_context, m_swscaler, m_context_frame,
+        m_rgb_array.data(), throw_on_error);
+    m_decoded = false;
+  }
+  else {
+    ok = bob::io::detail::ffmpeg::read_video_frame(m_parent->m_filepath, m_current_frame,
+        m_stream_index, m_format_context, m_codec_context, m_swscaler,
+        m_context_frame, m_rgb_array.data(), throw_on_error);
+  }
 
   if (ok) {
 
@@ -309,6 +408,8 @@ bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& dat
     dst = m_rgb_array.transpose(2,0,1);
     ++m_current_frame;
 
+    if (m_stride > 1) seek(m_current_frame + m_stride - 1);
+
   }
 
   return ok;
@@ -318,19 +419,20 @@ bool bob::io::VideoReader::const_iterator::read(bob::core::array::interface& dat
  * This method does essentially the same as read(), except it skips a few
  * operations to get a better performance.
  */
-bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator++ () {
-  if (!m_parent) {
-    //we are already past the end of the stream
-    throw std::runtime_error("video iterator for file has already reached its end and was reset");
-  }
-
+void bob::io::VideoReader::const_iterator::skip() {
   //checks if we have not passed the end of the video sequence already
   if(m_current_frame >= m_parent->numberOfFrames()) {
     reset();
-    return *this;
+    return;
+  }
+
+  //the frame was decoded while seeking, there is nothing else to do
+  if (m_decoded) {
+    m_decoded = false;
+    ++m_current_frame;
+    return;
   }
 
-  //we are going to need another copy step - use our internal array
   try {
     bool ok = bob::io::detail::ffmpeg::skip_video_frame(m_parent->m_filepath, m_current_frame,
         m_stream_index, m_format_context, m_codec_context, m_context_frame,
@@ -340,12 +442,100 @@ bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::oper
   catch (std::runtime_error& e) {
     reset();
   }
+}
+
+bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator++ () {
+  if (!m_parent) {
+    //we are already past the end of the stream
+    throw std::runtime_error("video iterator for file has already reached its end and was reset");
+  }
+
+  if (m_stride > 1) return seek(m_current_frame + m_stride);
 
+  skip();
   return *this;
 }
 
 bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::operator+= (size_t frames) {
-  for (size_t i=0; i<frames; ++i) ++(*this);
+  if (!m_parent || frames == 0) return *this;
+  return seek(m_current_frame + frames);
+}
+
+bool bob::io::VideoReader::const_iterator::seek_keyframe(size_t keyframe,
+    size_t frame) {
+
+  const bob::io::detail::ffmpeg::video_index& index = m_parent->index();
+  const std::string& filename = m_parent->m_filepath;
+
+  m_decoded = false;
+  if (!bob::io::detail::ffmpeg::seek_video_stream(filename, m_stream_index,
+        m_format_context, m_codec_context, index.seek_timestamps[keyframe],
+        false)) return false;
+
+  //decodes forward up to the requested frame: frames that are presented
+  //before the key frame (if any) may be output first by the decoder
+  const int64_t target = index.timestamps[frame];
+  const size_t max_frames = frame - index.keyframes[keyframe] + 64;
+  int64_t timestamp;
+  for (size_t i=0; i<max_frames; ++i) {
+    bool ok = bob::io::detail::ffmpeg::decode_video_frame(filename, frame,
+        m_stream_index, m_format_context, m_codec_context, m_context_frame,
+        timestamp, false);
+    if (!ok || timestamp == (int64_t)AV_NOPTS_VALUE || timestamp > target) break;
+    if (timestamp == target) {
+      m_current_frame = frame;
+      m_decoded = true;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bob::io::VideoReader::const_iterator& bob::io::VideoReader::const_iterator::seek (size_t frame) {
+  if (!m_parent) {
+    //we are already past the end of the stream
+    throw std::runtime_error("video iterator for file has already reached its end and was reset");
+  }
+
+  if (frame >= m_parent->numberOfFrames()) {
+    reset();
+    return *this;
+  }
+
+  if (frame == m_current_frame) return *this;
+
+  const bob::io::detail::ffmpeg::video_index& index = m_parent->index();
+  if (frame < index.timestamps.size()) {
+    //the closest key frame before the requested one
+    std::vector<size_t>::const_iterator k = std::upper_bound(
+        index.keyframes.begin(), index.keyframes.end(), frame);
+    if (k != index.keyframes.begin()) {
+      --k;
+      //decoding forward is cheaper if there is no key frame in between
+      if (frame < m_current_frame || *k > m_current_frame) {
+        if (seek_keyframe(k - index.keyframes.begin(), frame)) return *this;
+        rewind(); //synchronization was lost, restart from scratch
+        if (!m_parent) return *this;
+      }
+    }
+  }
+
+  //reads frame-by-frame
+  if (frame < m_current_frame) {
+    rewind();
+    if (!m_parent) return *this;
+  }
+  while (m_current_frame < frame) {
+    const size_t current = m_current_frame;
+    skip();
+    if (!m_parent) break;
+    if (m_current_frame == current) { //cannot go any further
+      reset();
+      break;
+    }
+  }
+
   return *this;
 }
 
@@ -20,8 +20,10 @@
  */
 
 #include <set>
+#include <algorithm>
 #include <boost/token_iterator.hpp>
 #include <boost/format.hpp>
+#include <boost/thread.hpp>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -960,7 +962,8 @@ static void deallocate_codec_context(AVCodecContext* c) {
 }
 
 boost::shared_ptr<AVCodecContext> bob::io::detail::ffmpeg::make_codec_context(
-    const std::string& filename, AVStream* stream, AVCodec* codec) {
+    const std::string& filename, AVStream* stream, AVCodec* codec,
+    size_t thread_count) {
 
   AVCodecContext* retval = stream->codec;
 
@@ -969,6 +972,15 @@ boost::shared_ptr<AVCodecContext> bob::io::detail::ffmpeg::make_codec_context(
     retval->time_base.den = 1000;
   }
 
+  // Lets the codec use its own (frame and/or slice) threading
+  if (thread_count != 1) {
+    if (thread_count == 0) thread_count = boost::thread::hardware_concurrency();
+    retval->thread_count = thread_count;
+#if LIBAVCODEC_VERSION_INT >= 0x347000 //52.112.0 @ ffmpeg-0.7
+    retval->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
+  }
+
 # if LIBAVCODEC_VERSION_INT < 0x347a00 //52.122.0 @ ffmpeg-0.7
 
   int ok = avcodec_open(retval, codec);
@@ -1303,6 +1315,35 @@ void bob::io::detail::ffmpeg::write_video_frame (const blitz::Array<uint8_t,3>&
 #endif // FFmpeg version >= 0.11.0
 }
 
+bool bob::io::detail::ffmpeg::convert_video_frame (const std::string& filename,
+    int current_frame, boost::shared_ptr<AVCodecContext> codec_context,
+    boost::shared_ptr<SwsContext> scaler,
+    boost::shared_ptr<AVFrame> context_frame, uint8_t* data,
+    bool throw_on_error) {
+
+  // In this case, we call the software scaler to decode the frame data.
+  // Normally, this means converting from planar YUV420 into packed RGB.
+
+  uint8_t* planes[] = {data, 0};
+  int linesize[] = {3*codec_context->width, 0};
+
+  int conv_height = sws_scale(scaler.get(), context_frame->data,
+      context_frame->linesize, 0, codec_context->height, planes, linesize);
+
+  if (conv_height < 0) {
+
+    if (throw_on_error) {
+      boost::format m("bob::io::detail::ffmpeg::sws_scale() failed: could not scale frame %d of file `%s' - ffmpeg reports error %d");
+      m % current_frame % filename % conv_height;
+      throw std::runtime_error(m.str());
+    }
+
+    return false;
+  }
+
+  return true;
+}
+
 static int decode_frame (const std::string& filename, int current_frame,
     boost::shared_ptr<AVCodecContext> codec_context,
     boost::shared_ptr<SwsContext> scaler,
@@ -1337,27 +1378,9 @@ static int decode_frame (const std::string& filename, int current_frame,
   }
 
   if (got_frame) {
-
-    // In this case, we call the software scaler to decode the frame data.
-    // Normally, this means converting from planar YUV420 into packed RGB.
-
-    uint8_t* planes[] = {data, 0};
-    int linesize[] = {3*codec_context->width, 0};
-
-    int conv_height = sws_scale(scaler.get(), context_frame->data,
-        context_frame->linesize, 0, codec_context->height, planes, linesize);
-
-    if (conv_height < 0) {
-
-      if (throw_on_error) {
-        boost::format m("bob::io::detail::ffmpeg::sws_scale() failed: could not scale frame %d of file `%s' - ffmpeg reports error %d");
-        m % current_frame % filename % conv_height;
-        throw std::runtime_error(m.str());
-      }
-
+    if (!bob::io::detail::ffmpeg::convert_video_frame(filename, current_frame,
+          codec_context, scaler, context_frame, data, throw_on_error))
       return -1;
-    }
-
   }
 
   return ok;
@@ -1459,17 +1482,17 @@ static int dummy_decode_frame (const std::string& filename, int current_frame,
   return ok;
 }
 
-bool bob::io::detail::ffmpeg::skip_video_frame (const std::string& filename,
+static bool next_frame (const std::string& filename,
     int current_frame, int stream_index,
     boost::shared_ptr<AVFormatContext> format_context,
     boost::shared_ptr<AVCodecContext> codec_context,
     boost::shared_ptr<AVFrame> context_frame,
-    bool throw_on_error) {
+    int& got_frame, bool throw_on_error) {
 
   boost::shared_ptr<AVPacket> pkt = make_packet();
 
   int ok = 0;
-  int got_frame = 0;
+  got_frame = 0;
 
   while ((ok = av_read_frame(format_context.get(), pkt.get())) >= 0) {
     if (pkt->stream_index == stream_index) {
@@ -1516,3 +1539,116 @@ bool bob::io::detail::ffmpeg::skip_video_frame (const std::string& filename,
 
   return true;
 }
+
+bool bob::io::detail::ffmpeg::skip_video_frame (const std::string& filename,
+    int current_frame, int stream_index,
+    boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVCodecContext> codec_context,
+    boost::shared_ptr<AVFrame> context_frame,
+    bool throw_on_error) {
+  int got_frame = 0;
+  return next_frame(filename, current_frame, stream_index, format_context,
+      codec_context, context_frame, got_frame, throw_on_error);
+}
+
+/**
+ * Returns the timestamp of the frame last decoded (in presentation order),
+ * or AV_NOPTS_VALUE if it is not known.
+ */
+static int64_t frame_timestamp(boost::shared_ptr<AVFrame> frame) {
+#if LIBAVCODEC_VERSION_INT >= 0x350a00 //53.10.0 @ ffmpeg-0.9
+  if (frame->best_effort_timestamp != (int64_t)AV_NOPTS_VALUE) 
+    return frame->best_effort_timestamp;
+#endif
+#if LIBAVCODEC_VERSION_INT >= 0x345e03 //52.94.3 @ ffmpeg-0.7
+  return frame->pkt_pts;
+#else
+  return (int64_t)AV_NOPTS_VALUE;
+#endif
+}
+
+bool bob::io::detail::ffmpeg::decode_video_frame (const std::string& filename,
+    int current_frame, int stream_index,
+    boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVCodecContext> codec_context,
+    boost::shared_ptr<AVFrame> context_frame, int64_t& timestamp,
+    bool throw_on_error) {
+
+  int got_frame = 0;
+  timestamp = (int64_t)AV_NOPTS_VALUE;
+  if (!next_frame(filename, current_frame, stream_index, format_context,
+        codec_context, context_frame, got_frame, throw_on_error))
+    return false;
+  if (!got_frame) return false;
+
+  timestamp = frame_timestamp(context_frame);
+  return true;
+}
+
+void bob::io::detail::ffmpeg::index_video_stream (const std::string& filename,
+    int stream_index, boost::shared_ptr<AVFormatContext> format_context,
+    bob::io::detail::ffmpeg::video_index& index) {
+
+  index.timestamps.clear();
+  index.keyframes.clear();
+  index.seek_timestamps.clear();
+
+  // timestamps of the key frames (presentation and seek), in decoding order
+  std::vector<std::pair<int64_t, int64_t> > keys;
+
+  boost::shared_ptr<AVPacket> pkt = make_packet();
+  bool valid = true;
+  while (valid && av_read_frame(format_context.get(), pkt.get()) >= 0) {
+    if (pkt->stream_index == stream_index) {
+      // this is the timestamp decoders report for the frame (see above)
+      int64_t ts = pkt->pts;
+      if (ts == (int64_t)AV_NOPTS_VALUE) ts = pkt->dts;
+      if (ts == (int64_t)AV_NOPTS_VALUE) valid = false;
+      else {
+        index.timestamps.push_back(ts);
+        if (pkt->flags & AV_PKT_FLAG_KEY) {
+          // decoding timestamps are the ones used by demuxer indexes
+          int64_t seek_ts = pkt->dts;
+          if (seek_ts == (int64_t)AV_NOPTS_VALUE || seek_ts > ts) seek_ts = ts;
+          keys.push_back(std::make_pair(ts, seek_ts));
+        }
+      }
+    }
+    av_free_packet(pkt.get());
+  }
+
+  if (!valid) { //cannot be indexed
+    index.timestamps.clear();
+    return;
+  }
+
+  // frames are presented in the order of their timestamps
+  std::sort(index.timestamps.begin(), index.timestamps.end());
+  std::sort(keys.begin(), keys.end());
+  for (size_t k=0; k<keys.size(); ++k) {
+    index.keyframes.push_back(std::lower_bound(index.timestamps.begin(), 
+          index.timestamps.end(), keys[k].first) - index.timestamps.begin());
+    index.seek_timestamps.push_back(keys[k].second);
+  }
+}
+
+bool bob::io::detail::ffmpeg::seek_video_stream (const std::string& filename,
+    int stream_index, boost::shared_ptr<AVFormatContext> format_context,
+    boost::shared_ptr<AVCodecContext> codec_context, int64_t timestamp,
+    bool throw_on_error) {
+
+  int ok = av_seek_frame(format_context.get(), stream_index, timestamp,
+      AVSEEK_FLAG_BACKWARD);
+
+  if (ok < 0) {
+    if (throw_on_error) {
+      boost::format m("bob::io::detail::ffmpeg::av_seek_frame() failed: could not seek to timestamp %d on file `%s' - ffmpeg reports error %d == `%s'");
+      m % timestamp % filename % ok % ffmpeg_error(ok);
+      throw std::runtime_error(m.str());
+    }
+    return false;
+  }
+
+  avcodec_flush_buffers(codec_context.get());
+  return true;
+}
@@ -24,6 +24,7 @@
 #include <boost/python/slice.hpp>
 
 #include <bob/io/VideoReader.h>
+#include <bob/io/AsyncVideoReader.h>
 #include <bob/io/VideoWriter.h>
 
 #include <bob/io/VideoUtilities.h>
@@ -84,6 +85,26 @@ struct iterator_wrapper {
 
 };
 
+/**
+ * Methods to iterate over the frames of an AsyncVideoReader in python
+ */
+static object asyncreader_next (bob::io::AsyncVideoReader& o) {
+  bob::python::py_array retval(o.reader().frame_type());
+  bool ok = false;
+  {
+    bob::python::no_gil unlock; //the decoding thread may take a while
+    ok = o.read(retval);
+  }
+  if (!ok) PYTHON_ERROR(StopIteration, "iteration finished");
+  return retval.pyobject();
+}
+
+static boost::shared_ptr<bob::io::AsyncVideoReader> asyncreader_from_reader
+(boost::shared_ptr<bob::io::VideoReader> reader, size_t n_buffers, 
+ size_t stride, bool raise_on_error) {
+  return boost::shared_ptr<bob::io::AsyncVideoReader>(new bob::io::AsyncVideoReader(reader, n_buffers, stride, raise_on_error));
+}
+
 /**
  * Python wrapper to read a single frame from a video sequence, allowing the
  * implementation of a __getitem__() functionality on VideoReader objects.
@@ -98,12 +119,28 @@ static object videoreader_getitem (bob::io::VideoReader& v, object intobj) {
   }
 
   bob::python::py_array retval(v.frame_type());
-  bob::io::VideoReader::const_iterator it = v.begin();
-  it += frame;
-  it.read(retval); //read and throw if a problem occurs
+  v.read(frame, retval, true); //read and throw if a problem occurs
+  return retval.pyobject();
+}
+
+/**
+ * Reads a single frame, returning None if it cannot be read (and errors
+ * are not raised)
+ */
+static object videoreader_read (bob::io::VideoReader& v, size_t frame,
+    bool raise_on_error=false) {
+  bob::python::py_array retval(v.frame_type());
+  if (!v.read(frame, retval, raise_on_error)) return object();
   return retval.pyobject();
 }
 
+BOOST_PYTHON_FUNCTION_OVERLOADS(videoreader_read_overloads, videoreader_read, 2, 3)
+
+static bob::io::VideoReader::const_iterator videoreader_begin
+(const bob::io::VideoReader& v, size_t stride) {
+  return v.begin(stride);
+}
+
 /**
  * Python wrapper to read multiple frames from a video sequence, allowing the
  * implementation of a __getitem__() functionality on VideoReader objects.
@@ -442,9 +479,19 @@ void bind_io_video() {
     .add_property("video_type", make_function(&bob::io::VideoReader::video_type, return_value_policy<copy_const_reference>()), "Typing information to load all of the file at once")
     .add_property("frame_type", make_function(&bob::io::VideoReader::frame_type, return_value_policy<copy_const_reference>()), "Typing information to load the file frame by frame.")
     .def("__load__", &videoreader_load, videoreader_load_overloads((arg("self"), arg("raise_on_error")=false), "Loads all of the video stream in a numpy ndarray organized in this way: (frames, color-bands, height, width). I'll dynamically allocate the output array and return it to you. The flag ``raise_on_error``, which is set to ``False`` by default influences the error reporting in case problems are found with the video file. If you set it to ``True``, we will report problems raising exceptions. If you either don't set it or set it to ``False``, we will truncate the file at the frame with problems and will not report anything. It is your task to verify if the number of frames returned matches the expected number of frames as reported by the property ``number_of_frames`` in this object."))
-    .def("__iter__", &bob::io::VideoReader::begin, with_custodian_and_ward_postcall<0,1>())
+    .def("__iter__", (bob::io::VideoReader::const_iterator (bob::io::VideoReader::*)() const)&bob::io::VideoReader::begin, with_custodian_and_ward_postcall<0,1>())
     .def("__getitem__", &videoreader_getitem)
     .def("__getitem__", &videoreader_getslice)
+    .def("read", &videoreader_read, videoreader_read_overloads((arg("self"), arg("index"), arg("raise_on_error")=false), "Reads a single frame, given its number in the video stream, and returns it as a (color-bands, height, width) array. The stream is moved to the closest key frame before the requested one, and decoded forward from there. The decoding contexts are kept from one call to the next, so reading frames in increasing order does not re-open the file. If the frame cannot be read, ``None`` is returned, unless ``raise_on_error`` is set, in which case an exception is raised."))
+    .def("begin", &videoreader_begin, (arg("self"), arg("stride")), "Returns an iterator over the frames of this video, which advances by ``stride`` frames after each frame.", with_custodian_and_ward_postcall<0,1>())
+    .add_property("decoding_threads", &bob::io::VideoReader::getDecodingThreads, &bob::io::VideoReader::setDecodingThreads, "The number of threads FFmpeg may use to decode frames or slices of the video in parallel (1 by default, 0 means as many threads as hardware cores). Not all codecs support multi-threaded decoding.")
+    ;
+
+  class_<bob::io::AsyncVideoReader, boost::shared_ptr<bob::io::AsyncVideoReader>, boost::noncopyable>("AsyncVideoReader", "AsyncVideoReader objects read the frames of a video in a background thread, which decodes frames into a bounded ring of pre-allocated buffers. Iterating over this object returns the frames, as (color-bands, height, width) arrays, waiting for them to be decoded if required. Decoding hence overlaps with the processing of the frames.", no_init)
+    .def("__init__", make_constructor(&asyncreader_from_reader, default_call_policies(), (arg("reader"), arg("buffers")=8, arg("stride")=1, arg("raise_on_error")=false)), "Starts reading the frames of the given VideoReader in a background thread, into a ring of ``buffers`` frames. The readout advances by ``stride`` frames after each frame. If ``raise_on_error`` is ``False`` (the default), the video is silently truncated at the first frame that cannot be read. Otherwise, the problem is reported while iterating.")
+    .add_property("buffers", &bob::io::AsyncVideoReader::buffers, "The number of frame buffers in the ring")
+    .def("next", &asyncreader_next)
+    .def("__iter__", pass_through)
     ;
 
   class_<bob::io::VideoWriter, boost::shared_ptr<bob::io::VideoWriter>, boost::noncopyable>("VideoWriter",
@@ -24,6 +24,11 @@
 #include "bob/core/array_copy.h"
 #include "bob/core/assert.h"
 #include <boost/make_shared.hpp>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 
 static double sqr(const double x)
 {
@@ -55,607 +60,276 @@ const blitz::TinyVector<int,1> bob::ip::GLCMProp::get_prop_shape(const blitz::Ar
 
 
 
-void bob::ip::GLCMProp::angular_second_moment(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
+const blitz::TinyVector<int,2> bob::ip::GLCMProp::get_properties_shape(const blitz::Array<double,3>& glcm) const
+{
+  blitz::TinyVector<int,2> res;
+  res(0) = glcm.extent(2);
+  res(1) = N_PROPERTIES;
+  return res;
+}
+
+void bob::ip::GLCMProp::properties(const blitz::Array<double,3>& glcm, blitz::Array<double,2>& props) const
 {
   // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
+  blitz::TinyVector<int,2> shape(get_properties_shape(glcm));
+  bob::core::array::assertSameShape(props, shape);
+
+  const int n_levels = glcm.extent(0);
+  const double eps = std::numeric_limits<double>::min(); // small numeric value is added to avoid 0 as an argument to the logarithm
+
+  std::vector<double> marg_prob_i(n_levels); // marginal probability of first dimension (i.e. row-wise sum)
+  std::vector<double> marg_prob_j(n_levels); // marginal probability of second dimension (i.e. column-wise sum)
+  std::vector<double> sum_prob(2 * n_levels - 1); // probability of i+j
+  std::vector<double> diff_prob(n_levels); // probability of |i-j|
+
+  for (int l=0; l < glcm.extent(2); ++l)
   {
-    mat = blitz::pow2(glcm_norm(rall, rall, l));
-    prop(l) = blitz::sum(mat); // angular second moment
-  } 
-}
+    // the matrix of each offset is separately normalized
+    double total = 0;
+    for (int i=0; i < n_levels; ++i)
+      for (int j=0; j < n_levels; ++j)
+        total += glcm(i,j,l);
+
+    std::fill(marg_prob_i.begin(), marg_prob_i.end(), 0.);
+    std::fill(marg_prob_j.begin(), marg_prob_j.end(), 0.);
+    std::fill(sum_prob.begin(), sum_prob.end(), 0.);
+    std::fill(diff_prob.begin(), diff_prob.end(), 0.);
+    double sum_p = 0, sum_p2 = 0, sum_plogp = 0, sum_ijp = 0;
+    double max_p = glcm(0,0,l) / total;
+
+    // single pass over the matrix
+    for (int i=0; i < n_levels; ++i)
+    {
+      for (int j=0; j < n_levels; ++j)
+      {
+        const double p = glcm(i,j,l) / total;
+        sum_p += p;
+        sum_p2 += p * p;
+        sum_plogp += p * log(p + eps);
+        sum_ijp += i * j * p;
+        max_p = std::max(max_p, p);
+        marg_prob_i[i] += p;
+        marg_prob_j[j] += p;
+        sum_prob[i+j] += p;
+        diff_prob[std::abs(i-j)] += p;
+      }
+    }
 
-void bob::ip::GLCMProp::energy(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const 
-{ 
-  //do the computation of the feature
-  angular_second_moment(glcm, prop);
-  prop = blitz::sqrt(prop);
+    // statistics of the marginal probabilities
+    double mean_x = 0, mean_y = 0, sum_px = 0, sum_py = 0, px_entropy = 0, py_entropy = 0;
+    for (int k=0; k < n_levels; ++k)
+    {
+      mean_x += k * marg_prob_i[k];
+      mean_y += k * marg_prob_j[k];
+      sum_px += marg_prob_i[k];
+      sum_py += marg_prob_j[k];
+      px_entropy -= marg_prob_i[k] * log(marg_prob_i[k] + eps);
+      py_entropy -= marg_prob_j[k] * log(marg_prob_j[k] + eps);
+    }
+    const double mean = sum_p / (n_levels * n_levels); // mean of the entries of the matrix
+    double var_x = 0, var_y = 0, variance = 0;
+    for (int k=0; k < n_levels; ++k)
+    {
+      var_x += sqr(k - mean_x) * marg_prob_i[k];
+      var_y += sqr(k - mean_y) * marg_prob_j[k];
+      variance += sqr(k - mean) * marg_prob_i[k];
+    }
+    const double std_x = sqrt(var_x);
+    const double std_y = sqrt(var_y);
+
+    // statistics of the sums of the grey levels
+    double sum_avg = 0, sum_entropy = 0, cluster_prom = 0, cluster_shade = 0;
+    for (int t=0; t < 2 * n_levels - 1; ++t)
+    {
+      const double c = t - mean_x - mean_y;
+      sum_avg += t * sum_prob[t];
+      sum_entropy -= sum_prob[t] * log(sum_prob[t] + eps);
+      cluster_prom += sqr(sqr(c)) * sum_prob[t];
+      cluster_shade += sqr(c) * c * sum_prob[t];
+    }
+    double sum_var = 0;
+    for (int t=0; t < 2 * n_levels - 1; ++t)
+      sum_var += sqr(t - sum_entropy) * sum_prob[t];
+
+    // statistics of the absolute differences of the grey levels
+    double contrast = 0, dissimilarity = 0, homogeneity = 0, inv_diff_mom = 0;
+    double diff_entropy = 0, inv_diff_norm = 0, inv_diff_mom_norm = 0;
+    for (int t=0; t < n_levels; ++t)
+    {
+      contrast += t * t * diff_prob[t];
+      dissimilarity += t * diff_prob[t];
+      homogeneity += diff_prob[t] / (1 + t);
+      inv_diff_mom += diff_prob[t] / (1 + t * t);
+      diff_entropy -= diff_prob[t] * log(diff_prob[t] + eps);
+      inv_diff_norm += diff_prob[t] / (1 + t / (double)n_levels);
+      inv_diff_mom_norm += diff_prob[t] / (1 + sqr(t) / sqr(n_levels));
+    }
+
+    // log(px(i) py(j)) = log px(i) + log py(j), and summing p(i,j) (resp.
+    // px(i) py(j)) over the other index leaves the marginals, so that
+    // HXY1 = HX + HY and HXY2 = HX sum(py) + HY sum(px) (up to the small
+    // value added to the arguments of the logarithms)
+    const double entropy = -sum_plogp;
+    const double hxy1 = px_entropy + py_entropy;
+    const double hxy2 = px_entropy * sum_py + py_entropy * sum_px;
+
+    double res[N_PROPERTIES];
+    res[ANGULAR_SECOND_MOMENT] = sum_p2;
+    res[ENERGY] = sqrt(sum_p2);
+    res[VARIANCE] = variance;
+    res[CONTRAST] = contrast;
+    res[AUTO_CORRELATION] = sum_ijp;
+    res[CORRELATION] = (sum_ijp - mean_x * mean_y) / (std_x * std_y);
+    res[CORRELATION_M] = (sum_ijp - mean_x * mean_y - mean_x * mean_x + mean_x * mean_x * sum_p) / (std_x * std_y);
+    res[INV_DIFF_MOM] = inv_diff_mom;
+    res[SUM_AVG] = sum_avg;
+    res[SUM_VAR] = sum_var;
+    res[SUM_ENTROPY] = sum_entropy;
+    res[ENTROPY] = entropy;
+    res[DIFF_VAR] = contrast;
+    res[DIFF_ENTROPY] = diff_entropy;
+    res[DISSIMILARITY] = dissimilarity;
+    res[HOMOGENEITY] = homogeneity;
+    res[CLUSTER_PROM] = cluster_prom;
+    res[CLUSTER_SHADE] = cluster_shade;
+    res[MAX_PROB] = max_p;
+    res[INF_MEAS_CORR1] = (entropy - hxy1) / std::max(px_entropy, py_entropy);
+    res[INF_MEAS_CORR2] = sqrt(1 - exp(-2 * (hxy2 - entropy)));
+    res[INV_DIFF] = homogeneity;
+    res[INV_DIFF_NORM] = inv_diff_norm;
+    res[INV_DIFF_MOM_NORM] = inv_diff_mom_norm;
+    for (int k=0; k < N_PROPERTIES; ++k)
+      props(l, k) = res[k];
+  }
 }
 
-void bob::ip::GLCMProp::variance(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
+void bob::ip::GLCMProp::extract_property(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop, const Property property) const
 {
   // check if the size of the output matrix is as expected
   blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum(sqr(i-blitz::mean(mat))*mat);
-  }  
+  bob::core::array::assertSameShape(prop, shape);
+
+  blitz::Array<double,2> props(get_properties_shape(glcm));
+  properties(glcm, props);
+  prop = props(blitz::Range::all(), (int)property);
+}
+
+void bob::ip::GLCMProp::angular_second_moment(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
+{
+  extract_property(glcm, prop, ANGULAR_SECOND_MOMENT);
 }
 
+void bob::ip::GLCMProp::energy(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
+{
+  extract_property(glcm, prop, ENERGY);
+}
+
+void bob::ip::GLCMProp::variance(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
+{
+  extract_property(glcm, prop, VARIANCE);
+}
 
 void bob::ip::GLCMProp::contrast(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum((i-j)*(i-j)*mat);
-  } 
-  /*
-  //as done in [1]
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double contrast = 0;
-    for (int t=0; t < glcm_norm.extent(0) - 1; ++t) // iterate through all the levels
-    {
-      contrast += t*t*blitz::sum(blitz::where(abs(i-j)==t, mat, 0));
-    } 
-    prop(l) = contrast;
-  }
-  */
+  extract_property(glcm, prop, CONTRAST);
 }
 
 void bob::ip::GLCMProp::auto_correlation(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum(i*j*mat);
-  }
+  extract_property(glcm, prop, AUTO_CORRELATION);
 }
 
-
 void bob::ip::GLCMProp::correlation(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double mean_x = blitz::sum(i*mat);
-    double mean_y = blitz::sum(j*mat);
-    double std_x = sqrt(blitz::sum(sqr(i-mean_x)*mat));
-    double std_y = sqrt(blitz::sum(sqr(j-mean_y)*mat));
-    prop(l) = (blitz::sum(i*j*mat) - mean_x*mean_y) / (std_x * std_y);
-  }
+  extract_property(glcm, prop, CORRELATION);
 }
 
 void bob::ip::GLCMProp::correlation_m(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double mean_x = blitz::sum(i*mat);
-    double mean_y = blitz::sum(j*mat);
-    double std_x = sqrt(blitz::sum(sqr(i-mean_x)*mat));
-    double std_y = sqrt(blitz::sum(sqr(j-mean_y)*mat));
-    prop(l) = blitz::sum(((i-mean_x) * (j-mean_x) * mat) / (std_x * std_y));
-  }
+  extract_property(glcm, prop, CORRELATION_M);
 }
 
 void bob::ip::GLCMProp::inv_diff_mom(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
-{ 
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum(mat / (1 + sqr(i-j)));
-  }
+{
+  extract_property(glcm, prop, INV_DIFF_MOM);
 }
 
-
 void bob::ip::GLCMProp::sum_avg(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double sum_avg = 0;
-    for (int t = 0; t < 2 * glcm_norm.extent(0) - 1; t++) // iterate through all the levels
-    {
-      sum_avg += t * blitz::sum(blitz::where(i+j==t, mat, 0));
-    }
-    prop(l) = sum_avg;
-  }  
+  extract_property(glcm, prop, SUM_AVG);
 }
 
-
 void bob::ip::GLCMProp::sum_var(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  blitz::Array<double,1>& prop_sum_entropy(prop);
-  sum_entropy(glcm, prop_sum_entropy);
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double sum_var = 0;
-    for (int t = 0; t < 2 * glcm_norm.extent(0) -1; t++) // iterate through all the levels
-    {
-      sum_var += sqr(t-prop_sum_entropy(l)) * blitz::sum(blitz::where(i+j==t, mat, 0));
-    }
-    prop(l) = sum_var;
-  }
+  extract_property(glcm, prop, SUM_VAR);
 }
 
 void bob::ip::GLCMProp::sum_entropy(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double sum_entropy = 0;
-    for (int t = 0; t < 2 * glcm_norm.extent(0) - 1; t++) // iterate through all grey levels
-    {
-      sum_entropy += blitz::sum(blitz::where(i+j==t, mat, 0)) * log(blitz::sum(blitz::where(i+j==t, mat, 0)) + std::numeric_limits<double>::min());
-    }
-    prop(l) = -sum_entropy; 
-  }
+  extract_property(glcm, prop, SUM_ENTROPY);
 }
-   
-   
-void bob::ip::GLCMProp::entropy(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const 
+
+void bob::ip::GLCMProp::entropy(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = -blitz::sum(mat * blitz::log(mat + std::numeric_limits<double>::min())); // small numeric value is added to avoid 0 as an argument to the logarithm
-  }
+  extract_property(glcm, prop, ENTROPY);
 }
 
-      
 void bob::ip::GLCMProp::diff_var(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double diff_var = 0;
-    for (int t = 0; t < glcm_norm.extent(0); t++) // iterate through all grey levels
-    {
-      diff_var +=  t * t * blitz::sum(blitz::where(abs(i-j)==t, mat, 0));
-    }
-    prop(l) = diff_var; 
-  }
+  extract_property(glcm, prop, DIFF_VAR);
 }
 
-
 void bob::ip::GLCMProp::diff_entropy(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double diff_entropy = 0;
-    for (int t = 0; t < glcm_norm.extent(0); t++) // iterate through all grey levels
-    {
-      diff_entropy += blitz::sum(blitz::where(abs(i-j)==t, mat, 0)) * log(blitz::sum(blitz::where(abs(i-j)==t, mat, 0)) + std::numeric_limits<double>::min());
-    }
-    prop(l) = -diff_entropy; 
-  }
+  extract_property(glcm, prop, DIFF_ENTROPY);
 }
 
-
 void bob::ip::GLCMProp::dissimilarity(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
-{ 
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum(abs(i-j)*mat);
-  }
+{
+  extract_property(glcm, prop, DISSIMILARITY);
 }
 
-
 void bob::ip::GLCMProp::homogeneity(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum(mat / (1 + abs(i-j)));
-  }  
+  extract_property(glcm, prop, HOMOGENEITY);
 }
 
-
 void bob::ip::GLCMProp::cluster_prom(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double mean_x = blitz::sum(i*mat);
-    double mean_y = blitz::sum(j*mat);
-    prop(l) = blitz::sum(pow(i + j - mean_x - mean_y, 4) * mat);
-  }
+  extract_property(glcm, prop, CLUSTER_PROM);
 }
 
 void bob::ip::GLCMProp::cluster_shade(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    double mean_x = blitz::sum(i*mat);
-    double mean_y = blitz::sum(j*mat);
-    prop(l) = blitz::sum(pow(i + j - mean_x - mean_y, 3) * mat);
-  }
+  extract_property(glcm, prop, CLUSTER_SHADE);
 }
 
 void bob::ip::GLCMProp::max_prob(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::max(mat);
-  }
+  extract_property(glcm, prop, MAX_PROB);
 }
 
 void bob::ip::GLCMProp::inf_meas_corr1(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  blitz::Array<double,1>& prop_entropy(prop);
-  entropy(glcm, prop_entropy); //calculate the entropy
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    
-    blitz::Array<double,1> marg_prob_i(blitz::sum(mat,j)); // marginal probability of first dimension (i.e. row-wise sum)
-    blitz::Array<double,1> marg_prob_j(blitz::sum(mat(j,i),j)); // marginal probability of second dimension (i.e. column-wise sum)
-
-    double hxy1 = -blitz::sum(mat * blitz::log(marg_prob_i(i) * marg_prob_j(j) + std::numeric_limits<double>::min())); // small numeric value is added to avoid 0 as an argument to the logarithm
-    double px_entropy = -blitz::sum(marg_prob_i * blitz::log(marg_prob_i + std::numeric_limits<double>::min()));
-    double py_entropy = -blitz::sum(marg_prob_j * blitz::log(marg_prob_j + std::numeric_limits<double>::min()));
-    prop(l) = (prop_entropy(l) - hxy1) / std::max(px_entropy, py_entropy);  
-  }
+  extract_property(glcm, prop, INF_MEAS_CORR1);
 }
 
 void bob::ip::GLCMProp::inf_meas_corr2(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  blitz::Array<double,1>& prop_entropy(prop);
-  entropy(glcm, prop_entropy); //calculate the entropy
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    blitz::Array<double,1> marg_prob_i(blitz::sum(mat,j)); // marginal probability of first dimension (i.e. row-wise sum)
-    blitz::Array<double,1> marg_prob_j(blitz::sum(mat(j,i),j)); // marginal probability of second dimension (i.e. column-wise sum)
-    
-    double hxy2 = -blitz::sum(marg_prob_i(i) * marg_prob_j(j) * blitz::log(marg_prob_i(i) * marg_prob_j(j) + std::numeric_limits<double>::min())); // small numeric value is added to avoid 0 as an argument to the logarithm
-    prop(l) = sqrt(1 - exp(-2 * (hxy2 - prop_entropy(l))));
-  }
-  
+  extract_property(glcm, prop, INF_MEAS_CORR2);
 }
 
 void bob::ip::GLCMProp::inv_diff(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  homogeneity(glcm, prop);
+  extract_property(glcm, prop, INV_DIFF);
 }
 
 void bob::ip::GLCMProp::inv_diff_norm(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum(mat / (1 + (abs(i-j) / (double)mat.extent(0)) ));
-  }  
+  extract_property(glcm, prop, INV_DIFF_NORM);
 }
 
 void bob::ip::GLCMProp::inv_diff_mom_norm(const blitz::Array<double,3>& glcm, blitz::Array<double,1>& prop) const
 {
-  // check if the size of the output matrix is as expected
-  blitz::TinyVector<int,1> shape(get_prop_shape(glcm));
-  bob::core::array::assertSameShape(prop, shape); 
-  
-  // normalize the input GLCM matrix
-  blitz::Array<double,3> glcm_norm = normalize_glcm(glcm);
-  
-  blitz::Array<double,2> mat(glcm.extent(0), glcm.extent(1)); // auxiliary matrix that will be used for glcm matrix for one particular offset
-  
-  blitz::Range rall = blitz::Range::all();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  
-  //do the computation of the feature
-  for (int l=0; l < glcm_norm.extent(2); ++l)
-  {
-    mat = glcm_norm(rall, rall, l);
-    prop(l) = blitz::sum(mat / (1 + (sqr(i-j) / sqr(mat.extent(0)))));
-  }
+  extract_property(glcm, prop, INV_DIFF_MOM_NORM);
 }
-
-
-
-
-
-
-
-
-
-
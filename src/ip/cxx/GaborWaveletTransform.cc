@@ -22,10 +22,17 @@
 
 #include "bob/core/assert.h"
 #include "bob/core/array_copy.h"
+#include "bob/core/cast.h"
+#include "bob/core/parallel.h"
 #include "bob/ip/GaborWaveletTransform.h"
+#include <cmath>
 #include <numeric>
+#include <algorithm>
 #include <sstream>
 #include <fstream>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
 
 static inline double sqr(double x){return x*x;}
 
@@ -224,7 +231,9 @@ bob::ip::GaborWaveletTransform::GaborWaveletTransform(
   m_fft(0,0),
   m_ifft(0,0),
   m_number_of_scales(number_of_scales),
-  m_number_of_directions(number_of_directions)
+  m_number_of_directions(number_of_directions),
+  m_n_threads(1),
+  m_spatial_epsilon(1e-6)
 {
   computeKernelFrequencies();
 }
@@ -241,7 +250,9 @@ bob::ip::GaborWaveletTransform::GaborWaveletTransform(
   m_fft(0,0),
   m_ifft(0,0),
   m_number_of_scales(other.m_number_of_scales),
-  m_number_of_directions(other.m_number_of_directions)
+  m_number_of_directions(other.m_number_of_directions),
+  m_n_threads(other.m_n_threads),
+  m_spatial_epsilon(other.m_spatial_epsilon)
 {
   computeKernelFrequencies();
 }
@@ -261,6 +272,9 @@ bob::ip::GaborWaveletTransform::operator =
   m_ifft = bob::sp::IFFT2D(0,0);
   m_number_of_scales = other.m_number_of_scales;
   m_number_of_directions = other.m_number_of_directions;
+  m_n_threads = other.m_n_threads;
+  m_spatial_epsilon = other.m_spatial_epsilon;
+  m_spatial_kernels.clear();
 
   computeKernelFrequencies();
   
@@ -345,6 +359,7 @@ void bob::ip::GaborWaveletTransform::generateKernels(
   if (resolution[1] != m_fft.getWidth() || resolution[0] != m_fft.getHeight()){
     // new kernels need to be generated
     m_gabor_kernels.clear();
+    m_spatial_kernels.clear();
     m_gabor_kernels.reserve(m_kernel_frequencies.size());
 
     for (unsigned j = 0; j < m_kernel_frequencies.size(); ++j){
@@ -492,6 +507,397 @@ void bob::ip::GaborWaveletTransform::computeJetImage(
   }
 }
 
+/**
+ * Sets the fraction of the largest value of the spatial kernels below which their values
+ * are discarded. The spatial kernels are regenerated the next time they are needed.
+ * @param spatial_epsilon  The relative threshold, in [0, 1)
+ */
+void bob::ip::GaborWaveletTransform::setSpatialEpsilon(const double spatial_epsilon){
+  if (spatial_epsilon < 0. || spatial_epsilon >= 1.){
+    boost::format m("the spatial epsilon needs to be in [0, 1), but it is %g");
+    m % spatial_epsilon;
+    throw std::runtime_error(m.str());
+  }
+  m_spatial_epsilon = spatial_epsilon;
+  m_spatial_kernels.clear();
+}
+
+/**
+ * Generates the Gabor wavelets in spatial domain for the current resolution,
+ * as the inverse Fourier transforms of the kernels in frequency domain.
+ * Each wavelet is cropped to the smallest box of (cyclic) offsets that contains
+ * all its values above the spatial epsilon times its largest absolute value.
+ */
+void bob::ip::GaborWaveletTransform::generateSpatialKernels(){
+  if (m_spatial_kernels.size() == m_gabor_kernels.size()) return;
+
+  const int height = m_temp_array.extent(0), width = m_temp_array.extent(1);
+  m_spatial_kernels.clear();
+  m_spatial_kernels.reserve(m_gabor_kernels.size());
+
+  for (unsigned j = 0; j < m_gabor_kernels.size(); ++j){
+    m_temp_array = bob::core::array::cast<std::complex<double> >(m_gabor_kernels[j].kernelImage());
+    m_ifft(m_temp_array);
+
+    // find the box of offsets that holds the significant values
+    const double threshold = blitz::max(blitz::abs(m_temp_array)) * m_spatial_epsilon;
+    int y_min = 0, y_max = 0, x_min = 0, x_max = 0;
+    for (int y = 0; y < height; ++y){
+      // offsets are centered around 0
+      const int dy = y < height - height / 2 ? y : y - height;
+      for (int x = 0; x < width; ++x){
+        const int dx = x < width - width / 2 ? x : x - width;
+        if (std::abs(m_temp_array(y,x)) > threshold){
+          y_min = std::min(y_min, dy); y_max = std::max(y_max, dy);
+          x_min = std::min(x_min, dx); x_max = std::max(x_max, dx);
+        }
+      }
+    }
+
+    SpatialKernel kernel;
+    kernel.y0 = y_min;
+    kernel.x0 = x_min;
+    kernel.values.resize(y_max - y_min + 1, x_max - x_min + 1);
+    for (int a = 0; a < kernel.values.extent(0); ++a)
+      for (int b = 0; b < kernel.values.extent(1); ++b)
+        kernel.values(a,b) = m_temp_array((y_min + a + height) % height, (x_min + b + width) % width);
+    m_spatial_kernels.push_back(kernel);
+  }
+}
+
+/**
+ * Computes the (complex) responses of all Gabor wavelets at the given positions, by
+ * inner products of the image with the spatial kernels. The image is considered to be
+ * periodic, so that the results are identical to the ones of the Fourier domain
+ * transform, up to the cropping of the spatial kernels.
+ * @param gray_image  The source image in spatial domain
+ * @param positions   The (y,x) positions to compute the responses at
+ */
+void bob::ip::GaborWaveletTransform::computeSparseResponses(
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  const blitz::Array<int,2>& positions
+)
+{
+  const int height = gray_image.extent(0), width = gray_image.extent(1);
+  if (positions.extent(1) != 2){
+    boost::format m("the positions need to be given as an array with 2 columns (y,x), but it has %d columns");
+    m % positions.extent(1);
+    throw std::runtime_error(m.str());
+  }
+  for (int i = 0; i < positions.extent(0); ++i){
+    if (positions(i,0) < 0 || positions(i,0) >= height || positions(i,1) < 0 || positions(i,1) >= width){
+      boost::format m("the position (%d, %d) is out of the image boundaries %d x %d");
+      m % positions(i,0) % positions(i,1) % height % width;
+      throw std::runtime_error(m.str());
+    }
+  }
+
+  // first, check if we need to reset the kernels
+  generateKernels(blitz::TinyVector<unsigned,2>(height, width));
+  generateSpatialKernels();
+
+  const blitz::Array<std::complex<double>,2> image = bob::core::array::ccopy(gray_image);
+  const std::complex<double>* image_data = image.data();
+  m_sparse_responses.resize(positions.extent(0), m_spatial_kernels.size());
+
+  for (int i = 0; i < positions.extent(0); ++i){
+    for (int j = 0; j < (int)m_spatial_kernels.size(); ++j){
+      const SpatialKernel& kernel = m_spatial_kernels[j];
+      const std::complex<double>* h = kernel.values.data();
+      const int box_height = kernel.values.extent(0), box_width = kernel.values.extent(1);
+      // response(y,x) = sum_{a,b} h(y0+a, x0+b) * image(y-y0-a, x-x0-b)
+      double real = 0., imag = 0.;
+      int yy = ((positions(i,0) - kernel.y0) % height + height) % height;
+      const int xx_start = ((positions(i,1) - kernel.x0) % width + width) % width;
+      for (int a = 0; a < box_height; ++a, h += box_width){
+        const std::complex<double>* row = image_data + yy * width;
+        int xx = xx_start;
+        for (int b = 0; b < box_width; ++b){
+          const double hr = h[b].real(), hi = h[b].imag(), gr = row[xx].real(), gi = row[xx].imag();
+          real += hr * gr - hi * gi;
+          imag += hr * gi + hi * gr;
+          if (--xx < 0) xx += width;
+        }
+        if (--yy < 0) yy += height;
+      }
+      m_sparse_responses(i,j) = std::complex<double>(real, imag);
+    }
+  }
+}
+
+/**
+ * Computes the Gabor jets including absolute values and phases at the given positions only.
+ * Instead of transforming the whole image in frequency domain, the jets are computed by inner
+ * products with the Gabor wavelets in spatial domain, which are generated once per resolution.
+ * This is faster than computeJetImage for up to sparseJetsCrossover() positions.
+ * @param gray_image  The source image in spatial domain
+ * @param positions   The (y,x) positions to compute the jets at, one per row
+ * @param jets        The resulting Gabor jets, including absolute values and phases for each position
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeSparseJets(
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  const blitz::Array<int,2>& positions,
+  blitz::Array<double,3>& jets,
+  bool do_normalize
+)
+{
+  // check that the shape is correct
+  bob::core::array::assertSameShape(jets, blitz::shape(positions.extent(0), 2, m_kernel_frequencies.size()));
+
+  computeSparseResponses(gray_image, positions);
+
+  for (int i = 0; i < positions.extent(0); ++i){
+    for (int j = 0; j < (int)m_kernel_frequencies.size(); ++j){
+      jets(i,0,j) = std::abs(m_sparse_responses(i,j));
+      jets(i,1,j) = std::arg(m_sparse_responses(i,j));
+    }
+    if (do_normalize){
+      blitz::Array<double,2> jet(jets(i,blitz::Range::all(),blitz::Range::all()));
+      bob::ip::normalizeGaborJet(jet);
+    }
+  }
+}
+
+/**
+ * Computes the Gabor jets including absolute values only at the given positions only.
+ * @param gray_image  The source image in spatial domain
+ * @param positions   The (y,x) positions to compute the jets at, one per row
+ * @param jets        The resulting Gabor jets, including only absolute values for each position
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeSparseJets(
+  const blitz::Array<std::complex<double>,2>& gray_image,
+  const blitz::Array<int,2>& positions,
+  blitz::Array<double,2>& jets,
+  bool do_normalize
+)
+{
+  // check that the shape is correct
+  bob::core::array::assertSameShape(jets, blitz::shape(positions.extent(0), m_kernel_frequencies.size()));
+
+  computeSparseResponses(gray_image, positions);
+
+  for (int i = 0; i < positions.extent(0); ++i){
+    for (int j = 0; j < (int)m_kernel_frequencies.size(); ++j){
+      jets(i,j) = std::abs(m_sparse_responses(i,j));
+    }
+    if (do_normalize){
+      blitz::Array<double,1> jet(jets(i,blitz::Range::all()));
+      bob::ip::normalizeGaborJet(jet);
+    }
+  }
+}
+
+/**
+ * Computes the number of positions up to which the sparse jets are cheaper than the full jet image.
+ * The costs are counted in complex multiply-adds: each sparse jet needs one per value of each cropped
+ * spatial kernel, while the jet image needs one FFT and one inverse FFT per kernel, each with about
+ * 5/8 N log2(N) multiply-adds for N pixels, and N products of the image with each kernel.
+ * @param resolution  The resolution of the images to compute the jets for
+ * @return  The largest number of positions for which computeSparseJets() should be used
+ */
+unsigned bob::ip::GaborWaveletTransform::sparseJetsCrossover(
+  blitz::TinyVector<unsigned,2> resolution
+)
+{
+  generateKernels(resolution);
+  generateSpatialKernels();
+
+  double sparse_cost = 0.;
+  for (unsigned j = 0; j < m_spatial_kernels.size(); ++j)
+    sparse_cost += m_spatial_kernels[j].values.size();
+
+  const double n = (double)resolution[0] * resolution[1];
+  const double fft_cost = 0.625 * n * std::log(n) / std::log(2.);
+  const double full_cost = (m_gabor_kernels.size() + 1) * fft_cost + m_gabor_kernels.size() * n;
+
+  return sparse_cost > 0. ? (unsigned)(full_cost / sparse_cost) : 0;
+}
+
+/**
+ * Transforms the images [begin, end) of the given batch job, using the scratch arrays of the given thread.
+ * Only raw pointers are used to access the input and output arrays, which are shared between the threads.
+ */
+void bob::ip::GaborWaveletTransform::transformImages(
+  const BatchJob& job,
+  std::vector<BatchBuffers>& buffers,
+  size_t thread,
+  size_t begin,
+  size_t end
+) const
+{
+  BatchBuffers& buffer = buffers[thread];
+  const int height = buffer.image.extent(0), width = buffer.image.extent(1);
+  const blitz::TinyVector<int,3>& is = job.image_strides;
+  const blitz::TinyVector<int,4>& ts = job.trafo_strides;
+  const blitz::TinyVector<int,5>& js = job.jet_strides;
+
+  for (int i = (int)begin; i < (int)end; ++i){
+    // copy the image into the contiguous scratch array, and transform it
+    const std::complex<double>* src = job.images + i * is[0];
+    std::complex<double>* image = buffer.image.data();
+    for (int y = 0; y < height; ++y)
+      for (int x = 0; x < width; ++x)
+        image[y * width + x] = src[y * is[1] + x * is[2]];
+    m_fft(buffer.image, buffer.frequency_image);
+
+    // now, let each kernel compute the transformation result
+    for (int j = 0; j < (int)m_gabor_kernels.size(); ++j){
+      m_gabor_kernels[j].transform(buffer.frequency_image, buffer.layer);
+      m_ifft(buffer.layer);
+      const std::complex<double>* layer = buffer.layer.data();
+
+      if (job.trafo){
+        std::complex<double>* dst = job.trafo + i * ts[0] + j * ts[1];
+        for (int y = 0; y < height; ++y)
+          for (int x = 0; x < width; ++x)
+            dst[y * ts[2] + x * ts[3]] = layer[y * width + x];
+      } else {
+        // convert into absolute and phase part
+        double* dst = job.jets + i * js[0] + j * js[4];
+        for (int y = 0; y < height; ++y)
+          for (int x = 0; x < width; ++x){
+            const std::complex<double>& value = layer[y * width + x];
+            dst[y * js[1] + x * js[2]] = std::abs(value);
+            if (job.include_phases) dst[y * js[1] + x * js[2] + js[3]] = std::arg(value);
+          }
+      }
+    } // for j
+
+    if (job.jets && job.do_normalize){
+      // normalize the absolute parts of the jets
+      for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x){
+          double* jet = job.jets + i * js[0] + y * js[1] + x * js[2];
+          double norm = 0.;
+          for (int j = 0; j < (int)m_gabor_kernels.size(); ++j) norm += sqr(jet[j * js[4]]);
+          norm = sqrt(norm);
+          for (int j = 0; j < (int)m_gabor_kernels.size(); ++j) jet[j * js[4]] /= norm;
+        }
+    }
+  } // for i
+}
+
+/**
+ * Runs the given batch job on the given number of images, splitting the images between threads.
+ * The kernels (and the FFT plans) are shared by all threads, while each thread has its own scratch arrays.
+ */
+void bob::ip::GaborWaveletTransform::performBatch(
+  const BatchJob& job,
+  int number_of_images
+)
+{
+  const size_t n_threads = bob::core::parallel_threads(number_of_images, m_n_threads);
+  std::vector<BatchBuffers> buffers(n_threads);
+  for (size_t t = 0; t < n_threads; ++t){
+    buffers[t].image.resize(m_temp_array.shape());
+    buffers[t].frequency_image.resize(m_temp_array.shape());
+    buffers[t].layer.resize(m_temp_array.shape());
+  }
+  bob::core::parallel_for(boost::bind(&GaborWaveletTransform::transformImages, this,
+        boost::cref(job), boost::ref(buffers), _1, _2, _3), number_of_images, n_threads);
+}
+
+/**
+ * Computes the Gabor wavelet transformation for several images of the same size (in spatial domain).
+ * The Gabor kernels are generated only once, and the images are transformed in m_n_threads threads.
+ * @param gray_images  The source images in spatial domain, one per layer
+ * @param trafo_images The convolution results, in spatial domain, one trafo image per source image
+ */
+void bob::ip::GaborWaveletTransform::performGWT(
+  const blitz::Array<std::complex<double>,3>& gray_images,
+  blitz::Array<std::complex<double>,4>& trafo_images
+)
+{
+  bob::core::array::assertZeroBase(gray_images);
+  bob::core::array::assertZeroBase(trafo_images);
+  // check that the shape is correct
+  bob::core::array::assertSameShape(trafo_images, blitz::shape(gray_images.extent(0), m_kernel_frequencies.size(), gray_images.extent(1), gray_images.extent(2)));
+
+  // first, check if we need to reset the kernels
+  generateKernels(blitz::TinyVector<unsigned,2>(gray_images.extent(1), gray_images.extent(2)));
+
+  BatchJob job;
+  job.images = gray_images.data();
+  for (int k = 0; k < 3; ++k) job.image_strides[k] = gray_images.stride(k);
+  job.trafo = trafo_images.data();
+  for (int k = 0; k < 4; ++k) job.trafo_strides[k] = trafo_images.stride(k);
+  job.jets = 0;
+  job.jet_strides = 0;
+  job.include_phases = false;
+  job.do_normalize = false;
+
+  performBatch(job, gray_images.extent(0));
+}
+
+/**
+ * Computes the Gabor jets including absolute values and phases for several images of the same size.
+ * @param gray_images  The source images in spatial domain, one per layer
+ * @param jet_images   The resulting Gabor jet images, including absolute values and phases for each pixel
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeJetImage(
+  const blitz::Array<std::complex<double>,3>& gray_images,
+  blitz::Array<double,5>& jet_images,
+  bool do_normalize
+)
+{
+  bob::core::array::assertZeroBase(gray_images);
+  bob::core::array::assertZeroBase(jet_images);
+  // check that the shape is correct
+  bob::core::array::assertSameShape(jet_images, blitz::shape(gray_images.extent(0), gray_images.extent(1), gray_images.extent(2), 2, m_kernel_frequencies.size()));
+
+  // first, check if we need to reset the kernels
+  generateKernels(blitz::TinyVector<unsigned,2>(gray_images.extent(1), gray_images.extent(2)));
+
+  BatchJob job;
+  job.images = gray_images.data();
+  for (int k = 0; k < 3; ++k) job.image_strides[k] = gray_images.stride(k);
+  job.trafo = 0;
+  job.trafo_strides = 0;
+  job.jets = jet_images.data();
+  for (int k = 0; k < 5; ++k) job.jet_strides[k] = jet_images.stride(k);
+  job.include_phases = true;
+  job.do_normalize = do_normalize;
+
+  performBatch(job, gray_images.extent(0));
+}
+
+/**
+ * Computes the Gabor jets including absolute values only for several images of the same size.
+ * @param gray_images  The source images in spatial domain, one per layer
+ * @param jet_images   The resulting Gabor jet images, including only absolute values for each pixel
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::ip::GaborWaveletTransform::computeJetImage(
+  const blitz::Array<std::complex<double>,3>& gray_images,
+  blitz::Array<double,4>& jet_images,
+  bool do_normalize
+)
+{
+  bob::core::array::assertZeroBase(gray_images);
+  bob::core::array::assertZeroBase(jet_images);
+  // check that the shape is correct
+  bob::core::array::assertSameShape(jet_images, blitz::shape(gray_images.extent(0), gray_images.extent(1), gray_images.extent(2), m_kernel_frequencies.size()));
+
+  // first, check if we need to reset the kernels
+  generateKernels(blitz::TinyVector<unsigned,2>(gray_images.extent(1), gray_images.extent(2)));
+
+  BatchJob job;
+  job.images = gray_images.data();
+  for (int k = 0; k < 3; ++k) job.image_strides[k] = gray_images.stride(k);
+  job.trafo = 0;
+  job.trafo_strides = 0;
+  job.jets = jet_images.data();
+  // there is no phase part
+  job.jet_strides = jet_images.stride(0), jet_images.stride(1), jet_images.stride(2), 0, jet_images.stride(3);
+  job.include_phases = false;
+  job.do_normalize = do_normalize;
+
+  performBatch(job, gray_images.extent(0));
+}
+
 void bob::ip::GaborWaveletTransform::save(bob::io::HDF5File& file) const{
   file.set("Sigma", m_sigma);
   file.set("PowOfK", m_pow_of_k);
@@ -41,7 +41,10 @@ bob::ip::LBP::LBP(const int P, const double R_y, const double R_x , const bool c
   m_rotation_invariant(rotation_invariant),
   m_eLBP_type(eLBP_type),
   m_lut(0),
-  m_positions(0,0)
+  m_positions(0,0),
+  m_offsets(0,0),
+  m_weights(0,0),
+  m_n_threads(1)
 {
   // sanity check
   if (m_eLBP_type == ELBP_DIRECTION_CODED && m_P%2)
@@ -62,7 +65,10 @@ bob::ip::LBP::LBP(const int P, const double R, const bool circular,
   m_rotation_invariant(rotation_invariant),
   m_eLBP_type(eLBP_type),
   m_lut(0),
-  m_positions(0,0)
+  m_positions(0,0),
+  m_offsets(0,0),
+  m_weights(0,0),
+  m_n_threads(1)
 {
   // sanity check
   if (m_eLBP_type == ELBP_DIRECTION_CODED && m_P%2)
@@ -82,7 +88,10 @@ bob::ip::LBP::LBP(const bob::ip::LBP& other):
   m_rotation_invariant(other.m_rotation_invariant),
   m_eLBP_type(other.m_eLBP_type),
   m_lut(0),
-  m_positions(0,0)
+  m_positions(0,0),
+  m_offsets(0,0),
+  m_weights(0,0),
+  m_n_threads(other.m_n_threads)
 {
   // sanity check
   if (m_eLBP_type == ELBP_DIRECTION_CODED && m_P%2)
@@ -102,6 +111,7 @@ bob::ip::LBP& bob::ip::LBP::operator=(const bob::ip::LBP& other) {
   m_uniform = other.m_uniform;
   m_rotation_invariant = other.m_rotation_invariant;
   m_eLBP_type = other.m_eLBP_type;
+  m_n_threads = other.m_n_threads;
   init();
   return *this;
 }
@@ -166,6 +176,24 @@ void bob::ip::LBP::init()
     }
   }
 
+  // precompute the offsets of the pixels surrounding each point, and the
+  // weights of the bilinear interpolation
+  m_offsets.resize(m_P,4);
+  m_weights.resize(m_P,2);
+  for (int p = 0; p < m_P; ++p){
+    double d_y = m_positions(p,0), d_x = m_positions(p,1);
+    // points that lie on a pixel up to round-off (e.g. cos(pi/2)) are not
+    // interpolated
+    if (std::fabs(d_y - round(d_y)) < 1e-12) d_y = round(d_y);
+    if (std::fabs(d_x - round(d_x)) < 1e-12) d_x = round(d_x);
+    m_offsets(p,0) = static_cast<int>(floor(d_y));
+    m_offsets(p,1) = static_cast<int>(ceil(d_y));
+    m_offsets(p,2) = static_cast<int>(floor(d_x));
+    m_offsets(p,3) = static_cast<int>(ceil(d_x));
+    m_weights(p,0) = m_offsets(p,1) - d_y;
+    m_weights(p,1) = m_offsets(p,3) - d_x;
+  }
+
   // initialize the look up table for the current setup
   // initialize all values with 0
   m_lut.resize(1 << m_P);
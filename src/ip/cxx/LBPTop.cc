@@ -33,7 +33,9 @@ bob::ip::LBPTop::LBPTop(const bob::ip::LBP& lbp_xy,
                    const bob::ip::LBP& lbp_yt)
 : m_lbp_xy(lbp_xy),
   m_lbp_xt(lbp_xt),
-  m_lbp_yt(lbp_yt)
+  m_lbp_yt(lbp_yt),
+  m_n_threads(1),
+  m_n_frames(0)
 {
  /*Checking the inputs. The radius in XY,XT and YT must be the same*/
 
@@ -53,7 +55,9 @@ bob::ip::LBPTop::LBPTop(const bob::ip::LBP& lbp_xy,
 bob::ip::LBPTop::LBPTop(const LBPTop& other)
 : m_lbp_xy(other.m_lbp_xy),
   m_lbp_xt(other.m_lbp_xt),
-  m_lbp_yt(other.m_lbp_yt)
+  m_lbp_yt(other.m_lbp_yt),
+  m_n_threads(other.m_n_threads),
+  m_n_frames(0)
 {
 }
 
@@ -63,9 +67,30 @@ bob::ip::LBPTop& bob::ip::LBPTop::operator= (const LBPTop& other) {
   m_lbp_xy = other.m_lbp_xy;
   m_lbp_xt = other.m_lbp_xt;
   m_lbp_yt = other.m_lbp_yt;
+  m_n_threads = other.m_n_threads;
+  m_n_frames = 0;
   return *this;
 }
 
+int bob::ip::LBPTop::maxRadius() const
+{
+  int radius_x = m_lbp_xy.getRadii()[0];  ///< The LBPu2,i radius in X direction
+  int radius_y = m_lbp_xy.getRadii()[1];  ///< The LBPu2,i radius in Y direction
+  int radius_t = m_lbp_yt.getRadii()[1];  ///< The LBPu2,i radius in T direction
+  int max_radius = radius_x > radius_y ? radius_x : radius_y;
+  max_radius = max_radius > radius_t ? max_radius : radius_t;
+
+  // the neighbourhood of each operator must fit in the one of the planes
+  const bob::ip::LBP* lbps[] = {&m_lbp_xy, &m_lbp_xt, &m_lbp_yt};
+  for (int i=0; i<3; ++i) {
+    const blitz::TinyVector<double,2> radii = lbps[i]->getRadii();
+    const int r = (int)ceil(std::max(radii[0], radii[1]));
+    if (r > max_radius)
+      throw bob::core::InvalidArgumentException("radius", r, 0, max_radius);
+  }
+  return max_radius;
+}
+
 void bob::ip::LBPTop::operator()(const blitz::Array<uint8_t,3>& src,
     blitz::Array<uint16_t,3>& xy,
     blitz::Array<uint16_t,3>& xt,
@@ -88,3 +113,27 @@ void bob::ip::LBPTop::operator()(const blitz::Array<double,3>& src,
 {
   process<double>(src, xy, xt, yt);
 }
+
+bool bob::ip::LBPTop::push(const blitz::Array<uint8_t,2>& frame,
+    blitz::Array<uint16_t,2>& xy,
+    blitz::Array<uint16_t,2>& xt,
+    blitz::Array<uint16_t,2>& yt)
+{
+  return push_<uint8_t>(frame, xy, xt, yt);
+}
+
+bool bob::ip::LBPTop::push(const blitz::Array<uint16_t,2>& frame,
+    blitz::Array<uint16_t,2>& xy,
+    blitz::Array<uint16_t,2>& xt,
+    blitz::Array<uint16_t,2>& yt)
+{
+  return push_<uint16_t>(frame, xy, xt, yt);
+}
+
+bool bob::ip::LBPTop::push(const blitz::Array<double,2>& frame,
+    blitz::Array<uint16_t,2>& xy,
+    blitz::Array<uint16_t,2>& xt,
+    blitz::Array<uint16_t,2>& yt)
+{
+  return push_<double>(frame, xy, xt, yt);
+}
@@ -0,0 +1,149 @@
+/**
+ * @file ip/cxx/Median.cc
+ * @date Sat Oct 17 14:21:09 2026 +0200
+ *
+ * @brief Histogram-based median filtering engines for integer images
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bob/ip/Median.h"
+
+/**
+ * Returns the index of the bin containing the element of (0-based) rank
+ * pos, given the histogram h with n bins. The number of elements in the
+ * bins before the returned one is added to the count argument.
+ */
+static inline int findRank(const int* h, const int n, const int pos,
+  int& count)
+{
+  int b=0;
+  for( ; b<n-1; ++b)
+  {
+    if (count + h[b] > pos) break;
+    count += h[b];
+  }
+  return b;
+}
+
+void bob::ip::detail::medianRows(const blitz::Array<uint8_t,2>& src,
+  blitz::Array<uint8_t,2>& dst, const int radius_y, const int radius_x,
+  const int row_begin, const int row_end)
+{
+  const int n_bins = 256;
+  const int size_y = 2*radius_y+1;
+  const int size_x = 2*radius_x+1;
+  const int median_pos = size_y*size_x/2;
+  const int width = src.extent(1);
+
+  // Initializes the column histograms with the first rows of the band
+  std::vector<int> columns(width*n_bins, 0);
+  for(int k=0; k<size_y; ++k)
+    for(int c=0; c<width; ++c)
+      ++columns[c*n_bins + src(row_begin+k,c)];
+
+  std::vector<int> kernel(n_bins);
+  for(int j=row_begin; j<row_end; ++j)
+  {
+    // Moves the column histograms down by one row
+    if (j > row_begin)
+    {
+      for(int c=0; c<width; ++c)
+      {
+        --columns[c*n_bins + src(j-1,c)];
+        ++columns[c*n_bins + src(j+2*radius_y,c)];
+      }
+    }
+
+    // Initializes the kernel histogram at the beginning of the row
+    std::fill(kernel.begin(), kernel.end(), 0);
+    for(int l=0; l<size_x; ++l)
+    {
+      const int* col = &columns[l*n_bins];
+      for(int b=0; b<n_bins; ++b) kernel[b] += col[b];
+    }
+    int count = 0;
+    dst(j,0) = (uint8_t)findRank(&kernel[0], n_bins, median_pos, count);
+
+    for(int i=1; i<dst.extent(1); ++i)
+    {
+      // Removes column i-1 and adds column i+2*radius_x
+      const int* col_out = &columns[(i-1)*n_bins];
+      const int* col_in = &columns[(i+2*radius_x)*n_bins];
+      for(int b=0; b<n_bins; ++b) kernel[b] += col_in[b] - col_out[b];
+
+      count = 0;
+      dst(j,i) = (uint8_t)findRank(&kernel[0], n_bins, median_pos, count);
+    }
+  }
+}
+
+void bob::ip::detail::medianRows(const blitz::Array<uint16_t,2>& src,
+  blitz::Array<uint16_t,2>& dst, const int radius_y, const int radius_x,
+  const int row_begin, const int row_end)
+{
+  const int n_coarse = 256;
+  const int n_fine = 65536;
+  const int size_y = 2*radius_y+1;
+  const int size_x = 2*radius_x+1;
+  const int median_pos = size_y*size_x/2;
+
+  std::vector<int> coarse(n_coarse, 0);
+  std::vector<int> fine(n_fine, 0);
+  for(int j=row_begin; j<row_end; ++j)
+  {
+    // Initializes the kernel histogram at the beginning of the row
+    for(int k=0; k<size_y; ++k)
+      for(int l=0; l<size_x; ++l)
+      {
+        const uint16_t v = src(j+k,l);
+        ++coarse[v >> 8];
+        ++fine[v];
+      }
+
+    for(int i=0; i<dst.extent(1); ++i)
+    {
+      // Removes column i-1 and adds column i+2*radius_x
+      if (i > 0)
+      {
+        for(int k=0; k<size_y; ++k)
+        {
+          const uint16_t v_out = src(j+k,i-1);
+          --coarse[v_out >> 8];
+          --fine[v_out];
+          const uint16_t v_in = src(j+k,i+2*radius_x);
+          ++coarse[v_in >> 8];
+          ++fine[v_in];
+        }
+      }
+
+      // Looks for the coarse bin, and then for the fine one
+      int count = 0;
+      const int c = findRank(&coarse[0], n_coarse, median_pos, count);
+      dst(j,i) = (uint16_t)((c << 8) +
+        findRank(&fine[c << 8], 256, median_pos, count));
+    }
+
+    // Empties the kernel histogram
+    const int last = dst.extent(1) - 1;
+    for(int k=0; k<size_y; ++k)
+      for(int l=0; l<size_x; ++l)
+      {
+        const uint16_t v = src(j+k,last+l);
+        --coarse[v >> 8];
+        --fine[v];
+      }
+  }
+}
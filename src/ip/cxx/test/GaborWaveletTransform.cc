@@ -232,4 +232,72 @@ BOOST_AUTO_TEST_CASE( test_GWT_output )
 
 }
 
+BOOST_AUTO_TEST_CASE( test_GWT_sparse_and_batch )
+{
+  // create a few textured images
+  const int n_images = 3, height = 41, width = 37;
+  blitz::Array<std::complex<double>,3> images(n_images, height, width);
+  for (int i = 0; i < n_images; ++i)
+    for (int y = 0; y < height; ++y)
+      for (int x = 0; x < width; ++x)
+        images(i,y,x) = (x * 37 + y * 101 + (x * y) % 13 * 17 + i * 59) % 256;
+
+  bob::ip::GaborWaveletTransform gwt;
+  const int n_kernels = gwt.numberOfKernels();
+  blitz::Range all = blitz::Range::all();
+
+  // compute the jet images of the single images as reference
+  blitz::Array<std::complex<double>,4> trafo_images(n_images, n_kernels, height, width);
+  blitz::Array<double,5> jet_images(n_images, height, width, 2, n_kernels);
+  blitz::Array<double,4> abs_jet_images(n_images, height, width, n_kernels);
+  for (int i = 0; i < n_images; ++i){
+    blitz::Array<std::complex<double>,2> image(images(i,all,all));
+    blitz::Array<std::complex<double>,3> trafo_image(trafo_images(i,all,all,all));
+    gwt.performGWT(image, trafo_image);
+    blitz::Array<double,4> jet_image(jet_images(i,all,all,all,all));
+    gwt.computeJetImage(image, jet_image, true);
+    blitz::Array<double,3> abs_jet_image(abs_jet_images(i,all,all,all));
+    gwt.computeJetImage(image, abs_jet_image, true);
+  }
+
+  // jets at some positions, including the image borders
+  blitz::Array<int,2> positions(5,2);
+  positions = 0, 0,  20, 18,  40, 36,  3, 30,  35, 2;
+  blitz::Array<double,3> sparse_jets(positions.extent(0), 2, n_kernels);
+  blitz::Array<double,2> sparse_abs_jets(positions.extent(0), n_kernels);
+  for (int i = 0; i < n_images; ++i){
+    gwt.computeSparseJets(images(i,all,all), positions, sparse_jets, true);
+    gwt.computeSparseJets(images(i,all,all), positions, sparse_abs_jets, true);
+    for (int p = 0; p < positions.extent(0); ++p){
+      const int y = positions(p,0), x = positions(p,1);
+      for (int j = 0; j < n_kernels; ++j){
+        // compare the complex values, since phases of small responses are unstable
+        std::complex<double> sparse = std::polar(sparse_jets(p,0,j), sparse_jets(p,1,j));
+        std::complex<double> reference = std::polar(jet_images(i,y,x,0,j), jet_images(i,y,x,1,j));
+        BOOST_CHECK_SMALL(std::abs(sparse - reference), epsilon);
+        BOOST_CHECK_SMALL(sparse_abs_jets(p,j) - abs_jet_images(i,y,x,j), epsilon);
+      }
+    }
+  }
+
+  // the batch transforms give the same results, with one or several threads
+  for (size_t n_threads = 1; n_threads <= 2; ++n_threads){
+    gwt.setNThreads(n_threads);
+    blitz::Array<std::complex<double>,4> batch_trafo_images(n_images, n_kernels, height, width);
+    gwt.performGWT(images, batch_trafo_images);
+    blitz::Array<double,5> batch_jet_images(n_images, height, width, 2, n_kernels);
+    gwt.computeJetImage(images, batch_jet_images, true);
+    blitz::Array<double,4> batch_abs_jet_images(n_images, height, width, n_kernels);
+    gwt.computeJetImage(images, batch_abs_jet_images, true);
+
+    for (int i = 0; i < n_images; ++i){
+      blitz::Array<std::complex<double>,3> trafo_image(trafo_images(i,all,all,all));
+      test_close(blitz::Array<std::complex<double>,3>(batch_trafo_images(i,all,all,all)), trafo_image, epsilon);
+      for (int p = 0; p < 2; ++p)
+        test_close(blitz::Array<double,3>(batch_jet_images(i,all,all,p,all)), blitz::Array<double,3>(jet_images(i,all,all,p,all)), epsilon);
+      test_close(blitz::Array<double,3>(batch_abs_jet_images(i,all,all,all)), blitz::Array<double,3>(abs_jet_images(i,all,all,all)), epsilon);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
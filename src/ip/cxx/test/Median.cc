@@ -25,6 +25,10 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 #include <blitz/array.h>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include "bob/ip/Median.h"
 
 struct T {
@@ -67,4 +71,64 @@ BOOST_AUTO_TEST_CASE( test_median_2d )
   checkBlitzEqual(dst, ref);
 }
 
+template <typename T>
+void checkAgainstSort(const blitz::Array<T,2>& src, const int ry, const int rx,
+  const size_t n_threads)
+{
+  bob::ip::Median<T> filter(ry,rx);
+  filter.setNThreads(n_threads);
+  blitz::Array<T,2> dst(src.extent(0)-2*ry, src.extent(1)-2*rx);
+  filter(src,dst);
+
+  std::vector<T> window;
+  for( int j=0; j<dst.extent(0); ++j)
+    for( int i=0; i<dst.extent(1); ++i)
+    {
+      window.clear();
+      for( int k=0; k<2*ry+1; ++k)
+        for( int l=0; l<2*rx+1; ++l)
+          window.push_back(src(j+k,i+l));
+      std::sort(window.begin(), window.end());
+      BOOST_CHECK_EQUAL(dst(j,i), window[window.size()/2]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_median_2d_types )
+{
+  blitz::Array<uint8_t,2> src8(23,17);
+  blitz::Array<uint16_t,2> src16(23,17);
+  blitz::Array<double,2> src64(23,17);
+  for( int j=0; j<src8.extent(0); ++j)
+    for( int i=0; i<src8.extent(1); ++i)
+    {
+      src8(j,i) = (uint8_t)((j*37 + i*101 + j*i*7) % 256);
+      src16(j,i) = (uint16_t)((j*3779 + i*1009 + j*i*71) % 65536);
+      src64(j,i) = ((j*37 + i*101 + j*i*7) % 97) / 7.;
+    }
+
+  for( size_t n_threads=1; n_threads<=4; n_threads+=3)
+  {
+    checkAgainstSort(src8, 1, 1, n_threads);
+    checkAgainstSort(src8, 3, 2, n_threads);
+    checkAgainstSort(src16, 1, 1, n_threads);
+    checkAgainstSort(src16, 2, 4, n_threads);
+    checkAgainstSort(src64, 1, 1, n_threads);
+    checkAgainstSort(src64, 4, 3, n_threads);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_median_2d_nan )
+{
+  // NaN values cannot be ordered, and are hence rejected
+  blitz::Array<double,2> src(9,8), dst(7,6);
+  src = 1.;
+  src(4,5) = std::numeric_limits<double>::quiet_NaN();
+  bob::ip::Median<double> median(1,1);
+  BOOST_CHECK_THROW(median(src, dst), std::runtime_error);
+
+  src(4,5) = std::numeric_limits<double>::infinity();
+  median(src, dst);
+  BOOST_CHECK_EQUAL(dst(3,4), 1.);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
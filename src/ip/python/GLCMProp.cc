@@ -43,6 +43,28 @@ static object call_getprop_shape(const bob::ip::GLCMProp& op, bob::python::const
   return object(output);
 }
 
+static object call_get_properties_shape(const bob::ip::GLCMProp& op, bob::python::const_ndarray input) 
+{
+  blitz::TinyVector<int,2> output;
+  output = op.get_properties_shape(input.bz<double, 3>());
+  return object(output);
+}
+
+static void call_properties_c(const bob::ip::GLCMProp& op, bob::python::const_ndarray input, bob::python::ndarray output) 
+{
+  blitz::Array<double,2> output_ = output.bz<double,2>();
+  return op.properties(input.bz<double,3>(), output_);
+}  
+  
+static object call_properties_p(const bob::ip::GLCMProp& op, bob::python::const_ndarray input) 
+{
+  const blitz::TinyVector<int,2> sh = op.get_properties_shape(input.bz<double,3>());
+  bob::python::ndarray output(bob::core::array::t_float64, sh(0), sh(1));
+  blitz::Array<double,2> output_ = output.bz<double,2>();
+  op.properties(input.bz<double,3>(), output_);
+  return output.self();
+}   
+
 static void call_angular_second_moment_c(const bob::ip::GLCMProp& op, bob::python::const_ndarray input, bob::python::ndarray output) 
 {
   blitz::Array<double,1> output_ = output.bz<double,1>();
@@ -416,11 +438,14 @@ static object call_inv_diff_mom_norm_p(const bob::ip::GLCMProp& op, bob::python:
 
 void bind_ip_glcmprop() 
 {
-  class_<bob::ip::GLCMProp, boost::shared_ptr<bob::ip::GLCMProp>, boost::noncopyable>("GLCMProp", glcmprop_doc, no_init)
-    .def("__init__", make_constructor(&py_constructor_glcmprop, default_call_policies()),"Constuctor")
+  class_<bob::ip::GLCMProp, boost::shared_ptr<bob::ip::GLCMProp>, boost::noncopyable> glcmprop("GLCMProp", glcmprop_doc, no_init);
+  glcmprop.def("__init__", make_constructor(&py_constructor_glcmprop, default_call_policies()),"Constuctor")
     .def(init<const bob::ip::GLCMProp&>((arg("glcmprop_operator")), "Copy constructs a GLCMProp operator"))
 
     .def("get_glcmprop_shape", &call_getprop_shape, (arg("self"), arg("input")), "Get the shape of the GLCM properties vector given the input GLCM. For each offset of the GLCM, one field of the output vector is filled.")
+    .def("get_properties_shape", &call_get_properties_shape, (arg("self"), arg("input")), "Get the shape of the output of properties() given the input GLCM. It has one row per offset of the GLCM, and one column per property.")
+    .def("properties", &call_properties_c, (arg("self"),arg("input"), arg("output")), "Extract all the properties of the input GLCM at once, reading the matrix of each offset only once. Each row of the output corresponds to one offset of the GLCM, while each column corresponds to one property, in the following order: angular second moment, energy, variance, contrast, auto-correlation, correlation, correlation as in MATLAB, inverse difference moment, sum average, sum variance, sum entropy, entropy, difference variance, difference entropy, dissimilarity, homogeneity, cluster prominance, cluster shade, maximum probability, information measure of correlation 1, information measure of correlation 2, inverse difference, inverse difference normalized and inverse difference moment normalized.")
+    .def("properties", &call_properties_p, (arg("self"),arg("input")), "Extract all the properties of the input GLCM at once, reading the matrix of each offset only once. Each row of the output corresponds to one offset of the GLCM, while each column corresponds to one property, in the following order: angular second moment, energy, variance, contrast, auto-correlation, correlation, correlation as in MATLAB, inverse difference moment, sum average, sum variance, sum entropy, entropy, difference variance, difference entropy, dissimilarity, homogeneity, cluster prominance, cluster shade, maximum probability, information measure of correlation 1, information measure of correlation 2, inverse difference, inverse difference normalized and inverse difference moment normalized.")
     .def("angular_second_moment", &call_angular_second_moment_c, (arg("self"),arg("input"), arg("output")), "Extract Angular Second Moment property of the input GLCM (see ref [1])")    
     .def("angular_second_moment", &call_angular_second_moment_p, (arg("self"),arg("input")), "Extract Angular Second Moment property of the input GLCM (see ref [1])")    
     .def("energy", &call_energy_c, (arg("self"),arg("input"), arg("output")), "Extract Energy property of the input GLCM (see ref [4])")    
@@ -470,4 +495,36 @@ void bind_ip_glcmprop()
     .def("inv_diff_mom_norm", &call_inv_diff_mom_norm_c, (arg("self"),arg("input"), arg("output")), "Extract Inverse Difference Moment Normalized property of the input GLCM (see ref [3]) - same as the Homogeneity property")    
     .def("inv_diff_mom_norm", &call_inv_diff_mom_norm_p, (arg("self"),arg("input")), "Extract Inverse Difference Moment Normalized property of the input GLCM (see ref [3]) - same as the Homogeneity property")   
     ;
+
+  // Sets the scope to the one of the GLCMProp
+  scope s(glcmprop);
+
+  // Columns of the output of properties()
+  enum_<bob::ip::GLCMProp::Property>("Property")
+    .value("ANGULAR_SECOND_MOMENT", bob::ip::GLCMProp::ANGULAR_SECOND_MOMENT)
+    .value("ENERGY", bob::ip::GLCMProp::ENERGY)
+    .value("VARIANCE", bob::ip::GLCMProp::VARIANCE)
+    .value("CONTRAST", bob::ip::GLCMProp::CONTRAST)
+    .value("AUTO_CORRELATION", bob::ip::GLCMProp::AUTO_CORRELATION)
+    .value("CORRELATION", bob::ip::GLCMProp::CORRELATION)
+    .value("CORRELATION_M", bob::ip::GLCMProp::CORRELATION_M)
+    .value("INV_DIFF_MOM", bob::ip::GLCMProp::INV_DIFF_MOM)
+    .value("SUM_AVG", bob::ip::GLCMProp::SUM_AVG)
+    .value("SUM_VAR", bob::ip::GLCMProp::SUM_VAR)
+    .value("SUM_ENTROPY", bob::ip::GLCMProp::SUM_ENTROPY)
+    .value("ENTROPY", bob::ip::GLCMProp::ENTROPY)
+    .value("DIFF_VAR", bob::ip::GLCMProp::DIFF_VAR)
+    .value("DIFF_ENTROPY", bob::ip::GLCMProp::DIFF_ENTROPY)
+    .value("DISSIMILARITY", bob::ip::GLCMProp::DISSIMILARITY)
+    .value("HOMOGENEITY", bob::ip::GLCMProp::HOMOGENEITY)
+    .value("CLUSTER_PROM", bob::ip::GLCMProp::CLUSTER_PROM)
+    .value("CLUSTER_SHADE", bob::ip::GLCMProp::CLUSTER_SHADE)
+    .value("MAX_PROB", bob::ip::GLCMProp::MAX_PROB)
+    .value("INF_MEAS_CORR1", bob::ip::GLCMProp::INF_MEAS_CORR1)
+    .value("INF_MEAS_CORR2", bob::ip::GLCMProp::INF_MEAS_CORR2)
+    .value("INV_DIFF", bob::ip::GLCMProp::INV_DIFF)
+    .value("INV_DIFF_NORM", bob::ip::GLCMProp::INV_DIFF_NORM)
+    .value("INV_DIFF_MOM_NORM", bob::ip::GLCMProp::INV_DIFF_MOM_NORM)
+    .export_values()
+    ;
 }
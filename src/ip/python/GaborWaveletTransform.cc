@@ -144,6 +144,58 @@ static bob::python::ndarray compute_jets_2(bob::ip::GaborWaveletTransform& gwt,
 }
 
 
+static inline const blitz::Array<std::complex<double>, 3> convert_images(bob::python::const_ndarray input){
+  switch (input.type().dtype){
+    case bob::core::array::t_uint8: return bob::core::array::cast<std::complex<double> >(input.bz<uint8_t,3>());
+    case bob::core::array::t_uint16: return bob::core::array::cast<std::complex<double> >(input.bz<uint16_t,3>());
+    case bob::core::array::t_float64: return bob::core::array::cast<std::complex<double> >(input.bz<double,3>());
+    case bob::core::array::t_complex128: return input.bz<std::complex<double>,3>();
+    default: throw bob::core::Exception();
+  }
+}
+
+static blitz::Array<std::complex<double>,4> perform_gwt_batch (bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_images){
+  const blitz::Array<std::complex<double>,3>& images = convert_images(input_images);
+  blitz::Array<std::complex<double>,4> trafo_images(images.extent(0), gwt.numberOfKernels(), images.extent(1), images.extent(2));
+  gwt.performGWT(images, trafo_images);
+  return trafo_images;
+}
+
+static bob::python::ndarray compute_jets_batch(bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_images, bool include_phases, bool normalized){
+  const blitz::Array<std::complex<double>,3>& images = convert_images(input_images);
+  if (include_phases){
+    bob::python::ndarray output(bob::core::array::t_float64, images.extent(0), images.extent(1), images.extent(2), 2, (int)gwt.numberOfKernels());
+    blitz::Array<double,5> jet_images = output.bz<double,5>();
+    gwt.computeJetImage(images, jet_images, normalized);
+    return output;
+  } else {
+    bob::python::ndarray output(bob::core::array::t_float64, images.extent(0), images.extent(1), images.extent(2), (int)gwt.numberOfKernels());
+    blitz::Array<double,4> jet_images = output.bz<double,4>();
+    gwt.computeJetImage(images, jet_images, normalized);
+    return output;
+  }
+}
+
+static bob::python::ndarray compute_sparse_jets(bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bob::python::const_ndarray input_positions, bool include_phases, bool normalized){
+  const blitz::Array<std::complex<double>,2>& image = convert_image(input_image);
+  const blitz::Array<int32_t,2> positions = input_positions.bz<int32_t,2>();
+  if (include_phases){
+    bob::python::ndarray output(bob::core::array::t_float64, positions.extent(0), 2, (int)gwt.numberOfKernels());
+    blitz::Array<double,3> jets = output.bz<double,3>();
+    gwt.computeSparseJets(image, positions, jets, normalized);
+    return output;
+  } else {
+    bob::python::ndarray output(bob::core::array::t_float64, positions.extent(0), (int)gwt.numberOfKernels());
+    blitz::Array<double,2> jets = output.bz<double,2>();
+    gwt.computeSparseJets(image, positions, jets, normalized);
+    return output;
+  }
+}
+
+static unsigned sparse_jets_crossover(bob::ip::GaborWaveletTransform& gwt, const blitz::TinyVector<int,2>& resolution){
+  return gwt.sparseJetsCrossover(blitz::TinyVector<unsigned,2>(resolution[0], resolution[1]));
+}
+
 static void normalize_gabor_jet(bob::python::ndarray gabor_jet){
   if (gabor_jet.type().nd == 1){
     blitz::Array<double,1> jet(gabor_jet.bz<double,1>());
@@ -251,6 +303,20 @@ void bind_ip_gabor_wavelet_transform() {
     "The number of directions that this Gabor wavelet family holds."
   )
 
+  .add_property(
+    "n_threads",
+    &bob::ip::GaborWaveletTransform::getNThreads,
+    &bob::ip::GaborWaveletTransform::setNThreads,
+    "The number of threads used by perform_gwt_batch() and compute_jets_batch(), each thread transforming a part of the images (0 means as many threads as hardware cores)."
+  )
+
+  .add_property(
+    "spatial_epsilon",
+    &bob::ip::GaborWaveletTransform::getSpatialEpsilon,
+    &bob::ip::GaborWaveletTransform::setSpatialEpsilon,
+    "The fraction of the largest value of a spatial Gabor wavelet below which its values are discarded by compute_sparse_jets() (default: 1e-6). Larger values give smaller wavelets, hence faster sparse jets, with a relative error of about spatial_epsilon. Counting operations, with the default family and a 128x128 image, compute_sparse_jets() is faster than compute_jets() for up to about 15 positions with 1e-6, and about 25 positions with 1e-3 (see sparse_jets_crossover())."
+  )
+
   .def(
     "empty_trafo_image",
     &empty_trafo_image,
@@ -305,6 +371,34 @@ void bind_ip_gabor_wavelet_transform() {
     &compute_jets_2,
     (boost::python::arg("self"), boost::python::arg("input_image"), boost::python::arg("include_phases")=true, boost::python::arg("normalized")=true),
     "Performs a Gabor wavelet transform and returns the image of Gabor jets, with or without Gabor phases. If the normalized parameter is set to True (the default), the absolute parts of the Gabor jets are normalized to unit Euclidean length."
+ )
+
+  .def(
+    "perform_gwt_batch",
+    &perform_gwt_batch,
+    (boost::python::arg("self"), boost::python::arg("input_images")),
+    "Performs a Gabor wavelet transform of several gray images of the same size, given as a 3D array, and returns a 4D array of Gabor wavelet transformed images. The kernels are generated only once, and the images are distributed over n_threads threads."
+  )
+
+  .def(
+    "compute_jets_batch",
+    &compute_jets_batch,
+    (boost::python::arg("self"), boost::python::arg("input_images"), boost::python::arg("include_phases")=true, boost::python::arg("normalized")=true),
+    "Performs a Gabor wavelet transform of several gray images of the same size, given as a 3D array, and returns one image of Gabor jets per input image, with or without Gabor phases. The kernels are generated only once, and the images are distributed over n_threads threads."
+  )
+
+  .def(
+    "compute_sparse_jets",
+    &compute_sparse_jets,
+    (boost::python::arg("self"), boost::python::arg("input_image"), boost::python::arg("positions"), boost::python::arg("include_phases")=true, boost::python::arg("normalized")=true),
+    "Computes the Gabor jets only at the given (y,x) positions (a 2D array of dtype 'int32' with one position per row), using inner products with the Gabor wavelets in spatial domain. This is faster than compute_jets() for up to sparse_jets_crossover() positions. The results are identical up to the cropping of the spatial wavelets, whose values smaller than spatial_epsilon times their largest value are discarded."
+  )
+
+  .def(
+    "sparse_jets_crossover",
+    &sparse_jets_crossover,
+    (boost::python::arg("self"), boost::python::arg("resolution")),
+    "Returns the largest number of positions for which compute_sparse_jets() is cheaper than compute_jets() on images of the given (height, width) resolution. Counting complex multiply-adds, one sparse jet costs the summed areas of the spatial wavelets cropped with spatial_epsilon, while the jet image costs one FFT and one inverse FFT per kernel plus one product per pixel and kernel."
   );
 
   boost::python::def(
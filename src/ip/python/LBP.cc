@@ -105,6 +105,23 @@ static void call_lbptop (const bob::ip::LBPTop& op, bob::python::const_ndarray i
   }
 }
 
+template <typename T>
+static bool inner_push_lbptop (bob::ip::LBPTop& op, bob::python::const_ndarray frame, bob::python::ndarray xy, bob::python::ndarray xt, bob::python::ndarray yt) {
+  blitz::Array<uint16_t,2> xy_ = xy.bz<uint16_t,2>();
+  blitz::Array<uint16_t,2> xt_ = xt.bz<uint16_t,2>();
+  blitz::Array<uint16_t,2> yt_ = yt.bz<uint16_t,2>();
+  return op.push(frame.bz<T,2>(), xy_, xt_, yt_);
+}
+
+static bool push_lbptop (bob::ip::LBPTop& op, bob::python::const_ndarray frame, bob::python::ndarray xy, bob::python::ndarray xt, bob::python::ndarray yt) {
+  switch(frame.type().dtype) {
+    case bob::core::array::t_uint8: return inner_push_lbptop<uint8_t>(op, frame, xy, xt, yt);
+    case bob::core::array::t_uint16: return inner_push_lbptop<uint16_t>(op, frame, xy, xt, yt);
+    case bob::core::array::t_float64: return inner_push_lbptop<double>(op, frame, xy, xt, yt);
+    default: PYTHON_ERROR(TypeError, "LBPTop operator cannot process image of type '%s'", frame.type().str().c_str()); return false;
+  }
+}
+
 
 template <typename T>
 static object inner_lbp_apply (bob::ip::LBPHSFeatures& op, bob::python::const_ndarray input) {
@@ -147,6 +164,7 @@ void bind_ip_lbp() {
     .add_property("max_label", &bob::ip::LBP::getMaxLabel)
     .add_property("look_up_table", &bob::ip::LBP::getLookUpTable, &bob::ip::LBP::setLookUpTable)
     .add_property("relative_positions", &bob::ip::LBP::getRelativePositions)
+    .add_property("n_threads", &bob::ip::LBP::getNThreads, &bob::ip::LBP::setNThreads, "The number of threads used to extract the LBP codes of a whole image, each thread processing a band of rows (0 means as many threads as hardware cores)")
 
     .def("get_lbp_shape", &get_shape, (arg("self"), arg("input")), "Get a tuple containing the expected size of the output when extracting LBP features.")
     .def("__call__", &call_inout, (arg("self"), arg("input"), arg("output")), "Call an object of this type to extract LBP features for the whole image.")
@@ -160,6 +178,9 @@ void bind_ip_lbp() {
     .add_property("xy", &bob::ip::LBPTop::getXY)
     .add_property("xt", &bob::ip::LBPTop::getXT)
     .add_property("yt", &bob::ip::LBPTop::getYT)
+    .add_property("n_threads", &bob::ip::LBPTop::getNThreads, &bob::ip::LBPTop::setNThreads, "The number of threads used to compute the codes, over the frames when processing a whole sequence and over the rows when pushing frames (0 means as many threads as hardware cores)")
+    .def("push", &push_lbptop, (arg("self"), arg("frame"), arg("xy"), arg("xt"), arg("yt")), "Pushes the next frame of a sequence of <b>grayscale</b> images. Only the last 2*R+1 frames are kept, R being the maximum radius of the three operators. Once 2*R+1 frames have been pushed, the LBP codes of the central frame of the queue (the one pushed R frames before) are computed in the three planes and returned (by argument) in xy, xt and yt (of size height-2*R x width-2*R), and True is returned. Otherwise, False is returned.")
+    .def("reset", &bob::ip::LBPTop::reset, (arg("self")), "Forgets the frames pushed so far, to start a new sequence")
     .def("__call__", &call_lbptop, (arg("self"),arg("input"), arg("xy"), arg("xt"), arg("yt")), "Processes a 3D array representing a set of <b>grayscale</b> images and returns (by argument) the three LBP planes calculated. The 3D array has to be arranged in this way:\n\n1st dimension => time\n2nd dimension => frame height\n3rd dimension => frame width\n\nThe central pixel is the point where the LBP planes intersect/have to be calculated from.")
     ;
 
@@ -168,6 +189,7 @@ void bind_ip_lbp() {
     .def(init<const int, const int, const int, const int, optional<const double, const int, const bool, const bool, const bool, const bool, const bool> >((arg("block_h"), arg("block_w"), arg("overlap_h"), arg("overlap_w"), arg("lbp_radius")=1., arg("lbp_neighbours")=8, arg("circular")=false,arg("to_average")=false,arg("add_average_bit")=false,arg("uniform")=false, arg("rotation_invariant")=false), "Constructs a new LBPHS features extractor creating a new LBP extractor with the given parameters."))
     .def(init<const int, const int, const int, const int, const bob::ip::LBP& >((arg("block_h"), arg("block_w"), arg("overlap_h"), arg("overlap_w"), arg("lbp")), "Constructs a new LBPHS features extractor using the given LBP extractor."))
     .add_property("n_bins", &bob::ip::LBPHSFeatures::getNBins)
+    .add_property("integral_histogram", &bob::ip::LBPHSFeatures::getIntegralHistogram, &bob::ip::LBPHSFeatures::setIntegralHistogram, "Whether the histograms of the blocks are computed from the integral histogram of the LBP codes of the whole image. The LBP codes of each pixel are then computed once, and the histogram of each block costs O(n_bins) whatever the size of the blocks and their overlap, at the price of storing height x width x n_bins counts. The histograms are the same in both modes.")
     .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<uint8_t,2>& src))&bob::ip::LBPHSFeatures::getNBlocks<uint8_t>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
     .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<uint16_t,2>& src))&bob::ip::LBPHSFeatures::getNBlocks<uint16_t>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
     .def("get_n_blocks", (const int (bob::ip::LBPHSFeatures::*)(const blitz::Array<double,2>& src))&bob::ip::LBPHSFeatures::getNBlocks<double>, (arg("self"),arg("input")), "Return the number of blocks generated when extracting LBPHS Features on the given input")
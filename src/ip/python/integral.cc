@@ -73,6 +73,38 @@ static void integral (bob::python::const_ndarray src, bob::python::ndarray dst,
 
 BOOST_PYTHON_FUNCTION_OVERLOADS(integral_overloads, integral, 2, 3)
 
+template <typename T>
+static void inner_integral_histogram (bob::python::const_ndarray src, bob::python::ndarray dst) {
+  blitz::Array<uint32_t,3> dst_ = dst.bz<uint32_t,3>();
+  bob::ip::integralHistogram(src.bz<T,2>(), dst_);
+}
+
+static void integral_histogram (bob::python::const_ndarray src, bob::python::ndarray dst) {
+  const bob::core::array::typeinfo& info = src.type();
+
+  if(info.nd != 2)
+    PYTHON_ERROR(TypeError, "integral histogram operator does not support input with " SIZE_T_FMT " dimensions.", info.nd);
+  if(dst.type().nd != 3 || dst.type().dtype != bob::core::array::t_uint32)
+    PYTHON_ERROR(TypeError, "integral histogram operator does not support output type '%s'", dst.type().str().c_str());
+
+  switch (info.dtype) {
+    case bob::core::array::t_uint8: return inner_integral_histogram<uint8_t>(src, dst);
+    case bob::core::array::t_uint16: return inner_integral_histogram<uint16_t>(src, dst);
+    default:
+      PYTHON_ERROR(TypeError, "integral histogram operator does not support input type '%s'", info.str().c_str());
+  }
+}
+
+static object integral_histogram_block (bob::python::const_ndarray integral, const int y, const int x, const int height, const int width) {
+  const blitz::Array<uint32_t,3> integral_ = integral.bz<uint32_t,3>();
+  bob::python::ndarray hist(bob::core::array::t_uint64, integral_.extent(2));
+  blitz::Array<uint64_t,1> hist_ = hist.bz<uint64_t,1>();
+  bob::ip::integralHistogramBlock(integral_, y, x, height, width, hist_);
+  return hist.self();
+}
+
 void bind_ip_integral() {
   def(BOOST_PP_STRINGIZE(integral), &integral, integral_overloads((arg("src"), arg("dst"), arg("add_zero_border")=false), "Compute the integral image of a 2D blitz array (image). It is the responsibility of the user to select an appropriate type for the numpy array which will contain the integral image. By default, src and dst should have the same size. If add_zero_border is set to true, then dst should be one pixel larger than src in each dimension.")); 
+  def("integral_histogram", &integral_histogram, (arg("src"), arg("dst")), "Compute the integral histogram of a 2D array of labels (e.g. LBP codes) of type uint8 or uint16: dst[y,x,b] is the number of pixels with label b in src[:y,:x]. dst is a uint32 array of size (height+1, width+1, n_bins), and all the labels must be smaller than n_bins. The histogram of any rectangle can then be computed in O(n_bins) using integral_histogram_block().");
+  def("integral_histogram_block", &integral_histogram_block, (arg("integral"), arg("y"), arg("x"), arg("height"), arg("width")), "Returns the histogram (uint64) of the labels of the rectangle src[y:y+height,x:x+width], given the integral histogram of src (see integral_histogram()).");
 }
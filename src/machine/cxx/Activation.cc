@@ -26,12 +26,30 @@
 
 namespace bob { namespace machine {
 
+  void Activation::f_inplace (blitz::Array<double,2>& z) const {
+    for (int i=0; i<z.extent(0); ++i)
+      for (int j=0; j<z.extent(1); ++j)
+        z(i,j) = f(z(i,j));
+  }
+
+  void Activation::multiply_f_prime_from_f (const blitz::Array<double,2>& a,
+      blitz::Array<double,2>& x) const {
+    for (int i=0; i<x.extent(0); ++i)
+      for (int j=0; j<x.extent(1); ++j)
+        x(i,j) *= f_prime_from_f(a(i,j));
+  }
+
   double IdentityActivation::f (double z) const { return z; }
 
   double IdentityActivation::f_prime (double) const { return 1.; }
   
   double IdentityActivation::f_prime_from_f (double) const { return 1.; }
 
+  void IdentityActivation::f_inplace (blitz::Array<double,2>&) const {}
+
+  void IdentityActivation::multiply_f_prime_from_f
+    (const blitz::Array<double,2>&, blitz::Array<double,2>&) const {}
+
   void IdentityActivation::save(bob::io::HDF5File& f) const {
     f.set("id", unique_identifier());
   }
@@ -57,6 +75,13 @@ namespace bob { namespace machine {
   
   double LinearActivation::f_prime_from_f (double a) const { return m_C; }
 
+  void LinearActivation::f_inplace (blitz::Array<double,2>& z) const
+  { z *= m_C; }
+
+  void LinearActivation::multiply_f_prime_from_f
+    (const blitz::Array<double,2>&, blitz::Array<double,2>& x) const
+  { x *= m_C; }
+
   double LinearActivation::C() const { return m_C; }
 
   void LinearActivation::save(bob::io::HDF5File& f) const {
@@ -84,6 +109,13 @@ namespace bob { namespace machine {
 
   double HyperbolicTangentActivation::f_prime_from_f (double a) const { return (1. - (a*a)); }
 
+  void HyperbolicTangentActivation::f_inplace (blitz::Array<double,2>& z) const
+  { z = blitz::tanh(z); }
+
+  void HyperbolicTangentActivation::multiply_f_prime_from_f
+    (const blitz::Array<double,2>& a, blitz::Array<double,2>& x) const
+  { x *= 1. - a*a; }
+
   void HyperbolicTangentActivation::save(bob::io::HDF5File& f) const {
     f.set("id", unique_identifier());
   }
@@ -111,6 +143,14 @@ namespace bob { namespace machine {
   double MultipliedHyperbolicTangentActivation::f_prime_from_f (double a) const
   { return m_C * m_M * (1. - std::pow(a/m_C,2)); }
 
+  void MultipliedHyperbolicTangentActivation::f_inplace
+    (blitz::Array<double,2>& z) const
+  { z = m_C * blitz::tanh(m_M * z); }
+
+  void MultipliedHyperbolicTangentActivation::multiply_f_prime_from_f
+    (const blitz::Array<double,2>& a, blitz::Array<double,2>& x) const
+  { x *= m_C * m_M * (1. - blitz::pow2(a/m_C)); }
+
   double MultipliedHyperbolicTangentActivation::C() const { return m_C; }
 
   double MultipliedHyperbolicTangentActivation::M() const { return m_M; }
@@ -143,6 +183,13 @@ namespace bob { namespace machine {
 
   double LogisticActivation::f_prime_from_f (double a) const { return a * (1. - a); }
 
+  void LogisticActivation::f_inplace (blitz::Array<double,2>& z) const
+  { z = 1. / (1. + blitz::exp(-z)); }
+
+  void LogisticActivation::multiply_f_prime_from_f
+    (const blitz::Array<double,2>& a, blitz::Array<double,2>& x) const
+  { x *= a * (1. - a); }
+
   void LogisticActivation::save(bob::io::HDF5File& f) const {
     f.set("id", unique_identifier());
   }
@@ -23,6 +23,14 @@
 #include <bob/core/assert.h>
 #include <bob/machine/Exception.h>
 #include <bob/math/log.h>
+#include <bob/math/gemm.h>
+#include <algorithm>
+
+/**
+ * Number of samples processed at once by the block-based accumulation
+ * of the statistics (accStatistics() on 2D arrays)
+ */
+static const int ACC_STATISTICS_BLOCK_SIZE = 256;
 
 bob::machine::GMMMachine::GMMMachine(): m_gaussians(0) {
   resize(0,0);
@@ -261,13 +269,15 @@ double bob::machine::GMMMachine::logLikelihood(const blitz::Array<double, 1> &x)
   bob::core::array::assertSameDimensionLength(x.extent(0), m_n_inputs);
   // Call the other logLikelihood_ (overloaded) function
   // (log_weighted_gaussian_likelihoods will be discarded)
-  return logLikelihood_(x,m_cache_log_weighted_gaussian_likelihoods);
+  blitz::Array<double,1> log_weighted_gaussian_likelihoods(m_n_gaussians);
+  return logLikelihood_(x,log_weighted_gaussian_likelihoods);
 }
 
 double bob::machine::GMMMachine::logLikelihood_(const blitz::Array<double, 1> &x) const {
   // Call the other logLikelihood (overloaded) function
   // (log_weighted_gaussian_likelihoods will be discarded)
-  return logLikelihood_(x,m_cache_log_weighted_gaussian_likelihoods);
+  blitz::Array<double,1> log_weighted_gaussian_likelihoods(m_n_gaussians);
+  return logLikelihood_(x,log_weighted_gaussian_likelihoods);
 }
 
 void bob::machine::GMMMachine::forward(const blitz::Array<double,1>& input, double& output) const {
@@ -285,24 +295,97 @@ void bob::machine::GMMMachine::forward_(const blitz::Array<double,1>& input,
 
 void bob::machine::GMMMachine::accStatistics(const blitz::Array<double,2>& input,
     bob::machine::GMMStats& stats) const {
-  // iterate over data
+  // check GMMStats size
+  bob::core::array::assertSameDimensionLength(stats.sumPx.extent(0), m_n_gaussians);
+  bob::core::array::assertSameDimensionLength(stats.sumPx.extent(1), m_n_inputs);
+  // check input size
+  bob::core::array::assertSameDimensionLength(input.extent(1), m_n_inputs);
+
+  accStatistics_(input, stats);
+}
+
+void bob::machine::GMMMachine::computeBlockTerms(blitz::Array<double,2>& A,
+  blitz::Array<double,2>& B, blitz::Array<double,1>& c) const
+{
+  // log(weight_i*p(x|Gaussian_i))
+  //   = log(weight_i) - 1/2 * (g_norm_i + sum_d (x_d-mean_id)^2/variance_id)
+  //   = sum_d x_d^2 * (-1/2/variance_id) + sum_d x_d * (mean_id/variance_id)
+  //     + log(weight_i) - 1/2 * (g_norm_i + sum_d mean_id^2/variance_id)
   blitz::Range a = blitz::Range::all();
-  for(int i=0; i<input.extent(0); ++i) {
-    // Get example
-    blitz::Array<double,1> x(input(i,a));
-    // Accumulate statistics
-    accStatistics(x,stats);
+  for(size_t i=0; i<m_n_gaussians; ++i) {
+    const blitz::Array<double,1>& mean = m_gaussians[i]->getMean();
+    const blitz::Array<double,1>& variance = m_gaussians[i]->getVariance();
+    blitz::Array<double,1> A_i = A(i,a);
+    blitz::Array<double,1> B_i = B(i,a);
+    A_i = -0.5 / variance;
+    B_i = mean / variance;
+    c(i) = m_cache_log_weights(i) - 0.5 * (m_gaussians[i]->getGNorm() +
+      blitz::sum(mean * B_i));
   }
 }
 
 void bob::machine::GMMMachine::accStatistics_(const blitz::Array<double,2>& input, bob::machine::GMMStats& stats) const {
-  // iterate over data
-  blitz::Range a = blitz::Range::all();
-  for(int i=0; i<input.extent(0); ++i) {
-    // Get example
-    blitz::Array<double,1> x(input(i, a));
+  const int n_samples = input.extent(0);
+  if(n_samples == 0) return;
+
+  // Precomputes the terms that only depend on the Gaussian components
+  blitz::Array<double,2> A(m_n_gaussians, m_n_inputs);
+  blitz::Array<double,2> B(m_n_gaussians, m_n_inputs);
+  blitz::Array<double,1> c(m_n_gaussians);
+  computeBlockTerms(A, B, c);
+
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  const int base0 = input.lbound(0);
+  const int base1 = input.lbound(1);
+
+  // Block buffers
+  blitz::Array<double,2> x, xx, L;
+  blitz::Array<double,1> l_max, l_sum;
+  for(int start=0; start<n_samples; start+=ACC_STATISTICS_BLOCK_SIZE) {
+    const int size = std::min(ACC_STATISTICS_BLOCK_SIZE, n_samples-start);
+    if(x.extent(0) != size) {
+      x.resize(size, m_n_inputs);
+      xx.resize(size, m_n_inputs);
+      L.resize(size, m_n_gaussians);
+      l_max.resize(size);
+      l_sum.resize(size);
+    }
+
+    // Get the block of samples (and their squared values)
+    // Elements are copied one by one rather than through a slice of
+    // input, as creating blitz views is not thread-safe (shared reference
+    // counter), and this function may be called concurrently on the same
+    // input array by different threads.
+    for(int n=0; n<size; ++n)
+      for(int d=0; d<static_cast<int>(m_n_inputs); ++d)
+        x(n,d) = input(base0+start+n, base1+d);
+    xx = blitz::pow2(x);
+
+    // Calculate Gaussian and GMM likelihoods
+    // - L(n,i) = log(weight_i*p(x_n|gaussian_i))
+    bob::math::gemm_(xx, A, L, false, true);
+    bob::math::gemm_(x, B, L, false, true, 1., 1.);
+    L += c(j);
+    // - log_likelihood(n) = log(sum_i(weight_i*p(x_n|gaussian_i)))
+    //   (log-sum-exp, using the maximum for numerical stability)
+    l_max = blitz::max(L(i,j), j);
+    L = blitz::exp(L(i,j) - l_max(i));
+    l_sum = blitz::sum(L(i,j), j);
+    // Calculate responsibilities (L now contains P)
+    L = L(i,j) / l_sum(i);
+
     // Accumulate statistics
-    accStatistics_(x,stats);
+    // - total likelihood
+    stats.log_likelihood += blitz::sum(l_max + blitz::log(l_sum));
+    // - number of samples
+    stats.T += size;
+    // - responsibilities
+    stats.n += blitz::sum(L(j,i), j);
+    // - first order stats
+    bob::math::gemm_(L, x, stats.sumPx, true, false, 1., 1.);
+    // - second order stats
+    bob::math::gemm_(L, xx, stats.sumPxx, true, false, 1., 1.);
   }
 }
 
@@ -312,27 +395,32 @@ void bob::machine::GMMMachine::accStatistics(const blitz::Array<double, 1>& x, b
   bob::core::array::assertSameDimensionLength(stats.sumPx.extent(1), m_n_inputs);
 
   // Calculate Gaussian and GMM likelihoods
-  // - m_cache_log_weighted_gaussian_likelihoods(i) = log(weight_i*p(x|gaussian_i))
+  // - log_weighted_gaussian_likelihoods(i) = log(weight_i*p(x|gaussian_i))
   // - log_likelihood = log(sum_i(weight_i*p(x|gaussian_i)))
-  double log_likelihood = logLikelihood(x, m_cache_log_weighted_gaussian_likelihoods);
+  blitz::Array<double,1> log_weighted_gaussian_likelihoods(m_n_gaussians);
+  double log_likelihood = logLikelihood(x, log_weighted_gaussian_likelihoods);
 
-  accStatisticsInternal(x, stats, log_likelihood);
+  accStatisticsInternal(x, stats, log_weighted_gaussian_likelihoods, log_likelihood);
 }
 
 void bob::machine::GMMMachine::accStatistics_(const blitz::Array<double, 1>& x, bob::machine::GMMStats& stats) const {
   // Calculate Gaussian and GMM likelihoods
-  // - m_cache_log_weighted_gaussian_likelihoods(i) = log(weight_i*p(x|gaussian_i))
+  // - log_weighted_gaussian_likelihoods(i) = log(weight_i*p(x|gaussian_i))
   // - log_likelihood = log(sum_i(weight_i*p(x|gaussian_i)))
-  double log_likelihood = logLikelihood_(x, m_cache_log_weighted_gaussian_likelihoods);
+  blitz::Array<double,1> log_weighted_gaussian_likelihoods(m_n_gaussians);
+  double log_likelihood = logLikelihood_(x, log_weighted_gaussian_likelihoods);
 
-  accStatisticsInternal(x, stats, log_likelihood);
+  accStatisticsInternal(x, stats, log_weighted_gaussian_likelihoods, log_likelihood);
 }
 
 void bob::machine::GMMMachine::accStatisticsInternal(const blitz::Array<double, 1>& x,
-  bob::machine::GMMStats& stats, const double log_likelihood) const
+  bob::machine::GMMStats& stats,
+  const blitz::Array<double,1>& log_weighted_gaussian_likelihoods,
+  const double log_likelihood) const
 {
   // Calculate responsibilities
-  m_cache_P = blitz::exp(m_cache_log_weighted_gaussian_likelihoods - log_likelihood);
+  blitz::Array<double,1> P(m_n_gaussians);
+  P = blitz::exp(log_weighted_gaussian_likelihoods - log_likelihood);
 
   // Accumulate statistics
   // - total likelihood
@@ -342,18 +430,16 @@ void bob::machine::GMMMachine::accStatisticsInternal(const blitz::Array<double,
   stats.T++;
 
   // - responsibilities
-  stats.n += m_cache_P;
+  stats.n += P;
 
   // - first order stats
   blitz::firstIndex i;
   blitz::secondIndex j;
 
-  m_cache_Px = m_cache_P(i) * x(j);
-
-  stats.sumPx += m_cache_Px;
+  stats.sumPx += P(i) * x(j);
 
   // - second order stats
-  stats.sumPxx += (m_cache_Px(i,j) * x(j));
+  stats.sumPxx += P(i) * blitz::pow2(x(j));
 }
 
 boost::shared_ptr<const bob::machine::Gaussian> bob::machine::GMMMachine::getGaussian(const size_t i) const {
@@ -429,9 +515,6 @@ void bob::machine::GMMMachine::initCache() const {
   // Initialise cache arrays
   m_cache_log_weights.resize(m_n_gaussians);
   recomputeLogWeights();
-  m_cache_log_weighted_gaussian_likelihoods.resize(m_n_gaussians);
-  m_cache_P.resize(m_n_gaussians);
-  m_cache_Px.resize(m_n_gaussians,m_n_inputs);
   m_cache_supervector = false;
 }
 
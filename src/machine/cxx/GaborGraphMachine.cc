@@ -181,6 +181,74 @@ void bob::machine::GaborGraphMachine::extract(
 }
 
 
+/**
+ * Extracts the Gabor jets (including phase information) at the node positions directly from the image.
+ * When the graph has at most bob::ip::GaborWaveletTransform::sparseJetsCrossover nodes, only the jets at
+ * the node positions are computed (see bob::ip::GaborWaveletTransform::computeSparseJets), otherwise the
+ * whole Gabor jet image is computed and the jets are extracted from it.
+ * @param gwt  The Gabor wavelet transform to use
+ * @param image  The image to extract the Gabor jets from
+ * @param graph_jets The graph that will be filled
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::machine::GaborGraphMachine::extract(
+  bob::ip::GaborWaveletTransform& gwt,
+  const blitz::Array<std::complex<double>,2>& image,
+  blitz::Array<double,3>& graph_jets,
+  bool do_normalize
+) const {
+  // check the positions
+  checkPositions(image.shape()[0], image.shape()[1]);
+  if (m_node_positions.extent(0) <= (int)gwt.sparseJetsCrossover(blitz::TinyVector<unsigned,2>(image.extent(0), image.extent(1)))){
+    // compute the Gabor jets at the node positions only
+    gwt.computeSparseJets(image, m_node_positions, graph_jets, do_normalize);
+  } else {
+    // compute the whole Gabor jet image, and normalize the extracted jets only
+    blitz::Array<double,4> jet_image(image.extent(0), image.extent(1), 2, (int)gwt.numberOfKernels());
+    gwt.computeJetImage(image, jet_image, false);
+    extract(jet_image, graph_jets);
+    if (do_normalize){
+      for (int i = 0; i < m_node_positions.extent(0); ++i){
+        blitz::Array<double,2> jet(graph_jets(i,blitz::Range::all(),blitz::Range::all()));
+        bob::ip::normalizeGaborJet(jet);
+      }
+    }
+  }
+}
+
+/**
+ * Extracts the Gabor jets (without phase information) at the node positions directly from the image,
+ * choosing between the sparse jets and the whole Gabor jet image as above.
+ * @param gwt  The Gabor wavelet transform to use
+ * @param image  The image to extract the Gabor jets from
+ * @param graph_jets The graph that will be filled
+ * @param do_normalize Shall the Gabor jets be normalized?
+ */
+void bob::machine::GaborGraphMachine::extract(
+  bob::ip::GaborWaveletTransform& gwt,
+  const blitz::Array<std::complex<double>,2>& image,
+  blitz::Array<double,2>& graph_jets,
+  bool do_normalize
+) const {
+  // check the positions
+  checkPositions(image.shape()[0], image.shape()[1]);
+  if (m_node_positions.extent(0) <= (int)gwt.sparseJetsCrossover(blitz::TinyVector<unsigned,2>(image.extent(0), image.extent(1)))){
+    // compute the Gabor jets at the node positions only
+    gwt.computeSparseJets(image, m_node_positions, graph_jets, do_normalize);
+  } else {
+    // compute the whole Gabor jet image, and normalize the extracted jets only
+    blitz::Array<double,3> jet_image(image.extent(0), image.extent(1), (int)gwt.numberOfKernels());
+    gwt.computeJetImage(image, jet_image, false);
+    extract(jet_image, graph_jets);
+    if (do_normalize){
+      for (int i = 0; i < m_node_positions.extent(0); ++i){
+        blitz::Array<double,1> jet(graph_jets(i,blitz::Range::all()));
+        bob::ip::normalizeGaborJet(jet);
+      }
+    }
+  }
+}
+
 /**
  * Averages the given set of Gabor graphs into a single one by interpolating the Gabor jets
  * @param many_graph_jets     The set of Gabor graphs to average
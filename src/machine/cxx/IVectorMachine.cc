@@ -23,6 +23,8 @@
 #include <bob/core/check.h>
 #include <bob/math/linear.h>
 #include <bob/math/linsolve.h>
+#include <bob/core/parallel.h>
+#include <algorithm>
 
 bob::machine::IVectorMachine::IVectorMachine()
 {
@@ -255,7 +257,90 @@ void bob::machine::IVectorMachine::forward_(const bob::machine::GMMStats& gs,
   // Computes \f$T^{T} \Sigma^{-1} \sum_{c=1}^{C} (F_c - N_c ubmmean_{c})\f$
   computeTtSigmaInvFnorm(gs, m_tmp_t1);
 
-  // Solves m_tmp_tt.ivector = m_tmp_t1
-  bob::math::linsolve(m_tmp_tt, ivector, m_tmp_t1);
+  // Solves m_tmp_tt.ivector = m_tmp_t1 (m_tmp_tt is symmetric positive
+  // definite)
+  bob::math::linsolveSympos_(m_tmp_tt, ivector, m_tmp_t1);
+}
+
+bob::machine::IVectorMachine::Posterior::Posterior(const size_t rt,
+    const bool with_covariance):
+  precision(rt, rt),
+  rhs(rt, with_covariance ? rt+1 : 1),
+  solution(rt, with_covariance ? rt+1 : 1)
+{
+}
+
+void bob::machine::IVectorMachine::computePosterior_(
+  const bob::machine::GMMStats& gs, Posterior& posterior) const
+{
+  // The cached arrays are only accessed through raw pointers, as blitz
+  // reference counting is not thread-safe
+  const int C = (int)getDimC();
+  const int D = (int)getDimD();
+  const int Rt = (int)m_rt;
+  const int P = posterior.rhs.extent(1);
+  const double* Tct_sigmacInv_Tc = m_cache_Tct_sigmacInv_Tc.data();
+  const double* Tct_sigmacInv = m_cache_Tct_sigmacInv.data();
+  const blitz::Array<double,1>& ubm_mean = m_ubm->getMeanSupervector();
+
+  // Computes \f$(Id + \sum_{c=1}^{C} N_{i,j,c} T^{T} \Sigma_{c}^{-1} T)\f$
+  double* precision = posterior.precision.data();
+  std::fill(precision, precision + Rt*Rt, 0.);
+  for (int k=0; k<Rt; ++k) precision[k*Rt+k] = 1.;
+  for (int c=0; c<C; ++c) {
+    const double n_c = gs.n(c);
+    if (n_c == 0.) continue;
+    const double* M = Tct_sigmacInv_Tc + c*Rt*Rt;
+    for (int k=0; k<Rt*Rt; ++k) precision[k] += n_c * M[k];
+  }
+
+  // Computes \f$T^{T} \Sigma^{-1} \sum_{c=1}^{C} (F_c - N_c ubmmean_{c})\f$
+  // in the first column of the right-hand side, the remaining ones being
+  // the identity matrix
+  double* rhs = posterior.rhs.data();
+  std::fill(rhs, rhs + Rt*P, 0.);
+  for (int k=1; k<P; ++k) rhs[(k-1)*P+k] = 1.;
+  for (int c=0; c<C; ++c) {
+    const double n_c = gs.n(c);
+    const double* M = Tct_sigmacInv + c*Rt*D;
+    for (int d=0; d<D; ++d) {
+      const double fnorm = gs.sumPx(c,d) - n_c * ubm_mean(c*D+d);
+      for (int k=0; k<Rt; ++k) rhs[k*P] += M[k*D+d] * fnorm;
+    }
+  }
+
+  bob::math::linsolveSympos_(posterior.precision, posterior.solution,
+    posterior.rhs);
+}
+
+/**
+ * @brief Extracts the ivectors of the GMMStats [begin, end), using its own
+ * workspace.
+ */
+static void forwardChunk(const bob::machine::IVectorMachine& machine,
+  const std::vector<bob::machine::GMMStats>& input,
+  blitz::Array<double,2>& output, const size_t thread, const size_t begin,
+  const size_t end)
+{
+  const int Rt = (int)machine.getDimRt();
+  bob::machine::IVectorMachine::Posterior posterior(Rt, false);
+  for (size_t i=begin; i<end; ++i) {
+    machine.computePosterior_(input[i], posterior);
+    for (int k=0; k<Rt; ++k) output((int)i,k) = posterior.solution(k,0);
+  }
+}
+
+void bob::machine::IVectorMachine::forward(
+  const std::vector<bob::machine::GMMStats>& input,
+  blitz::Array<double,2>& output, const size_t n_threads) const
+{
+  bob::core::array::assertSameDimensionLength(output.extent(0), (int)input.size());
+  bob::core::array::assertSameDimensionLength(output.extent(1), (int)m_rt);
+  // Updates the (lazily computed) supervectors of the UBM before starting
+  // the threads
+  m_ubm->getMeanSupervector();
+  bob::core::parallel_for(boost::bind(&forwardChunk, boost::cref(*this),
+        boost::cref(input), boost::ref(output), _1, _2, _3),
+      input.size(), n_threads);
 }
 
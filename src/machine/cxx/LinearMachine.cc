@@ -27,6 +27,8 @@
 #include <bob/core/array_copy.h>
 #include <bob/machine/LinearMachine.h>
 #include <bob/math/linear.h>
+#include <bob/math/gemm.h>
+#include <bob/core/assert.h>
 
 bob::machine::LinearMachine::LinearMachine(const blitz::Array<double,2>& weight)
   : m_input_sub(weight.extent(0)),
@@ -185,6 +187,33 @@ void bob::machine::LinearMachine::forward
   forward_(input, output);
 }
 
+void bob::machine::LinearMachine::forward_
+(const blitz::Array<double,2>& input, blitz::Array<double,2>& output) const {
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  blitz::Array<double,2> normalized(input.shape());
+  normalized = (input(i,j) - m_input_sub(j)) / m_input_div(j);
+  output = m_bias(j);
+  bob::math::gemm_(normalized, m_weight, output, false, false, 1., 1.);
+  m_activation->f_inplace(output);
+}
+
+void bob::machine::LinearMachine::forward
+(const blitz::Array<double,2>& input, blitz::Array<double,2>& output) const {
+  if (m_weight.extent(0) != input.extent(1)) { //checks input dimension
+    boost::format m("mismatch on the input dimension: expected a matrix with %d columns, but you input one with %d columns instead");
+    m % m_weight.extent(0) % input.extent(1);
+    throw std::runtime_error(m.str());
+  }
+  if (m_weight.extent(1) != output.extent(1)) { //checks output dimension
+    boost::format m("mismatch on the output dimension: expected a matrix with %d columns, but you input one with %d columns instead");
+    m % m_weight.extent(1) % output.extent(1);
+    throw std::runtime_error(m.str());
+  }
+  bob::core::array::assertSameDimensionLength(input.extent(0), output.extent(0));
+  forward_(input, output);
+}
+
 void bob::machine::LinearMachine::setWeights
 (const blitz::Array<double,2>& weight) {
   if (weight.extent(0) != m_input_sub.extent(0)) { //checks 1st dimension
@@ -17,20 +17,105 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+
 #include <bob/machine/LinearScoring.h>
-#include <bob/math/linear.h>
+#include <bob/math/gemm.h>
+#include <bob/core/assert.h>
+#include <bob/core/parallel.h>
+#include <limits>
 
 namespace bob { namespace machine {
 
 namespace detail {
 
-  void linearScoring(const std::vector<blitz::Array<double,1> >& models,
+  /**
+   * Computes the scores of the models [begin, end) (or of the test trials
+   * [begin, end) if split_models is false) using a single matrix product
+   */
+  static void linearScoringChunk(const blitz::Array<double,2>& A,
+    const blitz::Array<double,2>& B, blitz::Array<double,2>& scores,
+    const bool split_models, const size_t thread, const size_t begin,
+    const size_t end)
+  {
+    // The chunks are wrapped (without any reference counting) around the
+    // memory of A and B, as blitz views are not thread-safe
+    const int CD = A.extent(1);
+    const int n = end - begin;
+    const int Tm = (split_models ? n : A.extent(0));
+    const int Tt = (split_models ? B.extent(0) : n);
+    const blitz::Array<double,2> A_chunk(const_cast<double*>(A.data()) +
+        (split_models ? begin*CD : 0), blitz::shape(Tm, CD),
+        blitz::neverDeleteData);
+    const blitz::Array<double,2> B_chunk(const_cast<double*>(B.data()) +
+        (split_models ? 0 : begin*CD), blitz::shape(Tt, CD),
+        blitz::neverDeleteData);
+    blitz::Array<double,2> scores_chunk(Tm, Tt);
+    bob::math::gemm_(A_chunk, B_chunk, scores_chunk, false, true);
+
+    const int m0 = (split_models ? begin : 0);
+    const int t0 = (split_models ? 0 : begin);
+    for (int m=0; m<Tm; ++m)
+      for (int t=0; t<Tt; ++t)
+        scores(m0+m, t0+t) = scores_chunk(m, t);
+  }
+
+  /**
+   * Computes scores = A.B^T, where A contains the (normalised) offsets of 
+   * the models (one per row), and B the (normalised) first order 
+   * statistics of the test trials (one per row). Both should be 
+   * C-contiguous. If several threads are used, the product is split 
+   * along the largest dimension of the score matrix.
+   */
+  static void linearScoring(const blitz::Array<double,2>& A,
+    const blitz::Array<double,2>& B, blitz::Array<double,2>& scores,
+    const size_t n_threads)
+  {
+    const int Tm = A.extent(0);
+    const int Tt = B.extent(0);
+    const bool split_models = (Tm >= Tt);
+    const size_t n = 
+      bob::core::parallel_threads(split_models ? Tm : Tt, n_threads);
+    if (n == 1) 
+      bob::math::gemm(A, B, scores, false, true);
+    else
+      bob::core::parallel_for(boost::bind(&linearScoringChunk, boost::cref(A),
+          boost::cref(B), boost::ref(scores), split_models, _1, _2, _3),
+        split_models ? Tm : Tt, n);
+  }
+
+  /**
+   * Applies the frame length normalisation to the statistics of a test
+   * trial
+   */
+  static void normaliseFrameLength(blitz::Array<double,1> b, const double T)
+  {
+    if (T <= std::numeric_limits<double>::epsilon() && 
+        T >= -std::numeric_limits<double>::epsilon())
+      b = 0;
+    else 
+      b /= T;
+  }
+
+  /**
+   * Computes the normalised offsets of the models (one per row)
+   */
+  static void modelOffsets(const std::vector<blitz::Array<double,1> >& models,
+    const blitz::Array<double,1>& ubm_mean,
+    const blitz::Array<double,1>& ubm_variance, blitz::Array<double,2>& A)
+  {
+    for (size_t t=0; t<models.size(); ++t) {
+      blitz::Array<double, 1> tmp = A(t, blitz::Range::all());
+      tmp = (models[t] - ubm_mean) / ubm_variance;
+    }
+  }
+
+  static void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                      const blitz::Array<double,1>& ubm_mean,
                      const blitz::Array<double,1>& ubm_variance,
                      const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                      const std::vector<blitz::Array<double,1> >* test_channelOffset,
                      const bool frame_length_normalisation,
-                     blitz::Array<double,2>& scores) 
+                     blitz::Array<double,2>& scores, const size_t n_threads) 
   {
     int C = test_stats[0]->sumPx.extent(0);
     int D = test_stats[0]->sumPx.extent(1);
@@ -43,46 +128,104 @@ namespace detail {
     bob::core::array::assertSameDimensionLength(scores.extent(1), test_stats.size());
 
     blitz::Array<double,2> A(Tm, CD);
-    blitz::Array<double,2> B(CD, Tt);
+    blitz::Array<double,2> B(Tt, CD);
 
     // 1) Compute A
-    for(int t=0; t<Tm; ++t) {
-      blitz::Array<double, 1> tmp = A(t, blitz::Range::all());
-      tmp = (models[t] - ubm_mean) / ubm_variance;
-    }
+    modelOffsets(models, ubm_mean, ubm_variance, A);
 
     // 2) Compute B
-    if(test_channelOffset == 0) {
-      for(int t=0; t<Tt; ++t) 
-        for(int s=0; s<CD; ++s)
-          B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (ubm_mean(s) * test_stats[t]->n(s/D));
-    }
-    else {
+    if (test_channelOffset != 0) 
       bob::core::array::assertSameDimensionLength((*test_channelOffset).size(), Tt);
-      
-      for(int t=0; t<Tt; ++t) {
+    for (int t=0; t<Tt; ++t) {
+      const bob::machine::GMMStats& stats = *test_stats[t];
+      if (test_channelOffset != 0)
         bob::core::array::assertSameDimensionLength((*test_channelOffset)[t].extent(0), CD);
-        for(int s=0; s<CD; ++s) 
-          B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (test_stats[t]->n(s/D) * (ubm_mean(s) + (*test_channelOffset)[t](s)));
-      }
+      for (int c=0; c<C; ++c)
+        for (int d=0; d<D; ++d) {
+          const int s = c*D + d;
+          double offset = ubm_mean(s);
+          if (test_channelOffset != 0) offset += (*test_channelOffset)[t](s);
+          B(t, s) = stats.sumPx(c, d) - stats.n(c) * offset;
+        }
+
+      // Apply the normalisation if needed
+      if (frame_length_normalisation)
+        normaliseFrameLength(B(t, blitz::Range::all()), stats.T);
     }
 
-    // Apply the normalisation if needed
-    if(frame_length_normalisation) {
-      for(int t=0; t<Tt; ++t) {
-        double sum_N = test_stats[t]->T;
-        blitz::Array<double, 1> v_t = B(blitz::Range::all(),t);
-
-        if (sum_N <= std::numeric_limits<double>::epsilon() && sum_N >= -std::numeric_limits<double>::epsilon())
-          v_t = 0;
-        else 
-          v_t /= sum_N;
-      }
+    // 3) Compute LLR
+    linearScoring(A, B, scores, n_threads);
+  } 
+
+  static void linearScoring(const blitz::Array<double,2>& models,
+                     const blitz::Array<double,1>& ubm_mean,
+                     const blitz::Array<double,1>& ubm_variance,
+                     const blitz::Array<double,2>& test_n,
+                     const blitz::Array<double,2>& test_sumPx,
+                     const blitz::Array<double,1>& test_T,
+                     const blitz::Array<double,2>* test_channelOffset,
+                     const bool frame_length_normalisation,
+                     blitz::Array<double,2>& scores, const size_t n_threads) 
+  {
+    const int Tm = models.extent(0);
+    const int Tt = test_sumPx.extent(0);
+    const int C = test_n.extent(1);
+    const int CD = models.extent(1);
+    const int D = (C > 0 ? CD / C : 0);
+
+    // Check input and output sizes
+    bob::core::array::assertSameDimensionLength(ubm_mean.extent(0), CD);
+    bob::core::array::assertSameDimensionLength(ubm_variance.extent(0), CD);
+    bob::core::array::assertSameDimensionLength(test_n.extent(0), Tt);
+    bob::core::array::assertSameDimensionLength(test_sumPx.extent(1), CD);
+    bob::core::array::assertSameDimensionLength(C*D, CD);
+    bob::core::array::assertSameDimensionLength(test_T.extent(0), Tt);
+    if (test_channelOffset != 0) {
+      bob::core::array::assertSameDimensionLength(test_channelOffset->extent(0), Tt);
+      bob::core::array::assertSameDimensionLength(test_channelOffset->extent(1), CD);
+    }
+    bob::core::array::assertSameDimensionLength(scores.extent(0), Tm);
+    bob::core::array::assertSameDimensionLength(scores.extent(1), Tt);
+
+    // 1) Compute A
+    blitz::Array<double,2> A(Tm, CD);
+    blitz::firstIndex i;
+    blitz::secondIndex j;
+    A = (models(i,j) - ubm_mean(j)) / ubm_variance(j);
+
+    // 2) Compute B
+    blitz::Array<double,2> B(Tt, CD);
+    for (int t=0; t<Tt; ++t) {
+      for (int c=0; c<C; ++c)
+        for (int d=0; d<D; ++d) {
+          const int s = c*D + d;
+          double offset = ubm_mean(s);
+          if (test_channelOffset != 0) offset += (*test_channelOffset)(t, s);
+          B(t, s) = test_sumPx(t, s) - test_n(t, c) * offset;
+        }
+
+      // Apply the normalisation if needed
+      if (frame_length_normalisation)
+        normaliseFrameLength(B(t, blitz::Range::all()), test_T(t));
     }
 
     // 3) Compute LLR
-    bob::math::prod(A, B, scores);
+    linearScoring(A, B, scores, n_threads);
   } 
+
+  static void meanSupervectors(
+    const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
+    const bob::machine::GMMMachine& ubm,
+    std::vector<blitz::Array<double,1> >& models_b)
+  {
+    const int CD = ubm.getNGaussians() * ubm.getNInputs();
+    // Allocate and get the mean supervector
+    for(size_t i=0; i<models.size(); ++i) {
+      blitz::Array<double,1> mod(CD);
+      models[i]->getMeanSupervector(mod);
+      models_b.push_back(mod);
+    }
+  }
 }
 
 
@@ -91,39 +234,31 @@ void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double,1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores)
+                   blitz::Array<double, 2>& scores, const size_t n_threads)
 {
-  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, &test_channelOffset, frame_length_normalisation, scores);
+  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, &test_channelOffset, frame_length_normalisation, scores, n_threads);
 }
 
 void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores)
+                   blitz::Array<double, 2>& scores, const size_t n_threads)
 {
-  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, 0, frame_length_normalisation, scores);
+  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, 0, frame_length_normalisation, scores, n_threads);
 }
 
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
                    const bob::machine::GMMMachine& ubm,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores) 
+                   blitz::Array<double, 2>& scores, const size_t n_threads) 
 {
-  int C = test_stats[0]->sumPx.extent(0);
-  int D = test_stats[0]->sumPx.extent(1);
-  int CD = C*D;
   std::vector<blitz::Array<double,1> > models_b;
-  // Allocate and get the mean supervector
-  for(size_t i=0; i<models.size(); ++i) {
-    blitz::Array<double,1> mod(CD);
-    models[i]->getMeanSupervector(mod);
-    models_b.push_back(mod);
-  }
+  detail::meanSupervectors(models, ubm, models_b);
   const blitz::Array<double,1>& ubm_mean = ubm.getMeanSupervector();
   const blitz::Array<double,1>& ubm_variance = ubm.getVarianceSupervector();
-  detail::linearScoring(models_b, ubm_mean, ubm_variance, test_stats, 0, frame_length_normalisation, scores);
+  detail::linearScoring(models_b, ubm_mean, ubm_variance, test_stats, 0, frame_length_normalisation, scores, n_threads);
 }
 
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
@@ -131,21 +266,36 @@ void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMa
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double,1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores) 
+                   blitz::Array<double, 2>& scores, const size_t n_threads) 
 {
-  int C = test_stats[0]->sumPx.extent(0);
-  int D = test_stats[0]->sumPx.extent(1);
-  int CD = C*D;
   std::vector<blitz::Array<double,1> > models_b;
-  // Allocate and get the mean supervector
-  for(size_t i=0; i<models.size(); ++i) {
-    blitz::Array<double,1> mod(CD);
-    models[i]->getMeanSupervector(mod);
-    models_b.push_back(mod);
-  }
+  detail::meanSupervectors(models, ubm, models_b);
   const blitz::Array<double,1>& ubm_mean = ubm.getMeanSupervector();
   const blitz::Array<double,1>& ubm_variance = ubm.getVarianceSupervector();
-  detail::linearScoring(models_b, ubm_mean, ubm_variance, test_stats, &test_channelOffset, frame_length_normalisation, scores);
+  detail::linearScoring(models_b, ubm_mean, ubm_variance, test_stats, &test_channelOffset, frame_length_normalisation, scores, n_threads);
+}
+
+void linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const blitz::Array<double,2>& test_n,
+                   const blitz::Array<double,2>& test_sumPx,
+                   const blitz::Array<double,1>& test_T,
+                   const bool frame_length_normalisation,
+                   blitz::Array<double, 2>& scores, const size_t n_threads)
+{
+  detail::linearScoring(models, ubm_mean, ubm_variance, test_n, test_sumPx, test_T, 0, frame_length_normalisation, scores, n_threads);
+}
+
+void linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const blitz::Array<double,2>& test_n,
+                   const blitz::Array<double,2>& test_sumPx,
+                   const blitz::Array<double,1>& test_T,
+                   const blitz::Array<double,2>& test_channelOffset,
+                   const bool frame_length_normalisation,
+                   blitz::Array<double, 2>& scores, const size_t n_threads)
+{
+  detail::linearScoring(models, ubm_mean, ubm_variance, test_n, test_sumPx, test_T, &test_channelOffset, frame_length_normalisation, scores, n_threads);
 }
 
 }}
@@ -30,6 +30,7 @@
 #include <bob/core/assert.h>
 #include <bob/machine/MLP.h>
 #include <bob/math/linear.h>
+#include <bob/math/gemm.h>
 
 bob::machine::MLP::MLP (size_t input, size_t output):
   m_input_sub(input),
@@ -122,6 +123,7 @@ bob::machine::MLP& bob::machine::MLP::operator= (const MLP& other) {
     m_hidden_activation = other.m_hidden_activation;
     m_output_activation = other.m_output_activation;
     m_buffer.resize(other.m_buffer.size());
+    m_batch_buffer.clear();
     for (size_t i=0; i<other.m_weight.size(); ++i) {
       m_weight[i].reference(bob::core::array::ccopy(other.m_weight[i]));
       m_bias[i].reference(bob::core::array::ccopy(other.m_bias[i]));
@@ -264,11 +266,32 @@ void bob::machine::MLP::forward (const blitz::Array<double,1>& input,
 void bob::machine::MLP::forward_ (const blitz::Array<double,2>& input,
     blitz::Array<double,2>& output) {
 
-  blitz::Range all = blitz::Range::all();
-  for (int i=0; i<input.extent(0); ++i) {
-    blitz::Array<double,1> inref(input(i,all));
-    blitz::Array<double,1> outref(output(i,all));
-    forward_(inref, outref);
+  //doesn't check input, just computes
+  const int n_inputs = input.extent(0);
+  if (n_inputs == 0) return;
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+
+  //m_batch_buffer[0] keeps the normalized inputs, and m_batch_buffer[k] the
+  //outputs of the k-th layer
+  m_batch_buffer.resize(m_weight.size());
+  if (m_batch_buffer[0].extent(0) != n_inputs || 
+      m_batch_buffer[0].extent(1) != input.extent(1))
+    m_batch_buffer[0].resize(n_inputs, input.extent(1));
+  m_batch_buffer[0] = (input(i,j) - m_input_sub(j)) / m_input_div(j);
+
+  for (size_t k=0; k<m_weight.size(); ++k) {
+    const bool last = (k == m_weight.size()-1);
+    if (!last && (m_batch_buffer[k+1].extent(0) != n_inputs ||
+          m_batch_buffer[k+1].extent(1) != m_weight[k].extent(1)))
+      m_batch_buffer[k+1].resize(n_inputs, m_weight[k].extent(1));
+    blitz::Array<double,2>& out = (last ? output : m_batch_buffer[k+1]);
+
+    //out = bias + in * weight, followed by the activation
+    out = m_bias[k](j);
+    bob::math::gemm_(m_batch_buffer[k], m_weight[k], out, false, false, 1., 1.);
+    if (last) m_output_activation->f_inplace(out);
+    else m_hidden_activation->f_inplace(out);
   }
 }
 
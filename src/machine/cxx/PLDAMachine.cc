@@ -26,6 +26,7 @@
 #include <bob/machine/Exception.h>
 #include <bob/machine/PLDAMachine.h>
 #include <bob/math/linear.h>
+#include <bob/math/gemm.h>
 #include <bob/math/det.h>
 #include <bob/math/inv.h>
 
@@ -961,3 +962,116 @@ void bob::machine::PLDAMachine::resizeTmp()
     m_tmp_nf_nf_1.resize(getDimF(), getDimF());
   }
 }
+
+
+/**
+ * @brief Gets (from the caches of the machine) or computes gamma_a
+ */
+static void pldaGamma(const bob::machine::PLDAMachine& machine,
+  const size_t a, blitz::Array<double,2>& gamma_a)
+{
+  if (machine.getPLDABase()->hasGamma(a) || machine.hasGamma(a))
+    gamma_a = machine.getGamma(a);
+  else
+    machine.getPLDABase()->computeGamma(a, gamma_a);
+}
+
+/**
+ * @brief Gets (from the caches of the machine) or computes the log 
+ * likelihood constant term for a samples
+ */
+static double pldaLogLikeConstTerm(const bob::machine::PLDAMachine& machine,
+  const size_t a, const blitz::Array<double,2>& gamma_a)
+{
+  if (machine.getPLDABase()->hasLogLikeConstTerm(a) ||
+      machine.hasLogLikeConstTerm(a))
+    return machine.getLogLikeConstTerm(a);
+  else
+    return machine.getPLDABase()->computeLogLikeConstTerm(a, gamma_a);
+}
+
+void bob::machine::pldaScoring(
+  const std::vector<boost::shared_ptr<const bob::machine::PLDAMachine> >& models,
+  const blitz::Array<double,2>& probes, blitz::Array<double,2>& scores)
+{
+  const int n_models = models.size();
+  const int n_probes = probes.extent(0);
+  bob::core::array::assertSameDimensionLength(scores.extent(0), n_models);
+  bob::core::array::assertSameDimensionLength(scores.extent(1), n_probes);
+  if (n_models == 0 || n_probes == 0) return;
+
+  const boost::shared_ptr<bob::machine::PLDABase> base =
+    models[0]->getPLDABase();
+  if (!base)
+    throw std::runtime_error("No PLDABase set to this machine");
+  for (int m=1; m<n_models; ++m)
+    if (models[m]->getPLDABase() != base)
+      throw std::runtime_error("All the PLDAMachine's should share the same PLDABase");
+  const int dim_d = base->getDimD();
+  const int dim_f = base->getDimF();
+  bob::core::array::assertSameDimensionLength(probes.extent(1), dim_d);
+
+  // Projections of the probes: f = F^T.beta.(x-mu) (one per row)
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  const blitz::Array<double,1>& mu = base->getMu();
+  blitz::Array<double,2> probes_c(n_probes, dim_d);
+  probes_c = probes(i,j) - mu(j);
+  blitz::Array<double,2> f(n_probes, dim_f);
+  bob::math::gemm(probes_c, base->getFtBeta(), f, false, true);
+
+  // Terms of the score which do not depend on the enrolled samples
+  blitz::Array<double,2> gamma_1(dim_f, dim_f);
+  pldaGamma(*models[0], 1, gamma_1);
+  const double constterm_1 = pldaLogLikeConstTerm(*models[0], 1, gamma_1);
+
+  // Groups the models by number of enrollment samples
+  std::map<uint64_t, std::vector<int> > groups;
+  for (int m=0; m<n_models; ++m)
+    groups[models[m]->getNSamples()].push_back(m);
+
+  blitz::Array<double,2> gamma_a(dim_f, dim_f);
+  blitz::Array<double,2> f_gamma(n_probes, dim_f);
+  blitz::Array<double,1> quad(n_probes);
+  for (std::map<uint64_t, std::vector<int> >::const_iterator it=groups.begin();
+      it!=groups.end(); ++it)
+  {
+    const size_t a = it->first + 1;
+    const std::vector<int>& group = it->second;
+    const int n_group = group.size();
+    pldaGamma(*models[group[0]], a, gamma_a);
+    const double constterm_a =
+      pldaLogLikeConstTerm(*models[group[0]], a, gamma_a);
+
+    // Quadratic term of the probes: 1/2.f^T.(gamma_a-gamma_1).f
+    gamma_a -= gamma_1;
+    bob::math::gemm(f, gamma_a, f_gamma, false, true);
+    quad = 0.5 * blitz::sum(f(i,j) * f_gamma(i,j), j);
+    gamma_a += gamma_1;
+
+    // Weighted sums of the enrolled samples (one per row)
+    blitz::Array<double,2> w(n_group, dim_f);
+    for (int k=0; k<n_group; ++k) {
+      if (it->first > 0)
+        w(k, blitz::Range::all()) = models[group[k]]->getWeightedSum();
+      else
+        w(k, blitz::Range::all()) = 0.;
+    }
+
+    // Cross terms w^T.gamma_a.f
+    blitz::Array<double,2> w_gamma(n_group, dim_f);
+    bob::math::gemm(w, gamma_a, w_gamma, false, false);
+    blitz::Array<double,2> cross(n_group, n_probes);
+    bob::math::gemm(w_gamma, f, cross, false, true);
+
+    for (int k=0; k<n_group; ++k) {
+      const bob::machine::PLDAMachine& model = *models[group[k]];
+      // Constant term of the model
+      double c = 0.;
+      for (int l=0; l<dim_f; ++l) c += w(k,l) * w_gamma(k,l);
+      c = model.getWSumXitBetaXi() + 0.5 * c + constterm_a - constterm_1 -
+        model.getLogLikelihood();
+      scores(group[k], blitz::Range::all()) = c + cross(k, blitz::Range::all()) + quad;
+    }
+  }
+}
@@ -21,7 +21,12 @@
 
 #include <bob/machine/ZTNorm.h>
 #include <bob/core/assert.h>
+#include <bob/core/parallel.h>
+#include <boost/format.hpp>
+#include <algorithm>
 #include <limits>
+#include <stdexcept>
+#include <vector>
 
 namespace bob { 
 namespace machine {
@@ -158,6 +163,316 @@ namespace detail {
     else
       scores = zA;
   }
+
+  /**
+   * A block of consecutive rows of a score matrix, along with the
+   * corresponding rows of the Z-Norm cohort scores or of the mask, and
+   * the statistics computed over its columns.
+   */
+  struct RowBlock {
+    int offset; ///< index of the first row of the block
+    blitz::Array<double,2> scores;
+    blitz::Array<double,2> zscores;
+    blitz::Array<bool,2> mask;
+    blitz::Array<double,1> mean;
+    blitz::Array<double,1> m2; ///< sum of squared deviations from the mean
+  };
+
+  /**
+   * Gets the size of a matrix of scores stored in an HDF5 file, either as
+   * a 2D dataset or as a list of 1D arrays
+   */
+  static void scoresShape(bob::io::HDF5File& file, const std::string& path,
+    int& rows, int& cols)
+  {
+    const bob::io::HDF5Descriptor& d = file.describe(path)[0];
+    if (d.type.shape().n() != 1) {
+      boost::format m("the dataset '%s' is not a matrix of scores");
+      m % path;
+      throw std::runtime_error(m.str());
+    }
+    rows = d.size;
+    cols = d.type.shape()[0];
+  }
+
+  template <typename T>
+  static void readRows(bob::io::HDF5File& file, const std::string& path,
+    const int offset, const int cols, blitz::Array<T,2>& block)
+  {
+    blitz::Array<T,1> row(cols);
+    for (int i=0; i<block.extent(0); ++i) {
+      file.readArray(path, offset+i, row);
+      block(i, blitz::Range::all()) = row;
+    }
+  }
+
+  /**
+   * Reads the blocks of rows processed in parallel, starting at row first
+   * of the matrix of scores (and of the optional Z-Norm cohort scores and
+   * mask), and returns the number of rows read.
+   */
+  static int readBatch(bob::io::HDF5File& file, const std::string& path,
+    const std::string* zpath, const std::string* mask_path, const int first,
+    const int rows, const int cols, const int zcols, const int block_size,
+    const size_t n_threads, std::vector<RowBlock>& blocks)
+  {
+    const size_t n_blocks = bob::core::parallel_threads(
+      (rows - first + block_size - 1) / block_size, n_threads);
+    blocks.resize(n_blocks);
+    int offset = first;
+    for (size_t b=0; b<n_blocks; ++b) {
+      RowBlock& block = blocks[b];
+      const int n = std::min(block_size, rows - offset);
+      block.offset = offset;
+      block.scores.resize(n, cols);
+      readRows(file, path, offset, cols, block.scores);
+      if (zpath) {
+        block.zscores.resize(n, zcols);
+        readRows(file, *zpath, offset, zcols, block.zscores);
+      }
+      if (mask_path) {
+        block.mask.resize(n, cols);
+        readRows(file, *mask_path, offset, cols, block.mask);
+      }
+      block.mean.resize(cols);
+      block.m2.resize(cols);
+      offset += n;
+    }
+    return offset - first;
+  }
+
+  /**
+   * Computes the mean and the standard deviation of the rows of the
+   * Z-Norm scores of the T-Norm models (D), only considering impostors
+   */
+  static void impostorStatsBlocks(std::vector<RowBlock>& blocks,
+    const bool use_mask, blitz::Array<double,1>& mean_Dimp,
+    blitz::Array<double,1>& std_Dimp, const size_t thread,
+    const size_t begin, const size_t end)
+  {
+    const double eps = std::numeric_limits<double>::min();
+    for (size_t b=begin; b<end; ++b) {
+      const RowBlock& block = blocks[b];
+      for (int i=0; i<block.scores.extent(0); ++i) {
+        double sum = 0;
+        double sumsq = 0;
+        double count = 0;
+        for (int j=0; j<block.scores.extent(1); ++j) {
+          const bool keep = !use_mask || !block.mask(i, j);
+          const double value = keep * block.scores(i, j);
+          sum += value;
+          sumsq += value*value;
+          count += keep;
+        }
+        const double mean = sum / count;
+        double sd = 0;
+        if (count > 1)
+          sd = sqrt((sumsq - count * mean * mean) / (count -1));
+        mean_Dimp(block.offset + i) = mean;
+        std_Dimp(block.offset + i) = (sd <= eps ? 1. : sd);
+      }
+    }
+  }
+
+  /**
+   * Z-Normalises the T-Norm scores (C), if required, and computes the mean
+   * and the sum of squared deviations of each column of the blocks
+   */
+  static void tStatsBlocks(std::vector<RowBlock>& blocks, const bool use_D,
+    const blitz::Array<double,1>& mean_Dimp,
+    const blitz::Array<double,1>& std_Dimp, const size_t thread,
+    const size_t begin, const size_t end)
+  {
+    for (size_t b=begin; b<end; ++b) {
+      RowBlock& block = blocks[b];
+      const int n = block.scores.extent(0);
+      if (use_D) {
+        for (int i=0; i<n; ++i)
+          for (int j=0; j<block.scores.extent(1); ++j)
+            block.scores(i, j) = (block.scores(i, j) -
+              mean_Dimp(block.offset + i)) / std_Dimp(block.offset + i);
+      }
+      for (int j=0; j<block.scores.extent(1); ++j) {
+        double sum = 0;
+        for (int i=0; i<n; ++i) sum += block.scores(i, j);
+        const double mean = sum / n;
+        double m2 = 0;
+        for (int i=0; i<n; ++i) {
+          const double d = block.scores(i, j) - mean;
+          m2 += d*d;
+        }
+        block.mean(j) = mean;
+        block.m2(j) = m2;
+      }
+    }
+  }
+
+  /**
+   * Normalises the scores (A) of the blocks in place, using the Z-Norm
+   * cohort scores (B) of the blocks and the T-Norm statistics
+   */
+  static void normaliseBlocks(std::vector<RowBlock>& blocks, const bool use_B,
+    const bool use_C, const blitz::Array<double,1>& mean_zC,
+    const blitz::Array<double,1>& std_zC, const size_t thread,
+    const size_t begin, const size_t end)
+  {
+    const double eps = std::numeric_limits<double>::min();
+    for (size_t b=begin; b<end; ++b) {
+      RowBlock& block = blocks[b];
+      for (int i=0; i<block.scores.extent(0); ++i) {
+        if (use_B) {
+          const int size_znorm = block.zscores.extent(1);
+          double sum = 0;
+          for (int j=0; j<size_znorm; ++j) sum += block.zscores(i, j);
+          const double mean = sum / size_znorm;
+          double sd = 0;
+          if (size_znorm > 1) {
+            double sumsq = 0;
+            for (int j=0; j<size_znorm; ++j) {
+              const double d = block.zscores(i, j) - mean;
+              sumsq += d*d;
+            }
+            sd = sqrt(sumsq / (size_znorm - 1));
+          }
+          if (sd <= eps) sd = 1.;
+          for (int j=0; j<block.scores.extent(1); ++j)
+            block.scores(i, j) = (block.scores(i, j) - mean) / sd;
+        }
+        if (use_C) {
+          for (int j=0; j<block.scores.extent(1); ++j)
+            block.scores(i, j) = (block.scores(i, j) - mean_zC(j)) / std_zC(j);
+        }
+      }
+    }
+  }
+
+  void ztNorm(bob::io::HDF5File& file,
+              const std::string& rawscores_probes_vs_models,
+              const std::string* rawscores_zprobes_vs_models,
+              const std::string* rawscores_probes_vs_tmodels,
+              const std::string* rawscores_zprobes_vs_tmodels,
+              const std::string* mask_zprobes_vs_tmodels_istruetrial,
+              bob::io::HDF5File& output,
+              const std::string& normalizedscores,
+              const size_t block_size, const size_t n_threads)
+  {
+    // Rename variables
+    const std::string& A = rawscores_probes_vs_models;
+    const std::string* B = rawscores_zprobes_vs_models;
+    const std::string* C = rawscores_probes_vs_tmodels;
+    const std::string* D = rawscores_zprobes_vs_tmodels;
+    const std::string* mask = mask_zprobes_vs_tmodels_istruetrial;
+
+    // Compute the sizes and check the inputs
+    int size_eval, size_enrol, rows, cols;
+    scoresShape(file, A, size_eval, size_enrol);
+
+    int size_znorm = 0;
+    if (B) {
+      scoresShape(file, *B, rows, size_znorm);
+      if (size_znorm > 0)
+        bob::core::array::assertSameDimensionLength(rows, size_eval);
+    }
+
+    int size_tnorm = 0;
+    if (C) {
+      scoresShape(file, *C, size_tnorm, cols);
+      if (size_tnorm > 0)
+        bob::core::array::assertSameDimensionLength(cols, size_enrol);
+    }
+
+    const bool use_B = B && size_znorm > 0;
+    const bool use_C = C && size_tnorm > 0;
+    const bool use_D = D && use_B && use_C;
+    if (use_D) {
+      scoresShape(file, *D, rows, cols);
+      bob::core::array::assertSameDimensionLength(rows, size_tnorm);
+      bob::core::array::assertSameDimensionLength(cols, size_znorm);
+    }
+
+    if (mask) {
+      scoresShape(file, *mask, rows, cols);
+      bob::core::array::assertSameDimensionLength(rows, size_tnorm);
+      bob::core::array::assertSameDimensionLength(cols, size_znorm);
+    }
+
+    if (output.contains(normalizedscores)) {
+      boost::format m("the output dataset '%s' already exists");
+      m % normalizedscores;
+      throw std::runtime_error(m.str());
+    }
+
+    // The files are read (and written) sequentially, and the blocks of
+    // each batch are then processed in parallel
+    const int block = std::max(block_size, (size_t)1);
+    std::vector<RowBlock> blocks;
+
+    // Statistics of the impostor scores of the T-Norm models (D)
+    blitz::Array<double,1> mean_Dimp(size_tnorm);
+    blitz::Array<double,1> std_Dimp(size_tnorm);
+    if (use_D) {
+      for (int first=0; first<size_tnorm; ) {
+        first += readBatch(file, *D, 0, mask, first,
+          size_tnorm, size_znorm, 0, block, n_threads, blocks);
+        bob::core::parallel_for(boost::bind(&impostorStatsBlocks,
+              boost::ref(blocks), mask != 0, boost::ref(mean_Dimp),
+              boost::ref(std_Dimp), _1, _2, _3),
+            blocks.size(), n_threads);
+      }
+    }
+
+    // Statistics of the columns of the Z-Normalised T-Norm scores (zC),
+    // merged block after block
+    blitz::Array<double,1> mean_zC(size_enrol);
+    blitz::Array<double,1> std_zC(size_enrol);
+    if (use_C) {
+      blitz::Array<double,1> m2_zC(size_enrol);
+      mean_zC = 0.;
+      m2_zC = 0.;
+      double count = 0;
+      for (int first=0; first<size_tnorm; ) {
+        first += readBatch(file, *C, 0, 0, first, size_tnorm, size_enrol, 0,
+          block, n_threads, blocks);
+        bob::core::parallel_for(boost::bind(&tStatsBlocks,
+              boost::ref(blocks), use_D, boost::cref(mean_Dimp),
+              boost::cref(std_Dimp), _1, _2, _3),
+            blocks.size(), n_threads);
+        for (size_t b=0; b<blocks.size(); ++b) {
+          const double n = blocks[b].scores.extent(0);
+          const double total = count + n;
+          for (int j=0; j<size_enrol; ++j) {
+            const double delta = blocks[b].mean(j) - mean_zC(j);
+            mean_zC(j) += delta * n / total;
+            m2_zC(j) += blocks[b].m2(j) + delta * delta * count * n / total;
+          }
+          count = total;
+        }
+      }
+
+      const double eps = std::numeric_limits<double>::min();
+      if (size_tnorm > 1)
+        std_zC = blitz::sqrt(m2_zC / (size_tnorm - 1));
+      else // 1 single value -> std = 0
+        std_zC = 0;
+      std_zC = blitz::where(std_zC <= eps, 1., std_zC);
+    }
+
+    // Normalised scores
+    for (int first=0; first<size_eval; ) {
+      first += readBatch(file, A, (use_B ? B : 0), 0, first, size_eval,
+        size_enrol, size_znorm, block, n_threads, blocks);
+      bob::core::parallel_for(boost::bind(&normaliseBlocks,
+            boost::ref(blocks), use_B, use_C, boost::cref(mean_zC),
+            boost::cref(std_zC), _1, _2, _3),
+          blocks.size(), n_threads);
+      for (size_t b=0; b<blocks.size(); ++b)
+        for (int i=0; i<blocks[b].scores.extent(0); ++i) {
+          const blitz::Array<double,1> row =
+            blocks[b].scores(i, blitz::Range::all());
+          output.appendArray(normalizedscores, row);
+        }
+    }
+  }
 }
 
 void ztNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
@@ -197,4 +512,58 @@ void zNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
                  NULL, NULL, scores);
 }
 
+void ztNorm(bob::io::HDF5File& file,
+            const std::string& rawscores_probes_vs_models,
+            const std::string& rawscores_zprobes_vs_models,
+            const std::string& rawscores_probes_vs_tmodels,
+            const std::string& rawscores_zprobes_vs_tmodels,
+            const std::string& mask_zprobes_vs_tmodels_istruetrial,
+            bob::io::HDF5File& output,
+            const std::string& normalizedscores,
+            const size_t block_size, const size_t n_threads)
+{
+  detail::ztNorm(file, rawscores_probes_vs_models, &rawscores_zprobes_vs_models,
+                 &rawscores_probes_vs_tmodels, &rawscores_zprobes_vs_tmodels,
+                 &mask_zprobes_vs_tmodels_istruetrial, output, normalizedscores,
+                 block_size, n_threads);
+}
+
+void ztNorm(bob::io::HDF5File& file,
+            const std::string& rawscores_probes_vs_models,
+            const std::string& rawscores_zprobes_vs_models,
+            const std::string& rawscores_probes_vs_tmodels,
+            const std::string& rawscores_zprobes_vs_tmodels,
+            bob::io::HDF5File& output,
+            const std::string& normalizedscores,
+            const size_t block_size, const size_t n_threads)
+{
+  detail::ztNorm(file, rawscores_probes_vs_models, &rawscores_zprobes_vs_models,
+                 &rawscores_probes_vs_tmodels, &rawscores_zprobes_vs_tmodels,
+                 NULL, output, normalizedscores, block_size, n_threads);
+}
+
+void tNorm(bob::io::HDF5File& file,
+           const std::string& rawscores_probes_vs_models,
+           const std::string& rawscores_probes_vs_tmodels,
+           bob::io::HDF5File& output,
+           const std::string& normalizedscores,
+           const size_t block_size, const size_t n_threads)
+{
+  detail::ztNorm(file, rawscores_probes_vs_models, NULL,
+                 &rawscores_probes_vs_tmodels, NULL, NULL, output,
+                 normalizedscores, block_size, n_threads);
+}
+
+void zNorm(bob::io::HDF5File& file,
+           const std::string& rawscores_probes_vs_models,
+           const std::string& rawscores_zprobes_vs_models,
+           bob::io::HDF5File& output,
+           const std::string& normalizedscores,
+           const size_t block_size, const size_t n_threads)
+{
+  detail::ztNorm(file, rawscores_probes_vs_models, &rawscores_zprobes_vs_models,
+                 NULL, NULL, NULL, output, normalizedscores, block_size,
+                 n_threads);
+}
+
 }}
@@ -28,6 +28,7 @@
 #include <bob/machine/GaborGraphMachine.h>
 #include <bob/machine/GaborJetSimilarities.h>
 #include <bob/core/array_exception.h>
+#include <bob/core/cast.h>
 
 
 static void bob_extract(bob::machine::GaborGraphMachine& self, bob::python::const_ndarray input_jet_image, bob::python::ndarray output_graph){
@@ -58,6 +59,28 @@ static bob::python::ndarray bob_extract2(bob::machine::GaborGraphMachine& self,
   } else throw bob::core::array::UnexpectedShapeError();
 }
 
+static bob::python::ndarray bob_extract_from_image(bob::machine::GaborGraphMachine& self, bob::ip::GaborWaveletTransform& gwt, bob::python::const_ndarray input_image, bool include_phases, bool normalized){
+  blitz::Array<std::complex<double>,2> image;
+  switch (input_image.type().dtype){
+    case bob::core::array::t_uint8: image.reference(bob::core::array::cast<std::complex<double> >(input_image.bz<uint8_t,2>())); break;
+    case bob::core::array::t_uint16: image.reference(bob::core::array::cast<std::complex<double> >(input_image.bz<uint16_t,2>())); break;
+    case bob::core::array::t_float64: image.reference(bob::core::array::cast<std::complex<double> >(input_image.bz<double,2>())); break;
+    case bob::core::array::t_complex128: image.reference(input_image.bz<std::complex<double>,2>()); break;
+    default: throw bob::core::Exception();
+  }
+  if (include_phases){
+    bob::python::ndarray output_graph(bob::core::array::t_float64, self.numberOfNodes(), 2, (int)gwt.numberOfKernels());
+    blitz::Array<double,3> graph = output_graph.bz<double,3>();
+    self.extract(gwt, image, graph, normalized);
+    return output_graph;
+  } else {
+    bob::python::ndarray output_graph(bob::core::array::t_float64, self.numberOfNodes(), (int)gwt.numberOfKernels());
+    blitz::Array<double,2> graph = output_graph.bz<double,2>();
+    self.extract(gwt, image, graph, normalized);
+    return output_graph;
+  }
+}
+
 static void bob_average(bob::machine::GaborGraphMachine& self, bob::python::const_ndarray many_graph_jets, bob::python::ndarray averaged_graph_jets){
   const blitz::Array<double,4> graph_set = many_graph_jets.bz<double,4>();
   blitz::Array<double,3> graph = averaged_graph_jets.bz<double,3>();
@@ -247,6 +270,13 @@ void bind_machine_gabor(){
       "Extracts and returns the Gabor jets at the desired locations from the given Gabor jet image"
     )
 
+    .def(
+      "extract_from_image",
+      &bob_extract_from_image,
+      (boost::python::arg("self"), boost::python::arg("gwt"), boost::python::arg("image"), boost::python::arg("include_phases")=true, boost::python::arg("normalized")=true),
+      "Extracts and returns the Gabor jets at the desired locations directly from the given gray image, using the Gabor wavelet transform (gwt). If the graph has at most gwt.sparse_jets_crossover(image.shape) nodes, the jets are computed at the node positions only (see gwt.compute_sparse_jets()), otherwise the whole Gabor jet image is computed and the jets are extracted from it."
+    )
+
     .def(
       "average",
       &bob_average,
@@ -113,6 +113,16 @@ static object py_iv_forward2(const bob::machine::IVectorMachine& machine,
   return ivector.self();
 }
 
+static object py_iv_forward3(const bob::machine::IVectorMachine& machine,
+  object data, const size_t n_threads)
+{
+  stl_input_iterator<bob::machine::GMMStats> dbegin(data), dend;
+  std::vector<bob::machine::GMMStats> vdata(dbegin, dend);
+  bob::python::ndarray ivectors(bob::core::array::t_float64, vdata.size(), machine.getDimRt());
+  blitz::Array<double,2> ivectors_ = ivectors.bz<double,2>();
+  machine.forward(vdata, ivectors_, n_threads);
+  return ivectors.self();
+}
 
 void bind_machine_ivector()
 {
@@ -141,6 +151,7 @@ void bind_machine_ivector()
     .def("__compute_TtSigmaInvFnorm__", &py_computeTtSigmaInvFnorm2, (arg("self"), arg("gmmstats")), "Computes T^{T} Sigma^{-1} sum_{c=1}^{C} (F_c - N_c mean(c))")
     .def("__call__", &py_iv_forward1_, (arg("self"), arg("gmmstats"), arg("ivector")), "Executes the machine on the GMMStats, and updates the ivector array. NO CHECK is performed.")
     .def("__call__", &py_iv_forward2, (arg("self"), arg("gmmstats")), "Executes the machine on the GMMStats. The ivector is allocated an returned.")
+    .def("forward", &py_iv_forward3, (arg("self"), arg("gmmstats"), arg("n_threads")=1), "Executes the machine on each GMMStats of the given list, using several threads (0 means as many threads as the number of hardware cores). The ivectors are allocated and returned as the rows of a 2D array.")
     .def("forward", &py_iv_forward1, (arg("self"), arg("gmmstats"), arg("ivector")), "Executes the machine on the GMMStats, and updates the ivector array.")
     .def("forward_", &py_iv_forward1_, (arg("self"), arg("gmmstats"), arg("ivector")), "Executes the machine on the GMMStats, and updates the ivector array. NO CHECK is performed.")
     .def("forward", &py_iv_forward2, (arg("self"), arg("gmmstats")), "Executes the machine on the GMMStats. The ivector is allocated an returned.")
@@ -59,7 +59,7 @@ static void convertGMMMachineList(list models, std::vector<boost::shared_ptr<con
 static blitz::Array<double, 2> linearScoring1(list models,
     bob::python::const_ndarray ubm_mean, bob::python::const_ndarray ubm_variance,
     list test_stats, list test_channelOffset = list(), // Empty list
-    bool frame_length_normalisation = false) 
+    bool frame_length_normalisation = false, size_t n_threads = 1) 
 {
   blitz::Array<double,1> ubm_mean_ = ubm_mean.bz<double,1>();
   blitz::Array<double,1> ubm_variance_ = ubm_variance.bz<double,1>();
@@ -72,12 +72,12 @@ static blitz::Array<double, 2> linearScoring1(list models,
 
   blitz::Array<double, 2> ret(len(models), len(test_stats));
   if (len(test_channelOffset) == 0) { //list is empty
-    bob::machine::linearScoring(models_c, ubm_mean_, ubm_variance_, test_stats_c, frame_length_normalisation, ret);
+    bob::machine::linearScoring(models_c, ubm_mean_, ubm_variance_, test_stats_c, frame_length_normalisation, ret, n_threads);
   }
   else { 
     std::vector<blitz::Array<double,1> > test_channelOffset_c;
     convertChannelOffsetList(test_channelOffset, test_channelOffset_c);
-    bob::machine::linearScoring(models_c, ubm_mean_, ubm_variance_, test_stats_c, test_channelOffset_c, frame_length_normalisation, ret);
+    bob::machine::linearScoring(models_c, ubm_mean_, ubm_variance_, test_stats_c, test_channelOffset_c, frame_length_normalisation, ret, n_threads);
   }
  
   return ret;
@@ -86,7 +86,7 @@ static blitz::Array<double, 2> linearScoring1(list models,
 static blitz::Array<double, 2> linearScoring2(list models,
     bob::machine::GMMMachine& ubm,
     list test_stats, list test_channelOffset = list(), // Empty list
-    bool frame_length_normalisation = false) 
+    bool frame_length_normalisation = false, size_t n_threads = 1) 
 {
   std::vector<boost::shared_ptr<const bob::machine::GMMMachine> > models_c;
   convertGMMMachineList(models, models_c);
@@ -96,22 +96,44 @@ static blitz::Array<double, 2> linearScoring2(list models,
 
   blitz::Array<double, 2> ret(len(models), len(test_stats));
   if (len(test_channelOffset) == 0) { //list is empty
-    bob::machine::linearScoring(models_c, ubm, test_stats_c, frame_length_normalisation, ret);
+    bob::machine::linearScoring(models_c, ubm, test_stats_c, frame_length_normalisation, ret, n_threads);
   }
   else { 
     std::vector<blitz::Array<double,1> > test_channelOffset_c;
     convertChannelOffsetList(test_channelOffset, test_channelOffset_c);
-    bob::machine::linearScoring(models_c, ubm, test_stats_c, test_channelOffset_c, frame_length_normalisation, ret);
+    bob::machine::linearScoring(models_c, ubm, test_stats_c, test_channelOffset_c, frame_length_normalisation, ret, n_threads);
   }
   
   return ret;
 }
 
-BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring1_overloads, linearScoring1, 4, 6)
-BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring2_overloads, linearScoring2, 3, 5)
+static blitz::Array<double, 2> linearScoring3(bob::python::const_ndarray models,
+    bob::python::const_ndarray ubm_mean, bob::python::const_ndarray ubm_variance,
+    bob::python::const_ndarray test_n, bob::python::const_ndarray test_sumPx,
+    bob::python::const_ndarray test_T, object test_channelOffset = object(), // None
+    bool frame_length_normalisation = false, size_t n_threads = 1) 
+{
+  const blitz::Array<double,2> models_ = models.bz<double,2>();
+  const blitz::Array<double,2> test_sumPx_ = test_sumPx.bz<double,2>();
+
+  blitz::Array<double, 2> ret(models_.extent(0), test_sumPx_.extent(0));
+  if (test_channelOffset.ptr() == Py_None) {
+    bob::machine::linearScoring(models_, ubm_mean.bz<double,1>(), ubm_variance.bz<double,1>(), test_n.bz<double,2>(), test_sumPx_, test_T.bz<double,1>(), frame_length_normalisation, ret, n_threads);
+  }
+  else {
+    bob::python::const_ndarray test_channelOffset_ = extract<bob::python::const_ndarray>(test_channelOffset);
+    bob::machine::linearScoring(models_, ubm_mean.bz<double,1>(), ubm_variance.bz<double,1>(), test_n.bz<double,2>(), test_sumPx_, test_T.bz<double,1>(), test_channelOffset_.bz<double,2>(), frame_length_normalisation, ret, n_threads);
+  }
+
+  return ret;
+}
+
+BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring1_overloads, linearScoring1, 4, 7)
+BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring2_overloads, linearScoring2, 3, 6)
+BOOST_PYTHON_FUNCTION_OVERLOADS(linearScoring3_overloads, linearScoring3, 6, 9)
 
 void bind_machine_linear_scoring() {
-  def("linear_scoring", linearScoring1, linearScoring1_overloads(args("models", "ubm_mean", "ubm_variance", "test_stats", "test_channelOffset", "frame_length_normalisation"),
+  def("linear_scoring", linearScoring1, linearScoring1_overloads(args("models", "ubm_mean", "ubm_variance", "test_stats", "test_channelOffset", "frame_length_normalisation", "n_threads"),
     "Compute a matrix of scores using linear scoring.\n"
     "Return a 2D matrix of scores, scores[m, s] is the score for model m against statistics s\n"
     "\n"
@@ -123,8 +145,9 @@ void bind_machine_linear_scoring() {
     "test_stats   -- list of accumulate statistics for each test trial\n"
     "test_channelOffset -- \n"
     "frame_length_normlisation -- perform a normalisation by the number of feature vectors\n"
+    "n_threads   -- number of threads used to compute the scores (0 means as many threads as the number of hardware cores)\n"
     ));
-  def("linear_scoring", linearScoring2, linearScoring2_overloads(args("models", "ubm", "test_stats", "test_channel_offset", "frame_length_normalisation"),
+  def("linear_scoring", linearScoring2, linearScoring2_overloads(args("models", "ubm", "test_stats", "test_channel_offset", "frame_length_normalisation", "n_threads"),
     "Compute a matrix of scores using linear scoring.\n"
     "Return a 2D matrix of scores, scores[m, s] is the score for model m against statistics s\n"
     "\n"
@@ -135,5 +158,20 @@ void bind_machine_linear_scoring() {
     "test_stats  -- list of accumulate statistics for each test trial\n"
     "test_channel_offset -- \n"
     "frame_length_normlisation -- perform a normalisation by the number of feature vectors\n"
+    "n_threads   -- number of threads used to compute the scores (0 means as many threads as the number of hardware cores)\n"
+  ));
+  def("linear_scoring", linearScoring3, linearScoring3_overloads(args("models", "ubm_mean", "ubm_variance", "test_n", "test_sumPx", "test_T", "test_channel_offset", "frame_length_normalisation", "n_threads"),
+    "Compute a matrix of scores using linear scoring, from stacked arrays.\n"
+    "Return a 2D matrix of scores, scores[m, s] is the score for model m against statistics s\n"
+    "\n"
+    "models       -- 2D array of mean supervectors for the client models (one per row)\n"
+    "ubm_mean     -- mean supervector for the world model\n"
+    "ubm_variance -- variance supervector for the world model\n"
+    "test_n       -- 2D array of zeroth order statistics of the test trials (one per row)\n"
+    "test_sumPx   -- 2D array of first order statistics of the test trials (one supervector per row)\n"
+    "test_T       -- number of feature vectors of each test trial\n"
+    "test_channel_offset -- 2D array of channel offsets of the test trials (one supervector per row), or None\n"
+    "frame_length_normlisation -- perform a normalisation by the number of feature vectors\n"
+    "n_threads    -- number of threads used to compute the scores (0 means as many threads as the number of hardware cores)\n"
   ));
 }
@@ -181,6 +181,20 @@ static object plda_getGamma(bob::machine::PLDAMachine& m, const size_t a) {
   return object(res);
 }
 
+static object py_plda_scoring(list models, bob::python::const_ndarray probes)
+{
+  std::vector<boost::shared_ptr<const bob::machine::PLDAMachine> > models_c;
+  for (int i=0; i<len(models); ++i) {
+    boost::shared_ptr<bob::machine::PLDAMachine> m =
+      extract<boost::shared_ptr<bob::machine::PLDAMachine> >(models[i]);
+    models_c.push_back(m);
+  }
+  const blitz::Array<double,2> probes_ = probes.bz<double,2>();
+  blitz::Array<double,2> scores(models_c.size(), probes_.extent(0));
+  bob::machine::pldaScoring(models_c, probes_, scores);
+  return object(scores);
+}
+
 BOOST_PYTHON_FUNCTION_OVERLOADS(computeLogLikelihood1_overloads, computeLogLikelihood1, 2, 3)
 BOOST_PYTHON_FUNCTION_OVERLOADS(computeLogLikelihood2_overloads, computeLogLikelihood2, 2, 3)
 
@@ -256,4 +270,6 @@ void bind_machine_plda()
     .def("__call__", &plda_forward_sample, (arg("self"), arg("sample")), "Processes a sample and returns a score.")
     .def("forward", &plda_forward_sample, (arg("self"), arg("sample")), "Processes a sample and returns a score.")
   ;
+
+  def("plda_scoring", &py_plda_scoring, (arg("models"), arg("probes")), "Computes the scores of all the probes (2D array, one sample per row) against all the enrolled models (list of PLDAMachine's sharing the same PLDABase) at once, using a closed-form expression based on a few matrix products. The returned 2D array contains the score of model m for probe p at position [m,p], which is the same as models[m].forward(probes[p,:]).");
 }
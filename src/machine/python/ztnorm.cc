@@ -128,6 +128,60 @@ static object znorm(
   return ret.self();
 }
 
+static void ztnorm_hdf5_1(bob::io::HDF5File& file,
+  const std::string& rawscores_probes_vs_models,
+  const std::string& rawscores_zprobes_vs_models,
+  const std::string& rawscores_probes_vs_tmodels,
+  const std::string& rawscores_zprobes_vs_tmodels,
+  const std::string& mask_zprobes_vs_tmodels_istruetrial,
+  bob::io::HDF5File& output, const std::string& normalizedscores,
+  const size_t block_size, const size_t n_threads)
+{
+  bob::machine::ztNorm(file, rawscores_probes_vs_models,
+                       rawscores_zprobes_vs_models,
+                       rawscores_probes_vs_tmodels,
+                       rawscores_zprobes_vs_tmodels,
+                       mask_zprobes_vs_tmodels_istruetrial,
+                       output, normalizedscores, block_size, n_threads);
+}
+
+static void ztnorm_hdf5_2(bob::io::HDF5File& file,
+  const std::string& rawscores_probes_vs_models,
+  const std::string& rawscores_zprobes_vs_models,
+  const std::string& rawscores_probes_vs_tmodels,
+  const std::string& rawscores_zprobes_vs_tmodels,
+  bob::io::HDF5File& output, const std::string& normalizedscores,
+  const size_t block_size, const size_t n_threads)
+{
+  bob::machine::ztNorm(file, rawscores_probes_vs_models,
+                       rawscores_zprobes_vs_models,
+                       rawscores_probes_vs_tmodels,
+                       rawscores_zprobes_vs_tmodels,
+                       output, normalizedscores, block_size, n_threads);
+}
+
+static void tnorm_hdf5(bob::io::HDF5File& file,
+  const std::string& rawscores_probes_vs_models,
+  const std::string& rawscores_probes_vs_tmodels,
+  bob::io::HDF5File& output, const std::string& normalizedscores,
+  const size_t block_size, const size_t n_threads)
+{
+  bob::machine::tNorm(file, rawscores_probes_vs_models,
+                      rawscores_probes_vs_tmodels,
+                      output, normalizedscores, block_size, n_threads);
+}
+
+static void znorm_hdf5(bob::io::HDF5File& file,
+  const std::string& rawscores_probes_vs_models,
+  const std::string& rawscores_zprobes_vs_models,
+  bob::io::HDF5File& output, const std::string& normalizedscores,
+  const size_t block_size, const size_t n_threads)
+{
+  bob::machine::zNorm(file, rawscores_probes_vs_models,
+                      rawscores_zprobes_vs_models,
+                      output, normalizedscores, block_size, n_threads);
+}
+
 void bind_machine_ztnorm() 
 {
   def("ztnorm",
@@ -163,4 +217,49 @@ void bind_machine_ztnorm()
       "Normalise raw scores with Z-Norm."
      );
 
+  def("ztnorm",
+      ztnorm_hdf5_1,
+      (arg("file"),
+       arg("rawscores_probes_vs_models"),
+       arg("rawscores_zprobes_vs_models"),
+       arg("rawscores_probes_vs_tmodels"),
+       arg("rawscores_zprobes_vs_tmodels"),
+       arg("mask_zprobes_vs_tmodels_istruetrial"),
+       arg("output"), arg("normalizedscores"),
+       arg("block_size")=1024, arg("n_threads")=1),
+      "Normalise raw scores with ZT-Norm, by blocks of rows. The raw scores are read from datasets of the given HDF5 file, and the rows of normalised scores are appended to the (new) dataset normalizedscores of the output HDF5 file. At most n_threads blocks of block_size rows are loaded at once, and are processed in parallel (0 means as many threads as the number of hardware cores)."
+     );
+
+  def("ztnorm",
+      ztnorm_hdf5_2,
+      (arg("file"),
+       arg("rawscores_probes_vs_models"),
+       arg("rawscores_zprobes_vs_models"),
+       arg("rawscores_probes_vs_tmodels"),
+       arg("rawscores_zprobes_vs_tmodels"),
+       arg("output"), arg("normalizedscores"),
+       arg("block_size")=1024, arg("n_threads")=1),
+      "Normalise raw scores with ZT-Norm, by blocks of rows of HDF5 datasets. Assume that znorm and tnorm have no common subject id."
+     );
+
+  def("tnorm",
+      tnorm_hdf5,
+      (arg("file"),
+       arg("rawscores_probes_vs_models"),
+       arg("rawscores_probes_vs_tmodels"),
+       arg("output"), arg("normalizedscores"),
+       arg("block_size")=1024, arg("n_threads")=1),
+      "Normalise raw scores with T-Norm, by blocks of rows of HDF5 datasets."
+     );
+
+  def("znorm",
+      znorm_hdf5,
+      (arg("file"),
+       arg("rawscores_probes_vs_models"),
+       arg("rawscores_zprobes_vs_models"),
+       arg("output"), arg("normalizedscores"),
+       arg("block_size")=1024, arg("n_threads")=1),
+      "Normalise raw scores with Z-Norm, by blocks of rows of HDF5 datasets."
+     );
+
 }
@@ -0,0 +1,101 @@
+/**
+ * @file math/cxx/gemm.cc
+ * @date Sat Oct 17 10:12:41 2026 +0200
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/math/gemm.h>
+#include <bob/core/assert.h>
+#include <bob/core/check.h>
+#include <bob/core/array_copy.h>
+
+// Declaration of the external BLAS function
+// General matrix-matrix multiplication (dgemm)
+extern "C" void dgemm_( const char *transa, const char *transb,
+  const int *M, const int *N, const int *K, const double *alpha,
+  const double *A, const int *lda, const double *B, const int *ldb,
+  const double *beta, double *C, const int *ldc);
+
+void bob::math::gemm(const blitz::Array<double,2>& A,
+  const blitz::Array<double,2>& B, blitz::Array<double,2>& C,
+  const bool transA, const bool transB, const double alpha,
+  const double beta)
+{
+  // Checks zero base
+  bob::core::array::assertZeroBase(A);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertZeroBase(C);
+
+  // Checks dimensionality
+  const int M = (transA ? A.extent(1) : A.extent(0));
+  const int K = (transA ? A.extent(0) : A.extent(1));
+  const int Kb = (transB ? B.extent(1) : B.extent(0));
+  const int N = (transB ? B.extent(0) : B.extent(1));
+  bob::core::array::assertSameDimensionLength(K, Kb);
+  bob::core::array::assertSameDimensionLength(C.extent(0), M);
+  bob::core::array::assertSameDimensionLength(C.extent(1), N);
+
+  bob::math::gemm_(A, B, C, transA, transB, alpha, beta);
+}
+
+void bob::math::gemm_(const blitz::Array<double,2>& A,
+  const blitz::Array<double,2>& B, blitz::Array<double,2>& C,
+  const bool transA, const bool transB, const double alpha,
+  const double beta)
+{
+  // Size variables
+  const int M = C.extent(0);
+  const int N = C.extent(1);
+  const int K = (transA ? A.extent(0) : A.extent(1));
+
+  // Degenerated cases
+  if (M == 0 || N == 0) return;
+  if (K == 0) {
+    if (beta == 0.) C = 0.;
+    else C *= beta;
+    return;
+  }
+
+  // Uses the input arrays directly if they are C-contiguous
+  blitz::Array<double,2> A_blas, B_blas;
+  if (bob::core::array::isCZeroBaseContiguous(A)) A_blas.reference(A);
+  else A_blas.reference(bob::core::array::ccopy(A));
+  if (bob::core::array::isCZeroBaseContiguous(B)) B_blas.reference(B);
+  else B_blas.reference(bob::core::array::ccopy(B));
+
+  // Tries to use C directly if possible
+  bool C_direct_use = bob::core::array::isCZeroBaseContiguous(C);
+  blitz::Array<double,2> C_blas;
+  if (C_direct_use) C_blas.reference(C);
+  else C_blas.reference(bob::core::array::ccopy(C));
+
+  // Row-major (C) arrays are seen by BLAS as their column-major (Fortran)
+  // transposed counterparts. We hence compute C^T = op(B)^T * op(A)^T,
+  // which does not require any copy of the data.
+  const char transa = (transA ? 'T' : 'N');
+  const char transb = (transB ? 'T' : 'N');
+  const int lda = A_blas.extent(1);
+  const int ldb = B_blas.extent(1);
+  const int ldc = N;
+
+  // Calls the BLAS function
+  dgemm_( &transb, &transa, &N, &M, &K, &alpha, B_blas.data(), &ldb,
+    A_blas.data(), &lda, &beta, C_blas.data(), &ldc);
+
+  // Copy result back to C if required
+  if (!C_direct_use)
+    C = C_blas;
+}
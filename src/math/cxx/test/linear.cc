@@ -25,6 +25,7 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 #include <bob/math/linear.h>
+#include <bob/math/gemm.h>
 
 
 struct T {
@@ -111,6 +112,24 @@ BOOST_AUTO_TEST_CASE( test_matrix_matrix_prod )
   checkBlitzClose( A_23, sol, eps);
 }
 
+BOOST_AUTO_TEST_CASE( test_matrix_matrix_gemm )
+{
+  blitz::Array<double,2> sol(2,3);
+
+  bob::math::gemm( A_24, A_43, sol);
+  checkBlitzClose( A_23, sol, eps);
+
+  // Transposed inputs and accumulation (C = 2*A*B + C)
+  blitz::Array<double,2> A_42 = A_24.transpose(1,0);
+  blitz::Array<double,2> A_34 = A_43.transpose(1,0);
+  blitz::Array<double,2> sol3(2,3);
+  sol3 = A_23;
+  bob::math::gemm( A_42, A_34, sol3, true, true, 2., 1.);
+  blitz::Array<double,2> A_23_3(2,3);
+  A_23_3 = 3. * A_23;
+  checkBlitzClose( A_23_3, sol3, eps);
+}
+
 BOOST_AUTO_TEST_CASE( test_matrix_vector_prod )
 {
   blitz::Array<double,1> sol(2);
@@ -43,6 +43,34 @@ std::pair<double, double> bob::measure::farfrr(const blitz::Array<double,1>& neg
       false_rejects/(double)total_positives);
 }
 
+std::pair<double, double> bob::measure::sortedFarfrr(const blitz::Array<double,1>& negatives,
+    const blitz::Array<double,1>& positives, double threshold) {
+  // the binary searches below run on the raw data
+  bob::core::array::assertCZeroBaseContiguous(negatives);
+  bob::core::array::assertCZeroBaseContiguous(positives);
+  blitz::sizeType total_negatives = negatives.extent(blitz::firstDim);
+  blitz::sizeType total_positives = positives.extent(blitz::firstDim);
+  // negatives >= threshold are the ones after the first element not less
+  // than the threshold; positives < threshold are the ones before it
+  const double* n_begin = negatives.data();
+  const double* p_begin = positives.data();
+  blitz::sizeType false_accepts = total_negatives - 
+    (std::lower_bound(n_begin, n_begin+total_negatives, threshold) - n_begin);
+  blitz::sizeType false_rejects =
+    std::lower_bound(p_begin, p_begin+total_positives, threshold) - p_begin;
+  if (!total_negatives) total_negatives = 1; //avoids division by zero
+  if (!total_positives) total_positives = 1; //avoids division by zero
+  return std::make_pair(false_accepts/(double)total_negatives,
+      false_rejects/(double)total_positives);
+}
+
+blitz::Array<double,1> bob::measure::sortScores(const blitz::Array<double,1>& scores) {
+  blitz::Array<double,1> retval(scores.extent(0));
+  std::copy(scores.begin(), scores.end(), retval.begin());
+  std::sort(retval.data(), retval.data()+retval.extent(0));
+  return retval;
+}
+
 double eer_predicate(double far, double frr) {
   return std::abs(far - frr);
 }
@@ -167,13 +195,25 @@ blitz::Array<double,2> bob::measure::roc(const blitz::Array<double,1>& negatives
   double min = std::min(blitz::min(negatives), blitz::min(positives));
   double max = std::max(blitz::max(negatives), blitz::max(positives));
   double step = (max-min)/((double)points-1.0);
+
+  // sort the scores once; as the thresholds are increasing, the number of
+  // negatives and positives below the threshold can then be obtained by
+  // sweeping the sorted lists only once.
+  blitz::Array<double,1> negatives_ = bob::measure::sortScores(negatives);
+  blitz::Array<double,1> positives_ = bob::measure::sortScores(positives);
+  const int n_neg = negatives_.extent(0), n_pos = positives_.extent(0);
+  const double total_negatives = (n_neg ? n_neg : 1); //avoids division by zero
+  const double total_positives = (n_pos ? n_pos : 1); //avoids division by zero
+  int neg_index = 0, pos_index = 0;
+
   blitz::Array<double,2> retval(2, points);
   for (int i=0; i<(int)points; ++i) {
-    std::pair<double, double> ratios =
-      bob::measure::farfrr(negatives, positives, min + i*step);
+    const double threshold = min + i*step;
+    while (neg_index < n_neg && negatives_(neg_index) < threshold) ++neg_index;
+    while (pos_index < n_pos && positives_(pos_index) < threshold) ++pos_index;
     //note: inversion to preserve X x Y ordering (FRR x FAR)
-    retval(0,i) = ratios.second;
-    retval(1,i) = ratios.first;
+    retval(0,i) = pos_index / total_positives;
+    retval(1,i) = (n_neg - neg_index) / total_negatives;
   }
   return retval;
 }
@@ -479,14 +519,20 @@ blitz::Array<double,2> bob::measure::epc
  const blitz::Array<double,1>& test_negatives,
  const blitz::Array<double,1>& test_positives, size_t points) {
   double step = 1.0/((double)points-1.0);
+  // sort all the scores once for all the cost points
+  blitz::Array<double,1> dev_negatives_ = bob::measure::sortScores(dev_negatives);
+  blitz::Array<double,1> dev_positives_ = bob::measure::sortScores(dev_positives);
+  blitz::Array<double,1> test_negatives_ = bob::measure::sortScores(test_negatives);
+  blitz::Array<double,1> test_positives_ = bob::measure::sortScores(test_positives);
   blitz::Array<double,2> retval(2, points);
   for (int i=0; i<(int)points; ++i) {
     double alpha = (double)i*step;
     retval(0,i) = alpha;
-    double threshold = bob::measure::minWeightedErrorRateThreshold(dev_negatives,
-        dev_positives, alpha);
+    weighted_error predicate(alpha);
+    double threshold = bob::measure::sortedMinimizingThreshold(dev_negatives_,
+        dev_positives_, predicate);
     std::pair<double, double> ratios =
-      bob::measure::farfrr(test_negatives, test_positives, threshold);
+      bob::measure::sortedFarfrr(test_negatives_, test_positives_, threshold);
     retval(1,i) = (ratios.first + ratios.second) / 2;
   }
   return retval;
@@ -23,7 +23,7 @@
 
 #include <bob/sp/FFT1D.h>
 #include <bob/core/assert.h>
-#include <fftw3.h>
+#include "fftw_plan.h"
 
 
 bob::sp::FFT1DAbstract::FFT1DAbstract(const size_t length):
@@ -104,12 +104,7 @@ void bob::sp::FFT1D::operator()(const blitz::Array<std::complex<double>,1>& src,
   fftw_complex* src_ = reinterpret_cast<fftw_complex*>(const_cast<std::complex<double>* >(src.data()));
   fftw_complex* dst_ = reinterpret_cast<fftw_complex*>(dst.data());
   
-  fftw_plan p;
-  // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
-  // for large arrays
-  p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_FORWARD, FFTW_ESTIMATE);
-  fftw_execute(p);
-  fftw_destroy_plan(p);
+  bob::sp::detail::fftwExecuteDFT1D(src.extent(0), src_, dst_, FFTW_FORWARD);
 }
 
 
@@ -146,12 +141,7 @@ void bob::sp::IFFT1D::operator()(const blitz::Array<std::complex<double>,1>& src
   fftw_complex* src_ = reinterpret_cast<fftw_complex*>(const_cast<std::complex<double>* >(src.data()));
   fftw_complex* dst_ = reinterpret_cast<fftw_complex*>(dst.data());
   
-  fftw_plan p;
-  // FFTW_ESTIMATE -> The planner is computed quickly but may not be optimized 
-  // for large arrays
-  p = fftw_plan_dft_1d(src.extent(0), src_, dst_, FFTW_BACKWARD, FFTW_ESTIMATE);
-  fftw_execute(p); /* repeat as needed */
-  fftw_destroy_plan(p);
+  bob::sp::detail::fftwExecuteDFT1D(src.extent(0), src_, dst_, FFTW_BACKWARD);
 
   // Rescale as FFTW is not doing it
   dst /= static_cast<double>(m_length);
@@ -0,0 +1,235 @@
+/**
+ * @file sp/cxx/conv.cc
+ * @date Sat Oct 17 15:21:48 2026 +0200
+ *
+ * @brief Implement the FFT-based engines of the blitz-based convolution
+ * product, as well as the selection between direct and FFT-based
+ * computations
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/sp/conv.h>
+#include <bob/sp/FFT2D.h>
+#include <cmath>
+
+/**
+ * Kernels smaller than these sizes are always convolved directly
+ */
+static const int MIN_FFT_KERNEL_LENGTH = 32;
+static const int MIN_FFT_KERNEL_AREA = 64;
+
+/**
+ * Approximate cost of an FFT of length n, relative to the cost of a
+ * multiply-add of the direct computation, and fixed cost of a transform
+ * (planning and copies)
+ */
+static const double FFT_COST_FACTOR = 3.;
+static const double FFT_COST_OVERHEAD = 2000.;
+
+/**
+ * @brief Returns the smallest length larger or equal to n, which only
+ * has 2, 3, 5 and 7 as prime factors (and for which the FFT is fast)
+ */
+static int goodFFTSize(const int n)
+{
+  for (int m=std::max(n,1); ; ++m) {
+    int r = m;
+    while (r % 2 == 0) r /= 2;
+    while (r % 3 == 0) r /= 3;
+    while (r % 5 == 0) r /= 5;
+    while (r % 7 == 0) r /= 7;
+    if (r == 1) return m;
+  }
+}
+
+static double fftCost(const int n)
+{
+  const double n_ = std::max(n, 2);
+  return FFT_COST_FACTOR * n_ * std::log(n_) / std::log(2.) +
+    FFT_COST_OVERHEAD;
+}
+
+/**
+ * @brief Computes the length of the transforms and the length of the
+ * blocks of the signal used by the 1D FFT-based convolution. The full
+ * signal is processed at once unless the overlap-add method allows much
+ * shorter transforms.
+ */
+static void fftConvPlan(const int M, const int N, int& nfft, int& block)
+{
+  nfft = goodFFTSize(M + N - 1);
+  block = M;
+  const int nfft_ola = goodFFTSize(std::max(8*N, 256));
+  if (2*nfft_ola < nfft) {
+    nfft = nfft_ola;
+    block = nfft - N + 1;
+  }
+}
+
+bool bob::sp::detail::useFFTConv(const int M, const int N, const int P)
+{
+  if (N < MIN_FFT_KERNEL_LENGTH) return false;
+  int nfft, block;
+  fftConvPlan(M, N, nfft, block);
+  const int n_blocks = (M + block - 1) / block;
+  // One forward and one inverse transform per block, and the kernel one
+  const double fft_cost = (2*n_blocks + 1) * fftCost(nfft);
+  const double direct_cost = static_cast<double>(P) * N;
+  return fft_cost < direct_cost;
+}
+
+bool bob::sp::detail::useFFTConv(const int M0, const int M1, const int N0,
+  const int N1, const int P0, const int P1)
+{
+  if (N0 * N1 < MIN_FFT_KERNEL_AREA) return false;
+  const int L0 = goodFFTSize(M0 + N0 - 1);
+  const int L1 = goodFFTSize(M1 + N1 - 1);
+  const double fft_cost = 3 * fftCost(L0 * L1);
+  const double direct_cost =
+    static_cast<double>(P0) * P1 * static_cast<double>(N0) * N1;
+  return fft_cost < direct_cost;
+}
+
+
+bob::sp::detail::FFTConv1D::FFTConv1D(const blitz::Array<double,1>& b,
+    const int length):
+  m_kernel_length(b.extent(0)),
+  m_signal_length(length)
+{
+  int nfft;
+  fftConvPlan(m_signal_length, m_kernel_length, nfft, m_block);
+  m_fft.reset(nfft);
+  m_ifft.reset(nfft);
+  m_kernel_fft.resize(nfft);
+  m_buffer.resize(nfft);
+  m_buffer_fft.resize(nfft);
+  m_full.resize(m_signal_length + m_kernel_length - 1);
+
+  // Computes the spectrum of the zero-padded kernel
+  m_buffer = 0.;
+  for (int i=0; i<m_kernel_length; ++i) m_buffer(i) = b(i);
+  m_fft(m_buffer, m_kernel_fft);
+}
+
+void bob::sp::detail::FFTConv1D::operator()(const blitz::Array<double,1>& a,
+  blitz::Array<double,1>& c, const int start) const
+{
+  const int M = m_signal_length;
+  const int N = m_kernel_length;
+  const int P = c.extent(0);
+
+  // Overlap-add: each block of the signal is convolved separately, and the
+  // (overlapping) results are summed
+  m_full = 0.;
+  for (int s=0; s<M; s+=m_block) {
+    const int len = std::min(m_block, M-s);
+    m_buffer = 0.;
+    for (int i=0; i<len; ++i) m_buffer(i) = a(s+i);
+    m_fft(m_buffer, m_buffer_fft);
+    m_buffer_fft *= m_kernel_fft;
+    m_ifft(m_buffer_fft, m_buffer);
+    for (int i=0; i<len+N-1; ++i) m_full(s+i) += m_buffer(i).real();
+  }
+
+  for (int i=0; i<P; ++i) c(i) = m_full(start+i);
+}
+
+
+void bob::sp::detail::convEngine(const blitz::Array<double,1>& a,
+  const blitz::Array<double,1>& b, blitz::Array<double,1>& c,
+  const int offset_0, const int offset_1)
+{
+  if (useFFTConv(a.extent(0), b.extent(0), c.extent(0))) {
+    const FFTConv1D fft_conv(b, a.extent(0));
+    fft_conv(a, c, offset_1-1);
+  }
+  else
+    convInternal(a, b, c, offset_0, offset_1);
+}
+
+void bob::sp::detail::convEngine(const blitz::Array<double,2>& A,
+  const blitz::Array<double,2>& B, blitz::Array<double,2>& C,
+  const int offset0_0, const int offset0_1, const int offset1_0,
+  const int offset1_1)
+{
+  const int M0 = A.extent(0);
+  const int M1 = A.extent(1);
+  const int N0 = B.extent(0);
+  const int N1 = B.extent(1);
+  const int P0 = C.extent(0);
+  const int P1 = C.extent(1);
+
+  if (!useFFTConv(M0, M1, N0, N1, P0, P1)) {
+    convInternal(A, B, C, offset0_0, offset0_1, offset1_0, offset1_1);
+    return;
+  }
+
+  // Zero-pads both arrays to (at least) the size of the full convolution
+  const int L0 = goodFFTSize(M0 + N0 - 1);
+  const int L1 = goodFFTSize(M1 + N1 - 1);
+  blitz::Array<std::complex<double>,2> A_fft(L0, L1);
+  blitz::Array<std::complex<double>,2> B_fft(L0, L1);
+  A_fft = 0.;
+  B_fft = 0.;
+  for (int i=0; i<M0; ++i)
+    for (int j=0; j<M1; ++j)
+      A_fft(i,j) = A(i,j);
+  for (int i=0; i<N0; ++i)
+    for (int j=0; j<N1; ++j)
+      B_fft(i,j) = B(i,j);
+
+  const bob::sp::FFT2D fft(L0, L1);
+  const bob::sp::IFFT2D ifft(L0, L1);
+  fft(A_fft);
+  fft(B_fft);
+  A_fft *= B_fft;
+  ifft(A_fft);
+
+  const int start0 = offset0_1 - 1;
+  const int start1 = offset1_1 - 1;
+  for (int i=0; i<P0; ++i)
+    for (int j=0; j<P1; ++j)
+      C(i,j) = A_fft(start0+i, start1+j).real();
+}
+
+
+bob::sp::detail::LineConv<double>::LineConv(const blitz::Array<double,1>& b,
+    const int length, const Conv::SizeOption size_opt):
+  m_b(b),
+  m_size_opt(size_opt),
+  m_start(0)
+{
+  const int N = b.extent(0);
+  if (length < N) return; // conv() will raise the appropriate exception
+
+  int offset_1;
+  if (size_opt == Conv::Full) offset_1 = 1;
+  else if (size_opt == Conv::Same) offset_1 = (N+1)/2;
+  else offset_1 = N;
+
+  const int P = getConvOutputSize(length, N, size_opt);
+  if (useFFTConv(length, N, P)) {
+    m_fft.reset(new FFTConv1D(b, length));
+    m_start = offset_1 - 1;
+  }
+}
+
+void bob::sp::detail::LineConv<double>::operator()(
+  const blitz::Array<double,1>& a, blitz::Array<double,1>& c) const
+{
+  if (m_fft) (*m_fft)(a, c, m_start);
+  else conv(a, m_b, c, m_size_opt);
+}
@@ -0,0 +1,408 @@
+/**
+ * @file sp/cxx/fftw.cc
+ * @date Sat Oct 17 16:05:12 2026 +0200
+ *
+ * @brief Implements a thread-safe, process-wide cache of FFTW plans, as
+ * well as the control of the planning rigor and of the FFTW wisdom
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/sp/fftw.h>
+#include "fftw_plan.h"
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace {
+
+  /**
+   * The FFTW planner (as well as the wisdom functions) is not thread-safe,
+   * contrary to the execute functions. All the calls to the former are
+   * hence protected by this mutex.
+   */
+  boost::mutex& planner_mutex()
+  {
+    static boost::mutex mutex;
+    return mutex;
+  }
+
+  /**
+   * The cache of plans (as well as the planning rigor and the capacity of
+   * the cache) is protected by a separate readers-writer mutex, such that
+   * looking up a cached plan does neither wait for other lookups, nor for
+   * the creation of a new plan.
+   */
+  boost::shared_mutex& cache_mutex()
+  {
+    static boost::shared_mutex mutex;
+    return mutex;
+  }
+
+  /**
+   * The largest alignment (in bytes) fftw_alignment_of() may report, which
+   * is the one of the widest SIMD instructions supported by FFTW (AVX-512)
+   */
+  static const size_t MAX_SIMD_ALIGNMENT = 64;
+
+  typedef enum TransformType_ {
+    DFT1D,
+    DFT2D,
+    R2R1D,
+    R2R2D
+  } TransformType;
+
+  /**
+   * Identifies a plan in the cache. A plan can be executed on arrays which
+   * have the same alignment as the ones it was created for, as reported by
+   * fftw_alignment_of(), such that the alignments of the input and of the
+   * output are part of the key.
+   */
+  struct PlanKey
+  {
+    int values[8];
+
+    PlanKey(const TransformType type, const int n0, const int n1,
+        const int kind, const bool inplace, const int in_alignment,
+        const int out_alignment, const unsigned flags)
+    {
+      values[0] = type;
+      values[1] = n0;
+      values[2] = n1;
+      values[3] = kind;
+      values[4] = inplace;
+      values[5] = in_alignment;
+      values[6] = out_alignment;
+      values[7] = flags;
+    }
+
+    bool operator<(const PlanKey& other) const
+    {
+      return std::lexicographical_compare(values, values+8,
+          other.values, other.values+8);
+    }
+  };
+
+  /**
+   * A plan, which is destroyed (under the planner mutex) when the last
+   * reference to it is released.
+   */
+  class Plan: private boost::noncopyable
+  {
+    public:
+      Plan(const fftw_plan plan): m_plan(plan) {}
+
+      ~Plan()
+      {
+        boost::lock_guard<boost::mutex> lock(planner_mutex());
+        fftw_destroy_plan(m_plan);
+      }
+
+      fftw_plan get() const { return m_plan; }
+
+    private:
+      fftw_plan m_plan;
+  };
+
+  typedef std::map<PlanKey, boost::shared_ptr<Plan> > PlanMap;
+
+  /**
+   * The cache itself, the keys of the cached plans in order of creation
+   * (the oldest plans are released first when the cache is full), the
+   * capacity of the cache and the current planning rigor, which are all
+   * protected by the cache mutex
+   */
+  PlanMap& plans()
+  {
+    static PlanMap map;
+    return map;
+  }
+
+  std::deque<PlanKey>& plan_order()
+  {
+    static std::deque<PlanKey> order;
+    return order;
+  }
+
+  size_t& plan_capacity()
+  {
+    static size_t capacity = 256;
+    return capacity;
+  }
+
+  unsigned& rigor_flags()
+  {
+    static unsigned flags = FFTW_ESTIMATE;
+    return flags;
+  }
+
+  /**
+   * Removes the oldest plans until the cache holds at most capacity plans.
+   * The removed plans are moved to released, such that they can be
+   * destroyed once the mutexes have been released.
+   */
+  void shrinkCache(const size_t capacity,
+    std::vector<boost::shared_ptr<Plan> >& released)
+  {
+    while (plans().size() > capacity && !plan_order().empty()) {
+      PlanMap::iterator it = plans().find(plan_order().front());
+      plan_order().pop_front();
+      if (it == plans().end()) continue;
+      released.push_back(it->second);
+      plans().erase(it);
+    }
+  }
+
+  /**
+   * Buffers used to create the plans: the planner may overwrite the arrays
+   * when timing the algorithms, and the arrays given by the user should
+   * hence not be used. The data starts at the given offset from an address
+   * aligned for any SIMD instruction, such that it has the same alignment
+   * as the arrays of the user.
+   */
+  class PlanningBuffer: private boost::noncopyable
+  {
+    public:
+      PlanningBuffer(const size_t size, const size_t offset):
+        m_data(fftw_malloc(std::max(size, (size_t)1) + MAX_SIMD_ALIGNMENT)),
+        m_offset(offset)
+      {
+        if (!m_data) throw std::bad_alloc();
+      }
+
+      ~PlanningBuffer() { fftw_free(m_data); }
+
+      template <typename T> T* get() const
+      { return reinterpret_cast<T*>(reinterpret_cast<char*>(m_data) +
+          m_offset); }
+
+    private:
+      void* m_data;
+      size_t m_offset;
+  };
+
+  /**
+   * Creates a new plan for the given transform. This must be called with
+   * the planner mutex locked.
+   */
+  fftw_plan createPlan(const TransformType type, const int n0,
+    const int n1, const int kind, const bool inplace, const int in_alignment,
+    const int out_alignment, const unsigned flags)
+  {
+    const bool complex = (type == DFT1D || type == DFT2D);
+    const size_t size = (size_t)n0 * n1 *
+      (complex ? sizeof(fftw_complex) : sizeof(double));
+    PlanningBuffer in(size, in_alignment);
+    boost::shared_ptr<PlanningBuffer> out_buffer;
+    if (!inplace) out_buffer.reset(new PlanningBuffer(size, out_alignment));
+    const PlanningBuffer& out = (inplace ? in : *out_buffer);
+
+    fftw_plan p = 0;
+    switch (type) {
+      case DFT1D:
+        p = fftw_plan_dft_1d(n0, in.get<fftw_complex>(),
+            out.get<fftw_complex>(), kind, flags);
+        break;
+      case DFT2D:
+        p = fftw_plan_dft_2d(n0, n1, in.get<fftw_complex>(),
+            out.get<fftw_complex>(), kind, flags);
+        break;
+      case R2R1D:
+        p = fftw_plan_r2r_1d(n0, in.get<double>(), out.get<double>(),
+            (fftw_r2r_kind)kind, flags);
+        break;
+      case R2R2D:
+        p = fftw_plan_r2r_2d(n0, n1, in.get<double>(), out.get<double>(),
+            (fftw_r2r_kind)kind, (fftw_r2r_kind)kind, flags);
+        break;
+    }
+    if (!p) throw std::runtime_error("FFTW could not create a plan");
+    return p;
+  }
+
+  /**
+   * Returns the plan for the given transform and arrays, creating it if
+   * required
+   */
+  template <typename T>
+  boost::shared_ptr<Plan> getPlan(const TransformType type, const int n0,
+    const int n1, const int kind, T* in, T* out)
+  {
+    const bool inplace = (in == out);
+    const int in_alignment = fftw_alignment_of(reinterpret_cast<double*>(in));
+    const int out_alignment =
+      fftw_alignment_of(reinterpret_cast<double*>(out));
+
+    // Looks the plan up, which only requires a shared lock
+    unsigned flags;
+    {
+      boost::shared_lock<boost::shared_mutex> lock(cache_mutex());
+      flags = rigor_flags();
+      const PlanKey key(type, n0, n1, kind, inplace, in_alignment,
+          out_alignment, flags);
+      PlanMap::const_iterator it = plans().find(key);
+      if (it != plans().end()) return it->second;
+    }
+
+    // Creates the plan and adds it to the cache, releasing the oldest plans
+    // if it is full. The cache is only locked for the insertion, such that
+    // the lookups are not delayed when timing the algorithms. The released
+    // plans are destroyed at the end of the function, once both mutexes have
+    // been unlocked.
+    const PlanKey key(type, n0, n1, kind, inplace, in_alignment,
+        out_alignment, flags);
+    std::vector<boost::shared_ptr<Plan> > released;
+    boost::shared_ptr<Plan> plan;
+    {
+      boost::lock_guard<boost::mutex> lock(planner_mutex());
+      {
+        // Another thread may have created the plan in the meantime
+        boost::shared_lock<boost::shared_mutex> cache_lock(cache_mutex());
+        PlanMap::const_iterator it = plans().find(key);
+        if (it != plans().end()) return it->second;
+      }
+
+      plan.reset(new Plan(createPlan(type, n0, n1, kind, inplace,
+              in_alignment, out_alignment, flags)));
+
+      boost::unique_lock<boost::shared_mutex> cache_lock(cache_mutex());
+      if (plan_capacity() > 0) {
+        plans()[key] = plan;
+        plan_order().push_back(key);
+        shrinkCache(plan_capacity(), released);
+      }
+    }
+    return plan;
+  }
+
+}
+
+void bob::sp::detail::fftwExecuteDFT1D(const int n, fftw_complex* in,
+  fftw_complex* out, const int sign)
+{
+  if (n <= 0) return;
+  boost::shared_ptr<Plan> plan = getPlan(DFT1D, n, 1, sign, in, out);
+  fftw_execute_dft(plan->get(), in, out);
+}
+
+void bob::sp::detail::fftwExecuteDFT2D(const int n0, const int n1,
+  fftw_complex* in, fftw_complex* out, const int sign)
+{
+  if (n0 <= 0 || n1 <= 0) return;
+  boost::shared_ptr<Plan> plan = getPlan(DFT2D, n0, n1, sign, in, out);
+  fftw_execute_dft(plan->get(), in, out);
+}
+
+void bob::sp::detail::fftwExecuteR2R1D(const int n, double* in,
+  double* out, const fftw_r2r_kind kind)
+{
+  if (n <= 0) return;
+  boost::shared_ptr<Plan> plan = getPlan(R2R1D, n, 1, kind, in, out);
+  fftw_execute_r2r(plan->get(), in, out);
+}
+
+void bob::sp::detail::fftwExecuteR2R2D(const int n0, const int n1,
+  double* in, double* out, const fftw_r2r_kind kind)
+{
+  if (n0 <= 0 || n1 <= 0) return;
+  boost::shared_ptr<Plan> plan = getPlan(R2R2D, n0, n1, kind, in, out);
+  fftw_execute_r2r(plan->get(), in, out);
+}
+
+
+void bob::sp::setFFTWPlanningRigor(const bob::sp::FFTW::PlanningRigor rigor)
+{
+  boost::unique_lock<boost::shared_mutex> lock(cache_mutex());
+  switch (rigor) {
+    case FFTW::Measure:
+      rigor_flags() = FFTW_MEASURE;
+      break;
+    case FFTW::Patient:
+      rigor_flags() = FFTW_PATIENT;
+      break;
+    default:
+      rigor_flags() = FFTW_ESTIMATE;
+  }
+}
+
+bob::sp::FFTW::PlanningRigor bob::sp::getFFTWPlanningRigor()
+{
+  boost::shared_lock<boost::shared_mutex> lock(cache_mutex());
+  if (rigor_flags() == FFTW_MEASURE) return FFTW::Measure;
+  else if (rigor_flags() == FFTW_PATIENT) return FFTW::Patient;
+  else return FFTW::Estimate;
+}
+
+bool bob::sp::importFFTWWisdom(const std::string& filename)
+{
+  boost::lock_guard<boost::mutex> lock(planner_mutex());
+  FILE* f = fopen(filename.c_str(), "r");
+  if (!f) return false;
+  const int res = fftw_import_wisdom_from_file(f);
+  fclose(f);
+  return res != 0;
+}
+
+bool bob::sp::exportFFTWWisdom(const std::string& filename)
+{
+  boost::lock_guard<boost::mutex> lock(planner_mutex());
+  FILE* f = fopen(filename.c_str(), "w");
+  if (!f) return false;
+  fftw_export_wisdom_to_file(f);
+  return fclose(f) == 0;
+}
+
+void bob::sp::clearFFTWPlanCache()
+{
+  // The plans are destroyed once the mutex is released, as their
+  // destructor needs to acquire the planner mutex
+  PlanMap old;
+  {
+    boost::unique_lock<boost::shared_mutex> lock(cache_mutex());
+    old.swap(plans());
+    plan_order().clear();
+  }
+}
+
+size_t bob::sp::getFFTWPlanCacheSize()
+{
+  boost::shared_lock<boost::shared_mutex> lock(cache_mutex());
+  return plans().size();
+}
+
+void bob::sp::setFFTWPlanCacheCapacity(const size_t capacity)
+{
+  std::vector<boost::shared_ptr<Plan> > released;
+  {
+    boost::unique_lock<boost::shared_mutex> lock(cache_mutex());
+    plan_capacity() = capacity;
+    shrinkCache(capacity, released);
+  }
+}
+
+size_t bob::sp::getFFTWPlanCacheCapacity()
+{
+  boost::shared_lock<boost::shared_mutex> lock(cache_mutex());
+  return plan_capacity();
+}
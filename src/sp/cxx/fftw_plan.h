@@ -0,0 +1,61 @@
+/**
+ * @file sp/cxx/fftw_plan.h
+ * @date Sat Oct 17 16:05:12 2026 +0200
+ *
+ * @brief Internal interface to the process-wide cache of FFTW plans. The
+ * transforms are executed with the new-array execute functions of FFTW,
+ * such that a single plan is used for all the arrays of a given size.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOB_SP_FFTW_PLAN_H
+#define BOB_SP_FFTW_PLAN_H
+
+#include <fftw3.h>
+
+namespace bob { namespace sp { namespace detail {
+
+  /**
+   * @brief Executes a complex 1D DFT of length n (sign is FFTW_FORWARD or
+   * FFTW_BACKWARD). in and out may be the same array.
+   */
+  void fftwExecuteDFT1D(const int n, fftw_complex* in, fftw_complex* out,
+    const int sign);
+
+  /**
+   * @brief Executes a complex 2D DFT of size n0xn1 (sign is FFTW_FORWARD or
+   * FFTW_BACKWARD). in and out may be the same array.
+   */
+  void fftwExecuteDFT2D(const int n0, const int n1, fftw_complex* in,
+    fftw_complex* out, const int sign);
+
+  /**
+   * @brief Executes a real-to-real 1D transform of length n. in and out may
+   * be the same array.
+   */
+  void fftwExecuteR2R1D(const int n, double* in, double* out,
+    const fftw_r2r_kind kind);
+
+  /**
+   * @brief Executes a real-to-real 2D transform of size n0xn1 (with the
+   * same kind along both dimensions). in and out may be the same array.
+   */
+  void fftwExecuteR2R2D(const int n0, const int n1, double* in, double* out,
+    const fftw_r2r_kind kind);
+
+}}}
+
+#endif /* BOB_SP_FFTW_PLAN_H */
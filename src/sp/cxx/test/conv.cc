@@ -423,4 +423,70 @@ BOOST_AUTO_TEST_CASE( test_convolve_2D_3x4_2x2 )
     bob::sp::Conv::Valid);
 }
 
+// Compares the FFT-based engines with the direct computation, for large
+// kernels
+BOOST_AUTO_TEST_CASE( test_convolve_fft )
+{
+  const bob::sp::Conv::SizeOption opts[] = 
+    {bob::sp::Conv::Full, bob::sp::Conv::Same, bob::sp::Conv::Valid};
+
+  // 1D: long signal (overlap-add)
+  blitz::Array<double,1> a(2000), b(100);
+  blitz::firstIndex i;
+  a = blitz::sin(0.01*i) + 0.3*blitz::cos(0.7*i);
+  b = blitz::exp(-0.001*(i-50)*(i-50));
+  for (int k=0; k<3; ++k) {
+    blitz::Array<double,1> c(bob::sp::getConvOutputSize(a, b, opts[k]));
+    blitz::Array<double,1> c_ref(c.shape());
+    const int N = b.extent(0);
+    const int offset_0 = (k==0 ? N-1 : (k==1 ? N/2 : 0));
+    const int offset_1 = (k==0 ? 1 : (k==1 ? (N+1)/2 : N));
+    bob::sp::detail::convInternal(a, b, c_ref, offset_0, offset_1);
+    bob::sp::conv(a, b, c, opts[k]);
+    for (int j=0; j<c.extent(0); ++j)
+      BOOST_CHECK_SMALL(c(j) - c_ref(j), eps_d);
+  }
+
+  // 2D
+  blitz::Array<double,2> A(40,40), B(15,15);
+  blitz::secondIndex j;
+  A = blitz::sin(0.1*i) * blitz::cos(0.2*j) + 0.01*i*j;
+  B = blitz::exp(-0.05*((i-7)*(i-7) + (j-7)*(j-7)));
+  for (int k=0; k<3; ++k) {
+    blitz::Array<double,2> C(bob::sp::getConvOutputSize(A, B, opts[k]));
+    blitz::Array<double,2> C_ref(C.shape());
+    const int N0 = B.extent(0);
+    const int N1 = B.extent(1);
+    if (k==0)
+      bob::sp::detail::convInternal(A, B, C_ref, N0-1, 1, N1-1, 1);
+    else if (k==1)
+      bob::sp::detail::convInternal(A, B, C_ref, N0/2, (N0+1)/2, N1/2, 
+        (N1+1)/2);
+    else
+      bob::sp::detail::convInternal(A, B, C_ref, 0, N0, 0, N1);
+    bob::sp::conv(A, B, C, opts[k]);
+    for (int x=0; x<C.extent(0); ++x)
+      for (int y=0; y<C.extent(1); ++y)
+        BOOST_CHECK_SMALL(C(x,y) - C_ref(x,y), eps_d);
+  }
+
+  // Separable convolution along both dimensions
+  blitz::Array<double,2> S(300,50);
+  S = blitz::sin(0.05*i) + blitz::cos(0.3*j);
+  for (int k=0; k<3; ++k) {
+    blitz::Array<double,2> C(bob::sp::getConvSepOutputSize(S, b, 0, opts[k]));
+    bob::sp::convSep(S, b, C, 0, opts[k]);
+    for (int y=0; y<S.extent(1); ++y) {
+      blitz::Array<double,1> c_ref(C.extent(0));
+      blitz::Array<double,1> s = S(blitz::Range::all(), y);
+      const int N = b.extent(0);
+      const int offset_0 = (k==0 ? N-1 : (k==1 ? N/2 : 0));
+      const int offset_1 = (k==0 ? 1 : (k==1 ? (N+1)/2 : N));
+      bob::sp::detail::convInternal(s, b, c_ref, offset_0, offset_1);
+      for (int x=0; x<C.extent(0); ++x)
+        BOOST_CHECK_SMALL(C(x,y) - c_ref(x), eps_d);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,7 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
+#include <boost/filesystem.hpp>
 
 #include <bob/sp/fftshift.h>
 #include <bob/sp/FFT1D.h>
@@ -36,8 +37,10 @@
 #include <bob/sp/DCT1DNaive.h>
 #include <bob/sp/DCT2D.h>
 #include <bob/sp/DCT2DNaive.h>
+#include <bob/sp/fftw.h>
 // Random number
 #include <cstdlib>
+#include <cstdio>
 
 struct T {
   double eps;
@@ -489,4 +492,80 @@ BOOST_AUTO_TEST_CASE( test_fftshift2D_random )
   }
 }
 
+BOOST_AUTO_TEST_CASE( test_fftw_plan_cache )
+{
+  bob::sp::clearFFTWPlanCache();
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanCacheSize(), (size_t)0 );
+
+  // Transforms of the same size and kind share their plan (as long as the
+  // arrays have the same SIMD alignment, which is part of the key)
+  const int N = 37;
+  blitz::Array<std::complex<double>,1> t1(N), t2(N), r1(N), r2(N);
+  for (int i=0; i<N; ++i) {
+    t1(i) = std::complex<double>(1.0+i, 0);
+    t2(i) = std::complex<double>(0, 2.0*i-3);
+  }
+  bob::sp::FFT1D fft(N);
+  fft(t1, r1);
+  r2 = r1;
+  fft(t1, r1);
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanCacheSize(), (size_t)1 );
+  bob::sp::FFT1D fft_other(N);
+  fft_other(t1, r1);
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanCacheSize(), (size_t)1 );
+  for (int i=0; i<N; ++i)
+    BOOST_CHECK_SMALL( abs(r1(i)-r2(i)), eps);
+
+  // Arrays with another alignment get their own plan
+  blitz::Array<std::complex<double>,1> t_big(N+1), r_big(N+1);
+  t_big = 0.;
+  t_big(blitz::Range(1,N)) = t1;
+  blitz::Array<std::complex<double>,1> t_shifted(N), r_shifted(N);
+  t_shifted.reference(t_big(blitz::Range(1,N)));
+  r_shifted.reference(r_big(blitz::Range(1,N)));
+  fft(t_shifted, r_shifted);
+  for (int i=0; i<N; ++i)
+    BOOST_CHECK_SMALL( abs(r_shifted(i)-r2(i)), eps);
+
+  // Measured plans give the same results as the estimated ones
+  bob::sp::setFFTWPlanningRigor(bob::sp::FFTW::Measure);
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanningRigor(), bob::sp::FFTW::Measure );
+  test_fft1D( t2, eps);
+  blitz::Array<double,2> t3(6,5);
+  for (int i=0; i<6; ++i)
+    for (int j=0; j<5; ++j)
+      t3(i,j) = 1.0+i-0.5*j*j;
+  test_fct2D( t3, eps);
+  bob::sp::setFFTWPlanningRigor(bob::sp::FFTW::Estimate);
+
+  // Wisdom export and import
+  const std::string filename = (boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("bob_fftw_%%%%-%%%%-%%%%.wisdom")).string();
+  BOOST_CHECK( bob::sp::exportFFTWWisdom(filename) );
+  BOOST_CHECK( bob::sp::importFFTWWisdom(filename) );
+  std::remove(filename.c_str());
+  BOOST_CHECK( !bob::sp::importFFTWWisdom(filename) );
+
+  // The oldest plans are released when the cache is full
+  bob::sp::clearFFTWPlanCache();
+  const size_t capacity = bob::sp::getFFTWPlanCacheCapacity();
+  bob::sp::setFFTWPlanCacheCapacity(2);
+  for (int n=1; n<=4; ++n) {
+    blitz::Array<std::complex<double>,1> tn(n), rn(n);
+    tn = std::complex<double>(1.0, -1.0);
+    bob::sp::FFT1D fft_n(n);
+    fft_n(tn, rn);
+    BOOST_CHECK_SMALL( abs(rn(0)-std::complex<double>(n, -n)), eps);
+  }
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanCacheSize(), (size_t)2 );
+  bob::sp::setFFTWPlanCacheCapacity(0);
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanCacheSize(), (size_t)0 );
+  test_fft1D( t1, eps);
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanCacheSize(), (size_t)0 );
+  bob::sp::setFFTWPlanCacheCapacity(capacity);
+
+  bob::sp::clearFFTWPlanCache();
+  BOOST_CHECK_EQUAL( bob::sp::getFFTWPlanCacheSize(), (size_t)0 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
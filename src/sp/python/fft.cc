@@ -28,6 +28,7 @@
 #include <bob/sp/FFT1DNaive.h>
 #include <bob/sp/FFT2DNaive.h>
 #include <bob/sp/fftshift.h>
+#include <bob/sp/fftw.h>
 
 
 using namespace boost::python;
@@ -325,4 +326,19 @@ void bind_sp_fft()
 
   def("fftshift", &py_fftshift, (arg("input"),arg("output")), FFTSHIFT_DOC);
   def("ifftshift", &py_ifftshift, (arg("input"),arg("output")), IFFTSHIFT_DOC);
+
+  // FFTW planning
+  enum_<bob::sp::FFTW::PlanningRigor>("FFTWPlanningRigor")
+    .value("ESTIMATE", bob::sp::FFTW::Estimate)
+    .value("MEASURE", bob::sp::FFTW::Measure)
+    .value("PATIENT", bob::sp::FFTW::Patient)
+    ;
+
+  def("set_fftw_planning_rigor", &bob::sp::setFFTWPlanningRigor, (arg("rigor")), "Sets the rigor used to create new FFTW plans. ESTIMATE (default) creates plans quickly, while MEASURE and PATIENT time several algorithms on the first transform of a given size, leading to faster transforms afterwards.");
+  def("get_fftw_planning_rigor", &bob::sp::getFFTWPlanningRigor, "Returns the rigor used to create new FFTW plans.");
+  def("import_fftw_wisdom", &bob::sp::importFFTWWisdom, (arg("filename")), "Imports FFTW wisdom from the given file. Returns False if the wisdom could not be read.");
+  def("export_fftw_wisdom", &bob::sp::exportFFTWWisdom, (arg("filename")), "Exports the FFTW wisdom accumulated so far to the given file. Returns False if the file could not be written.");
+  def("clear_fftw_plan_cache", &bob::sp::clearFFTWPlanCache, "Releases all the cached FFTW plans.");
+  def("set_fftw_plan_cache_capacity", &bob::sp::setFFTWPlanCacheCapacity, (arg("capacity")), "Sets the maximum number of cached FFTW plans (256 by default). When the cache is full, the oldest plans are released first. With a capacity of 0, the plans are not cached at all.");
+  def("get_fftw_plan_cache_capacity", &bob::sp::getFFTWPlanCacheCapacity, "Returns the maximum number of cached FFTW plans.");
 }
@@ -21,6 +21,9 @@
 #include <bob/trainer/GMMTrainer.h>
 #include <bob/core/assert.h>
 #include <bob/core/check.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/parallel.h>
+#include <vector>
 
 bob::trainer::GMMTrainer::GMMTrainer(const bool update_means, 
     const bool update_variances, const bool update_weights,
@@ -28,14 +31,16 @@ bob::trainer::GMMTrainer::GMMTrainer(const bool update_means,
   bob::trainer::EMTrainer<bob::machine::GMMMachine, blitz::Array<double,2> >(), 
   m_update_means(update_means), m_update_variances(update_variances),
   m_update_weights(update_weights), 
-  m_mean_var_update_responsibilities_threshold(mean_var_update_responsibilities_threshold) 
+  m_mean_var_update_responsibilities_threshold(mean_var_update_responsibilities_threshold),
+  m_n_threads(1)
 {
 }
 
 bob::trainer::GMMTrainer::GMMTrainer(const bob::trainer::GMMTrainer& b):
   bob::trainer::EMTrainer<bob::machine::GMMMachine, blitz::Array<double,2> >(b),
   m_update_means(b.m_update_means), m_update_variances(b.m_update_variances),
-  m_mean_var_update_responsibilities_threshold(b.m_mean_var_update_responsibilities_threshold)
+  m_mean_var_update_responsibilities_threshold(b.m_mean_var_update_responsibilities_threshold),
+  m_n_threads(b.m_n_threads)
 {
 }
 
@@ -50,12 +55,54 @@ void bob::trainer::GMMTrainer::initialization(bob::machine::GMMMachine& gmm,
   m_ss.resize(gmm.getNGaussians(),gmm.getNInputs());
 }
 
+/**
+ * Accumulates the statistics of the samples [begin, end) of data into
+ * the GMMStats of the given thread.
+ */
+static void accStatisticsChunk(const bob::machine::GMMMachine& gmm,
+  const blitz::Array<double,2>& data,
+  std::vector<bob::machine::GMMStats>& stats, const size_t thread,
+  const size_t begin, const size_t end)
+{
+  // The chunk is wrapped (without any reference counting) around the
+  // memory of data, as blitz views are not thread-safe
+  const blitz::TinyVector<int,2> shape(end-begin, data.extent(1));
+  const blitz::Array<double,2> chunk(
+    const_cast<double*>(data.data()) + begin*data.extent(1), shape,
+    blitz::neverDeleteData);
+  gmm.accStatistics_(chunk, stats[thread]);
+}
+
 void bob::trainer::GMMTrainer::eStep(bob::machine::GMMMachine& gmm,
   const blitz::Array<double,2>& data) 
 {
   m_ss.init();
-  // Calculate the sufficient statistics and save in m_ss
-  gmm.accStatistics(data, m_ss);
+  const size_t n_threads = bob::core::parallel_threads(data.extent(0), m_n_threads);
+  if (n_threads == 1) {
+    // Calculate the sufficient statistics and save in m_ss
+    gmm.accStatistics(data, m_ss);
+    return;
+  }
+
+  // Checks the input (this is not done by accStatistics_())
+  bob::core::array::assertSameDimensionLength(data.extent(1), gmm.getNInputs());
+  bob::core::array::assertSameDimensionLength(m_ss.sumPx.extent(0), gmm.getNGaussians());
+  bob::core::array::assertSameDimensionLength(m_ss.sumPx.extent(1), gmm.getNInputs());
+
+  // Calculate the sufficient statistics of each chunk of samples in
+  // parallel, each thread using its own GMMStats
+  const blitz::Array<double,2> data_c = 
+    (bob::core::array::isCZeroBaseContiguous(data) ? data : 
+     bob::core::array::ccopy(data));
+  std::vector<bob::machine::GMMStats> stats(n_threads,
+    bob::machine::GMMStats(gmm.getNGaussians(), gmm.getNInputs()));
+  bob::core::parallel_for(boost::bind(&accStatisticsChunk, boost::cref(gmm),
+      boost::cref(data_c), boost::ref(stats), _1, _2, _3), 
+    data.extent(0), n_threads);
+
+  // Merge the statistics and save in m_ss
+  for (size_t t=0; t<n_threads; ++t)
+    m_ss += stats[t];
 }
 
 double bob::trainer::GMMTrainer::computeLikelihood(bob::machine::GMMMachine& gmm)
@@ -80,6 +127,7 @@ bob::trainer::GMMTrainer& bob::trainer::GMMTrainer::operator=
     m_update_variances = other.m_update_variances;
     m_update_weights = other.m_update_weights;
     m_mean_var_update_responsibilities_threshold = other.m_mean_var_update_responsibilities_threshold;
+    m_n_threads = other.m_n_threads;
   }
   return *this;
 }
@@ -24,11 +24,12 @@
 #include <bob/core/array_copy.h>
 #include <bob/core/array_random.h>
 #include <bob/core/check.h>
-#include <bob/math/inv.h>
+#include <bob/core/parallel.h>
 #include <bob/math/linear.h>
 #include <bob/math/linsolve.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/random.hpp>
+#include <algorithm>
 
 bob::trainer::IVectorTrainer::IVectorTrainer(const bool update_sigma,
     const double convergence_threshold,
@@ -36,28 +37,24 @@ bob::trainer::IVectorTrainer::IVectorTrainer(const bool update_sigma,
   bob::trainer::EMTrainer<bob::machine::IVectorMachine, 
     std::vector<bob::machine::GMMStats> >(convergence_threshold,
       max_iterations, compute_likelihood), 
-  m_update_sigma(update_sigma)
+  m_update_sigma(update_sigma),
+  m_n_threads(1)
 {
 }
 
 bob::trainer::IVectorTrainer::IVectorTrainer(const bob::trainer::IVectorTrainer& other):
   bob::trainer::EMTrainer<bob::machine::IVectorMachine, 
     std::vector<bob::machine::GMMStats> >(other),
-  m_update_sigma(other.m_update_sigma)
+  m_update_sigma(other.m_update_sigma),
+  m_n_threads(other.m_n_threads)
 {
   m_acc_Nij_wij2.reference(bob::core::array::ccopy(other.m_acc_Nij_wij2));
   m_acc_Fnormij_wij.reference(bob::core::array::ccopy(other.m_acc_Fnormij_wij));
   m_acc_Nij.reference(bob::core::array::ccopy(other.m_acc_Nij));
   m_acc_Snormij.reference(bob::core::array::ccopy(other.m_acc_Snormij));
 
-  m_tmp_wij.reference(bob::core::array::ccopy(other.m_tmp_wij));
-  m_tmp_wij2.reference(bob::core::array::ccopy(other.m_tmp_wij2));
   m_tmp_d1.reference(bob::core::array::ccopy(other.m_tmp_d1));
-  m_tmp_t1.reference(bob::core::array::ccopy(other.m_tmp_t1));
   m_tmp_dd1.reference(bob::core::array::ccopy(other.m_tmp_dd1));
-  m_tmp_dt1.reference(bob::core::array::ccopy(other.m_tmp_dt1));
-  m_tmp_tt1.reference(bob::core::array::ccopy(other.m_tmp_tt1));
-  m_tmp_tt2.reference(bob::core::array::ccopy(other.m_tmp_tt2));
 }
 
 bob::trainer::IVectorTrainer::~IVectorTrainer() 
@@ -82,13 +79,7 @@ void bob::trainer::IVectorTrainer::initialization(
   }
 
   // Tmp
-  m_tmp_wij.resize(Rt);
-  m_tmp_wij2.resize(Rt,Rt);
   m_tmp_d1.resize(D);
-  m_tmp_t1.resize(Rt);
-  m_tmp_dt1.resize(D,Rt);
-  m_tmp_tt1.resize(Rt,Rt);
-  m_tmp_tt2.resize(Rt,Rt);
   if (m_update_sigma)
     m_tmp_dd1.resize(D,D);
 
@@ -100,13 +91,84 @@ void bob::trainer::IVectorTrainer::initialization(
   machine.precompute();
 }
 
+namespace {
+  /**
+   * Accumulators of the E-step, for a chunk of the data
+   */
+  struct IVectorAccumulators
+  {
+    blitz::Array<double,3> Nij_wij2;
+    blitz::Array<double,3> Fnormij_wij;
+    blitz::Array<double,1> Nij;
+    blitz::Array<double,2> Snormij;
+  };
+}
+
+/**
+ * Accumulates the statistics of the GMMStats [begin, end) into the
+ * accumulators of the given thread. The (contiguous) arrays shared between
+ * threads are only accessed through raw pointers or element-wise, as blitz
+ * reference counting is not thread-safe.
+ */
+static void eStepChunk(const bob::machine::IVectorMachine& machine,
+  const std::vector<bob::machine::GMMStats>& data, const bool update_sigma,
+  const double* ubm_mean, std::vector<IVectorAccumulators>& accs,
+  const size_t thread, const size_t begin, const size_t end)
+{
+  const int C = machine.getDimC();
+  const int D = machine.getDimD();
+  const int Rt = machine.getDimRt();
+  const int P = Rt + 1;
+
+  bob::machine::IVectorMachine::Posterior posterior(Rt, true);
+  std::vector<double> wij2(Rt*Rt);
+  IVectorAccumulators& acc = accs[thread];
+  double* acc_Nij_wij2 = acc.Nij_wij2.data();
+  double* acc_Fnormij_wij = acc.Fnormij_wij.data();
+  double* acc_Nij = (update_sigma ? acc.Nij.data() : 0);
+  double* acc_Snormij = (update_sigma ? acc.Snormij.data() : 0);
+
+  for (size_t i=begin; i<end; ++i)
+  {
+    const bob::machine::GMMStats& gs = data[i];
+    // Computes E{wij} (first column of the solution) and
+    // \f$(Id + T^{T} \Sigma^{-1} T)^{-1}\f$ (remaining columns)
+    machine.computePosterior_(gs, posterior);
+    const double* sol = posterior.solution.data();
+    // Computes \f$E{wij.wij^{T}} = (Id + T^{T} \Sigma^{-1} T)^{-1} + E{wij}.E{wij^{T}}\f$
+    for (int k=0; k<Rt; ++k)
+      for (int l=0; l<Rt; ++l)
+        wij2[k*Rt+l] = sol[k*P+1+l] + sol[k*P] * sol[l*P];
+
+    for (int c=0; c<C; ++c)
+    {
+      const double n_c = gs.n(c);
+      // acc_Nij_wij2_c += Nijc . E{wij.wij^{T}}
+      double* acc_Nij_wij2_c = acc_Nij_wij2 + c*Rt*Rt;
+      for (int k=0; k<Rt*Rt; ++k)
+        acc_Nij_wij2_c[k] += n_c * wij2[k];
+      if (update_sigma)
+        acc_Nij[c] += n_c;
+      for (int d=0; d<D; ++d)
+      {
+        const double mcd = ubm_mean[c*D+d];
+        // Fijc - Nijc * ubmmean_{c}
+        const double fnorm = gs.sumPx(c,d) - n_c * mcd;
+        // acc_Fnormij_wij += (Fijc - Nijc * ubmmean_{c}).E{wij}^{T}
+        double* acc_Fnormij_wij_cd = acc_Fnormij_wij + (c*D+d)*Rt;
+        for (int k=0; k<Rt; ++k)
+          acc_Fnormij_wij_cd[k] += fnorm * sol[k*P];
+        if (update_sigma)
+          acc_Snormij[c*D+d] += gs.sumPxx(c,d) - mcd * (gs.sumPx(c,d) + fnorm);
+      }
+    }
+  }
+}
+
 void bob::trainer::IVectorTrainer::eStep(
   bob::machine::IVectorMachine& machine,
   const std::vector<bob::machine::GMMStats>& data)
 {
-  blitz::Range rall = blitz::Range::all();
-  const int C = machine.getDimC();
-
   // Reinitializes accumulators to 0
   m_acc_Nij_wij2 = 0.;
   m_acc_Fnormij_wij = 0.;
@@ -115,46 +177,50 @@ void bob::trainer::IVectorTrainer::eStep(
     m_acc_Nij = 0.;
     m_acc_Snormij = 0.;
   }
-  for (std::vector<bob::machine::GMMStats>::const_iterator it = data.begin();
-       it != data.end(); ++it)
-  {
-    // Computes E{wij} and E{wij.wij^{T}}
-    // a. Computes \f$T^{T} \Sigma^{-1} F_{norm}\f$
-    machine.computeTtSigmaInvFnorm(*it, m_tmp_t1);
-    // b. Computes \f$Id + T^{T} \Sigma^{-1} T\f$
-    machine.computeIdTtSigmaInvT(*it, m_tmp_tt1);
-    // c. Computes \f$(Id + T^{T} \Sigma^{-1} T)^{-1}\f$
-    bob::math::inv(m_tmp_tt1, m_tmp_tt2);
-    // d. Computes \f$E{wij} = (Id + T^{T} \Sigma^{-1} T)^{-1} T^{T} \Sigma^{-1} F_{norm}\f$
-    bob::math::prod(m_tmp_tt2, m_tmp_t1, m_tmp_wij); // E{wij}
-    // e.  Computes \f$E{wij}.E{wij^{T}}\f$
-    bob::math::prod(m_tmp_wij, m_tmp_wij, m_tmp_wij2);
-    // f. Computes \f$E{wij.wij^{T}} = (Id + T^{T} \Sigma^{-1} T)^{-1} + E{wij}.E{wij^{T}}\f$
-    m_tmp_wij2 += m_tmp_tt2; // E{wij.wij^{T}}
 
-    if (m_update_sigma)
-      m_acc_Nij += (*it).n;
-
-    for (int c=0; c<C; ++c)
+  // The first thread directly uses the accumulators of the trainer, and
+  // the other ones their own (zeroed) copy
+  const size_t n_threads = bob::core::parallel_threads(data.size(), m_n_threads);
+  std::vector<IVectorAccumulators> accs(n_threads);
+  for (size_t t=0; t<n_threads; ++t)
+  {
+    if (t == 0)
     {
-      blitz::Array<double,2> acc_Nij_wij2_c = m_acc_Nij_wij2(c,rall,rall);
-      blitz::Array<double,2> acc_Fnormij_wij = m_acc_Fnormij_wij(c,rall,rall);
-      // acc_Nij_wij2_c += Nijc . E{wij.wij^{T}}
-      acc_Nij_wij2_c += (*it).n(c) * m_tmp_wij2;
-      blitz::Array<double,1> mc = machine.getUbm()->getGaussian(c)->getMean();
-      // m_tmp_d1 = Fijc - Nijc * ubmmean_{c}
-      m_tmp_d1 = (*it).sumPx(c,rall) - (*it).n(c)*mc; // Fnorm_c
-      // m_tmp_dt1 = (Fijc - Nijc * ubmmean_{c}).E{wij}^{T}
-      bob::math::prod(m_tmp_d1, m_tmp_wij, m_tmp_dt1); 
-      // acc_Fnormij_wij += (Fijc - Nijc * ubmmean_{c}).E{wij}^{T}
-      acc_Fnormij_wij += m_tmp_dt1;
+      accs[t].Nij_wij2.reference(m_acc_Nij_wij2);
+      accs[t].Fnormij_wij.reference(m_acc_Fnormij_wij);
+      accs[t].Nij.reference(m_acc_Nij);
+      accs[t].Snormij.reference(m_acc_Snormij);
+    }
+    else
+    {
+      accs[t].Nij_wij2.reference(bob::core::array::ccopy(m_acc_Nij_wij2));
+      accs[t].Fnormij_wij.reference(bob::core::array::ccopy(m_acc_Fnormij_wij));
       if (m_update_sigma)
       {
-        blitz::Array<double,1> acc_Snormij_c = m_acc_Snormij(c,rall);
-        acc_Snormij_c += (*it).sumPxx(c,rall) - mc*((*it).sumPx(c,rall) + m_tmp_d1);
+        accs[t].Nij.reference(bob::core::array::ccopy(m_acc_Nij));
+        accs[t].Snormij.reference(bob::core::array::ccopy(m_acc_Snormij));
       }
     }
   }
+
+  const blitz::Array<double,1>& ubm_mean =
+    machine.getUbm()->getMeanSupervector();
+  bob::core::parallel_for(boost::bind(&eStepChunk, boost::cref(machine),
+        boost::cref(data), m_update_sigma, ubm_mean.data(),
+        boost::ref(accs), _1, _2, _3),
+      data.size(), n_threads);
+
+  // Sums the accumulators of the other threads
+  for (size_t t=1; t<n_threads; ++t)
+  {
+    m_acc_Nij_wij2 += accs[t].Nij_wij2;
+    m_acc_Fnormij_wij += accs[t].Fnormij_wij;
+    if (m_update_sigma)
+    {
+      m_acc_Nij += accs[t].Nij;
+      m_acc_Snormij += accs[t].Snormij;
+    }
+  }
 }
 
 void bob::trainer::IVectorTrainer::mStep(
@@ -213,20 +279,15 @@ bob::trainer::IVectorTrainer& bob::trainer::IVectorTrainer::operator=
     bob::trainer::EMTrainer<bob::machine::IVectorMachine,
       std::vector<bob::machine::GMMStats> >::operator=(other);
     m_update_sigma = other.m_update_sigma;
+    m_n_threads = other.m_n_threads;
 
     m_acc_Nij_wij2.reference(bob::core::array::ccopy(other.m_acc_Nij_wij2));
     m_acc_Fnormij_wij.reference(bob::core::array::ccopy(other.m_acc_Fnormij_wij));
     m_acc_Nij.reference(bob::core::array::ccopy(other.m_acc_Nij));
     m_acc_Snormij.reference(bob::core::array::ccopy(other.m_acc_Snormij));
 
-    m_tmp_wij.reference(bob::core::array::ccopy(other.m_tmp_wij));
-    m_tmp_wij2.reference(bob::core::array::ccopy(other.m_tmp_wij2));
     m_tmp_d1.reference(bob::core::array::ccopy(other.m_tmp_d1));
-    m_tmp_t1.reference(bob::core::array::ccopy(other.m_tmp_t1));
     m_tmp_dd1.reference(bob::core::array::ccopy(other.m_tmp_dd1));
-    m_tmp_dt1.reference(bob::core::array::ccopy(other.m_tmp_dt1));
-    m_tmp_tt1.reference(bob::core::array::ccopy(other.m_tmp_tt1));
-    m_tmp_tt2.reference(bob::core::array::ccopy(other.m_tmp_tt2)); 
   }
   return *this;
 }
@@ -29,6 +29,8 @@
 #include <bob/core/check.h>
 #include <bob/core/Exception.h>
 #include <bob/core/array_repmat.h>
+#include <bob/core/parallel.h>
+#include <bob/math/gemm.h>
 #include <algorithm>
 
 #include <random/normal.h>
@@ -36,11 +38,12 @@
 
 bob::trainer::FABaseTrainer::FABaseTrainer(): 
   m_Nid(0), m_dim_C(0), m_dim_D(0), m_dim_ru(0), m_dim_rv(0),
-  m_x(0), m_y(0), m_z(0), m_Nacc(0), m_Facc(0)
+  m_x(0), m_y(0), m_z(0), m_Nacc(0), m_Facc(0), m_n_threads(1)
 {
 }
 
-bob::trainer::FABaseTrainer::FABaseTrainer(const bob::trainer::FABaseTrainer& other)
+bob::trainer::FABaseTrainer::FABaseTrainer(const bob::trainer::FABaseTrainer& other):
+  m_n_threads(other.m_n_threads)
 {
 }
 
@@ -186,6 +189,167 @@ void bob::trainer::FABaseTrainer::initCache()
 
 
 
+namespace {
+  /**
+   * Wraps an array (without any reference counting) around the memory of
+   * the given one, as blitz reference counting is not thread-safe
+   */
+  template <typename T, int N>
+  blitz::Array<T,N> unsharedView(const blitz::Array<T,N>& a)
+  {
+    if (a.size() == 0) return blitz::Array<T,N>(a.shape());
+    return blitz::Array<T,N>(const_cast<T*>(a.data()), a.shape(), a.stride(),
+      blitz::neverDeleteData);
+  }
+}
+
+bob::trainer::FABaseTrainer::Workspace::Workspace(
+    bob::trainer::FABaseTrainer& t, const bob::machine::FABase* m,
+    const bool own, const Accumulator acc)
+{
+  if (m) {
+    U.reference(unsharedView(m->getU()));
+    V.reference(unsharedView(m->getV()));
+    d.reference(unsharedView(m->getD()));
+    mean.reference(unsharedView(m->getUbmMean()));
+  }
+  UtSigmaInv.reference(unsharedView(t.m_cache_UtSigmaInv));
+  UProd.reference(unsharedView(t.m_cache_UProd));
+  VtSigmaInv.reference(unsharedView(t.m_cache_VtSigmaInv));
+  VProd.reference(unsharedView(t.m_cache_VProd));
+  DtSigmaInv.reference(unsharedView(t.m_cache_DtSigmaInv));
+  DProd.reference(unsharedView(t.m_cache_DProd));
+
+  if (!own) {
+    IdPlusUProd_ih.reference(t.m_cache_IdPlusUProd_ih);
+    Fn_x_ih.reference(t.m_cache_Fn_x_ih);
+    IdPlusVProd_i.reference(t.m_cache_IdPlusVProd_i);
+    Fn_y_i.reference(t.m_cache_Fn_y_i);
+    IdPlusDProd_i.reference(t.m_cache_IdPlusDProd_i);
+    Fn_z_i.reference(t.m_cache_Fn_z_i);
+    tmp_ruru.reference(t.m_tmp_ruru);
+    tmp_rvrv.reference(t.m_tmp_rvrv);
+    tmp_rv.reference(t.m_tmp_rv);
+    tmp_CD.reference(t.m_tmp_CD);
+    tmp_CD_b.reference(t.m_tmp_CD_b);
+    acc_U_A1.reference(t.m_acc_U_A1);
+    acc_U_A2.reference(t.m_acc_U_A2);
+    acc_V_A1.reference(t.m_acc_V_A1);
+    acc_V_A2.reference(t.m_acc_V_A2);
+    acc_D_A1.reference(t.m_acc_D_A1);
+    acc_D_A2.reference(t.m_acc_D_A2);
+    return;
+  }
+
+  const int C = t.m_dim_C;
+  const int CD = t.m_dim_C*t.m_dim_D;
+  const int ru = t.m_dim_ru;
+  const int rv = t.m_dim_rv;
+  IdPlusUProd_ih.resize(ru, ru);
+  Fn_x_ih.resize(CD);
+  IdPlusVProd_i.resize(rv, rv);
+  Fn_y_i.resize(CD);
+  IdPlusDProd_i.resize(CD);
+  Fn_z_i.resize(CD);
+  tmp_ruru.resize(ru, ru);
+  tmp_rvrv.resize(rv, rv);
+  tmp_rv.resize(rv);
+  tmp_CD.resize(CD);
+  tmp_CD_b.resize(CD);
+  switch (acc) {
+    case AccumulatorU:
+      acc_U_A1.resize(C, ru, ru);
+      acc_U_A1 = 0.;
+      acc_U_A2.resize(CD, ru);
+      acc_U_A2 = 0.;
+      break;
+    case AccumulatorV:
+      acc_V_A1.resize(C, rv, rv);
+      acc_V_A1 = 0.;
+      acc_V_A2.resize(CD, rv);
+      acc_V_A2 = 0.;
+      break;
+    case AccumulatorD:
+      acc_D_A1.resize(CD);
+      acc_D_A1 = 0.;
+      acc_D_A2.resize(CD);
+      acc_D_A2 = 0.;
+      break;
+    default:
+      break;
+  }
+}
+
+void bob::trainer::FABaseTrainer::parallelLoopWorker(
+  bob::trainer::FABaseTrainer& trainer, IdentityLoop loop,
+  const StatsVec& stats,
+  std::vector<boost::shared_ptr<Workspace> >& workspaces,
+  const size_t thread, const size_t begin, const size_t end)
+{
+  (trainer.*loop)(stats, *workspaces[thread], begin, end);
+}
+
+void bob::trainer::FABaseTrainer::parallelLoop(IdentityLoop loop,
+  const Accumulator acc, const bob::machine::FABase& m, const StatsVec& stats)
+{
+  // The first thread directly uses the working arrays and accumulators of
+  // the trainer, and the other ones their own (zeroed) copy
+  const size_t n_threads = bob::core::parallel_threads(stats.size(), m_n_threads);
+  std::vector<boost::shared_ptr<Workspace> > workspaces(n_threads);
+  for (size_t t=0; t<n_threads; ++t)
+    workspaces[t].reset(new Workspace(*this, &m, t>0, acc));
+
+  bob::core::parallel_for(boost::bind(&FABaseTrainer::parallelLoopWorker,
+        boost::ref(*this), loop, boost::cref(stats), boost::ref(workspaces),
+        _1, _2, _3),
+      stats.size(), n_threads);
+
+  // Sums the accumulators of the other threads
+  for (size_t t=1; t<n_threads; ++t) {
+    const Workspace& w = *workspaces[t];
+    switch (acc) {
+      case AccumulatorU:
+        m_acc_U_A1 += w.acc_U_A1;
+        m_acc_U_A2 += w.acc_U_A2;
+        break;
+      case AccumulatorV:
+        m_acc_V_A1 += w.acc_V_A1;
+        m_acc_V_A2 += w.acc_V_A2;
+        break;
+      case AccumulatorD:
+        m_acc_D_A1 += w.acc_D_A1;
+        m_acc_D_A2 += w.acc_D_A2;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void bob::trainer::FABaseTrainer::subtractUx_i(
+  const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+  const size_t id, blitz::Array<double,1>& Fn, Workspace& w) const
+{
+  // Fn -= sum_{sessions h}(N_{i,h}*U*x_{i,h})
+  const blitz::Array<double,2>& X = m_x[id];
+  const int H = X.extent(1);
+  if (H == 0) return;
+  const int C = m_dim_C;
+  const int D = m_dim_D;
+  if (w.CD_H.extent(0) != C*D || w.CD_H.extent(1) != H)
+    w.CD_H.resize(C*D, H);
+  bob::math::gemm(w.U, X, w.CD_H); // w.CD_H = U*x_{i,h} for all the sessions
+  for (int h=0; h<H; ++h) {
+    const bob::machine::GMMStats& s = *stats[h];
+    for (int c=0; c<C; ++c) {
+      const double Nihc = s.n(c);
+      for (int dd=0; dd<D; ++dd)
+        Fn(c*D+dd) -= Nihc * w.CD_H(c*D+dd, h);
+    }
+  }
+}
+
+
 //////////////////////////// V ///////////////////////////
 void bob::trainer::FABaseTrainer::computeVtSigmaInv(const bob::machine::FABase& m)
 {
@@ -218,48 +382,67 @@ void bob::trainer::FABaseTrainer::computeVProd(const bob::machine::FABase& m)
 }
 
 void bob::trainer::FABaseTrainer::computeIdPlusVProd_i(const size_t id) 
+{
+  Workspace w(*this, 0, false, NoAccumulator);
+  computeIdPlusVProd_i(id, w);
+}
+
+void bob::trainer::FABaseTrainer::computeIdPlusVProd_i(const size_t id,
+  Workspace& w) const
 {
   const blitz::Array<double,1>& Ni = m_Nacc[id];
-  bob::math::eye(m_tmp_rvrv); // m_tmp_rvrv = I
+  bob::math::eye(w.tmp_rvrv); // w.tmp_rvrv = I
   blitz::Range rall = blitz::Range::all();
   for (size_t c=0; c<m_dim_C; ++c) {
-    blitz::Array<double,2> VProd_c = m_cache_VProd(c, rall, rall);
-    m_tmp_rvrv += VProd_c * Ni(c);
+    blitz::Array<double,2> VProd_c = w.VProd(c, rall, rall);
+    w.tmp_rvrv += VProd_c * Ni(c);
   }
-  bob::math::inv(m_tmp_rvrv, m_cache_IdPlusVProd_i); // m_cache_IdPlusVProd_i = ( I+Vt*diag(sigma)^-1*Ni*V)^-1
+  bob::math::inv(w.tmp_rvrv, w.IdPlusVProd_i); // w.IdPlusVProd_i = ( I+Vt*diag(sigma)^-1*Ni*V)^-1
 }
 
 void bob::trainer::FABaseTrainer::computeFn_y_i(const bob::machine::FABase& mb,
   const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats, const size_t id)
 {
-  const blitz::Array<double,2>& U = mb.getU();
-  const blitz::Array<double,1>& d = mb.getD();
+  Workspace w(*this, &mb, false, NoAccumulator);
+  computeFn_y_i(stats, id, w);
+}
+
+void bob::trainer::FABaseTrainer::computeFn_y_i(
+  const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+  const size_t id, Workspace& w) const
+{
   // Compute Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h}) (Normalised first order statistics)
   const blitz::Array<double,1>& Fi = m_Facc[id];
-  const blitz::Array<double,1>& m = mb.getUbmMean();
   const blitz::Array<double,1>& z = m_z[id];
-  bob::core::array::repelem(m_Nacc[id], m_tmp_CD);
-  m_cache_Fn_y_i = Fi - m_tmp_CD * (m + d * z); // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i}) 
-  const blitz::Array<double,2>& X = m_x[id];
-  blitz::Range rall = blitz::Range::all();
-  for (int h=0; h<X.extent(1); ++h) // Loops over the sessions
-  {
-    blitz::Array<double,1> Xh = X(rall, h); // Xh = x_{i,h} (length: ru)
-    bob::math::prod(U, Xh, m_tmp_CD_b); // m_tmp_CD_b = U*x_{i,h}
-    const blitz::Array<double,1>& Nih = stats[h]->n;
-    bob::core::array::repelem(Nih, m_tmp_CD);
-    m_cache_Fn_y_i -= m_tmp_CD * m_tmp_CD_b; // N_{i,h} * U * x_{i,h}
-  }
+  bob::core::array::repelem(m_Nacc[id], w.tmp_CD);
+  w.Fn_y_i = Fi - w.tmp_CD * (w.mean + w.d * z); // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i}) 
+  subtractUx_i(stats, id, w.Fn_y_i, w);
   // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
 }
 
 void bob::trainer::FABaseTrainer::updateY_i(const size_t id)
+{
+  Workspace w(*this, 0, false, NoAccumulator);
+  updateY_i(id, w);
+}
+
+void bob::trainer::FABaseTrainer::updateY_i(const size_t id, Workspace& w)
 {
   // Computes yi = Ayi * Cvs * Fn_yi
   blitz::Array<double,1>& y = m_y[id];
-  // m_tmp_rv = m_cache_VtSigmaInv * m_cache_Fn_y_i = Vt*diag(sigma)^-1 * sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
-  bob::math::prod(m_cache_VtSigmaInv, m_cache_Fn_y_i, m_tmp_rv); 
-  bob::math::prod(m_cache_IdPlusVProd_i, m_tmp_rv, y);
+  // w.tmp_rv = w.VtSigmaInv * w.Fn_y_i = Vt*diag(sigma)^-1 * sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
+  bob::math::prod(w.VtSigmaInv, w.Fn_y_i, w.tmp_rv); 
+  bob::math::prod(w.IdPlusVProd_i, w.tmp_rv, y);
+}
+
+void bob::trainer::FABaseTrainer::updateYLoop(const StatsVec& stats,
+  Workspace& w, const size_t begin, const size_t end)
+{
+  for (size_t id=begin; id<end; ++id) {
+    computeIdPlusVProd_i(id, w);
+    computeFn_y_i(stats[id], id, w);
+    updateY_i(id, w);
+  }
 }
 
 void bob::trainer::FABaseTrainer::updateY(const bob::machine::FABase& m,
@@ -269,41 +452,43 @@ void bob::trainer::FABaseTrainer::updateY(const bob::machine::FABase& m,
   computeVtSigmaInv(m);
   computeVProd(m);
   // Loops over all people
-  for (size_t id=0; id<stats.size(); ++id) {
-    computeIdPlusVProd_i(id);
-    computeFn_y_i(m, stats[id], id);
-    updateY_i(id);
-  }
+  parallelLoop(&FABaseTrainer::updateYLoop, NoAccumulator, m, stats);
 }
 
-void bob::trainer::FABaseTrainer::computeAccumulatorsV(
-  const bob::machine::FABase& m,
-  const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats)
-{  
-  // Initializes the cache accumulator
-  m_acc_V_A1 = 0.;
-  m_acc_V_A2 = 0.;
-  // Loops over all people
+void bob::trainer::FABaseTrainer::accumulateVLoop(const StatsVec& stats,
+  Workspace& w, const size_t begin, const size_t end)
+{
   blitz::firstIndex i;
   blitz::secondIndex j;
   blitz::Range rall = blitz::Range::all();
-  for (size_t id=0; id<stats.size(); ++id) {
-    computeIdPlusVProd_i(id);
-    computeFn_y_i(m, stats[id], id);
+  for (size_t id=begin; id<end; ++id) {
+    computeIdPlusVProd_i(id, w);
+    computeFn_y_i(stats[id], id, w);
 
     // Needs to return values to be accumulated for estimating V
     const blitz::Array<double,1>& y = m_y[id];
-    m_tmp_rvrv = m_cache_IdPlusVProd_i;
-    m_tmp_rvrv += y(i) * y(j); 
+    w.tmp_rvrv = w.IdPlusVProd_i;
+    w.tmp_rvrv += y(i) * y(j); 
     for (size_t c=0; c<m_dim_C; ++c)
     {
-      blitz::Array<double,2> A1_y_c = m_acc_V_A1(c, rall, rall);
-      A1_y_c += m_tmp_rvrv * m_Nacc[id](c);
+      blitz::Array<double,2> A1_y_c = w.acc_V_A1(c, rall, rall);
+      A1_y_c += w.tmp_rvrv * m_Nacc[id](c);
     }
-    m_acc_V_A2 += m_cache_Fn_y_i(i) * y(j);
+    w.acc_V_A2 += w.Fn_y_i(i) * y(j);
   }
 }
 
+void bob::trainer::FABaseTrainer::computeAccumulatorsV(
+  const bob::machine::FABase& m,
+  const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats)
+{  
+  // Initializes the cache accumulator
+  m_acc_V_A1 = 0.;
+  m_acc_V_A2 = 0.;
+  // Loops over all people
+  parallelLoop(&FABaseTrainer::accumulateVLoop, AccumulatorV, m, stats);
+}
+
 void bob::trainer::FABaseTrainer::updateV(blitz::Array<double,2>& V)
 {
   blitz::Range rall = blitz::Range::all();
@@ -351,36 +536,65 @@ void bob::trainer::FABaseTrainer::computeUProd(const bob::machine::FABase& m)
 void bob::trainer::FABaseTrainer::computeIdPlusUProd_ih(
   const boost::shared_ptr<bob::machine::GMMStats>& stats) 
 {
-  const blitz::Array<double,1>& Nih = stats->n;
-  bob::math::eye(m_tmp_ruru); // m_tmp_ruru = I
+  Workspace w(*this, 0, false, NoAccumulator);
+  computeIdPlusUProd_ih(*stats, w);
+}
+
+void bob::trainer::FABaseTrainer::computeIdPlusUProd_ih(
+  const bob::machine::GMMStats& stats, Workspace& w) const
+{
+  bob::math::eye(w.tmp_ruru); // w.tmp_ruru = I
   for (size_t c=0; c<m_dim_C; ++c) {
-    blitz::Array<double,2> UProd_c = m_cache_UProd(c,blitz::Range::all(),blitz::Range::all());
-    m_tmp_ruru += UProd_c * Nih(c);
+    blitz::Array<double,2> UProd_c = w.UProd(c,blitz::Range::all(),blitz::Range::all());
+    w.tmp_ruru += UProd_c * stats.n(c);
   }
-  bob::math::inv(m_tmp_ruru, m_cache_IdPlusUProd_ih); // m_cache_IdPlusUProd_ih = ( I+Ut*diag(sigma)^-1*Ni*U)^-1
+  bob::math::inv(w.tmp_ruru, w.IdPlusUProd_ih); // w.IdPlusUProd_ih = ( I+Ut*diag(sigma)^-1*Ni*U)^-1
 }
 
 void bob::trainer::FABaseTrainer::computeFn_x_ih(const bob::machine::FABase& mb,
   const boost::shared_ptr<bob::machine::GMMStats>& stats, const size_t id)
 {
-  const blitz::Array<double,2>& V = mb.getV();
-  const blitz::Array<double,1>& d =  mb.getD();
-  // Compute Fn_x_ih = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i}) (Normalised first order statistics)
-  const blitz::Array<double,2>& Fih = stats->sumPx;
-  const blitz::Array<double,1>& m = mb.getUbmMean();
-  const blitz::Array<double,1>& z = m_z[id];
-  const blitz::Array<double,1>& Nih = stats->n;
-  bob::core::array::repelem(Nih, m_tmp_CD); 
-  for (size_t c=0; c<m_dim_C; ++c) {
-    blitz::Array<double,1> Fn_x_ih_c = m_cache_Fn_x_ih(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1));
-    Fn_x_ih_c = Fih(c,blitz::Range::all());
-  } 
-  m_cache_Fn_x_ih -= m_tmp_CD * (m + d * z); // Fn_x_ih = N_{i,h}*(o_{i,h} - m - D*z_{i}) 
+  Workspace w(*this, &mb, false, NoAccumulator);
+  computeOffset_x_i(id, w);
+  computeFn_x_ih(*stats, w.Fn_x_ih, w);
+}
 
-  const blitz::Array<double,1>& y = m_y[id];
-  bob::math::prod(V, y, m_tmp_CD_b);
-  m_cache_Fn_x_ih -= m_tmp_CD * m_tmp_CD_b;
-  // Fn_x_ih = N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i})
+void bob::trainer::FABaseTrainer::computeOffset_x_i(const size_t id,
+  Workspace& w) const
+{
+  // w.tmp_CD_b = m + D*z_{i} + V*y_{i}, which is common to all the sessions
+  bob::math::prod(w.V, m_y[id], w.tmp_CD_b);
+  w.tmp_CD_b += w.mean + w.d * m_z[id];
+}
+
+void bob::trainer::FABaseTrainer::computeFn_x_ih(
+  const bob::machine::GMMStats& stats, blitz::Array<double,1>& Fn_x_ih,
+  Workspace& w) const
+{
+  // Compute Fn_x_ih = N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i}) (Normalised first order statistics)
+  const int C = m_dim_C;
+  const int D = m_dim_D;
+  for (int c=0; c<C; ++c) {
+    const double Nihc = stats.n(c);
+    for (int dd=0; dd<D; ++dd)
+      Fn_x_ih(c*D+dd) = stats.sumPx(c,dd) - Nihc * w.tmp_CD_b(c*D+dd);
+  }
+}
+
+void bob::trainer::FABaseTrainer::computeFn_X_i(
+  const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+  const size_t id, Workspace& w) const
+{
+  // Stores Fn_x_ih for all the sessions h as the columns of w.Fn_X
+  const int H = stats.size();
+  const int CD = m_dim_C*m_dim_D;
+  if (w.Fn_X.extent(0) != CD || w.Fn_X.extent(1) != H)
+    w.Fn_X.resize(CD, H);
+  computeOffset_x_i(id, w);
+  for (int h=0; h<H; ++h) {
+    blitz::Array<double,1> Fn_x_ih = w.Fn_X(blitz::Range::all(), h);
+    computeFn_x_ih(*stats[h], Fn_x_ih, w);
+  }
 }
 
 void bob::trainer::FABaseTrainer::updateX_ih(const size_t id, const size_t h)
@@ -392,6 +606,30 @@ void bob::trainer::FABaseTrainer::updateX_ih(const size_t id, const size_t h)
   bob::math::prod(m_cache_IdPlusUProd_ih, m_tmp_ru, x);
 }
 
+void bob::trainer::FABaseTrainer::updateXLoop(const StatsVec& stats,
+  Workspace& w, const size_t begin, const size_t end)
+{
+  blitz::Range rall = blitz::Range::all();
+  for (size_t id=begin; id<end; ++id) {
+    const int H = stats[id].size();
+    if (H == 0) continue;
+    computeFn_X_i(stats[id], id, w);
+    // w.ru_H = Ut*diag(sigma)^-1 * N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i}),
+    // for all the sessions at once
+    if (w.ru_H.extent(0) != (int)m_dim_ru || w.ru_H.extent(1) != H)
+      w.ru_H.resize(m_dim_ru, H);
+    bob::math::gemm(w.UtSigmaInv, w.Fn_X, w.ru_H);
+    // Computes xih = Axih * Cus * Fn_x_ih
+    blitz::Array<double,2>& X = m_x[id];
+    for (int h=0; h<H; ++h) {
+      computeIdPlusUProd_ih(*stats[id][h], w);
+      blitz::Array<double,1> x = X(rall, h);
+      blitz::Array<double,1> ru_h = w.ru_H(rall, h);
+      bob::math::prod(w.IdPlusUProd_ih, ru_h, x);
+    }
+  }
+}
+
 void bob::trainer::FABaseTrainer::updateX(const bob::machine::FABase& m,
   const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats)
 {
@@ -399,13 +637,35 @@ void bob::trainer::FABaseTrainer::updateX(const bob::machine::FABase& m,
   computeUtSigmaInv(m);
   computeUProd(m);
   // Loops over all people
-  for (size_t id=0; id<stats.size(); ++id) {
-    int n_session_i = stats[id].size();
-    for (int s=0; s<n_session_i; ++s) {
-      computeIdPlusUProd_ih(stats[id][s]);
-      computeFn_x_ih(m, stats[id][s], id);
-      updateX_ih(id, s);
+  parallelLoop(&FABaseTrainer::updateXLoop, NoAccumulator, m, stats);
+}
+
+void bob::trainer::FABaseTrainer::accumulateULoop(const StatsVec& stats,
+  Workspace& w, const size_t begin, const size_t end)
+{
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  blitz::Range rall = blitz::Range::all();
+  for (size_t id=begin; id<end; ++id) {
+    const int H = stats[id].size();
+    if (H == 0) continue;
+    computeFn_X_i(stats[id], id, w);
+
+    // Needs to return values to be accumulated for estimating U
+    const blitz::Array<double,2>& X = m_x[id];
+    for (int h=0; h<H; ++h) {
+      computeIdPlusUProd_ih(*stats[id][h], w);
+      blitz::Array<double,1> x = X(rall, h);
+      w.tmp_ruru = w.IdPlusUProd_ih;
+      w.tmp_ruru += x(i) * x(j); 
+      for (int c=0; c<(int)m_dim_C; ++c)
+      {
+        blitz::Array<double,2> A1_x_c = w.acc_U_A1(c,rall,rall);
+        A1_x_c += w.tmp_ruru * stats[id][h]->n(c);
+      }
     }
+    // w.acc_U_A2 += sum_{sessions h}(Fn_x_ih * x_{i,h}^T)
+    bob::math::gemm(w.Fn_X, X, w.acc_U_A2, false, true, 1., 1.);
   }
 }
 
@@ -417,27 +677,7 @@ void bob::trainer::FABaseTrainer::computeAccumulatorsU(
   m_acc_U_A1 = 0.;
   m_acc_U_A2 = 0.;
   // Loops over all people
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  blitz::Range rall = blitz::Range::all();
-  for (size_t id=0; id<stats.size(); ++id) {
-    int n_session_i = stats[id].size();
-    for (int h=0; h<n_session_i; ++h) {
-      computeIdPlusUProd_ih(stats[id][h]);
-      computeFn_x_ih(m, stats[id][h], id);
-
-      // Needs to return values to be accumulated for estimating U
-      blitz::Array<double,1> x = m_x[id](rall, h);
-      m_tmp_ruru = m_cache_IdPlusUProd_ih;
-      m_tmp_ruru += x(i) * x(j); 
-      for (int c=0; c<(int)m_dim_C; ++c)
-      {
-        blitz::Array<double,2> A1_x_c = m_acc_U_A1(c,rall,rall);
-        A1_x_c += m_tmp_ruru * stats[id][h]->n(c);
-      }
-      m_acc_U_A2 += m_cache_Fn_x_ih(i) * x(j);
-    }
-  }
+  parallelLoop(&FABaseTrainer::accumulateULoop, AccumulatorU, m, stats);
 }
 
 void bob::trainer::FABaseTrainer::updateU(blitz::Array<double,2>& U)
@@ -469,47 +709,64 @@ void bob::trainer::FABaseTrainer::computeDProd(const bob::machine::FABase& m)
 }
 
 void bob::trainer::FABaseTrainer::computeIdPlusDProd_i(const size_t id)
+{
+  Workspace w(*this, 0, false, NoAccumulator);
+  computeIdPlusDProd_i(id, w);
+}
+
+void bob::trainer::FABaseTrainer::computeIdPlusDProd_i(const size_t id,
+  Workspace& w) const
 {
   const blitz::Array<double,1>& Ni = m_Nacc[id];
-  bob::core::array::repelem(Ni, m_tmp_CD); // m_tmp_CD = Ni 'repmat'
-  m_cache_IdPlusDProd_i = 1.; // m_cache_IdPlusDProd_i = Id
-  m_cache_IdPlusDProd_i += m_cache_DProd * m_tmp_CD; // m_cache_IdPlusDProd_i = I+Dt*diag(sigma)^-1*Ni*D
-  m_cache_IdPlusDProd_i = 1 / m_cache_IdPlusDProd_i; // m_cache_IdPlusVProd_i = (I+Dt*diag(sigma)^-1*Ni*D)^-1
+  bob::core::array::repelem(Ni, w.tmp_CD); // w.tmp_CD = Ni 'repmat'
+  w.IdPlusDProd_i = 1.; // w.IdPlusDProd_i = Id
+  w.IdPlusDProd_i += w.DProd * w.tmp_CD; // w.IdPlusDProd_i = I+Dt*diag(sigma)^-1*Ni*D
+  w.IdPlusDProd_i = 1 / w.IdPlusDProd_i; // w.IdPlusDProd_i = (I+Dt*diag(sigma)^-1*Ni*D)^-1
 }
 
 void bob::trainer::FABaseTrainer::computeFn_z_i(
   const bob::machine::FABase& mb,
   const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats, const size_t id)
 {
-  const blitz::Array<double,2>& U = mb.getU();
-  const blitz::Array<double,2>& V = mb.getV();
+  Workspace w(*this, &mb, false, NoAccumulator);
+  computeFn_z_i(stats, id, w);
+}
+
+void bob::trainer::FABaseTrainer::computeFn_z_i(
+  const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+  const size_t id, Workspace& w) const
+{
   // Compute Fn_z_i = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h}) (Normalised first order statistics)
   const blitz::Array<double,1>& Fi = m_Facc[id];
-  const blitz::Array<double,1>& m = mb.getUbmMean();
-  const blitz::Array<double,1>& y = m_y[id];
-  bob::core::array::repelem(m_Nacc[id], m_tmp_CD);
-  bob::math::prod(V, y, m_tmp_CD_b); // m_tmp_CD_b = V * y
-  m_cache_Fn_z_i = Fi - m_tmp_CD * (m + m_tmp_CD_b); // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i}) 
-
-  const blitz::Array<double,2>& X = m_x[id];
-  blitz::Range rall = blitz::Range::all();
-  for (int h=0; h<X.extent(1); ++h) // Loops over the sessions
-  {
-    const blitz::Array<double,1>& Nh = stats[h]->n; // Nh = N_{i,h} (length: C)
-    bob::core::array::repelem(Nh, m_tmp_CD);
-    blitz::Array<double,1> Xh = X(rall, h); // Xh = x_{i,h} (length: ru)
-    bob::math::prod(U, Xh, m_tmp_CD_b);
-    m_cache_Fn_z_i -= m_tmp_CD * m_tmp_CD_b;
-  }
+  bob::core::array::repelem(m_Nacc[id], w.tmp_CD);
+  bob::math::prod(w.V, m_y[id], w.tmp_CD_b); // w.tmp_CD_b = V * y
+  w.Fn_z_i = Fi - w.tmp_CD * (w.mean + w.tmp_CD_b); // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i}) 
+  subtractUx_i(stats, id, w.Fn_z_i, w);
   // Fn_z_i = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
 }
 
 void bob::trainer::FABaseTrainer::updateZ_i(const size_t id)
+{
+  Workspace w(*this, 0, false, NoAccumulator);
+  updateZ_i(id, w);
+}
+
+void bob::trainer::FABaseTrainer::updateZ_i(const size_t id, Workspace& w)
 {
   // Computes zi = Azi * D^T.Sigma^-1 * Fn_zi
   blitz::Array<double,1>& z = m_z[id];
-  // m_tmp_CD = m_cache_DtSigmaInv * m_cache_Fn_z_i = Dt*diag(sigma)^-1 * sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
-  z = m_cache_IdPlusDProd_i * m_cache_DtSigmaInv * m_cache_Fn_z_i; 
+  // w.DtSigmaInv * w.Fn_z_i = Dt*diag(sigma)^-1 * sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
+  z = w.IdPlusDProd_i * w.DtSigmaInv * w.Fn_z_i; 
+}
+
+void bob::trainer::FABaseTrainer::updateZLoop(const StatsVec& stats,
+  Workspace& w, const size_t begin, const size_t end)
+{
+  for (size_t id=begin; id<end; ++id) {
+    computeIdPlusDProd_i(id, w);
+    computeFn_z_i(stats[id], id, w);
+    updateZ_i(id, w);
+  }
 }
 
 void bob::trainer::FABaseTrainer::updateZ(const bob::machine::FABase& m,
@@ -519,10 +776,21 @@ void bob::trainer::FABaseTrainer::updateZ(const bob::machine::FABase& m,
   computeDtSigmaInv(m);
   computeDProd(m);
   // Loops over all people
-  for (size_t id=0; id<m_Nid; ++id) {
-    computeIdPlusDProd_i(id);
-    computeFn_z_i(m, stats[id], id);
-    updateZ_i(id);
+  parallelLoop(&FABaseTrainer::updateZLoop, NoAccumulator, m, stats);
+}
+
+void bob::trainer::FABaseTrainer::accumulateDLoop(const StatsVec& stats,
+  Workspace& w, const size_t begin, const size_t end)
+{
+  for (size_t id=begin; id<end; ++id) {
+    computeIdPlusDProd_i(id, w);
+    computeFn_z_i(stats[id], id, w);
+
+    // Needs to return values to be accumulated for estimating D
+    const blitz::Array<double,1>& z = m_z[id];
+    bob::core::array::repelem(m_Nacc[id], w.tmp_CD);
+    w.acc_D_A1 += (w.IdPlusDProd_i + z * z) * w.tmp_CD;
+    w.acc_D_A2 += w.Fn_z_i * z;
   }
 }
 
@@ -534,18 +802,7 @@ void bob::trainer::FABaseTrainer::computeAccumulatorsD(
   m_acc_D_A1 = 0.;
   m_acc_D_A2 = 0.;
   // Loops over all people
-  blitz::firstIndex i;
-  blitz::secondIndex j; 
-  for (size_t id=0; id<stats.size(); ++id) {
-    computeIdPlusDProd_i(id);
-    computeFn_z_i(m, stats[id], id);
-
-    // Needs to return values to be accumulated for estimating D
-    blitz::Array<double,1> z = m_z[id];
-    bob::core::array::repelem(m_Nacc[id], m_tmp_CD);
-    m_acc_D_A1 += (m_cache_IdPlusDProd_i + z * z) * m_tmp_CD;
-    m_acc_D_A2 += m_cache_Fn_z_i * z;
-  }
+  parallelLoop(&FABaseTrainer::accumulateDLoop, AccumulatorD, m, stats);
 }
 
 void bob::trainer::FABaseTrainer::updateD(blitz::Array<double,1>& d)
@@ -586,6 +843,7 @@ bob::trainer::ISVTrainer::ISVTrainer(const bob::trainer::ISVTrainer& other):
      other.m_compute_likelihood), 
   m_relevance_factor(other.m_relevance_factor)
 {
+  m_base_trainer.setNThreads(other.getNThreads());
 }
 
 bob::trainer::ISVTrainer::~ISVTrainer()
@@ -600,6 +858,7 @@ bob::trainer::ISVTrainer& bob::trainer::ISVTrainer::operator=
     bob::trainer::EMTrainer<bob::machine::ISVBase, 
       std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > >::operator=(other);
     m_relevance_factor = other.m_relevance_factor;
+    m_base_trainer.setNThreads(other.getNThreads());
   }
   return *this;
 }
@@ -704,6 +963,7 @@ bob::trainer::JFATrainer::JFATrainer(const size_t max_iterations):
 bob::trainer::JFATrainer::JFATrainer(const bob::trainer::JFATrainer& other):
   m_max_iterations(other.m_max_iterations), m_rng(other.m_rng)
 {
+  m_base_trainer.setNThreads(other.getNThreads());
 }
 
 bob::trainer::JFATrainer::~JFATrainer()
@@ -717,6 +977,7 @@ bob::trainer::JFATrainer& bob::trainer::JFATrainer::operator=
   {
     m_max_iterations = other.m_max_iterations;
     m_rng = other.m_rng;
+    m_base_trainer.setNThreads(other.getNThreads());
   }
   return *this;
 }
@@ -21,8 +21,15 @@
 
 #include <bob/trainer/KMeansTrainer.h>
 #include <bob/core/array_copy.h>
+#include <bob/core/check.h>
+#include <bob/core/parallel.h>
 #include <bob/trainer/Exception.h>
 #include <boost/random.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
 
 #if BOOST_VERSION >= 104700
 #include <boost/random/discrete_distribution.hpp>
@@ -32,9 +39,10 @@ bob::trainer::KMeansTrainer::KMeansTrainer(double convergence_threshold,
     size_t max_iterations, bool compute_likelihood, InitializationMethod i_m):
   bob::trainer::EMTrainer<bob::machine::KMeansMachine, blitz::Array<double,2> >(
     convergence_threshold, max_iterations, compute_likelihood), 
-  m_initialization_method(i_m),
+  m_initialization_method(i_m), m_assignment_method(DIRECT),
+  m_oversampling_rounds(5), m_oversampling_factor(2.), m_n_threads(1),
   m_rng(new boost::mt19937()), m_average_min_distance(0),
-  m_zeroethOrderStats(0), m_firstOrderStats(0,0)
+  m_zeroethOrderStats(0), m_firstOrderStats(0,0), m_bounds_data(0)
 {
 }
 
@@ -42,9 +50,14 @@ bob::trainer::KMeansTrainer::KMeansTrainer(const bob::trainer::KMeansTrainer& ot
   bob::trainer::EMTrainer<bob::machine::KMeansMachine, blitz::Array<double,2> >(
     other.m_convergence_threshold, other.m_max_iterations, other.m_compute_likelihood), 
   m_initialization_method(other.m_initialization_method),
+  m_assignment_method(other.m_assignment_method),
+  m_oversampling_rounds(other.m_oversampling_rounds),
+  m_oversampling_factor(other.m_oversampling_factor),
+  m_n_threads(other.m_n_threads),
   m_rng(other.m_rng), m_average_min_distance(other.m_average_min_distance),
   m_zeroethOrderStats(bob::core::array::ccopy(other.m_zeroethOrderStats)), 
-  m_firstOrderStats(bob::core::array::ccopy(other.m_firstOrderStats))
+  m_firstOrderStats(bob::core::array::ccopy(other.m_firstOrderStats)),
+  m_bounds_data(0)
 {
 }
  
@@ -55,10 +68,15 @@ bob::trainer::KMeansTrainer& bob::trainer::KMeansTrainer::operator=
   {
     EMTrainer<bob::machine::KMeansMachine, blitz::Array<double,2> >::operator=(other);
     m_initialization_method = other.m_initialization_method;
+    m_assignment_method = other.m_assignment_method;
+    m_oversampling_rounds = other.m_oversampling_rounds;
+    m_oversampling_factor = other.m_oversampling_factor;
+    m_n_threads = other.m_n_threads;
     m_rng = other.m_rng;
     m_average_min_distance = other.m_average_min_distance;
     m_zeroethOrderStats.reference(bob::core::array::ccopy(other.m_zeroethOrderStats));
     m_firstOrderStats.reference(bob::core::array::ccopy(other.m_firstOrderStats));
+    resetBounds();
   }
   return *this;
 }
@@ -66,6 +84,9 @@ bob::trainer::KMeansTrainer& bob::trainer::KMeansTrainer::operator=
 bool bob::trainer::KMeansTrainer::operator==(const bob::trainer::KMeansTrainer& b) const {
   return EMTrainer<bob::machine::KMeansMachine, blitz::Array<double,2> >::operator==(b) &&
          m_initialization_method == b.m_initialization_method &&
+         m_assignment_method == b.m_assignment_method &&
+         m_oversampling_rounds == b.m_oversampling_rounds &&
+         m_oversampling_factor == b.m_oversampling_factor &&
          *m_rng == *(b.m_rng) && m_average_min_distance == b.m_average_min_distance &&
          bob::core::array::hasSameShape(m_zeroethOrderStats, b.m_zeroethOrderStats) &&
          bob::core::array::hasSameShape(m_firstOrderStats, b.m_firstOrderStats) &&
@@ -76,7 +97,257 @@ bool bob::trainer::KMeansTrainer::operator==(const bob::trainer::KMeansTrainer&
 bool bob::trainer::KMeansTrainer::operator!=(const bob::trainer::KMeansTrainer& b) const {
   return !(this->operator==(b));
 }
+
+void bob::trainer::KMeansTrainer::setOversamplingRounds(const size_t v)
+{
+  if (v == 0)
+    throw std::runtime_error("the k-means|| initialization needs at least one oversampling round");
+  m_oversampling_rounds = v;
+}
+
+void bob::trainer::KMeansTrainer::setOversamplingFactor(const double v)
+{
+  if (!(v > 0.)) {
+    boost::format m("the oversampling factor of the k-means|| initialization should be strictly positive, but it is %g");
+    m % v;
+    throw std::runtime_error(m.str());
+  }
+  m_oversampling_factor = v;
+}
  
+namespace {
+  inline double squareDistance(const double* x, const double* m,
+    const size_t n_inputs)
+  {
+    double d = 0.;
+    for (size_t k=0; k<n_inputs; ++k) {
+      const double diff = x[k] - m[k];
+      d += diff * diff;
+    }
+    return d;
+  }
+
+#if BOOST_VERSION >= 104700
+  /**
+   * Number of samples sharing the same random number generator during the
+   * oversampling passes of k-means||, such that the selected candidates do
+   * not depend on the number of threads
+   */
+  const size_t KMEANS_PARALLEL_BLOCK_SIZE = 4096;
+
+  /**
+   * Data used to update the (square Euclidean) distance of each point to its
+   * closest centre, when the centres [first_centre, end_centre) are added.
+   * The (contiguous) arrays are only accessed through raw pointers, as blitz
+   * reference counting is not thread-safe.
+   */
+  struct MinDistanceData
+  {
+    size_t n_inputs;
+    const double* points;
+    const double* centres;
+    size_t first_centre;
+    size_t end_centre;
+    double* min_distance;
+    size_t* closest; ///< Index of the closest centre (optional)
+  };
+
+  void updateMinDistancesChunk(const MinDistanceData& d, const size_t thread,
+    const size_t begin, const size_t end)
+  {
+    for (size_t i=begin; i<end; ++i) {
+      const double* x = d.points + i*d.n_inputs;
+      for (size_t c=d.first_centre; c<d.end_centre; ++c) {
+        const double dist = squareDistance(x, d.centres + c*d.n_inputs,
+          d.n_inputs);
+        if (dist < d.min_distance[i]) {
+          d.min_distance[i] = dist;
+          if (d.closest) d.closest[i] = c;
+        }
+      }
+    }
+  }
+
+  void updateMinDistances(const double* points, const size_t n_points,
+    const size_t n_inputs, const double* centres, const size_t first_centre,
+    const size_t end_centre, std::vector<double>& min_distance,
+    size_t* closest, const size_t n_threads)
+  {
+    MinDistanceData d;
+    d.n_inputs = n_inputs;
+    d.points = points;
+    d.centres = centres;
+    d.first_centre = first_centre;
+    d.end_centre = end_centre;
+    d.min_distance = &min_distance[0];
+    d.closest = closest;
+    bob::core::parallel_for(boost::bind(&updateMinDistancesChunk,
+          boost::cref(d), _1, _2, _3),
+        n_points, bob::core::parallel_threads(n_points, n_threads));
+  }
+
+  /**
+   * Data of an oversampling pass of k-means||: each point is independently
+   * selected with a probability equal to factor times its square distance
+   * to the closest candidate
+   */
+  struct OversamplingData
+  {
+    size_t n_points;
+    const double* min_distance;
+    double factor;
+    const boost::uint32_t* seeds; ///< Seed of each block of points
+    std::vector<std::vector<size_t> >* selected; ///< Selection of each block
+  };
+
+  void oversampleChunk(const OversamplingData& d, const size_t thread,
+    const size_t begin, const size_t end)
+  {
+    for (size_t b=begin; b<end; ++b) {
+      boost::mt19937 rng(d.seeds[b]);
+      boost::uniform_real<> range(0., 1.);
+      boost::variate_generator<boost::mt19937&, boost::uniform_real<> > 
+        die(rng, range);
+      std::vector<size_t>& selected = (*d.selected)[b];
+      const size_t block_end = std::min(d.n_points,
+        (b+1) * KMEANS_PARALLEL_BLOCK_SIZE);
+      for (size_t i=b*KMEANS_PARALLEL_BLOCK_SIZE; i<block_end; ++i)
+        if (die() < d.factor * d.min_distance[i]) selected.push_back(i);
+    }
+  }
+
+  /**
+   * Selects n_means among the (C-contiguous) points using k-means++: the 
+   * first one is selected uniformly (or according to the weights of the 
+   * points if given), and the next ones with a probability proportional to
+   * their (weighted) square distance to the closest mean already selected.
+   */
+  void kmeansPlusPlus(const double* points, const size_t n_points,
+    const size_t n_inputs, const double* weights, boost::mt19937& rng,
+    const size_t n_threads, bob::machine::KMeansMachine& kmeans)
+  {
+    size_t index;
+    if (weights) {
+      boost::random::discrete_distribution<> die(weights, weights+n_points);
+      index = die(rng);
+    }
+    else {
+      boost::uniform_int<> range(0, n_points-1);
+      boost::variate_generator<boost::mt19937&, boost::uniform_int<> > 
+        die(rng, range);
+      index = die();
+    }
+
+    std::vector<double> min_distance(n_points,
+      std::numeric_limits<double>::infinity());
+    std::vector<double> probabilities(n_points);
+    for (size_t m=0; ; ) 
+    {
+      const double* mean = points + index*n_inputs;
+      kmeans.setMean(m, blitz::Array<double,1>(const_cast<double*>(mean),
+        blitz::shape(n_inputs), blitz::neverDeleteData));
+      if (++m == kmeans.getNMeans()) break;
+
+      // Only the distances to the new mean need to be computed
+      updateMinDistances(points, n_points, n_inputs, mean, 0, 1,
+        min_distance, 0, n_threads);
+
+      double sum = 0.;
+      for (size_t i=0; i<n_points; ++i) {
+        probabilities[i] = (weights ? weights[i] : 1.) * min_distance[i];
+        sum += probabilities[i];
+      }
+      if (sum > 0.) {
+        for (size_t i=0; i<n_points; ++i) probabilities[i] /= sum;
+        boost::random::discrete_distribution<> die(probabilities.begin(),
+          probabilities.end());
+        index = die(rng);
+      }
+      else // All the points are already means, which would leave empty clusters
+        throw bob::trainer::KMeansInitializationFailure();
+    }
+  }
+
+  /**
+   * Selects the means using k-means||: candidates are oversampled in a few
+   * (parallel) passes over the data, weighted by the number of samples 
+   * closer to them than to any other candidate, and the means are finally
+   * selected among the candidates using k-means++.
+   */
+  void kmeansParallel(const double* data, const size_t n_data,
+    const size_t n_inputs, const size_t n_rounds, const double factor,
+    boost::mt19937& rng, const size_t n_threads,
+    bob::machine::KMeansMachine& kmeans)
+  {
+    std::vector<double> candidates;
+    std::vector<double> min_distance(n_data,
+      std::numeric_limits<double>::infinity());
+    std::vector<size_t> closest(n_data, 0);
+
+    // Selects the first candidate uniformly
+    boost::uniform_int<> range(0, n_data-1);
+    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > 
+      die(rng, range);
+    const size_t first = die();
+    candidates.insert(candidates.end(), data + first*n_inputs,
+      data + (first+1)*n_inputs);
+    updateMinDistances(data, n_data, n_inputs, &candidates[0], 0, 1,
+      min_distance, &closest[0], n_threads);
+
+    const size_t n_blocks = (n_data + KMEANS_PARALLEL_BLOCK_SIZE - 1) /
+      KMEANS_PARALLEL_BLOCK_SIZE;
+    std::vector<boost::uint32_t> seeds(n_blocks);
+    std::vector<std::vector<size_t> > selected(n_blocks);
+    for (size_t r=0; r<n_rounds; ++r)
+    {
+      double cost = 0.;
+      for (size_t i=0; i<n_data; ++i) cost += min_distance[i];
+      if (cost <= 0.) break; // All the samples are candidates
+
+      for (size_t b=0; b<n_blocks; ++b) {
+        seeds[b] = rng();
+        selected[b].clear();
+      }
+      OversamplingData d;
+      d.n_points = n_data;
+      d.min_distance = &min_distance[0];
+      d.factor = factor * kmeans.getNMeans() / cost;
+      d.seeds = &seeds[0];
+      d.selected = &selected;
+      bob::core::parallel_for(boost::bind(&oversampleChunk, boost::cref(d),
+            _1, _2, _3),
+          n_blocks, bob::core::parallel_threads(n_blocks, n_threads));
+
+      const size_t n_candidates = candidates.size() / n_inputs;
+      for (size_t b=0; b<n_blocks; ++b)
+        for (size_t j=0; j<selected[b].size(); ++j)
+          candidates.insert(candidates.end(), data + selected[b][j]*n_inputs,
+            data + (selected[b][j]+1)*n_inputs);
+      updateMinDistances(data, n_data, n_inputs, &candidates[0], n_candidates,
+        candidates.size() / n_inputs, min_distance, &closest[0], n_threads);
+    }
+
+    // Weights the candidates by the number of samples they are closest to.
+    // Identical candidates get the samples of the first one only, so that
+    // the candidates with a positive weight are all different.
+    const size_t n_candidates = candidates.size() / n_inputs;
+    std::vector<double> weights(n_candidates, 0.);
+    for (size_t i=0; i<n_data; ++i) weights[closest[i]] += 1.;
+    const size_t n_distinct = n_candidates -
+      std::count(weights.begin(), weights.end(), 0.);
+
+    // With too few candidates (small oversampling factor, or unlucky draws),
+    // k-means++ would select the same candidate several times, and leave 
+    // empty clusters: the means are then selected among all the samples
+    if (n_distinct < kmeans.getNMeans())
+      kmeansPlusPlus(data, n_data, n_inputs, 0, rng, n_threads, kmeans);
+    else
+      kmeansPlusPlus(&candidates[0], n_candidates, n_inputs, &weights[0], rng,
+        n_threads, kmeans);
+  }
+#endif
+}
+
 void bob::trainer::KMeansTrainer::initialization(bob::machine::KMeansMachine& kmeans,
   const blitz::Array<double,2>& ar) 
 {
@@ -139,47 +410,149 @@ void bob::trainer::KMeansTrainer::initialization(bob::machine::KMeansMachine& km
     }
   }
 #if BOOST_VERSION >= 104700
-  else // K-Means++
+  else
   {
-    // 1.a. Selects one sample randomly
-    boost::uniform_int<> range(0, n_data-1);
-    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > die(*m_rng, range);
-    //   Gets the example at a random index
-    blitz::Array<double,1> mean = ar(die(),a);
-    kmeans.setMean(0, mean);
-
-    // 1.b. Loops, computes probability distribution and select samples accordingly
-    blitz::Array<double,1> weights(n_data);
-    for(size_t m=1; m<kmeans.getNMeans(); ++m) 
-    {
-      // For each sample, puts the distance to the closest mean in the weight vector
-      for(size_t s=0; s<n_data; ++s)
-      {
-        blitz::Array<double,1> s_cur = ar(s,a);
-        double& w_cur = weights(s);
-        // Initializes with the distance to first mean
-        w_cur = kmeans.getDistanceFromMean(s_cur, 0);
-        // Loops over the remaining mean and update the mean distance if required
-        for(size_t i=1; i<m; ++i)
-          w_cur = std::min(w_cur, kmeans.getDistanceFromMean(s_cur, i));
-      }
-      // Square and normalize the weights vectors such that
-      // \f$weights[x] = D(x)^{2} \sum_{y} D(y)^{2}\f$
-      weights = blitz::pow2(weights);
-      weights /= blitz::sum(weights);
-
-      // Takes a sample according to the weights distribution
-      // Blitz iterators is fine as the weights array should be C-style contiguous
-      bob::core::array::assertCContiguous(weights);
-      boost::random::discrete_distribution<> die2(weights.begin(), weights.end());
-      blitz::Array<double,1> new_mean = ar(die2(*m_rng),a); 
-      kmeans.setMean(m, new_mean);
-    }
+    // k-means++ and k-means|| work on a C-contiguous copy of the data, which
+    // is accessed by several threads
+    blitz::Array<double,2> data;
+    if (bob::core::array::isCZeroBaseContiguous(ar)) data.reference(ar);
+    else data.reference(bob::core::array::ccopy(ar));
+    if (m_initialization_method == KMEANS_PLUS_PLUS)
+      kmeansPlusPlus(data.data(), n_data, kmeans.getNInputs(), 0, *m_rng,
+        m_n_threads, kmeans);
+    else
+      kmeansParallel(data.data(), n_data, kmeans.getNInputs(),
+        m_oversampling_rounds, m_oversampling_factor, *m_rng, m_n_threads,
+        kmeans);
   }
 #endif
    // Resize the accumulator
   m_zeroethOrderStats.resize(kmeans.getNMeans());
   m_firstOrderStats.resize(kmeans.getNMeans(), kmeans.getNInputs());
+  // The bounds of the accelerated assignment are recomputed
+  resetBounds();
+}
+
+namespace {
+  /**
+   * Accumulators of the E-step, for a chunk of the data
+   */
+  struct KMeansAccumulators
+  {
+    blitz::Array<double,1> zeroeth;
+    blitz::Array<double,2> first;
+    double sum_min_distance;
+  };
+
+  /**
+   * Data of the E-step shared by all the threads. The (contiguous) arrays
+   * are only accessed through raw pointers, as blitz reference counting is
+   * not thread-safe.
+   */
+  struct KMeansEStepData
+  {
+    size_t n_means;
+    size_t n_inputs;
+    const double* data;
+    const double* means;
+    // Accelerated assignment only
+    bool hamerly;
+    bool exact_distance; ///< Whether the min distances must be exact
+    const double* drift; ///< Displacement of each mean since the last E-step
+    size_t max_drift_mean; ///< Mean with the largest displacement
+    double max_drift; ///< Largest displacement
+    double second_max_drift; ///< Second largest displacement
+    const double* half_separation; ///< Half the distance of each mean to its closest mean
+    size_t* assignment;
+    double* upper;
+    double* lower;
+  };
+
+  /**
+   * Finds the closest mean of x, along with the (square Euclidean) distance
+   * to the closest and second closest means
+   */
+  void findClosestMeans(const double* x, const double* means,
+    const size_t n_means, const size_t n_inputs, size_t& closest,
+    double& min_distance, double& second_min_distance)
+  {
+    closest = 0;
+    min_distance = std::numeric_limits<double>::max();
+    second_min_distance = std::numeric_limits<double>::max();
+    for (size_t c=0; c<n_means; ++c) {
+      const double d = squareDistance(x, means + c*n_inputs, n_inputs);
+      if (d < min_distance) {
+        second_min_distance = min_distance;
+        min_distance = d;
+        closest = c;
+      }
+      else if (d < second_min_distance)
+        second_min_distance = d;
+    }
+  }
+}
+
+/**
+ * Assigns the samples [begin, end) to their closest mean and accumulates
+ * the statistics into the accumulators of the given thread
+ */
+static void eStepChunk(const KMeansEStepData& d,
+  std::vector<KMeansAccumulators>& accs, const size_t thread,
+  const size_t begin, const size_t end)
+{
+  const size_t D = d.n_inputs;
+  KMeansAccumulators& acc = accs[thread];
+  double* zeroeth = acc.zeroeth.data();
+  double* first = acc.first.data();
+  for (size_t i=begin; i<end; ++i)
+  {
+    const double* x = d.data + i*D;
+    size_t closest;
+    double min_distance, second_min_distance;
+    if (!d.hamerly)
+      findClosestMeans(x, d.means, d.n_means, D, closest, min_distance,
+        second_min_distance);
+    else
+    {
+      // Updates the bounds with the displacement of the means
+      closest = d.assignment[i];
+      double& u = d.upper[i];
+      double& l = d.lower[i];
+      u += d.drift[closest];
+      l -= (closest == d.max_drift_mean ? d.second_max_drift : d.max_drift);
+
+      const double bound = std::max(d.half_separation[closest], l);
+      bool exact = false;
+      if (u > bound) {
+        // Tightens the upper bound, and searches for the closest mean if
+        // the bounds still overlap
+        min_distance = squareDistance(x, d.means + closest*D, D);
+        u = sqrt(min_distance);
+        exact = true;
+        if (u > bound) {
+          findClosestMeans(x, d.means, d.n_means, D, closest, min_distance,
+            second_min_distance);
+          d.assignment[i] = closest;
+          u = sqrt(min_distance);
+          l = sqrt(second_min_distance);
+        }
+      }
+      if (!exact) {
+        if (d.exact_distance) {
+          min_distance = squareDistance(x, d.means + closest*D, D);
+          u = sqrt(min_distance);
+        }
+        else
+          min_distance = u * u;
+      }
+    }
+
+    // Accumulates the statistics
+    acc.sum_min_distance += min_distance;
+    zeroeth[closest] += 1.;
+    double* first_c = first + closest*D;
+    for (size_t k=0; k<D; ++k) first_c[k] += x[k];
+  }
 }
 
 void bob::trainer::KMeansTrainer::eStep(bob::machine::KMeansMachine& kmeans, 
@@ -188,21 +561,104 @@ void bob::trainer::KMeansTrainer::eStep(bob::machine::KMeansMachine& kmeans,
   // initialise the accumulators
   resetAccumulators(kmeans);
 
-  // iterate over data samples
-  blitz::Range a = blitz::Range::all();
-  for(int i=0; i<ar.extent(0); ++i) {
-    // get example
-    blitz::Array<double, 1> x(ar(i,a));
+  const size_t n_samples = ar.extent(0);
+  const size_t n_means = kmeans.getNMeans();
+  const size_t n_inputs = kmeans.getNInputs();
+  blitz::Array<double,2> data;
+  if (bob::core::array::isCZeroBaseContiguous(ar)) data.reference(ar);
+  else data.reference(bob::core::array::ccopy(ar));
+  const blitz::Array<double,2> means = bob::core::array::ccopy(kmeans.getMeans());
+
+  KMeansEStepData d;
+  d.n_means = n_means;
+  d.n_inputs = n_inputs;
+  d.data = data.data();
+  d.means = means.data();
+  d.hamerly = (m_assignment_method == HAMERLY);
+
+  std::vector<double> drift(n_means, 0.);
+  std::vector<double> half_separation(n_means,
+    std::numeric_limits<double>::max());
+  if (d.hamerly)
+  {
+    // (Re)initializes the bounds if they were not computed for these data
+    // and means: the first search of each sample is then exhaustive
+    if (m_bounds_data != ar.data() || m_upper_bounds.size() != n_samples ||
+        !bob::core::array::hasSameShape(m_bounds_means, means))
+    {
+      m_assignment.assign(n_samples, 0);
+      m_upper_bounds.assign(n_samples, std::numeric_limits<double>::infinity());
+      m_lower_bounds.assign(n_samples, 0.);
+      m_bounds_means.reference(bob::core::array::ccopy(means));
+      m_bounds_data = ar.data();
+    }
+
+    // Displacement of the means since the last E-step
+    d.max_drift_mean = 0;
+    d.max_drift = 0.;
+    d.second_max_drift = 0.;
+    for (size_t c=0; c<n_means; ++c) {
+      drift[c] = sqrt(squareDistance(d.means + c*n_inputs,
+        m_bounds_means.data() + c*n_inputs, n_inputs));
+      if (drift[c] > d.max_drift) {
+        d.second_max_drift = d.max_drift;
+        d.max_drift = drift[c];
+        d.max_drift_mean = c;
+      }
+      else if (drift[c] > d.second_max_drift)
+        d.second_max_drift = drift[c];
+    }
+    m_bounds_means = means;
+
+    // Half the distance of each mean to its closest mean
+    for (size_t c=0; c<n_means; ++c)
+      for (size_t c2=c+1; c2<n_means; ++c2) {
+        const double s = 0.5 * sqrt(squareDistance(d.means + c*n_inputs,
+          d.means + c2*n_inputs, n_inputs));
+        half_separation[c] = std::min(half_separation[c], s);
+        half_separation[c2] = std::min(half_separation[c2], s);
+      }
+
+    d.exact_distance = m_compute_likelihood;
+    d.drift = &drift[0];
+    d.half_separation = &half_separation[0];
+    d.assignment = (n_samples ? &m_assignment[0] : 0);
+    d.upper = (n_samples ? &m_upper_bounds[0] : 0);
+    d.lower = (n_samples ? &m_lower_bounds[0] : 0);
+  }
+
+  // The first thread directly uses the accumulators of the trainer, and
+  // the other ones their own (zeroed) copy
+  const size_t n_threads = bob::core::parallel_threads(n_samples, m_n_threads);
+  std::vector<KMeansAccumulators> accs(n_threads);
+  for (size_t t=0; t<n_threads; ++t)
+  {
+    if (t == 0)
+    {
+      accs[t].zeroeth.reference(m_zeroethOrderStats);
+      accs[t].first.reference(m_firstOrderStats);
+    }
+    else
+    {
+      accs[t].zeroeth.reference(bob::core::array::ccopy(m_zeroethOrderStats));
+      accs[t].first.reference(bob::core::array::ccopy(m_firstOrderStats));
+    }
+    accs[t].sum_min_distance = 0.;
+  }
 
-    // find closest mean, and distance from that mean
-    size_t closest_mean = 0;
-    double min_distance = 0;
-    kmeans.getClosestMean(x,closest_mean,min_distance);
+  bob::core::parallel_for(boost::bind(&eStepChunk, boost::cref(d),
+        boost::ref(accs), _1, _2, _3),
+      n_samples, n_threads);
 
-    // accumulate the stats
-    m_average_min_distance += min_distance;
-    ++m_zeroethOrderStats(closest_mean);
-    m_firstOrderStats(closest_mean,blitz::Range::all()) += x;
+  // Sums the accumulators of the threads
+  for (size_t t=0; t<n_threads; ++t)
+  {
+    if (t > 0)
+    {
+      m_zeroethOrderStats += accs[t].zeroeth;
+      m_firstOrderStats += accs[t].first;
+    }
+    m_average_min_distance += accs[t].sum_min_distance;
   }
   m_average_min_distance /= static_cast<double>(ar.extent(0));
 }
@@ -228,6 +684,15 @@ void bob::trainer::KMeansTrainer::finalization(bob::machine::KMeansMachine& kmea
 {
 }
 
+void bob::trainer::KMeansTrainer::resetBounds()
+{
+  m_assignment.clear();
+  m_upper_bounds.clear();
+  m_lower_bounds.clear();
+  m_bounds_means.resize(0,0);
+  m_bounds_data = 0;
+}
+
 bool bob::trainer::KMeansTrainer::resetAccumulators(bob::machine::KMeansMachine& kmeans)
 {
   m_average_min_distance = 0;
@@ -24,6 +24,7 @@
 #include <bob/core/check.h>
 #include <bob/core/Exception.h>
 #include <bob/math/linear.h>
+#include <bob/math/gemm.h>
 #include <bob/trainer/Exception.h>
 #include <bob/trainer/MLPBaseTrainer.h>
 
@@ -148,16 +149,15 @@ void bob::trainer::MLPBaseTrainer::forward_step(const bob::machine::MLP& machine
   boost::shared_ptr<bob::machine::Activation> hidden_actfun = machine.getHiddenActivation();
   boost::shared_ptr<bob::machine::Activation> output_actfun = machine.getOutputActivation();
 
+  blitz::secondIndex j;
   for (size_t k=0; k<machine_weight.size(); ++k) { //for all layers
-    if (k == 0) bob::math::prod_(input, machine_weight[k], m_output[k]);
-    else bob::math::prod_(m_output[k-1], machine_weight[k], m_output[k]);
+    //output = bias + input * weight, for all the examples at once
+    m_output[k] = machine_bias[k](j);
+    if (k == 0) bob::math::gemm_(input, machine_weight[k], m_output[k], false, false, 1., 1.);
+    else bob::math::gemm_(m_output[k-1], machine_weight[k], m_output[k], false, false, 1., 1.);
     boost::shared_ptr<bob::machine::Activation> cur_actfun = 
       (k == (machine_weight.size()-1) ? output_actfun : hidden_actfun );
-    for (int i=0; i<(int)m_batch_size; ++i) { //for every example
-      for (int j=0; j<m_output[k].extent(1); ++j) { //for all variables
-        m_output[k](i,j) = cur_actfun->f(m_output[k](i,j) + machine_bias[k](j));
-      }
-    }
+    cur_actfun->f_inplace(m_output[k]);
   }
 }
 
@@ -178,20 +178,16 @@ void bob::trainer::MLPBaseTrainer::backward_step
   //all other layers
   boost::shared_ptr<bob::machine::Activation> hidden_actfun = machine.getHiddenActivation();
   for (size_t k=m_H; k>0; --k) {
-    bob::math::prod_(m_error[k], machine_weight[k].transpose(1,0), m_error[k-1]);
-    for (int i=0; i<(int)m_batch_size; ++i) { //for every example
-      for (int j=0; j<m_error[k-1].extent(1); ++j) { //for all variables
-        m_error[k-1](i,j) *= hidden_actfun->f_prime_from_f(m_output[k-1](i,j));
-      }
-    }
+    bob::math::gemm_(m_error[k], machine_weight[k], m_error[k-1], false, true, 1., 0.);
+    hidden_actfun->multiply_f_prime_from_f(m_output[k-1], m_error[k-1]);
   }
 
   //calculate the derivatives of the cost w.r.t. the weights and biases
   for (size_t k=0; k<machine_weight.size(); ++k) { //for all layers
     // For the weights
-    if (k == 0) bob::math::prod_(input.transpose(1,0), m_error[k], m_deriv[k]);
-    else bob::math::prod_(m_output[k-1].transpose(1,0), m_error[k], m_deriv[k]);
-    m_deriv[k] /= m_batch_size;
+    const double alpha = 1. / m_batch_size;
+    if (k == 0) bob::math::gemm_(input, m_error[k], m_deriv[k], true, false, alpha, 0.);
+    else bob::math::gemm_(m_output[k-1], m_error[k], m_deriv[k], true, false, alpha, 0.);
     // For the biases
     blitz::secondIndex bj;
     m_deriv_bias[k] = blitz::mean(m_error[k].transpose(1,0), bj);
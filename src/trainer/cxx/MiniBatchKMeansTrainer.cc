@@ -0,0 +1,174 @@
+/**
+ * @file trainer/cxx/MiniBatchKMeansTrainer.cc
+ * @date Sat Oct 17 18:42:10 2026 +0200
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/trainer/MiniBatchKMeansTrainer.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/check.h>
+#include <bob/core/logging.h>
+#include <bob/trainer/Exception.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+bob::trainer::MiniBatchKMeansTrainer::MiniBatchKMeansTrainer(
+    const size_t batch_size, const double convergence_threshold,
+    const size_t max_iterations,
+    const bob::trainer::KMeansTrainer::InitializationMethod i_m):
+  m_batch_size(batch_size),
+  m_convergence_threshold(convergence_threshold),
+  m_max_iterations(max_iterations),
+  m_trainer(convergence_threshold, max_iterations, true, i_m),
+  m_counts(0),
+  m_average_min_distance(0)
+{
+}
+
+bob::trainer::MiniBatchKMeansTrainer::MiniBatchKMeansTrainer(
+    const bob::trainer::MiniBatchKMeansTrainer& other):
+  m_batch_size(other.m_batch_size),
+  m_convergence_threshold(other.m_convergence_threshold),
+  m_max_iterations(other.m_max_iterations),
+  m_trainer(other.m_trainer),
+  m_counts(bob::core::array::ccopy(other.m_counts)),
+  m_average_min_distance(other.m_average_min_distance)
+{
+}
+
+bob::trainer::MiniBatchKMeansTrainer&
+bob::trainer::MiniBatchKMeansTrainer::operator=
+  (const bob::trainer::MiniBatchKMeansTrainer& other)
+{
+  if (this != &other)
+  {
+    m_batch_size = other.m_batch_size;
+    m_convergence_threshold = other.m_convergence_threshold;
+    m_max_iterations = other.m_max_iterations;
+    m_trainer = other.m_trainer;
+    m_counts.reference(bob::core::array::ccopy(other.m_counts));
+    m_average_min_distance = other.m_average_min_distance;
+  }
+  return *this;
+}
+
+bool bob::trainer::MiniBatchKMeansTrainer::operator==
+  (const bob::trainer::MiniBatchKMeansTrainer& b) const
+{
+  return m_batch_size == b.m_batch_size &&
+         m_convergence_threshold == b.m_convergence_threshold &&
+         m_max_iterations == b.m_max_iterations &&
+         m_trainer == b.m_trainer &&
+         bob::core::array::hasSameShape(m_counts, b.m_counts) &&
+         blitz::all(m_counts == b.m_counts) &&
+         m_average_min_distance == b.m_average_min_distance;
+}
+
+bool bob::trainer::MiniBatchKMeansTrainer::operator!=
+  (const bob::trainer::MiniBatchKMeansTrainer& b) const
+{
+  return !(this->operator==(b));
+}
+
+void bob::trainer::MiniBatchKMeansTrainer::initialization(
+  bob::machine::KMeansMachine& kmeans, bob::trainer::SampleSource& source)
+{
+  bob::core::array::assertSameDimensionLength(source.getNInputs(),
+    kmeans.getNInputs());
+
+  // The initial means are selected among the samples of the first batch
+  source.reset();
+  blitz::Array<double,2> batch(std::max(m_batch_size, kmeans.getNMeans()),
+    kmeans.getNInputs());
+  const int n = source.read(batch);
+  if (n < (int)kmeans.getNMeans())
+    throw bob::trainer::KMeansInitializationFailure();
+  m_trainer.initialization(kmeans, batch(blitz::Range(0, n-1),
+    blitz::Range::all()));
+
+  m_counts.resize(kmeans.getNMeans());
+  m_counts = 0.;
+  m_average_min_distance = 0.;
+}
+
+void bob::trainer::MiniBatchKMeansTrainer::update(
+  bob::machine::KMeansMachine& kmeans, const blitz::Array<double,2>& batch)
+{
+  bob::core::array::assertSameShape(m_counts,
+    blitz::TinyVector<int,1>(kmeans.getNMeans()));
+
+  // Assigns the samples to their closest mean
+  m_trainer.eStep(kmeans, batch);
+  m_average_min_distance = m_trainer.getAverageMinDistance();
+
+  // Moves each mean towards the average of the samples assigned to it:
+  // m_c <- m_c + (sum_i x_i - n_c m_c) / N_c, where N_c is the total
+  // number of samples assigned to m_c so far
+  const blitz::Array<double,1>& zeroeth = m_trainer.getZeroethOrderStats();
+  const blitz::Array<double,2>& first = m_trainer.getFirstOrderStats();
+  blitz::Array<double,2>& means = kmeans.updateMeans();
+  blitz::Range a = blitz::Range::all();
+  for (size_t c=0; c<kmeans.getNMeans(); ++c)
+  {
+    if (zeroeth(c) <= 0.) continue;
+    m_counts(c) += zeroeth(c);
+    blitz::Array<double,1> mean = means(c,a);
+    mean += (first(c,a) - zeroeth(c) * mean) / m_counts(c);
+  }
+}
+
+void bob::trainer::MiniBatchKMeansTrainer::train(
+  bob::machine::KMeansMachine& kmeans, bob::trainer::SampleSource& source)
+{
+  bob::core::info << "# MiniBatchKMeansTrainer:" << std::endl;
+  initialization(kmeans, source);
+
+  blitz::Array<double,2> batch(std::max(m_batch_size, (size_t)1),
+    kmeans.getNInputs());
+  double average_previous;
+  double average = std::numeric_limits<double>::max();
+  for (size_t iter=0; ; ++iter)
+  {
+    average_previous = average;
+
+    // One pass over the data
+    source.reset();
+    double sum_min_distance = 0.;
+    size_t n_samples = 0;
+    for (int n; (n = source.read(batch)) > 0; )
+    {
+      update(kmeans, batch(blitz::Range(0, n-1), blitz::Range::all()));
+      sum_min_distance += m_average_min_distance * n;
+      n_samples += n;
+    }
+    average = (n_samples ? sum_min_distance / n_samples : 0.);
+    m_average_min_distance = average;
+
+    bob::core::info << "# Iteration " << iter+1 << ": " << average_previous
+      << " -> " << average << std::endl;
+
+    if (iter > 0 && fabs((average_previous - average) / average_previous) <=
+        m_convergence_threshold) {
+      bob::core::info << "# Mini-batch k-means terminated: average min distance converged" << std::endl;
+      break;
+    }
+    if (m_max_iterations > 0 && iter+1 >= m_max_iterations) {
+      bob::core::info << "# Mini-batch k-means terminated: maximum number of iterations reached." << std::endl;
+      break;
+    }
+  }
+}
@@ -0,0 +1,174 @@
+/**
+ * @file trainer/cxx/OnlineGMMTrainer.cc
+ * @date Sat Oct 17 18:42:10 2026 +0200
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/trainer/OnlineGMMTrainer.h>
+#include <bob/core/check.h>
+#include <bob/core/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+bob::trainer::OnlineGMMTrainer::OnlineGMMTrainer(const size_t batch_size,
+    const double forgetting_rate, const bool update_means,
+    const bool update_variances, const bool update_weights,
+    const double mean_var_update_responsibilities_threshold):
+  m_batch_size(batch_size),
+  m_forgetting_rate(forgetting_rate),
+  m_convergence_threshold(0.001),
+  m_max_iterations(10),
+  m_trainer(update_means, update_variances, update_weights,
+    mean_var_update_responsibilities_threshold),
+  m_n_updates(0),
+  m_average_log_likelihood(0)
+{
+}
+
+bob::trainer::OnlineGMMTrainer::OnlineGMMTrainer(
+    const bob::trainer::OnlineGMMTrainer& other):
+  m_batch_size(other.m_batch_size),
+  m_forgetting_rate(other.m_forgetting_rate),
+  m_convergence_threshold(other.m_convergence_threshold),
+  m_max_iterations(other.m_max_iterations),
+  m_trainer(other.m_trainer),
+  m_ss(other.m_ss),
+  m_n_updates(other.m_n_updates),
+  m_average_log_likelihood(other.m_average_log_likelihood)
+{
+}
+
+bob::trainer::OnlineGMMTrainer& bob::trainer::OnlineGMMTrainer::operator=
+  (const bob::trainer::OnlineGMMTrainer& other)
+{
+  if (this != &other)
+  {
+    m_batch_size = other.m_batch_size;
+    m_forgetting_rate = other.m_forgetting_rate;
+    m_convergence_threshold = other.m_convergence_threshold;
+    m_max_iterations = other.m_max_iterations;
+    m_trainer = other.m_trainer;
+    m_ss = other.m_ss;
+    m_n_updates = other.m_n_updates;
+    m_average_log_likelihood = other.m_average_log_likelihood;
+  }
+  return *this;
+}
+
+bool bob::trainer::OnlineGMMTrainer::operator==
+  (const bob::trainer::OnlineGMMTrainer& b) const
+{
+  return m_batch_size == b.m_batch_size &&
+         m_forgetting_rate == b.m_forgetting_rate &&
+         m_convergence_threshold == b.m_convergence_threshold &&
+         m_max_iterations == b.m_max_iterations &&
+         m_trainer == b.m_trainer &&
+         m_ss == b.m_ss &&
+         m_n_updates == b.m_n_updates;
+}
+
+bool bob::trainer::OnlineGMMTrainer::operator!=
+  (const bob::trainer::OnlineGMMTrainer& b) const
+{
+  return !(this->operator==(b));
+}
+
+void bob::trainer::OnlineGMMTrainer::initialization(
+  bob::machine::GMMMachine& gmm)
+{
+  m_ss.resize(gmm.getNGaussians(), gmm.getNInputs());
+  m_n_updates = 0;
+  m_average_log_likelihood = 0.;
+}
+
+void bob::trainer::OnlineGMMTrainer::update(bob::machine::GMMMachine& gmm,
+  const blitz::Array<double,2>& batch)
+{
+  bob::core::array::assertSameDimensionLength(m_ss.sumPx.extent(0),
+    gmm.getNGaussians());
+  bob::core::array::assertSameDimensionLength(m_ss.sumPx.extent(1),
+    gmm.getNInputs());
+  if (batch.extent(0) == 0) return;
+
+  // Statistics of the batch (the allocation of the statistics of the
+  // trainer is a no-op once done)
+  m_trainer.initialization(gmm, batch);
+  m_trainer.eStep(gmm, batch);
+  const bob::machine::GMMStats& stats = m_trainer.getGMMStats();
+  const double T = static_cast<double>(stats.T);
+  m_average_log_likelihood = stats.log_likelihood / T;
+
+  // Interpolates the normalized statistics of the batch with the running
+  // ones (the first batch replaces the initial statistics)
+  const double eta = (m_n_updates == 0 ? 1. :
+    pow(m_n_updates + 1., -m_forgetting_rate));
+  m_ss.n = (1.-eta) * m_ss.n + (eta/T) * stats.n;
+  m_ss.sumPx = (1.-eta) * m_ss.sumPx + (eta/T) * stats.sumPx;
+  m_ss.sumPxx = (1.-eta) * m_ss.sumPxx + (eta/T) * stats.sumPxx;
+  m_ss.log_likelihood = (1.-eta) * m_ss.log_likelihood +
+    (eta/T) * stats.log_likelihood;
+  m_ss.T = 1;
+  ++m_n_updates;
+
+  // Maximum likelihood estimates from the running statistics
+  m_trainer.setGMMStats(m_ss);
+  m_trainer.mStep(gmm, batch);
+}
+
+void bob::trainer::OnlineGMMTrainer::train(bob::machine::GMMMachine& gmm,
+  bob::trainer::SampleSource& source)
+{
+  bob::core::info << "# OnlineGMMTrainer:" << std::endl;
+  bob::core::array::assertSameDimensionLength(source.getNInputs(),
+    gmm.getNInputs());
+  initialization(gmm);
+
+  blitz::Array<double,2> batch(std::max(m_batch_size, (size_t)1),
+    gmm.getNInputs());
+  double average_previous;
+  double average = - std::numeric_limits<double>::max();
+  for (size_t iter=0; ; ++iter)
+  {
+    average_previous = average;
+
+    // One pass over the data
+    source.reset();
+    double sum_log_likelihood = 0.;
+    size_t n_samples = 0;
+    for (int n; (n = source.read(batch)) > 0; )
+    {
+      update(gmm, batch(blitz::Range(0, n-1), blitz::Range::all()));
+      sum_log_likelihood += m_average_log_likelihood * n;
+      n_samples += n;
+    }
+    average = (n_samples ? sum_log_likelihood / n_samples : 0.);
+    m_average_log_likelihood = average;
+
+    bob::core::info << "# Iteration " << iter+1 << ": " << average_previous
+      << " -> " << average << std::endl;
+
+    if (iter > 0 && fabs((average_previous - average) / average_previous) <=
+        m_convergence_threshold) {
+      bob::core::info << "# Online EM terminated: likelihood converged" << std::endl;
+      break;
+    }
+    if (m_max_iterations > 0 && iter+1 >= m_max_iterations) {
+      bob::core::info << "# Online EM terminated: maximum number of iterations reached." << std::endl;
+      break;
+    }
+  }
+}
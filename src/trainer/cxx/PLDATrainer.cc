@@ -26,6 +26,8 @@
 #include <bob/math/linear.h>
 #include <bob/math/inv.h>
 #include <bob/math/svd.h>
+#include <bob/math/gemm.h>
+#include <bob/core/parallel.h>
 #include <bob/trainer/Exception.h>
 #include <algorithm>
 #include <boost/random.hpp>
@@ -41,12 +43,12 @@ bob::trainer::PLDATrainer::PLDATrainer(const size_t max_iterations,
   m_initF_method(bob::trainer::PLDATrainer::RANDOM_F), m_initF_ratio(1.),
   m_initG_method(bob::trainer::PLDATrainer::RANDOM_G), m_initG_ratio(1.),
   m_initSigma_method(bob::trainer::PLDATrainer::RANDOM_SIGMA), 
-  m_initSigma_ratio(1.),
+  m_initSigma_ratio(1.), m_n_threads(1),
   m_cache_S(0,0), 
   m_cache_z_first_order(0), m_cache_sum_z_second_order(0,0), m_cache_z_second_order(0),
   m_cache_n_samples_per_id(0), m_cache_n_samples_in_training(), m_cache_B(0,0),
   m_cache_Ft_isigma_G(0,0), m_cache_eta(0,0), m_cache_zeta(), m_cache_iota(),
-  m_tmp_nf_1(0), m_tmp_nf_2(0), m_tmp_ng_1(0),
+  m_tmp_nf_1(0),
   m_tmp_D_1(0), m_tmp_D_2(0), 
   m_tmp_nfng_nfng(0,0), m_tmp_D_nfng_1(0,0), m_tmp_D_nfng_2(0,0)
 {
@@ -61,6 +63,7 @@ bob::trainer::PLDATrainer::PLDATrainer(const bob::trainer::PLDATrainer& other):
   m_initF_method(other.m_initF_method), m_initF_ratio(other.m_initF_ratio),
   m_initG_method(other.m_initG_method), m_initG_ratio(other.m_initG_ratio),
   m_initSigma_method(other.m_initSigma_method), m_initSigma_ratio(other.m_initSigma_ratio),
+  m_n_threads(other.m_n_threads),
   m_cache_S(bob::core::array::ccopy(other.m_cache_S)),
   m_cache_z_first_order(),
   m_cache_sum_z_second_order(bob::core::array::ccopy(other.m_cache_sum_z_second_order)),
@@ -98,6 +101,7 @@ bob::trainer::PLDATrainer& bob::trainer::PLDATrainer::operator=
     m_initG_ratio = other.m_initG_ratio;
     m_initSigma_method = other.m_initSigma_method;
     m_initSigma_ratio = other.m_initSigma_ratio;
+    m_n_threads = other.m_n_threads;
     m_cache_S = bob::core::array::ccopy(other.m_cache_S);
     bob::core::array::ccopy(other.m_cache_z_first_order, m_cache_z_first_order);
     m_cache_sum_z_second_order = bob::core::array::ccopy(other.m_cache_sum_z_second_order);
@@ -281,8 +285,6 @@ void bob::trainer::PLDATrainer::initMembers(const std::vector<blitz::Array<doubl
 void bob::trainer::PLDATrainer::resizeTmp()
 {
   m_tmp_nf_1.resize(m_dim_f);
-  m_tmp_nf_2.resize(m_dim_f);
-  m_tmp_ng_1.resize(m_dim_g);
   m_tmp_D_1.resize(m_dim_d);
   m_tmp_D_2.resize(m_dim_d);
   m_tmp_nfng_nfng.resize(m_dim_f+m_dim_g, m_dim_f+m_dim_g);
@@ -503,98 +505,201 @@ void bob::trainer::PLDATrainer::initSigma(bob::machine::PLDABase& machine,
   machine.applyVarianceThreshold();
 }
 
+namespace {
+  /**
+   * Data of the E-step shared by all the threads. The (contiguous) arrays
+   * of the machine are only accessed through raw pointers, and the
+   * per-identity arrays element-wise, as blitz reference counting is not
+   * thread-safe.
+   */
+  struct PLDAEStepData
+  {
+    int dim_d;
+    int dim_f;
+    int dim_g;
+    const double* mu; ///< \f$\mu\f$ (dim_d)
+    const double* F; ///< \f$F\f$ (dim_d x dim_f)
+    const double* FtBeta; ///< \f$F^T \beta\f$ (dim_f x dim_d)
+    const double* alphaGtISigma; ///< \f$\alpha G^T \Sigma^{-1}\f$ (dim_g x dim_d)
+    // Precomputed values of the identities, which only depend on their
+    // number of samples a
+    std::vector<const double*> gamma; ///< \f$\gamma_{a}\f$ (dim_f x dim_f)
+    std::vector<const double*> zeta; ///< \f$\zeta_{a}\f$ (dim_g x dim_g)
+    std::vector<const double*> iota; ///< \f$\iota_{a}\f$ (dim_f x dim_g)
+    const std::vector<blitz::Array<double,2> >* data;
+    std::vector<blitz::Array<double,2> >* z_first_order;
+    std::vector<blitz::Array<double,3> >* z_second_order; ///< 0 if only the sum is kept
+  };
+}
+
+/**
+ * Computes the first (and second) order statistics of the latent variables
+ * of the identities [begin, end), and accumulates the sum of the
+ * \f$E{z_{ij}}.E{z_{ij}}^T\f$ into the accumulator of the given thread.
+ */
+static void eStepChunk(const PLDAEStepData& d,
+  std::vector<blitz::Array<double,2> >& accs, const size_t thread,
+  const size_t begin, const size_t end)
+{
+  const int D = d.dim_d;
+  const int nf = d.dim_f;
+  const int ng = d.dim_g;
+  const int nz = nf + ng;
+  const blitz::Array<double,2> alphaGtISigma(
+    const_cast<double*>(d.alphaGtISigma), blitz::shape(ng, D),
+    blitz::neverDeleteData);
+  blitz::Array<double,2>& acc = accs[thread];
+
+  std::vector<double> sum_x(D);
+  std::vector<double> FtBeta_x(nf);
+  std::vector<double> h(nf);
+  std::vector<double> Fh(D);
+  blitz::Array<double,2> R; // x_ij - mu - F.E{h_i} for all the samples j
+  blitz::Array<double,2> W; // E{w_ij} for all the samples j
+  blitz::Array<double,2> Z; // E{z_ij} for all the samples j
+  for (size_t i=begin; i<end; ++i)
+  {
+    const blitz::Array<double,2>& x = (*d.data)[i];
+    const int n_i = x.extent(0);
+
+    // 1/ E{h_i} = gamma_a.F^T.beta.sum_j(x_ij-mu)
+    std::fill(sum_x.begin(), sum_x.end(), 0.);
+    for (int j=0; j<n_i; ++j)
+      for (int k=0; k<D; ++k)
+        sum_x[k] += x(j,k) - d.mu[k];
+    for (int l=0; l<nf; ++l) {
+      double s = 0.;
+      for (int k=0; k<D; ++k) s += d.FtBeta[l*D+k] * sum_x[k];
+      FtBeta_x[l] = s;
+    }
+    const double* gamma_a = d.gamma[i];
+    for (int l=0; l<nf; ++l) {
+      double s = 0.;
+      for (int m=0; m<nf; ++m) s += gamma_a[l*nf+m] * FtBeta_x[m];
+      h[l] = s;
+    }
+    for (int k=0; k<D; ++k) {
+      double s = 0.;
+      for (int l=0; l<nf; ++l) s += d.F[k*nf+l] * h[l];
+      Fh[k] = s;
+    }
+
+    // 2/ E{w_ij} = alpha.G^T.sigma^-1.(x_ij-mu-F.E{h_i}), for all the 
+    // samples at once
+    if (R.extent(0) != n_i) {
+      R.resize(n_i, D);
+      W.resize(n_i, ng);
+      Z.resize(n_i, nz);
+    }
+    for (int j=0; j<n_i; ++j)
+      for (int k=0; k<D; ++k)
+        R(j,k) = x(j,k) - d.mu[k] - Fh[k];
+    bob::math::gemm_(R, alphaGtISigma, W, false, true);
+
+    // 3/ First order statistics of z_ij = [h_i w_ij]
+    blitz::Array<double,2>& z_first_order_i = (*d.z_first_order)[i];
+    for (int j=0; j<n_i; ++j) {
+      for (int l=0; l<nf; ++l)
+        z_first_order_i(j,l) = Z(j,l) = h[l];
+      for (int l=0; l<ng; ++l)
+        z_first_order_i(j,nf+l) = Z(j,nf+l) = W(j,l);
+    }
+
+    // 4/ Second order statistics of z: the sum of the constant parts
+    // (gamma_a, iota_a and zeta_a) is added once per number of samples
+    bob::math::gemm_(Z, Z, acc, true, false, 1., 1.);
+    if (d.z_second_order) {
+      blitz::Array<double,3>& z_second_order_i = (*d.z_second_order)[i];
+      const double* zeta_a = d.zeta[i];
+      const double* iota_a = d.iota[i];
+      for (int j=0; j<n_i; ++j)
+        for (int p=0; p<nz; ++p)
+          for (int q=0; q<nz; ++q) {
+            double c;
+            if (p < nf && q < nf) c = gamma_a[p*nf+q];
+            else if (p < nf) c = iota_a[p*ng+(q-nf)];
+            else if (q < nf) c = iota_a[q*ng+(p-nf)];
+            else c = zeta_a[(p-nf)*ng+(q-nf)];
+            z_second_order_i(j,p,q) = c + Z(j,p) * Z(j,q);
+          }
+    }
+  }
+}
+
 void bob::trainer::PLDATrainer::eStep(bob::machine::PLDABase& machine, 
   const std::vector<blitz::Array<double,2> >& v_ar)
 {  
   // Precomputes useful variables using current estimates of F,G, and sigma
   precomputeFromFGSigma(machine);
-  // Gets the mean mu from the machine
-  const blitz::Array<double,1>& mu = machine.getMu();
-  const blitz::Array<double,2>& alpha = machine.getAlpha();
-  const blitz::Array<double,2>& F = machine.getF();
-  const blitz::Array<double,2>& FtBeta = machine.getFtBeta();
-  const blitz::Array<double,2>& GtISigma = machine.getGtISigma();
-  blitz::Range a = blitz::Range::all();
-
-  // blitz indices
-  blitz::firstIndex bi;
-  blitz::secondIndex bj;
-  // Initializes sum of z second order statistics to 0
-  m_cache_sum_z_second_order = 0.;
+  // Contiguous copies of the arrays of the machine, and alpha.G^T.sigma^-1
+  const blitz::Array<double,1> mu = bob::core::array::ccopy(machine.getMu());
+  const blitz::Array<double,2> F = bob::core::array::ccopy(machine.getF());
+  const blitz::Array<double,2> FtBeta = bob::core::array::ccopy(machine.getFtBeta());
+  blitz::Array<double,2> alphaGtISigma(m_dim_g, m_dim_d);
+  bob::math::prod(machine.getAlpha(), machine.getGtISigma(), alphaGtISigma);
+
+  PLDAEStepData d;
+  d.dim_d = m_dim_d;
+  d.dim_f = m_dim_f;
+  d.dim_g = m_dim_g;
+  d.mu = mu.data();
+  d.F = F.data();
+  d.FtBeta = FtBeta.data();
+  d.alphaGtISigma = alphaGtISigma.data();
+  d.data = &v_ar;
+  d.z_first_order = &m_cache_z_first_order;
+  d.z_second_order = (m_use_sum_second_order ? 0 : &m_cache_z_second_order);
+  // Buckets the identities by number of samples
+  std::map<size_t,size_t> n_ids_per_n_samples;
+  d.gamma.resize(v_ar.size());
+  d.zeta.resize(v_ar.size());
+  d.iota.resize(v_ar.size());
   for (size_t i=0; i<v_ar.size(); ++i)
   {
-    // Computes expectation of z_ij = [h_i w_ij]
-    // 1/a/ Computes expectation of h_i
-    // Loop over the samples
-    m_tmp_nf_1 = 0.;
-    for (int j=0; j<v_ar[i].extent(0); ++j)
-    {
-      // m_tmp_D_1 = x_sj-mu
-      m_tmp_D_1 = v_ar[i](j,a) - mu;
+    const size_t n_i = v_ar[i].extent(0);
+    ++n_ids_per_n_samples[n_i];
+    d.gamma[i] = machine.getAddGamma(n_i).data();
+    d.zeta[i] = m_cache_zeta[n_i].data();
+    d.iota[i] = m_cache_iota[n_i].data();
+  }
 
-      // m_tmp_nf_2 = F^T.beta.(x_sj-mu)
-      bob::math::prod(FtBeta, m_tmp_D_1, m_tmp_nf_2);
-      // m_tmp_nf_1 = sum_j F^T.beta.(x_sj-mu)
-      m_tmp_nf_1 += m_tmp_nf_2;
-    }
-    const blitz::Array<double,2>& gamma_a = machine.getAddGamma(v_ar[i].extent(0));
-    blitz::Range r_hi(0, m_dim_f-1);
-    // m_tmp_nf_2 = E(h_i) = gamma_A  sum_j F^T.beta.(x_sj-mu)
-    bob::math::prod(gamma_a, m_tmp_nf_1, m_tmp_nf_2);
-
-    // 1/b/ Precomputes: m_tmp_D_2 = F.E{h_i}
-    bob::math::prod(F, m_tmp_nf_2, m_tmp_D_2);
-
-    // 2/ First and second order statistics of z
-    // Precomputed values 
-    blitz::Array<double,2>& zeta_a = m_cache_zeta[v_ar[i].extent(0)];
-    blitz::Array<double,2>& iota_a = m_cache_iota[v_ar[i].extent(0)];
+  // Initializes sum of z second order statistics to 0. The first thread 
+  // directly uses this sum, and the other ones their own (zeroed) copy
+  m_cache_sum_z_second_order = 0.;
+  const size_t n_threads = bob::core::parallel_threads(v_ar.size(), m_n_threads);
+  std::vector<blitz::Array<double,2> > accs(n_threads);
+  accs[0].reference(m_cache_sum_z_second_order);
+  for (size_t t=1; t<n_threads; ++t)
+    accs[t].reference(bob::core::array::ccopy(m_cache_sum_z_second_order));
+
+  bob::core::parallel_for(boost::bind(&eStepChunk, boost::cref(d),
+        boost::ref(accs), _1, _2, _3),
+      v_ar.size(), n_threads);
+
+  // Sums the accumulators of the other threads
+  for (size_t t=1; t<n_threads; ++t)
+    m_cache_sum_z_second_order += accs[t];
+
+  // Adds the constant parts of the second order statistics, once for each
+  // number of samples a: sum_ij [gamma_a iota_a; iota_a^T zeta_a]
+  blitz::Range r1(0, m_dim_f-1);
+  blitz::Range r2(m_dim_f, m_dim_f+m_dim_g-1);
+  blitz::Array<double,2> z_sum_so_11 = m_cache_sum_z_second_order(r1,r1);
+  blitz::Array<double,2> z_sum_so_12 = m_cache_sum_z_second_order(r1,r2);
+  blitz::Array<double,2> z_sum_so_21 = m_cache_sum_z_second_order(r2,r1);
+  blitz::Array<double,2> z_sum_so_22 = m_cache_sum_z_second_order(r2,r2);
+  std::map<size_t,size_t>::const_iterator it;
+  for (it=n_ids_per_n_samples.begin(); it!=n_ids_per_n_samples.end(); ++it)
+  {
+    const double n_samples = static_cast<double>(it->first * it->second);
+    const blitz::Array<double,2>& gamma_a = machine.getAddGamma(it->first);
+    blitz::Array<double,2>& zeta_a = m_cache_zeta[it->first];
+    blitz::Array<double,2>& iota_a = m_cache_iota[it->first];
     blitz::Array<double,2> iotat_a = iota_a.transpose(1,0);
-
-    // Extracts statistics of z_ij = [h_i w_ij] from y_i = [h_i w_i1 ... w_iJ]
-    blitz::Range r1(0, m_dim_f-1);
-    blitz::Range r2(m_dim_f, m_dim_f+m_dim_g-1);
-    for (int j=0; j<v_ar[i].extent(0); ++j)
-    {
-      // 1/ First order statistics of z
-      blitz::Array<double,1> z_first_order_ij_1 = m_cache_z_first_order[i](j,r1);
-      z_first_order_ij_1 = m_tmp_nf_2; // E{h_i}
-      // m_tmp_D_1 = x_sj - mu - F.E{h_i}
-      m_tmp_D_1 = v_ar[i](j,a) - mu - m_tmp_D_2;
-      // m_tmp_ng_1 = G^T.sigma^-1.(x_sj-mu-fhi)
-      bob::math::prod(GtISigma, m_tmp_D_1, m_tmp_ng_1);
-      // z_first_order_ij_2 = (Id+G^T.sigma^-1.G)^-1.G^T.sigma^-1.(x_sj-mu) = E{w_ij}
-      blitz::Array<double,1> z_first_order_ij_2 = m_cache_z_first_order[i](j,r2);
-      bob::math::prod(alpha, m_tmp_ng_1, z_first_order_ij_2); 
-
-      // 2/ Second order statistics of z
-      blitz::Array<double,2> z_sum_so_11 = m_cache_sum_z_second_order(r1,r1);
-      blitz::Array<double,2> z_sum_so_12 = m_cache_sum_z_second_order(r1,r2);
-      blitz::Array<double,2> z_sum_so_21 = m_cache_sum_z_second_order(r2,r1);
-      blitz::Array<double,2> z_sum_so_22 = m_cache_sum_z_second_order(r2,r2);
-      if (m_use_sum_second_order)
-      {
-        z_sum_so_11 += gamma_a + z_first_order_ij_1(bi) * z_first_order_ij_1(bj);
-        z_sum_so_12 += iota_a + z_first_order_ij_1(bi) * z_first_order_ij_2(bj);
-        z_sum_so_21 += iotat_a + z_first_order_ij_2(bi) * z_first_order_ij_1(bj);
-        z_sum_so_22 += zeta_a + z_first_order_ij_2(bi) * z_first_order_ij_2(bj);
-      }
-      else
-      {
-        blitz::Array<double,2> z_so_11 = m_cache_z_second_order[i](j,r1,r1);
-        z_so_11 = gamma_a + z_first_order_ij_1(bi) * z_first_order_ij_1(bj);
-        z_sum_so_11 += z_so_11;
-        blitz::Array<double,2> z_so_12 = m_cache_z_second_order[i](j,r1,r2);
-        z_so_12 = iota_a + z_first_order_ij_1(bi) * z_first_order_ij_2(bj);
-        z_sum_so_12 += z_so_12;
-        blitz::Array<double,2> z_so_21 = m_cache_z_second_order[i](j,r2,r1);
-        z_so_21 = iotat_a + z_first_order_ij_2(bi) * z_first_order_ij_1(bj);
-        z_sum_so_21 += z_so_21;
-        blitz::Array<double,2> z_so_22 = m_cache_z_second_order[i](j,r2,r2);
-        z_so_22 = zeta_a + z_first_order_ij_2(bi) * z_first_order_ij_2(bj);
-        z_sum_so_22 += z_so_22;
-      }
-    }
+    z_sum_so_11 += n_samples * gamma_a;
+    z_sum_so_12 += n_samples * iota_a;
+    z_sum_so_21 += n_samples * iotat_a;
+    z_sum_so_22 += n_samples * zeta_a;
   }
 }
 
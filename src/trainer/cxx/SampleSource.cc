@@ -0,0 +1,265 @@
+/**
+ * @file trainer/cxx/SampleSource.cc
+ * @date Sat Oct 17 18:42:10 2026 +0200
+ *
+ * @brief Implements the pull-based sources of training samples
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bob/trainer/SampleSource.h>
+#include <bob/core/assert.h>
+#include <bob/core/array_copy.h>
+#include <bob/io/utils.h>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+/**
+ * Number of samples loaded at once from files containing one sample per
+ * (1D) array
+ */
+static const size_t FILE_SAMPLES_PER_BLOCK = 4096;
+
+/**
+ * Copies the rows [offset, offset+len) of samples into the rows
+ * [n, n+len) of block
+ */
+static void copyRows(const blitz::Array<double,2>& samples, const int offset,
+  blitz::Array<double,2>& block, const int n, const int len)
+{
+  blitz::Range a = blitz::Range::all();
+  block(blitz::Range(n, n+len-1), a) =
+    samples(blitz::Range(offset, offset+len-1), a);
+}
+
+
+bob::trainer::ArraySampleSource::ArraySampleSource(
+    const blitz::Array<double,2>& data):
+  m_data(bob::core::array::ccopy(data)),
+  m_offset(0)
+{
+}
+
+size_t bob::trainer::ArraySampleSource::read(blitz::Array<double,2>& block)
+{
+  bob::core::array::assertSameDimensionLength(block.extent(1),
+    m_data.extent(1));
+  const int len = std::min(block.extent(0), m_data.extent(0) - m_offset);
+  if (len <= 0) return 0;
+  copyRows(m_data, m_offset, block, 0, len);
+  m_offset += len;
+  return len;
+}
+
+
+/**
+ * Checks if the file is read by the HDF5 codec, given its extension
+ */
+static bool isHDF5(const std::string& filename)
+{
+  std::string extension = boost::filesystem::path(filename).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+    ::tolower);
+  return extension == ".hdf5" || extension == ".h5" || extension == ".hdf";
+}
+
+/**
+ * Gets the dataset of an HDF5 file that holds the samples (the first one, as
+ * for bob::io::open()), and its extents. The samples are the rows of a 2D
+ * dataset, or of each array of a list of 2D arrays (3D dataset).
+ */
+static void describeHDF5(const bob::io::HDF5File& file, std::string& path,
+  bob::io::HDF5Shape& extents)
+{
+  std::vector<std::string> paths;
+  file.paths(paths);
+  if (paths.empty()) {
+    boost::format m("the file '%s' does not contain any dataset");
+    m % file.filename();
+    throw std::runtime_error(m.str());
+  }
+  path = paths[0];
+  // The last descriptor reads the dataset as a single array
+  extents = file.describe(path).back().type.shape();
+  if (extents.n() != 2 && extents.n() != 3) {
+    boost::format m("the dataset '%s' of the file '%s' has %d dimensions, whereas samples should be stored as the rows of 2D arrays");
+    m % path % file.filename() % extents.n();
+    throw std::runtime_error(m.str());
+  }
+}
+
+bob::trainer::FileSampleSource::FileSampleSource(
+    const std::vector<std::string>& filenames):
+  m_filenames(filenames),
+  m_n_inputs(0),
+  m_file_index(0),
+  m_list(false),
+  m_n_arrays(0),
+  m_n_rows(0),
+  m_row(0),
+  m_array_index(0),
+  m_offset(0)
+{
+  if (m_filenames.empty())
+    throw std::runtime_error("FileSampleSource requires at least one file");
+
+  // The dimensionality of the samples is given by the first file
+  if (isHDF5(m_filenames[0]))
+  {
+    bob::io::HDF5File file(m_filenames[0], bob::io::HDF5File::in);
+    std::string path;
+    bob::io::HDF5Shape extents;
+    describeHDF5(file, path, extents);
+    m_n_inputs = extents[extents.n()-1];
+  }
+  else
+  {
+    boost::shared_ptr<bob::io::File> file = bob::io::open(m_filenames[0], 'r');
+    const bob::core::array::typeinfo& type = file->type();
+    if (type.nd == 2) m_n_inputs = type.shape[1];
+    else if (type.nd == 1) m_n_inputs = type.shape[0];
+    else {
+      boost::format m("the file '%s' contains %d-dimensional arrays, whereas samples should be stored as 1D or 2D arrays");
+      m % m_filenames[0] % type.nd;
+      throw std::runtime_error(m.str());
+    }
+  }
+  reset();
+}
+
+void bob::trainer::FileSampleSource::reset()
+{
+  m_file_index = 0;
+  m_file.reset();
+  m_hdf5.reset();
+  m_n_arrays = 0;
+  m_row = 0;
+  m_array_index = 0;
+  m_samples.resize(0, m_n_inputs);
+  m_offset = 0;
+}
+
+bool bob::trainer::FileSampleSource::openNext()
+{
+  m_file.reset();
+  m_hdf5.reset();
+  m_array_index = 0;
+  m_row = 0;
+  if (m_file_index >= m_filenames.size()) return false;
+
+  const std::string& filename = m_filenames[m_file_index++];
+  if (isHDF5(filename))
+  {
+    m_hdf5.reset(new bob::io::HDF5File(filename, bob::io::HDF5File::in));
+    bob::io::HDF5Shape extents;
+    describeHDF5(*m_hdf5, m_path, extents);
+    m_list = (extents.n() == 3);
+    m_n_arrays = m_list ? extents[0] : 1;
+    m_n_rows = extents[extents.n()-2];
+    if (extents[extents.n()-1] != m_n_inputs) {
+      boost::format m("the samples of the file '%s' have %d features, whereas %d were expected");
+      m % filename % extents[extents.n()-1] % m_n_inputs;
+      throw std::runtime_error(m.str());
+    }
+  }
+  else
+    m_file = bob::io::open(filename, 'r');
+  return true;
+}
+
+bool bob::trainer::FileSampleSource::loadNext(const size_t max_rows)
+{
+  while (true)
+  {
+    if (m_hdf5 && m_array_index < m_n_arrays)
+    {
+      // Reads the next rows of the current array, at most max_rows of them
+      const size_t n = std::min(max_rows, m_n_rows - m_row);
+      m_samples.resize(n, m_n_inputs);
+      if (n > 0)
+      {
+        if (m_list) {
+          const hsize_t start[3] = {m_array_index, m_row, 0};
+          blitz::Array<double,3> slab(m_samples.data(),
+            blitz::shape(1, (int)n, (int)m_n_inputs), blitz::neverDeleteData);
+          m_hdf5->read_hyperslab(m_path, bob::io::HDF5Shape(3, start),
+            bob::io::HDF5Type(slab), slab.data());
+        }
+        else {
+          const hsize_t start[2] = {m_row, 0};
+          m_hdf5->read_hyperslab(m_path, bob::io::HDF5Shape(2, start),
+            bob::io::HDF5Type(m_samples), m_samples.data());
+        }
+      }
+      m_row += n;
+      if (m_row >= m_n_rows) {
+        ++m_array_index;
+        m_row = 0;
+      }
+      m_offset = 0;
+      if (n > 0) return true;
+    }
+    else if (m_file && m_array_index < m_file->size())
+    {
+      const bob::core::array::typeinfo& type = m_file->type();
+      if (type.nd == 2)
+        m_samples.reference(m_file->cast<double,2>(m_array_index++));
+      else if (type.nd == 1)
+      {
+        const size_t n = std::min(FILE_SAMPLES_PER_BLOCK,
+          m_file->size() - m_array_index);
+        m_samples.resize(n, type.shape[0]);
+        for (size_t i=0; i<n; ++i)
+          m_samples(i, blitz::Range::all()) =
+            m_file->cast<double,1>(m_array_index++);
+      }
+      else {
+        boost::format m("the file '%s' contains %d-dimensional arrays, whereas samples should be stored as 1D or 2D arrays");
+        m % m_file->filename() % type.nd;
+        throw std::runtime_error(m.str());
+      }
+
+      if ((size_t)m_samples.extent(1) != m_n_inputs) {
+        boost::format m("the samples of the file '%s' have %d features, whereas %d were expected");
+        m % m_file->filename() % m_samples.extent(1) % m_n_inputs;
+        throw std::runtime_error(m.str());
+      }
+      m_offset = 0;
+      if (m_samples.extent(0) > 0) return true;
+    }
+    // Opens the next file, once the current one has been read
+    else if (!openNext()) return false;
+  }
+}
+
+size_t bob::trainer::FileSampleSource::read(blitz::Array<double,2>& block)
+{
+  bob::core::array::assertSameDimensionLength(block.extent(1), m_n_inputs);
+  int n = 0;
+  while (n < block.extent(0))
+  {
+    if (m_offset >= m_samples.extent(0) && !loadNext(block.extent(0) - n))
+      break;
+    const int len = std::min(block.extent(0) - n,
+      m_samples.extent(0) - m_offset);
+    copyRows(m_samples, m_offset, block, n, len);
+    n += len;
+    m_offset += len;
+  }
+  return n;
+}
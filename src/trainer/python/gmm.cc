@@ -61,6 +61,7 @@ void bind_trainer_gmm() {
       "This class implements the E-step of the expectation-maximisation algorithm for a GMM Machine.\n"
       "See Section 9.2.2 of Bishop, \"Pattern recognition and machine learning\", 2006", no_init)
     .add_property("gmm_statistics", &py_gmmtrainer_get_gmmstats, &bob::trainer::GMMTrainer::setGMMStats, "The internal GMM statistics. Useful to parallelize the E-step.")
+    .add_property("n_threads", &bob::trainer::GMMTrainer::getNThreads, &bob::trainer::GMMTrainer::setNThreads, "The number of threads used during the E-step (0 means as many threads as hardware cores)")
   ;
 
   class_<bob::trainer::MAP_GMMTrainer, boost::noncopyable, bases<bob::trainer::GMMTrainer> >("MAP_GMMTrainer",
@@ -167,5 +167,6 @@ void bind_trainer_ivector()
     .add_property("acc_fnormij_wij", &py_get_AccFnormijWij, &py_set_AccFnormijWij, "Accumulator updated during the E-step")
     .add_property("acc_nij", &py_get_AccNij, &py_set_AccNij, "Accumulator updated during the E-step")
     .add_property("acc_snormij", &py_get_AccSnormij, &py_set_AccSnormij, "Accumulator updated during the E-step")
+    .add_property("n_threads", &bob::trainer::IVectorTrainer::getNThreads, &bob::trainer::IVectorTrainer::setNThreads, "The number of threads used during the E-step (0 means as many threads as hardware cores)")
   ;
 }
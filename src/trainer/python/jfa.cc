@@ -431,6 +431,7 @@ void bind_trainer_jfa()
     .def(init<const bob::trainer::ISVTrainer&>((arg("other")), "Copy constructs an ISVTrainer"))
     .add_property("max_iterations", &bob::trainer::ISVTrainer::getMaxIterations, &bob::trainer::ISVTrainer::setMaxIterations, "Max iterations")
     .add_property("rng", &bob::trainer::ISVTrainer::getRng, &bob::trainer::ISVTrainer::setRng, "The Mersenne Twister mt19937 random generator used for the initialization of subspaces/arrays before the EM loop.")
+    .add_property("n_threads", &bob::trainer::ISVTrainer::getNThreads, &bob::trainer::ISVTrainer::setNThreads, "The number of threads used during the E-steps (0 means as many threads as hardware cores)")
     .add_property("__X__", &isv_get_x, &isv_set_x)
     .add_property("__Z__", &isv_get_z, &isv_set_z)
     .def(self == self)
@@ -450,6 +451,7 @@ void bind_trainer_jfa()
     .def(init<const bob::trainer::JFATrainer&>((arg("other")), "Copy constructs an JFATrainer"))
     .add_property("max_iterations", &bob::trainer::JFATrainer::getMaxIterations, &bob::trainer::JFATrainer::setMaxIterations, "Max iterations")
     .add_property("rng", &bob::trainer::JFATrainer::getRng, &bob::trainer::JFATrainer::setRng, "The Mersenne Twister mt19937 random generator used for the initialization of subspaces/arrays before the EM loop.")
+    .add_property("n_threads", &bob::trainer::JFATrainer::getNThreads, &bob::trainer::JFATrainer::setNThreads, "The number of threads used during the E-steps (0 means as many threads as hardware cores)")
     .add_property("__X__", &jfa_get_x, &jfa_set_x)
     .add_property("__Y__", &jfa_get_y, &jfa_set_y)
     .add_property("__Z__", &jfa_get_z, &jfa_set_z)
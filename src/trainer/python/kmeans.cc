@@ -98,6 +98,10 @@ void bind_trainer_kmeans()
   KMT.def(self == self)
      .def(self != self)
      .add_property("initialization_method", &bob::trainer::KMeansTrainer::getInitializationMethod, &bob::trainer::KMeansTrainer::setInitializationMethod, "The initialization method to generate the initial means.")
+     .add_property("oversampling_rounds", &bob::trainer::KMeansTrainer::getOversamplingRounds, &bob::trainer::KMeansTrainer::setOversamplingRounds, "The number of oversampling passes over the data of the KMEANS_PARALLEL initialization (at least one).")
+     .add_property("oversampling_factor", &bob::trainer::KMeansTrainer::getOversamplingFactor, &bob::trainer::KMeansTrainer::setOversamplingFactor, "The oversampling factor of the KMEANS_PARALLEL initialization: on average, oversampling_factor*k candidates are selected at each pass over the data (strictly positive).")
+     .add_property("assignment_method", &bob::trainer::KMeansTrainer::getAssignmentMethod, &bob::trainer::KMeansTrainer::setAssignmentMethod, "The method used to assign the samples to their closest mean during the E-step. HAMERLY keeps bounds on the distances of the samples to the means across the E-steps, and skips most of the distance computations.")
+     .add_property("n_threads", &bob::trainer::KMeansTrainer::getNThreads, &bob::trainer::KMeansTrainer::setNThreads, "The number of threads used during the E-step (0 means as many threads as hardware cores).")
      .add_property("rng", &bob::trainer::KMeansTrainer::getRng, &bob::trainer::KMeansTrainer::setRng, "The Mersenne Twister mt19937 random generator used for the initialization of the means.")
      .add_property("average_min_distance", &bob::trainer::KMeansTrainer::getAverageMinDistance, &bob::trainer::KMeansTrainer::setAverageMinDistance, "Average min (square Euclidean) distance. Useful to parallelize the E-step.")
      .add_property("zeroeth_order_statistics", &py_getZeroethOrderStats, &py_setZeroethOrderStats, "The zeroeth order statistics. Useful to parallelize the E-step.")
@@ -113,10 +117,17 @@ void bind_trainer_kmeans()
     .value("RANDOM_NO_DUPLICATE", bob::trainer::KMeansTrainer::RANDOM_NO_DUPLICATE)
 #if BOOST_VERSION >= 104700
     .value("KMEANS_PLUS_PLUS", bob::trainer::KMeansTrainer::KMEANS_PLUS_PLUS)
+    .value("KMEANS_PARALLEL", bob::trainer::KMeansTrainer::KMEANS_PARALLEL)
 #endif
     .export_values()
     ;   
 
+  enum_<bob::trainer::KMeansTrainer::AssignmentMethod>("assignment_method_type")
+    .value("DIRECT", bob::trainer::KMeansTrainer::DIRECT)
+    .value("HAMERLY", bob::trainer::KMeansTrainer::HAMERLY)
+    .export_values()
+    ;
+
   // Binds methods that has nested enum values as default parameters
   KMT.def(init<optional<double,int,bool,bob::trainer::KMeansTrainer::InitializationMethod> >((arg("convergence_threshold")=0.001, arg("max_iterations")=10, arg("compute_likelihood")=true, arg("initialization_method")=bob::trainer::KMeansTrainer::RANDOM)));
 }
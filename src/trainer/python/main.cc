@@ -41,6 +41,7 @@ void bind_trainer_cglogreg();
 void bind_trainer_whitening();
 void bind_trainer_wccn();
 void bind_trainer_cost();
+void bind_trainer_minibatch();
 
 #if WITH_LIBSVM
 void bind_trainer_svm();
@@ -68,6 +69,7 @@ BOOST_PYTHON_MODULE(_trainer) {
   bind_trainer_whitening();
   bind_trainer_wccn();
   bind_trainer_cost();
+  bind_trainer_minibatch();
 # if WITH_LIBSVM
   bind_trainer_svm();
 # endif
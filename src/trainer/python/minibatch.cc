@@ -0,0 +1,138 @@
+/**
+ * @file trainer/python/minibatch.cc
+ * @date Sat Oct 17 18:42:10 2026 +0200
+ *
+ * @brief Python bindings to the sample sources and to the mini-batch
+ * (online) k-means and GMM trainers
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+#include <bob/python/ndarray.h>
+#include <bob/trainer/SampleSource.h>
+#include <bob/trainer/MiniBatchKMeansTrainer.h>
+#include <bob/trainer/OnlineGMMTrainer.h>
+
+using namespace boost::python;
+
+static boost::shared_ptr<bob::trainer::ArraySampleSource>
+py_array_source(bob::python::const_ndarray data)
+{
+  return boost::shared_ptr<bob::trainer::ArraySampleSource>(
+    new bob::trainer::ArraySampleSource(data.bz<double,2>()));
+}
+
+static boost::shared_ptr<bob::trainer::FileSampleSource>
+py_file_source(object filenames)
+{
+  stl_input_iterator<std::string> begin(filenames), end;
+  std::vector<std::string> v(begin, end);
+  return boost::shared_ptr<bob::trainer::FileSampleSource>(
+    new bob::trainer::FileSampleSource(v));
+}
+
+static object py_source_read(bob::trainer::SampleSource& source,
+  const size_t n_samples)
+{
+  blitz::Array<double,2> block(n_samples, source.getNInputs());
+  const size_t n = source.read(block);
+  bob::python::ndarray block_new(bob::core::array::t_float64, n,
+    source.getNInputs());
+  blitz::Array<double,2> block_new_ = block_new.bz<double,2>();
+  if (n > 0)
+    block_new_ = block(blitz::Range(0, n-1), blitz::Range::all());
+  return block_new.self();
+}
+
+static void py_kmeans_update(bob::trainer::MiniBatchKMeansTrainer& t,
+  bob::machine::KMeansMachine& m, bob::python::const_ndarray batch)
+{
+  t.update(m, batch.bz<double,2>());
+}
+
+static object py_kmeans_get_counts(const bob::trainer::MiniBatchKMeansTrainer& t)
+{
+  const blitz::Array<double,1>& counts = t.getCounts();
+  bob::python::ndarray counts_new(bob::core::array::t_float64,
+    counts.extent(0));
+  blitz::Array<double,1> counts_new_ = counts_new.bz<double,1>();
+  counts_new_ = counts;
+  return counts_new.self();
+}
+
+static void py_gmm_update(bob::trainer::OnlineGMMTrainer& t,
+  bob::machine::GMMMachine& m, bob::python::const_ndarray batch)
+{
+  t.update(m, batch.bz<double,2>());
+}
+
+static object py_gmm_get_gmmstats(const bob::trainer::OnlineGMMTrainer& t)
+{
+  bob::machine::GMMStats s(t.getGMMStats());
+  return object(s);
+}
+
+void bind_trainer_minibatch()
+{
+  class_<bob::trainer::SampleSource, boost::shared_ptr<bob::trainer::SampleSource>, boost::noncopyable>("SampleSource", "A pull-based source of training samples (one sample per row), which is read sequentially by blocks of rows, such that trainers can process training sets that do not fit in memory.", no_init)
+    .add_property("n_inputs", &bob::trainer::SampleSource::getNInputs, "The dimensionality of the samples")
+    .def("read", &py_source_read, (arg("self"), arg("n_samples")), "Reads (at most) the next n_samples samples, and returns them as a 2D array. An empty array is returned once all the samples have been read.")
+    .def("reset", &bob::trainer::SampleSource::reset, (arg("self")), "Restarts the reading from the first sample")
+    ;
+
+  class_<bob::trainer::ArraySampleSource, boost::shared_ptr<bob::trainer::ArraySampleSource>, bases<bob::trainer::SampleSource>, boost::noncopyable>("ArraySampleSource", "A source of samples stored in memory (one sample per row). The data is copied internally.", no_init)
+    .def("__init__", make_constructor(&py_array_source, default_call_policies(), (arg("data"))), "Builds a source from a 2D array of samples")
+    ;
+
+  class_<bob::trainer::FileSampleSource, boost::shared_ptr<bob::trainer::FileSampleSource>, bases<bob::trainer::SampleSource>, boost::noncopyable>("FileSampleSource", "A source of samples stored in a list of files (e.g. HDF5 files), which are opened one after the other. Each file contains either 2D arrays, with one sample per row, or 1D arrays, with one sample each. HDF5 files are read by blocks of rows, which are never larger than the number of samples requested by read(), whatever the size of the stored arrays. Other files are read one array at a time.", no_init)
+    .def("__init__", make_constructor(&py_file_source, default_call_policies(), (arg("filenames"))), "Builds a source from a list of filenames")
+    ;
+
+  class_<bob::trainer::MiniBatchKMeansTrainer, boost::shared_ptr<bob::trainer::MiniBatchKMeansTrainer> >("MiniBatchKMeansTrainer", "Trains a KMeansMachine using mini-batch k-means: the samples of each batch are assigned to their closest mean, and each mean is then moved towards the samples assigned to it, with a learning rate equal to the inverse of the number of samples assigned to it so far. Only one batch is kept in memory.\nReference: D. Sculley, \"Web-scale k-means clustering\", WWW 2010", init<optional<const size_t, const double, const size_t, const bob::trainer::KMeansTrainer::InitializationMethod> >((arg("batch_size")=1000, arg("convergence_threshold")=0.001, arg("max_iterations")=10, arg("initialization_method")=bob::trainer::KMeansTrainer::RANDOM), "Builds a new trainer"))
+    .def(init<const bob::trainer::MiniBatchKMeansTrainer&>((arg("other")), "Copy constructs a MiniBatchKMeansTrainer"))
+    .def(self == self)
+    .def(self != self)
+    .add_property("batch_size", &bob::trainer::MiniBatchKMeansTrainer::getBatchSize, &bob::trainer::MiniBatchKMeansTrainer::setBatchSize, "The number of samples of each batch")
+    .add_property("convergence_threshold", &bob::trainer::MiniBatchKMeansTrainer::getConvergenceThreshold, &bob::trainer::MiniBatchKMeansTrainer::setConvergenceThreshold, "The convergence threshold on the relative change of the average min distance over a pass")
+    .add_property("max_iterations", &bob::trainer::MiniBatchKMeansTrainer::getMaxIterations, &bob::trainer::MiniBatchKMeansTrainer::setMaxIterations, "The maximum number of passes over the data")
+    .add_property("initialization_method", &bob::trainer::MiniBatchKMeansTrainer::getInitializationMethod, &bob::trainer::MiniBatchKMeansTrainer::setInitializationMethod, "The method used to initialize the means from the first batch")
+    .add_property("rng", &bob::trainer::MiniBatchKMeansTrainer::getRng, &bob::trainer::MiniBatchKMeansTrainer::setRng, "The Mersenne Twister mt19937 random generator used for the initialization of the means.")
+    .add_property("n_threads", &bob::trainer::MiniBatchKMeansTrainer::getNThreads, &bob::trainer::MiniBatchKMeansTrainer::setNThreads, "The number of threads used to assign the samples of a batch (0 means as many threads as hardware cores)")
+    .add_property("counts", &py_kmeans_get_counts, "The number of samples assigned to each mean so far")
+    .add_property("average_min_distance", &bob::trainer::MiniBatchKMeansTrainer::getAverageMinDistance, "The average min (square Euclidean) distance of the samples of the last pass over the data (or of the last batch)")
+    .def("initialization", &bob::trainer::MiniBatchKMeansTrainer::initialization, (arg("self"), arg("machine"), arg("source")), "Initializes the means using the first batch of the source")
+    .def("update", &py_kmeans_update, (arg("self"), arg("machine"), arg("batch")), "Updates the means using a batch of samples")
+    .def("train", &bob::trainer::MiniBatchKMeansTrainer::train, (arg("self"), arg("machine"), arg("source")), "Initializes the means, and then updates them with all the batches of the source, until convergence")
+    ;
+
+  class_<bob::trainer::OnlineGMMTrainer, boost::shared_ptr<bob::trainer::OnlineGMMTrainer> >("OnlineGMMTrainer", "Trains a GMMMachine (maximum likelihood) using stepwise EM: the sufficient statistics of each batch, normalized by its number of samples, are interpolated with the running statistics, s <- (1-eta_t) s + eta_t s_t, using the decreasing step size eta_t = (t+1)^-kappa, and the parameters are re-estimated after each batch. Only one batch is kept in memory. The GMM should be initialized beforehand (e.g. using k-means).\nReference: P. Liang and D. Klein, \"Online EM for unsupervised models\", NAACL 2009", init<optional<const size_t, const double, const bool, const bool, const bool, const double> >((arg("batch_size")=1000, arg("forgetting_rate")=0.6, arg("update_means")=true, arg("update_variances")=false, arg("update_weights")=false, arg("mean_var_update_responsibilities_threshold")=std::numeric_limits<double>::epsilon()), "Builds a new trainer"))
+    .def(init<const bob::trainer::OnlineGMMTrainer&>((arg("other")), "Copy constructs an OnlineGMMTrainer"))
+    .def(self == self)
+    .def(self != self)
+    .add_property("batch_size", &bob::trainer::OnlineGMMTrainer::getBatchSize, &bob::trainer::OnlineGMMTrainer::setBatchSize, "The number of samples of each batch")
+    .add_property("forgetting_rate", &bob::trainer::OnlineGMMTrainer::getForgettingRate, &bob::trainer::OnlineGMMTrainer::setForgettingRate, "The forgetting rate kappa of the step size, in ]0.5,1]")
+    .add_property("convergence_threshold", &bob::trainer::OnlineGMMTrainer::getConvergenceThreshold, &bob::trainer::OnlineGMMTrainer::setConvergenceThreshold, "The convergence threshold on the relative change of the average log likelihood over a pass")
+    .add_property("max_iterations", &bob::trainer::OnlineGMMTrainer::getMaxIterations, &bob::trainer::OnlineGMMTrainer::setMaxIterations, "The maximum number of passes over the data")
+    .add_property("n_threads", &bob::trainer::OnlineGMMTrainer::getNThreads, &bob::trainer::OnlineGMMTrainer::setNThreads, "The number of threads used to compute the statistics of a batch (0 means as many threads as hardware cores)")
+    .add_property("gmm_statistics", &py_gmm_get_gmmstats, "The running statistics, normalized by the number of samples")
+    .add_property("n_updates", &bob::trainer::OnlineGMMTrainer::getNUpdates, "The number of batches processed since the initialization")
+    .add_property("average_log_likelihood", &bob::trainer::OnlineGMMTrainer::getAverageLogLikelihood, "The average log likelihood of the samples of the last pass over the data (or of the last batch)")
+    .def("initialization", &bob::trainer::OnlineGMMTrainer::initialization, (arg("self"), arg("machine")), "Resets the running statistics")
+    .def("update", &py_gmm_update, (arg("self"), arg("machine"), arg("batch")), "Updates the running statistics and the parameters of the GMM using a batch of samples")
+    .def("train", &bob::trainer::OnlineGMMTrainer::train, (arg("self"), arg("machine"), arg("source")), "Resets the running statistics, and then updates the GMM with all the batches of the source, until convergence")
+    ;
+}
@@ -31,6 +31,7 @@
 #include "bob/visioner/cv/cv_detector.h"
 #include "bob/visioner/model/mdecoder.h"
 #include "bob/visioner/util/timer.h"
+#include "bob/visioner/util/threads.h"
 
 namespace bob { namespace visioner {
 
@@ -40,6 +41,7 @@ namespace bob { namespace visioner {
     m_cluster(0.05),
     m_threshold(0.0),
     m_type(GroundTruth),
+    m_threads(0),
     m_levels(0)
   {
   }
@@ -84,7 +86,11 @@ namespace bob { namespace visioner {
       
       ("detect_method",
        boost::program_options::value<std::string>()->default_value("groundtruth"),
-       "detection: method (scanning, groundtruth)");
+       "detection: method (scanning, groundtruth)")
+
+      ("detect_threads",
+       boost::program_options::value<uint64_t>()->default_value(m_threads),
+       "detection: number of scanning threads (0 - current thread)");
 
   }
 
@@ -104,6 +110,8 @@ namespace bob { namespace visioner {
       return false;
     }
 
+    m_tmodels.clear();
+
     param_t _param = param();
     _param.m_ds = m_ds;
     m_ipyramid.reset(_param); 
@@ -113,6 +121,7 @@ namespace bob { namespace visioner {
     decode_var(po_desc, po_vm, "detect_levels", m_levels);
     decode_var(po_desc, po_vm, "detect_ds", m_ds);
     decode_var(po_desc, po_vm, "detect_cluster", m_cluster);     
+    decode_var(po_desc, po_vm, "detect_threads", m_threads);
 
     std::string cmd_method;
     decode_var(po_desc, po_vm, "detect_method", cmd_method);
@@ -143,7 +152,8 @@ namespace bob { namespace visioner {
     m_ds(scale_variation),
     m_cluster(clustering),
     m_threshold(threshold),
-    m_type(detection_method) {
+    m_type(detection_method),
+    m_threads(0) {
 
       // Load the model
       if (Model::load(model, m_model) == false) {
@@ -256,44 +266,75 @@ namespace bob { namespace visioner {
       return false;
     }
 
-    // Scan the image ... 
-    Timer timer;
+    // Split the scanning in bands of columns at each scale and for each
+    //  model type (NB: the order of the work items is the scanning order)
+    const int band = 16;
+    std::vector<scan_item_t> items;
     for (uint64_t is = 0; is < m_ipyramid.size(); is ++)
     {
       const ipscale_t& ip = m_ipyramid[is];
-      m_model->preprocess(ip);
-
-      // ... with every model type
+      const int band_dx = band * ip.m_scan_dx;
       for (uint64_t o = 0; o < n_outputs(); o ++)
       {
-        for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
-          for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
-          {
-            // Concentrate computation on the most promising detections
-            double score = 0.0;
-            for (uint64_t l = 0; l <= m_levels && score >= 0.0; l ++)
-            {
-              const uint64_t lbegin = m_lmodel_begins[o][l];
-              const uint64_t lend = m_lmodel_ends[o][l];
-              score += m_model->score(o, lbegin, lend, x, y);
-
-              // Update statistics
-              m_stats.m_evals += lend - lbegin;
-            }
+        for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += band_dx)
+        {
+          scan_item_t item;
+          item.m_scale = is;
+          item.m_output = o;
+          item.m_min_x = x;
+          item.m_max_x = std::min(x + band_dx, ip.m_scan_max_x);
+          items.push_back(item);
+        }
+      }
+    }
 
-            // Threshold detection and map it to the original image size
-            if (score >= m_threshold)
-            {
-              detections.push_back(make_detection(
-                    score, 
-                    m_ipyramid.map(subwindow_t(x, y, is)), 
-                    o));
-            }
+    // Scan the image ... 
+    Timer timer;
+    std::vector<std::vector<detection_t> > idetections(items.size());
 
-            // Update statistics
-            m_stats.m_sws ++;
-          }
+    const uint64_t n_threads = std::min(m_threads, (uint64_t)items.size());
+    std::vector<stats_t> tstats(std::max(n_threads, (uint64_t)1));
+    std::vector<Model*> tmodels;
+    if (n_threads <= 1)
+    {
+      // The detector's model is used when scanning in the current thread
+      tmodels.push_back(m_model.get());
+      scan_mt(0, std::pair<uint64_t,uint64_t>(0, items.size()),
+          items, tmodels, idetections, tstats);
+    }
+    else
+    {
+      // Each thread preprocesses the images with its own model
+      if (m_tmodels.size() < n_threads)
+      {
+        for (uint64_t ith = m_tmodels.size(); ith < n_threads; ith ++)
+        {
+          m_tmodels.push_back(m_model->clone());
+        }
+      }
+      for (uint64_t ith = 0; ith < n_threads; ith ++)
+      {
+        tmodels.push_back(m_tmodels[ith].get());
       }
+
+      thread_iloop(
+          boost::bind(&CVDetector::scan_mt, this, 
+            boost::lambda::_1, boost::lambda::_2, boost::cref(items), 
+            boost::cref(tmodels), boost::ref(idetections), 
+            boost::ref(tstats)),
+          items.size(), n_threads);
+    }
+
+    // Merge the detections in the scanning order
+    for (uint64_t i = 0; i < idetections.size(); i ++)
+    {
+      detections.insert(detections.end(), 
+          idetections[i].begin(), idetections[i].end());
+    }
+    for (uint64_t ith = 0; ith < tstats.size(); ith ++)
+    {
+      m_stats.m_sws += tstats[ith].m_sws;
+      m_stats.m_evals += tstats[ith].m_evals;
     }
 
     // Update statistics
@@ -305,6 +346,60 @@ namespace bob { namespace visioner {
     return true;
   }
 
+  // Scan the [begin, end) work items
+  void CVDetector::scan_mt(uint64_t ith, 
+      const std::pair<uint64_t, uint64_t>& range,
+      const std::vector<scan_item_t>& items,
+      const std::vector<Model*>& tmodels,
+      std::vector<std::vector<detection_t> >& idetections,
+      std::vector<stats_t>& tstats) const
+  {
+    Model& model = *tmodels[ith];
+    stats_t& stats = tstats[ith];
+
+    uint64_t crt_scale = m_ipyramid.size();
+    for (uint64_t i = range.first; i < range.second; i ++)
+    {
+      const scan_item_t& item = items[i];
+      const ipscale_t& ip = m_ipyramid[item.m_scale];
+      if (item.m_scale != crt_scale)
+      {
+        model.preprocess(ip);
+        crt_scale = item.m_scale;
+      }
+
+      const uint64_t o = item.m_output;
+      std::vector<detection_t>& detections = idetections[i];
+      for (int x = item.m_min_x; x < item.m_max_x; x += ip.m_scan_dx)
+        for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
+        {
+          // Concentrate computation on the most promising detections
+          double score = 0.0;
+          for (uint64_t l = 0; l <= m_levels && score >= 0.0; l ++)
+          {
+            const uint64_t lbegin = m_lmodel_begins[o][l];
+            const uint64_t lend = m_lmodel_ends[o][l];
+            score += model.score(o, lbegin, lend, x, y);
+
+            // Update statistics
+            stats.m_evals += lend - lbegin;
+          }
+
+          // Threshold detection and map it to the original image size
+          if (score >= m_threshold)
+          {
+            detections.push_back(make_detection(
+                  score, 
+                  m_ipyramid.map(subwindow_t(x, y, item.m_scale)), 
+                  o));
+          }
+
+          // Update statistics
+          stats.m_sws ++;
+        }
+    }
+  }
+
   // Match detections with ground truth locations
   bool CVDetector::match(const detection_t& detection, Object& object) const
   {
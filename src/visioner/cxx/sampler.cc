@@ -333,8 +333,10 @@ namespace bob { namespace visioner {
     data.resize(n_outputs(), samples.size(), model.n_features(), model.n_fvalues());
 
     // Split the computation (buffer the feature values and the targets)
+    // NB: one range per thread, as th_map clones the model and preprocesses
+    //  the images at each call
     std::vector<uint64_t> types(samples.size(), 0);
-    thread_loop(
+    thread_sloop(
         boost::bind(
           &Sampler::th_map, this, boost::lambda::_1,
           boost::cref(samples), boost::cref(model), boost::ref(types), boost::ref(data)), samples.size(), threads);
@@ -0,0 +1,150 @@
+/**
+ * @file visioner/cxx/test/threads.cc
+ * @date Sat 17 Oct 2026 10:12:41 CEST
+ *
+ * @brief Tests the thread pool and the multi-threaded loops of Visioner
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Visioner-Threads Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <vector>
+#include <bob/visioner/util/threads.h>
+
+typedef std::pair<uint64_t, uint64_t> range_t;
+
+// Records the ranges processed by the threads
+struct Recorder {
+  boost::mutex m_mutex;
+  std::vector<range_t> m_ranges;
+  std::vector<boost::thread::id> m_ids;
+
+  void op(range_t range) {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_ranges.push_back(range);
+    m_ids.push_back(boost::this_thread::get_id());
+  }
+
+  void iop(size_t ith, range_t range) {
+    op(range);
+  }
+
+  // Number of times each object was processed
+  // NB: the last entry counts the invalid ranges
+  std::vector<size_t> visits(uint64_t size) const {
+    std::vector<size_t> result(size + 1, 0);
+    for (size_t i = 0; i < m_ranges.size(); ++ i) {
+      if (m_ranges[i].first > m_ranges[i].second || 
+          m_ranges[i].second > size) {
+        ++ result[size];
+        continue;
+      }
+      for (uint64_t k = m_ranges[i].first; k < m_ranges[i].second; ++ k) {
+        ++ result[k];
+      }
+    }
+    return result;
+  }
+};
+
+void check_visits(const Recorder& recorder, uint64_t size) {
+  const std::vector<size_t> visits = recorder.visits(size);
+  for (uint64_t k = 0; k < size; ++ k) {
+    BOOST_CHECK_EQUAL(visits[k], 1);
+  }
+  BOOST_CHECK_EQUAL(visits[size], 0);
+}
+
+// Runs a nested loop and checks (from the calling thread) that it was
+// executed inline and that each object was processed once
+void nested(std::vector<int>& ok, size_t ith, range_t range) {
+  Recorder inner;
+  bob::visioner::thread_loop(boost::bind(&Recorder::op, &inner, _1), 100, 4);
+
+  bool result = true;
+  const std::vector<size_t> visits = inner.visits(100);
+  for (uint64_t k = 0; k < 100; ++ k) {
+    result = result && visits[k] == 1;
+  }
+  result = result && visits[100] == 0;
+  for (size_t i = 0; i < inner.m_ids.size(); ++ i) {
+    result = result && inner.m_ids[i] == boost::this_thread::get_id();
+  }
+  ok[ith] = result ? 1 : 0;
+}
+
+void throwing(uint64_t bad, range_t range) {
+  if (range.first <= bad && bad < range.second) {
+    throw std::runtime_error("failure in a worker thread");
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( test_setup )
+
+BOOST_AUTO_TEST_CASE( test_visioner_thread_loop_visits )
+{
+  static const uint64_t sizes[] = {0, 1, 2, 7, 97, 1000, 4099};
+  static const size_t threads[] = {1, 2, 3, 5, 8};
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++ s) {
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++ t) {
+      Recorder dynamic;
+      bob::visioner::thread_loop(boost::bind(&Recorder::op, &dynamic, _1), sizes[s], threads[t]);
+      check_visits(dynamic, sizes[s]);
+
+      Recorder split;
+      bob::visioner::thread_sloop(boost::bind(&Recorder::op, &split, _1), sizes[s], threads[t]);
+      check_visits(split, sizes[s]);
+      BOOST_CHECK(split.m_ranges.size() <= threads[t]);
+
+      Recorder indexed;
+      bob::visioner::thread_iloop(
+          boost::bind(&Recorder::iop, &indexed, _1, _2), sizes[s], threads[t]);
+      check_visits(indexed, sizes[s]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_visioner_thread_loop_nested )
+{
+  // A loop submitted from a worker of the pool runs in the worker itself
+  std::vector<int> ok(4, 0);
+  bob::visioner::thread_iloop(
+      boost::bind(&nested, boost::ref(ok), _1, _2), 4, 4);
+  for (size_t ith = 0; ith < ok.size(); ++ ith) {
+    BOOST_CHECK_EQUAL(ok[ith], 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_visioner_thread_loop_exception )
+{
+  for (uint64_t bad = 0; bad < 1000; bad += 111) {
+    BOOST_CHECK_THROW(bob::visioner::thread_loop(
+          boost::bind(&throwing, bad, _1), 1000, 4), std::runtime_error);
+    BOOST_CHECK_THROW(bob::visioner::thread_sloop(
+          boost::bind(&throwing, bad, _1), 1000, 4), std::runtime_error);
+  }
+
+  // The pool is still usable after an exception
+  Recorder recorder;
+  bob::visioner::thread_loop(boost::bind(&Recorder::op, &recorder, _1), 1000, 4);
+  check_visits(recorder, 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -38,3 +38,209 @@ void bob::visioner::thread_split(uint64_t n_objects,
   }
 
 }
+
+namespace {
+
+  // Set for the worker threads of a pool, to detect nested jobs
+  boost::thread_specific_ptr<bool> s_is_worker;
+
+  bool is_worker() {
+    return s_is_worker.get() != 0 && *s_is_worker == true;
+  }
+
+}
+
+bob::visioner::ThreadPool::ThreadPool(size_t n_workers)
+  : m_n_slots(0), m_pending(0), m_generation(0), m_stop(false)
+{
+  start(n_workers);
+}
+
+bob::visioner::ThreadPool::~ThreadPool() {
+  stop();
+}
+
+void bob::visioner::ThreadPool::start(size_t n_workers) {
+  if (n_workers == 0) n_workers = boost::thread::hardware_concurrency();
+
+  m_stop = false;
+  for (size_t i = m_workers.size(); i < n_workers; ++ i) {
+    m_workers.push_back(boost::shared_ptr<boost::thread>(new boost::thread(
+            boost::bind(&ThreadPool::work, this, i, m_generation))));
+  }
+}
+
+void bob::visioner::ThreadPool::stop() {
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_job_ready.notify_all();
+
+  for (size_t i = 0; i < m_workers.size(); ++ i) {
+    m_workers[i]->join();
+  }
+  m_workers.clear();
+}
+
+void bob::visioner::ThreadPool::resize(size_t n_workers) {
+  boost::lock_guard<boost::mutex> submit(m_submit);
+  stop();
+  start(n_workers);
+}
+
+void bob::visioner::ThreadPool::execute(const job_t& job, size_t n_slots) {
+
+  if (n_slots == 0) {
+    return;
+  }
+
+  // Nothing to gain from the pool: run in the calling thread
+  if (n_slots == 1 || is_worker() == true) {
+    for (size_t slot = 0; slot < n_slots; ++ slot) {
+      job(slot);
+    }
+    return;
+  }
+
+  boost::lock_guard<boost::mutex> submit(m_submit);
+  if (m_workers.size() < n_slots) {
+    start(n_slots);
+  }
+
+  std::exception_ptr error;
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_job = job;
+    m_n_slots = n_slots;
+    m_pending = n_slots;
+    m_error = std::exception_ptr();
+    ++ m_generation;
+
+    m_job_ready.notify_all();
+    while (m_pending > 0) {
+      m_job_done.wait(lock);
+    }
+
+    m_job = job_t();
+    error = m_error;
+    m_error = std::exception_ptr();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void bob::visioner::ThreadPool::work(size_t index, uint64_t generation) {
+
+  s_is_worker.reset(new bool(true));
+
+  while (true) {
+
+    job_t job;
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while (m_stop == false && 
+          (m_generation == generation || index >= m_n_slots)) {
+        generation = m_generation;
+        m_job_ready.wait(lock);
+      }
+      if (m_stop == true) {
+        return;
+      }
+      generation = m_generation;
+      job = m_job;
+    }
+
+    std::exception_ptr error;
+    try {
+      job(index);
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      if (error && !m_error) {
+        m_error = error;
+      }
+      if (-- m_pending == 0) {
+        m_job_done.notify_all();
+      }
+    }
+  }
+}
+
+bob::visioner::ThreadPool& bob::visioner::ThreadPool::instance() {
+  static ThreadPool pool(boost::thread::hardware_concurrency());
+  return pool;
+}
+
+bob::visioner::WorkRanges::WorkRanges(uint64_t size, size_t n_slots, 
+    uint64_t grain)
+  : m_shares(new share_t[std::max(n_slots, (size_t)1)]), 
+    m_n_slots(std::max(n_slots, (size_t)1)), 
+    m_grain(std::max(grain, (uint64_t)1))
+{
+  for (size_t s = 0; s < m_n_slots; ++ s) {
+    m_shares[s].m_begin = (size * s) / m_n_slots;
+    m_shares[s].m_end = (size * (s + 1)) / m_n_slots;
+  }
+}
+
+bool bob::visioner::WorkRanges::next(size_t slot, 
+    std::pair<uint64_t, uint64_t>& chunk) {
+
+  share_t& own = m_shares[slot];
+  while (true) {
+
+    // Take a chunk from the front of its own share ...
+    {
+      boost::lock_guard<boost::mutex> lock(own.m_mutex);
+      if (own.m_begin < own.m_end) {
+        chunk.first = own.m_begin;
+        chunk.second = std::min(own.m_begin + m_grain, own.m_end);
+        own.m_begin = chunk.second;
+        return true;
+      }
+    }
+
+    // ... or steal the upper half of the largest remaining share
+    size_t victim = m_n_slots;
+    uint64_t victim_size = 0;
+    for (size_t s = 0; s < m_n_slots; ++ s) {
+      if (s == slot) continue;
+      boost::lock_guard<boost::mutex> lock(m_shares[s].m_mutex);
+      const uint64_t size = m_shares[s].m_end - m_shares[s].m_begin;
+      if (size > victim_size) {
+        victim = s;
+        victim_size = size;
+      }
+    }
+
+    if (victim == m_n_slots) {
+      return false;
+    }
+
+    uint64_t begin = 0, end = 0;
+    {
+      boost::lock_guard<boost::mutex> lock(m_shares[victim].m_mutex);
+      share_t& other = m_shares[victim];
+      if (other.m_begin < other.m_end) {
+        begin = other.m_begin + (other.m_end - other.m_begin) / 2;
+        end = other.m_end;
+        other.m_end = begin;
+      }
+    }
+
+    // NB: the stolen range becomes its own share (the victim may have been
+    //  emptied meanwhile, in which case another victim is searched).
+    if (begin < end) {
+      boost::lock_guard<boost::mutex> lock(own.m_mutex);
+      own.m_begin = begin;
+      own.m_end = end;
+    }
+  }
+}
@@ -112,6 +112,11 @@ static boost::python::object locate(bob::visioner::CVLocalizer& loc,
   return boost::python::make_tuple(bbox, boost::python::tuple(tmp));
 }
 
+static boost::python::tuple detector_stats(const bob::visioner::CVDetector& det) {
+  const bob::visioner::CVDetector::stats_t& stats = det.stats();
+  return boost::python::make_tuple(stats.m_gts, stats.m_sws, stats.m_evals);
+}
+
 void bind_visioner_localize() {
   boost::python::enum_<bob::visioner::CVDetector::Type>("DetectionMethod")
     .value("Scanning", bob::visioner::CVDetector::Scanning)
@@ -124,6 +129,8 @@ void bind_visioner_localize() {
     .def_readwrite("scale_variation", &bob::visioner::CVDetector::m_ds, "Scale variation in pixels")
     .def_readwrite("clustering", &bob::visioner::CVDetector::m_cluster, "Overlapping threshold for clustering detections")
     .def_readwrite("method", &bob::visioner::CVDetector::m_type, "Scanning or GroundTruth (default)")
+    .def_readwrite("threads", &bob::visioner::CVDetector::m_threads, "Number of threads used for scanning (0 or 1 to scan in the current thread, the default). The detections are the same whatever the number of threads.")
+    .add_property("stats", &detector_stats, "Scanning statistics accumulated since this detector was created, as a tuple with the number of ground truth objects, the number of sub-windows processed and the number of look-up table evaluations")
     .def("detect", &detect, (boost::python::arg("self"), boost::python::arg("image")), "Detects faces in the input (gray-scaled) image according to the current settings. The input image format should be a 2D array of dtype=uint8.")
     .def("detect_max", &detect_max, (boost::python::arg("self"), boost::python::arg("image")), "Detects the most probable face in the input (gray-scaled) image according to the current settings")
     .def("save", &bob::visioner::CVDetector::save, (boost::python::arg("self"), boost::python::arg("filename")), "Saves the model and parameters to a given file.\n\n**Note**: Serialization will use a native text format by default. Files that have their name suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format.")